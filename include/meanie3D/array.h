@@ -25,9 +25,12 @@
 #define M3D_ARRAY_INCLUDES_H
 
 #include <meanie3D/array/array_index.h>
+#include <meanie3D/array/dense_grid.h>
 #include <meanie3D/array/linear_index_mapping.h>
 #include <meanie3D/array/multiarray.h>
 #include <meanie3D/array/multiarray_blitz.h>
+#include <meanie3D/array/multiarray_dense.h>
+#include <meanie3D/array/multiarray_linear.h>
 #include <meanie3D/array/multiarray_recursive.h>
 #include <meanie3D/array/multiarray_boost.h>
 
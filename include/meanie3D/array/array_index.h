@@ -27,8 +27,10 @@
 
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
+#include <meanie3D/array/multiarray_dense.h>
 #include <meanie3D/featurespace/point.h>
 
+#include <boost/cstdint.hpp>
 #include <vector>
 #include <netcdf>
 
@@ -36,13 +38,34 @@ namespace m3D {
 
     using std::vector;
 
+    /** Index of points by grid point. The grid is a DenseGrid of
+     * point ids (-1 for empty grid points), the points themselves
+     * live in a table addressed by those ids.
+     * Neighbourhood queries walk a pre-computed table of linear
+     * offsets, which reduces the 3^d neighbourhood of a grid point
+     * in the interior of the grid to 3^d loads.
+     */
     template <class T>
     class ArrayIndex
     {
+    public:
+
+        /** Type of the point ids stored in the grid */
+        typedef boost::int32_t id_t;
+
+        /** Marks an empty grid point */
+        static const id_t NO_POINT = -1;
+
     protected:
 
-        typedef vector<void*> array_t;
-        typedef array_t* array_t_ptr;
+        /** Linear offsets of all grid points in a neighbourhood
+         * of a given reach, for use in the interior of the grid.
+         */
+        struct offset_table_t
+        {
+            size_t reach;
+            vector<long> linear;
+        };
 
 #pragma mark -
 #pragma mark Attributes
@@ -50,63 +73,74 @@ namespace m3D {
     private:
 
         vector<size_t> m_dimensions;
-        array_t *m_data;
+        MultiArray<id_t> *m_id_grid;
+        DenseGridView<id_t> m_ids;
+        typename Point<T>::list m_points;
         bool m_make_copies;
 
-        /** Called by build_index, copy constructor
-         */
-        void
-        construct_array_recursive(size_t dim_index,
-                array_t **array,
-                vector<int> &gridpoint,
-                ArrayIndex<T> *other = NULL);
+        /** Offset table for reach 1 (built at construction) */
+        offset_table_t m_offsets;
 
-        /** Called by destructor.
+        /** Sets up the id grid and offset table.
          */
         void
-        destroy_array_recursive(size_t dim_index,
-                array_t **array,
-                vector<int> &gridpoint);
+        initialise();
 
-        /** Copy all points from the final dimension into the list provided
+        /** Fills the given offset table for the given reach.
          */
         void
-        add_points_to_list(typename Point<T>::list &points,
-                vector<int> &gridpoint);
+        build_offsets(size_t reach, offset_table_t &table) const;
 
-        /** Called by replace_points.
+        /** @return linear index of the given grid point or -1
+         * if it lies outside of the grid.
+         * @throws std::invalid_argument if any but the last
+         *         index is out of range.
          */
-        void
-        replace_points_recursive(typename Point<T>::list &points,
-                size_t dim_index,
-                vector<int> &gridpoint);
-
-        void
-        get_points_from_index(ArrayIndex<T> *otherIndex,
-                vector<int> &gridpoint);
-        void
-        copy_points_recursive(ArrayIndex<T> *otherIndex,
-                size_t dim_index,
-                vector<int> &gridpoint);
-
-        void
-        count_recursive(size_t dim_index,
-                array_t *array,
-                vector<int> &gridpoint,
-                size_t &count,
-                bool originalPointsOnly = false);
-
-        void
-        clear_recursive(size_t dim_index,
-                array_t *array,
-                vector<int> &gridpoint,
-                bool delete_points);
-
-        void
-        find_neighbours_recursive(vector<int> &gridpoint,
-                size_t dim_index,
-                typename Point<T>::list &list,
-                size_t reach);
+        long
+        linear_index(const vector<int> &gp) const;
+
+        /** Core of the neighbourhood search. Calls sink(id) for every
+         * occupied grid point in the neighbourhood described by the
+         * given offset table. Grid points in the interior are resolved
+         * by offset alone, at the edges the neighbourhood is walked
+         * with the grid's clipping neighbourhood iterator.
+         * @return number of ids handed to the sink
+         */
+        template <class Sink>
+        size_t
+        for_each_neighbour(const vector<int> &gridpoint,
+                const offset_table_t &table,
+                Sink &sink) const;
+
+        /** Writes ids into a buffer */
+        struct id_sink
+        {
+            id_t *ids;
+
+            inline void operator()(id_t id)
+            {
+                *ids++ = id;
+            }
+        };
+
+        /** Appends the identified points to a list */
+        struct point_sink
+        {
+            const typename Point<T>::list *points;
+            typename Point<T>::list *result;
+
+            inline void operator()(id_t id)
+            {
+                typename Point<T>::ptr p = (*points)[id];
+                if (p != NULL) {
+                    result->push_back(p);
+                }
+            }
+        };
+
+        // Not copyable, use the copy constructor on pointer
+        ArrayIndex(const ArrayIndex<T> &);
+        ArrayIndex<T> &operator=(const ArrayIndex<T> &);
 
 #pragma mark -
 #pragma mark Constructors/Destructors
@@ -176,6 +210,23 @@ namespace m3D {
                 typename Point<T>::ptr p,
                 bool copy = true);
 
+        /** @param grid point (may lie outside of the grid)
+         * @return id of the point at the given grid point or
+         * NO_POINT if there is none. The points of a list handed to
+         * the constructor get their position in that list as id.
+         */
+        id_t
+        id(const vector<int> &gp) const;
+
+        /** @param point id (as returned by find_neighbour_ids)
+         * @return the point with that id
+         */
+        inline typename Point<T>::ptr
+        point(id_t id) const
+        {
+            return m_points[id];
+        }
+
         /** @return the rank (# of dimensions) of this array index
          */
         const size_t rank();
@@ -205,6 +256,35 @@ namespace m3D {
          */
         size_t count(bool originalPointsOnly = false);
 
+        /** @return maximum number of points in a neighbourhood
+         * of the given reach, (2*reach+1)^rank. Use this to size
+         * the buffer handed to find_neighbour_ids.
+         */
+        size_t neighbourhood_size(size_t reach = 1) const;
+
+        /** Find the ids of the points in the neighborhood of the given
+         * gridpoint, including the gridpoint itself, in row-major order.
+         * @param grid point
+         * @param buffer for at least neighbourhood_size(reach) ids
+         * @param neighborhood size (in #grid points)
+         * @return number of ids written
+         */
+        size_t
+        find_neighbour_ids(const vector<int> &gridpoint,
+                id_t *ids,
+                size_t reach = 1) const;
+
+        /** Find the points in the neighborhood of the given gridpoint.
+         * @param grid point
+         * @param list the points are written to (cleared first)
+         * @param neighborhood size (in #grid points)
+         * @return number of points found
+         */
+        size_t
+        find_neighbours(const vector<int> &gridpoint,
+                typename Point<T>::list &result,
+                size_t reach = 1) const;
+
         /** Find the points in the neighborhood of the given gridpoint.
          * @param grid point
          * @param neighborhood size (in #grid points)
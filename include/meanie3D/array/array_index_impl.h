@@ -38,6 +38,9 @@
 
 namespace m3D {
 
+    template <typename T>
+    const typename ArrayIndex<T>::id_t ArrayIndex<T>::NO_POINT;
+
     template <typename T>
     const size_t
     ArrayIndex<T>::rank()
@@ -52,15 +55,17 @@ namespace m3D {
         return m_dimensions;
     };
 
+#pragma mark -
+#pragma mark Constructors/Destructors
+
     template <typename T>
     ArrayIndex<T>::ArrayIndex(const vector<size_t> &dimensions,
             bool make_copies)
     : m_dimensions(dimensions)
-    , m_data(NULL)
+    , m_id_grid(NULL)
     , m_make_copies(make_copies)
     {
-        vector<int> gp = vector<int>(dimensions.size(), 0);
-        this->construct_array_recursive(0, &m_data, gp);
+        this->initialise();
     }
 
     template <typename T>
@@ -68,492 +73,379 @@ namespace m3D {
             const typename Point<T>::list &points,
             bool make_copies)
     : m_dimensions(dimensions)
-    , m_data(NULL)
+    , m_id_grid(NULL)
     , m_make_copies(make_copies)
     {
-        vector<int> gp = vector<int>(dimensions.size(), 0);
-        this->construct_array_recursive(0, &m_data, gp);
+        this->initialise();
         this->index(points);
     }
 
     template <typename T>
     ArrayIndex<T>::ArrayIndex(ArrayIndex<T> *o)
     : m_dimensions(o->m_dimensions)
-    , m_data(NULL)
+    , m_id_grid(create_dense_multiarray<id_t>(o->m_dimensions, NO_POINT))
+    , m_points(o->m_points)
     , m_make_copies(o->m_make_copies)
+    , m_offsets(o->m_offsets)
     {
-        vector<int> gp = vector<int>(o->m_dimensions.size(), 0);
-        this->copy_points_recursive(o, 0, gp);
+        m_id_grid->copy_from(o->m_id_grid);
+        m_ids = DenseGridView<id_t>(m_id_grid);
+
+        if (m_make_copies) {
+            for (size_t i = 0; i < m_points.size(); i++) {
+                if (m_points[i] != NULL) {
+                    m_points[i] = PointFactory<T>::get_instance()->copy(m_points[i]);
+                }
+            }
+        }
     }
 
     template <typename T>
     ArrayIndex<T>::~ArrayIndex()
     {
-        vector<int> gp = vector<int>(m_dimensions.size(), 0);
-        this->destroy_array_recursive(0, &m_data, gp);
+        if (m_make_copies) {
+            for (size_t i = 0; i < m_points.size(); i++) {
+                delete m_points[i];
+            }
+        }
+
+        delete m_id_grid;
     }
 
     template <typename T>
     void
-    ArrayIndex<T>::add_points_to_list(typename Point<T>::list &points,
-            vector<int> &gridpoint)
+    ArrayIndex<T>::initialise()
     {
-        // obtain the size of the last dimension
-
-        size_t dimSize = m_dimensions[gridpoint.size() - 1];
-
-        // copy all points over into the given point list
-        // using the point factory's copy method
+        m_id_grid = create_dense_multiarray<id_t>(m_dimensions, NO_POINT);
 
-        vector<int> gIter = gridpoint;
+        m_ids = DenseGridView<id_t>(m_id_grid);
 
-        for (size_t i = 0; i < dimSize; i++) {
-            gIter[gridpoint.size() - 1] = i;
-
-            typename Point<T>::ptr p = this->get(gIter);
-
-            if (p != NULL) {
-                typename Point<T>::ptr copy = PointFactory<T>::get_instance()->copy(p);
-
-                points.push_back(copy);
-            }
-        }
+        this->build_offsets(1, m_offsets);
     }
 
     template <typename T>
     void
-    ArrayIndex<T>::get_points_from_index(ArrayIndex<T> *otherIndex,
-            vector<int> &gridpoint)
+    ArrayIndex<T>::build_offsets(size_t reach, offset_table_t &table) const
     {
-        // obtain the size of the last dimension
+        size_t rank = m_dimensions.size();
+        size_t n = this->neighbourhood_size(reach);
+        const vector<size_t> &strides = m_ids.strides();
 
-        size_t dimSize = m_dimensions[gridpoint.size() - 1];
+        table.reach = reach;
+        table.linear.resize(n);
 
-        vector<int> gIter = gridpoint;
+        // Walk the (2*reach+1)^rank box in row-major order,
+        // last dimension running fastest.
 
-        for (size_t i = 0; i < dimSize; i++) {
-            gIter[gridpoint.size() - 1] = i;
+        vector<int> delta(rank, -((int) reach));
 
-            typename Point<T>::ptr p = otherIndex->get(gIter);
-
-            // TODO: obtain the pointer to the array directly
-            // instead of using 'set'
+        for (size_t k = 0; k < n; k++) {
+            long offset = 0;
+            for (size_t d = 0; d < rank; d++) {
+                offset += delta[d] * (long) strides[d];
+            }
+            table.linear[k] = offset;
 
-            if (p != NULL) {
-                if (this->m_make_copies) {
-                    this->set(gIter, PointFactory<T>::get_instance()->copy(p));
-                } else {
-                    this->set(gIter, p);
+            for (size_t d = rank; d > 0; d--) {
+                if (delta[d - 1] < (int) reach) {
+                    delta[d - 1]++;
+                    break;
                 }
+                delta[d - 1] = -((int) reach);
             }
         }
     }
 
     template <typename T>
-    void
-    ArrayIndex<T>::replace_points_recursive(typename Point<T>::list &points,
-            size_t dim_index,
-            vector<int> &gridpoint)
+    long
+    ArrayIndex<T>::linear_index(const vector<int> &gp) const
     {
-        size_t dimSize = m_dimensions[dim_index];
-
-        if (m_dimensions.size() == 1) {
-            this->add_points_to_list(points, gridpoint);
-        } else if (dim_index < (m_dimensions.size() - 1)) {
-            for (size_t index = 0; index < dimSize; index++) {
-                gridpoint[dim_index] = index;
+        for (size_t d = 0; d < gp.size(); d++) {
+            int i = gp[d];
 
-                replace_points_recursive(points, dim_index + 1, gridpoint);
+            if (i < 0 || i >= (int) m_dimensions[d]) {
+                if (d < gp.size() - 1) {
+                    throw std::invalid_argument("index parameter out of range");
+                }
+                return -1;
             }
-        } else {
-            this->add_points_to_list(points, gridpoint);
         }
+
+        return (long) m_ids.linear_index(gp);
     }
 
+#pragma mark -
+#pragma mark Indexing operation
+
     template <typename T>
     void
-    ArrayIndex<T>::copy_points_recursive(ArrayIndex<T> *otherIndex,
-            size_t dim_index,
-            vector<int> &gridpoint)
+    ArrayIndex<T>::index(const typename Point<T>::list &list)
     {
-        size_t dimSize = m_dimensions[dim_index];
-
-        if (m_dimensions.size() == 1) {
-            this->get_points_from_index(otherIndex, gridpoint);
-        } else if (dim_index < (m_dimensions.size() - 1)) {
-            for (size_t index = 0; index < dimSize; index++) {
-                gridpoint[dim_index] = index;
+        for (size_t i = 0; i < list.size(); i++) {
+            typename Point<T>::ptr p = list[i];
 
-                copy_points_recursive(otherIndex, dim_index + 1, gridpoint);
-            }
-        } else {
-            this->get_points_from_index(otherIndex, gridpoint);
+            this->set(p->gridpoint, p, this->m_make_copies);
         }
     }
 
+#pragma mark -
+#pragma mark Accessors
+
     template <typename T>
-    void
-    ArrayIndex<T>::replace_points(typename Point<T>::list &points)
+    typename Point<T>::ptr
+    ArrayIndex<T>::get(const vector<int> &gp)
     {
-        // clean the original list out and
-        // release all the points
-
-        for (size_t i = 0; i < points.size(); i++) {
-            typename Point<T>::ptr p = points[i];
+        long index = this->linear_index(gp);
 
-            delete p;
-
-            points[i] = NULL;
+        if (index < 0) {
+            return NULL;
         }
 
-        points.clear();
-
-        vector<int> gp = vector<int>(m_dimensions.size(), 0);
-
-        // Add copies of points from this index
+        id_t id = m_ids.get(index);
 
-        this->replace_points_recursive(points, 0, gp);
+        return (id == NO_POINT) ? NULL : m_points[id];
     }
 
     template <typename T>
-    void
-    ArrayIndex<T>::construct_array_recursive(size_t dim_index,
-            array_t **array,
-            vector<int> &gridpoint,
-            ArrayIndex<T> *other)
+    typename ArrayIndex<T>::id_t
+    ArrayIndex<T>::id(const vector<int> &gp) const
     {
-        size_t dimSize = m_dimensions[dim_index];
-
-        if (m_dimensions.size() == 1) {
-            *array = (array_t *) new vector<typename Point<T>::ptr > (dimSize, NULL);
-
-            if (other != NULL) {
-                this->get_points_from_index(other, gridpoint);
-            }
-        } else if (dim_index < (m_dimensions.size() - 1)) {
-            // create array
-
-            if (dim_index == 0) {
-                vector<void *> *new_array = new vector<void *>(dimSize, NULL);
-
-                *array = new_array;
-
-                for (size_t index = 0; index < dimSize; index++) {
-                    gridpoint[dim_index] = index;
-
-                    construct_array_recursive(dim_index + 1, array, gridpoint, other);
-                }
-            } else {
-                vector<void *> *super_array = *array;
-
-                size_t super_index = gridpoint[dim_index - 1];
-
-                vector<void *> *new_array = new vector<void *>(dimSize, NULL);
-
-                super_array->at(super_index) = new_array;
-
-                for (size_t index = 0; index < dimSize; index++) {
-                    gridpoint[dim_index] = index;
-
-                    construct_array_recursive(dim_index + 1, &new_array, gridpoint);
-                }
-            }
-        } else {
-            vector<void *> *super_array = *array;
-
-            size_t super_index = gridpoint[dim_index - 1];
-
-            vector<typename Point<T>::ptr> *new_array = new vector<typename Point<T>::ptr > (dimSize, NULL);
-
-            super_array->at(super_index) = new_array;
-
-            if (other != NULL) {
-                this->get_points_from_index(other, gridpoint);
+        for (size_t d = 0; d < m_dimensions.size(); d++) {
+            if (gp[d] < 0 || gp[d] >= (int) m_dimensions[d]) {
+                return NO_POINT;
             }
         }
+
+        return m_ids.get(m_ids.linear_index(gp));
     }
 
     template <typename T>
     void
-    ArrayIndex<T>::destroy_array_recursive(size_t dim_index, array_t **array, vector<int> &gridpoint)
+    ArrayIndex<T>::set(const vector<int> &gp, typename Point<T>::ptr p, bool copy)
     {
-        size_t dimSize = m_dimensions[dim_index];
-
-        if (m_dimensions.size() == 1) {
-            delete m_data;
-        } else if (dim_index < (m_dimensions.size() - 1)) {
-            if (dim_index == 0) {
-                vector<void *> *the_array = *array;
-
-                for (size_t index = 0; index < dimSize; index++) {
-                    gridpoint[dim_index] = index;
-
-                    destroy_array_recursive(dim_index + 1, array, gridpoint);
-                }
-
-                delete the_array;
-
-                *array = NULL;
-            } else {
-                size_t super_index = gridpoint[dim_index - 1];
-
-                vector<void *> *super_array = *array;
+        long index;
 
-                vector<void *> *the_array = (vector<void *> *) super_array->at(super_index);
-
-                for (size_t index = 0; index < dimSize; index++) {
-                    gridpoint[dim_index] = index;
+        try {
+            index = this->linear_index(gp);
+        } catch (const std::invalid_argument &e) {
+            cerr << "ERROR:index parameter out of range: " << gp << endl;
+            throw;
+        }
 
-                    destroy_array_recursive(dim_index + 1, &the_array, gridpoint);
-                }
+        if (index < 0) {
+            return;
+        }
 
-                delete the_array;
+        typename Point<T>::ptr point = p;
 
-                super_array->at(super_index) = NULL;
+        if (copy) {
+            point = PointFactory<T>::get_instance()->copy(p);
+            if (p->isOriginalPoint != point->isOriginalPoint) {
+                cerr << "ERROR:could not copy point" << endl;
             }
-        } else {
-            vector<void *> *super_array = *array;
-
-            size_t super_index = gridpoint[dim_index - 1];
-
-            vector<typename Point<T>::ptr> *the_array = (vector<typename Point<T>::ptr> *) super_array->at(super_index);
+        }
 
-            if (this->m_make_copies) {
-                for (size_t i = 0; i < the_array->size(); i++) {
-                    typename Point<T>::ptr p = the_array->at(i);
+        id_t id = m_ids.get(index);
 
-                    if (p != NULL) {
-                        delete p;
-                        the_array->at(i) = NULL;
-                    }
-                }
+        if (id == NO_POINT) {
+            // new points are appended to the point table
+            id = (id_t) m_points.size();
+            m_points.push_back(point);
+            m_ids.set(index, id);
+        } else {
+            // re-use the slot of the existing point
+            if (m_points[id] != NULL && m_points[id] != p) {
+                delete m_points[id];
             }
-
-            super_array->at(super_index) = NULL;
+            m_points[id] = point;
         }
     }
 
+#pragma mark -
+#pragma mark Clear Index
+
     template <typename T>
     void
-    ArrayIndex<T>::index(const typename Point<T>::list &list)
+    ArrayIndex<T>::clear(bool delete_points)
     {
-        for (size_t i = 0; i < list.size(); i++) {
-            typename Point<T>::ptr p = list[i];
-
-            this->set(p->gridpoint, p, this->m_make_copies);
+        if (delete_points) {
+            for (size_t i = 0; i < m_points.size(); i++) {
+                delete m_points[i];
+            }
         }
+
+        m_points.clear();
+
+        m_id_grid->populate_array(NO_POINT);
     }
 
 #pragma mark -
-#pragma mark Accessors
+#pragma mark Misc
 
     template <typename T>
-    typename Point<T>::ptr
-    ArrayIndex<T>::get(const vector<int> &gp)
+    void
+    ArrayIndex<T>::replace_points(typename Point<T>::list &points)
     {
-        vector<void *> *array = m_data;
+        // clean the original list out and
+        // release all the points
 
-        typename Point<T>::ptr result = NULL;
+        for (size_t i = 0; i < points.size(); i++) {
+            typename Point<T>::ptr p = points[i];
 
-        for (size_t dim_index = 0; dim_index < gp.size(); dim_index++) {
-            if (dim_index < gp.size() - 1) {
-                int index = gp[dim_index];
+            delete p;
 
-                if (index >= 0 && index < array->size()) {
-                    array = (vector<void *> *) array->at(index);
-                } else {
-                    throw std::invalid_argument("index parameter out of range");
-                }
-            } else {
-                vector<typename Point<T>::ptr> *points = (vector<typename Point<T>::ptr> *) array;
+            points[i] = NULL;
+        }
 
-                int index = gp[dim_index];
+        points.clear();
 
-                if (index >= 0 && index < points->size()) {
-                    result = points->at(index);
-                }
+        // Add copies of points from this index in grid order
+
+        for (size_t i = 0; i < m_ids.size(); i++) {
+            id_t id = m_ids.get(i);
+
+            if (id != NO_POINT && m_points[id] != NULL) {
+                points.push_back(PointFactory<T>::get_instance()->copy(m_points[id]));
             }
         }
-
-        return result;
     }
 
+#pragma mark -
+#pragma mark Counting
+
     template <typename T>
-    void
-    ArrayIndex<T>::set(const vector<int> &gp, typename Point<T>::ptr p, bool copy)
+    size_t
+    ArrayIndex<T>::count(bool originalPointsOnly)
     {
-        vector<void *> *array = m_data;
+        size_t count = 0;
 
-        for (size_t dim_index = 0; dim_index < gp.size(); dim_index++) {
-            if (dim_index < gp.size() - 1) {
-                int index = gp[dim_index];
+        for (size_t i = 0; i < m_points.size(); i++) {
+            typename Point<T>::ptr p = m_points[i];
 
-                if (index >= 0 && index < array->size()) {
-                    array = (vector<void *> *) array->at(index);
-                } else {
-                    cerr << "ERROR:index parameter out of range: " << gp << endl;
-                    throw std::invalid_argument("index parameter out of range");
-                }
-            } else {
-                vector<typename Point<T>::ptr> *points = (vector<typename Point<T>::ptr> *) array;
-
-                int index = gp[dim_index];
-
-                if (index >= 0 && index < array->size()) {
-                    typename Point<T>::ptr existingPoint = points->at(index);
-
-                    if (existingPoint != NULL) {
-                        delete existingPoint;
-                    }
-
-                    if (copy) {
-                        Point<T> *c = PointFactory<T>::get_instance()->copy(p);
-                        points->at(index) = c;
-                        if (p->isOriginalPoint != c->isOriginalPoint) {
-                            cerr << "ERROR:could not copy point" << endl;
-                        }
-                    } else {
-                        points->at(index) = p;
-                    }
+            if (p != NULL) {
+                if ((originalPointsOnly && p->isOriginalPoint) || !originalPointsOnly) {
+                    count++;
                 }
             }
         }
+
+        return count;
     }
 
 #pragma mark -
-#pragma mark Clear Index
+#pragma mark Neighbourhood search
 
     template <typename T>
-    void
-    ArrayIndex<T>::clear_recursive(size_t dim_index,
-            array_t *array,
-            vector<int> &gridpoint,
-            bool delete_points)
+    size_t
+    ArrayIndex<T>::neighbourhood_size(size_t reach) const
     {
-        size_t dimSize = m_dimensions[dim_index];
+        size_t n = 1;
 
-        if (dim_index < (m_dimensions.size() - 1)) {
-            for (size_t index = 0; index < dimSize; index++) {
-                gridpoint[dim_index] = index;
+        for (size_t d = 0; d < m_dimensions.size(); d++) {
+            n *= (2 * reach + 1);
+        }
 
-                vector<void *> *a = (vector<void *> *) array->at(index);
+        return n;
+    }
 
-                clear_recursive(dim_index + 1, a, gridpoint, delete_points);
-            }
-        } else {
-            vector<typename Point<T>::ptr> *points = (vector<typename Point<T>::ptr> *) array;
+    template <typename T>
+    template <class Sink>
+    size_t
+    ArrayIndex<T>::for_each_neighbour(const vector<int> &gridpoint,
+            const offset_table_t &table,
+            Sink &sink) const
+    {
+        const size_t rank = m_dimensions.size();
+        const int reach = (int) table.reach;
+        const size_t n = table.linear.size();
 
-            for (size_t index = 0; index < dimSize; index++) {
-                typename Point<T>::ptr p = points->at(index);
+        if (m_ids.size() == 0) {
+            return 0;
+        }
 
-                if (p != NULL && delete_points) {
-                    delete p;
-                }
-            }
+        const vector<size_t> &strides = m_ids.strides();
 
-            points->clear();
-        }
-    }
+        // linear index of the center and whether the whole
+        // neighbourhood lies inside of the grid
 
-    template <typename T>
-    void
-    ArrayIndex<T>::clear(bool delete_points)
-    {
-        vector<int> gp = vector<int>(m_dimensions.size(), 0);
+        long center = 0;
 
-        clear_recursive(0, m_data, gp, delete_points);
-    }
+        bool interior = true;
 
-#pragma mark -
-#pragma mark Counting
+        for (size_t d = 0; d < rank; d++) {
+            int g = gridpoint[d];
+            center += g * (long) strides[d];
+            interior = interior && (g >= reach) && (g + reach < (int) m_dimensions[d]);
+        }
 
-    template <typename T>
-    void
-    ArrayIndex<T>::count_recursive(size_t dim_index,
-            array_t *array,
-            vector<int> &gridpoint,
-            size_t &count,
-            bool originalPointsOnly)
-    {
-        size_t dimSize = m_dimensions[dim_index];
+        const id_t *ids = m_ids.data();
 
-        if (dim_index < (m_dimensions.size() - 1)) {
-            for (size_t index = 0; index < dimSize; index++) {
-                gridpoint[dim_index] = index;
+        size_t count = 0;
 
-                vector<void *> *a = (vector<void *> *) array->at(index);
+        if (interior) {
+            const long *offsets = &table.linear[0];
 
-                count_recursive(dim_index + 1, a, gridpoint, count, originalPointsOnly);
+            for (size_t k = 0; k < n; k++) {
+                id_t id = ids[center + offsets[k]];
+                if (id != NO_POINT) {
+                    sink(id);
+                    count++;
+                }
             }
         } else {
-            vector<typename Point<T>::ptr> *points = (vector<typename Point<T>::ptr> *) array;
-
-            for (size_t index = 0; index < dimSize; index++) {
-                typename Point<T>::ptr p = points->at(index);
+            typename DenseGridView<id_t>::neighbourhood_iterator it(m_ids, gridpoint, reach);
 
-                if (p != NULL) {
-                    if ((originalPointsOnly && p->isOriginalPoint) || !originalPointsOnly) {
-                        count++;
-                    }
+            for (; it.valid(); ++it) {
+                id_t id = ids[it.linear_index()];
+                if (id != NO_POINT) {
+                    sink(id);
+                    count++;
                 }
             }
         }
+
+        return count;
     }
 
     template <typename T>
     size_t
-    ArrayIndex<T>::count(bool originalPointsOnly)
+    ArrayIndex<T>::find_neighbour_ids(const vector<int> &gridpoint,
+            id_t *ids,
+            size_t reach) const
     {
-        size_t count = 0;
-
-        vector<int> gp = vector<int>(m_dimensions.size(), 0);
+        id_sink sink;
+        sink.ids = ids;
 
-        count_recursive(0, m_data, gp, count, originalPointsOnly);
+        if (reach == m_offsets.reach) {
+            return this->for_each_neighbour(gridpoint, m_offsets, sink);
+        }
 
-        return count;
+        offset_table_t table;
+        this->build_offsets(reach, table);
+        return this->for_each_neighbour(gridpoint, table, sink);
     }
 
     template <typename T>
-    void
-    ArrayIndex<T>::find_neighbours_recursive(vector<int> &gridpoint,
-            size_t dimensionIndex,
-            typename Point<T>::list &list,
-            size_t reach)
+    size_t
+    ArrayIndex<T>::find_neighbours(const vector<int> &gridpoint,
+            typename Point<T>::list &result,
+            size_t reach) const
     {
-        size_t dimSize = this->dimensions()[dimensionIndex];
-
-        // iterate over dimensions
-
-        int start = gridpoint[dimensionIndex] - reach;
-
-        int end = gridpoint[dimensionIndex] + reach;
+        result.clear();
 
-        for (int index = start; index <= end; index++) {
-            gridpoint[dimensionIndex] = index;
+        point_sink sink;
+        sink.points = &m_points;
+        sink.result = &result;
 
-            // guard against index error
-
-            if (index < 0 || index > (dimSize - 1)) {
-                continue;
-            }
-
-            if (dimensionIndex < (gridpoint.size() - 1)) {
-                // recurse
-                find_neighbours_recursive(gridpoint, dimensionIndex + 1, list, reach);
-            } else {
-                // collect
-
-                //std::cout << gridpoint << endl;
-
-                typename Point<T>::ptr p = this->get(gridpoint);
-
-                if (p != NULL) {
-                    list.push_back(p);
-                }
-            }
+        if (reach == m_offsets.reach) {
+            this->for_each_neighbour(gridpoint, m_offsets, sink);
+        } else {
+            offset_table_t table;
+            this->build_offsets(reach, table);
+            this->for_each_neighbour(gridpoint, table, sink);
         }
 
-        gridpoint[dimensionIndex] = start + reach;
+        return result.size();
     }
 
     template <typename T>
@@ -562,14 +454,10 @@ namespace m3D {
     {
         typename Point<T>::list neighbours;
 
-        typename CoordinateSystem<T>::GridPoint gp = gridpoint;
-
-        this->find_neighbours_recursive(gp, 0, neighbours, reach);
+        this->find_neighbours(gridpoint, neighbours, reach);
 
         return neighbours;
     }
-
-
 }
 
 #endif
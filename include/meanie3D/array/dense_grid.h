@@ -0,0 +1,312 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef M3D_DENSE_GRID_H
+#define M3D_DENSE_GRID_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+
+#include <boost/array.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace m3D {
+
+    using std::vector;
+
+    /** Element type used to store values of type T in a 
+     * DenseGrid. bool is stored as unsigned char, which avoids
+     * the bit-packed vector<bool>: neighbouring elements can be 
+     * written from different threads, and the storage is a plain 
+     * contiguous array.
+     */
+    template <typename T>
+    struct dense_grid_storage
+    {
+        typedef T type;
+    };
+
+    template <>
+    struct dense_grid_storage<bool>
+    {
+        typedef unsigned char type;
+    };
+
+    /** Dense array of fixed rank, stored flat in row-major ('C') 
+     * order. Since the rank is a template parameter, all loops over
+     * the dimensions have a fixed trip count and are unrolled by 
+     * the compiler, and indexes are fixed size arrays instead of 
+     * vectors. Dimension sizes and strides are fixed at construction.
+     */
+    template <typename T, size_t Rank>
+    class DenseGrid
+    {
+    public:
+
+        typedef boost::array<int, Rank> index_t;
+        typedef boost::array<size_t, Rank> extent_t;
+        typedef typename dense_grid_storage<T>::type storage_t;
+
+    private:
+
+        extent_t m_dims;
+        extent_t m_strides;
+        vector<storage_t> m_data;
+
+        void
+        calculate_strides()
+        {
+            size_t stride = 1;
+            for (size_t d = Rank; d > 0; d--) {
+                m_strides[d - 1] = stride;
+                stride *= m_dims[d - 1];
+            }
+        }
+
+    public:
+
+#pragma mark -
+#pragma mark Constructors
+
+        DenseGrid()
+        {
+            m_dims.assign(0);
+            m_strides.assign(0);
+        }
+
+        /** @param dimension sizes (Rank entries)
+         * @param initial value of all elements
+         */
+        DenseGrid(const vector<size_t> &dims, const T &value = T())
+        {
+            assert(dims.size() == Rank);
+            m_dims.assign(0);
+            std::copy(dims.begin(), dims.end(), m_dims.begin());
+            this->calculate_strides();
+            m_data.assign(this->size(), (storage_t) value);
+        }
+
+        DenseGrid(const extent_t &dims, const T &value = T())
+        : m_dims(dims)
+        {
+            this->calculate_strides();
+            m_data.assign(this->size(), (storage_t) value);
+        }
+
+#pragma mark -
+#pragma mark Geometry
+
+        /** @return number of elements */
+        inline size_t size() const
+        {
+            size_t n = 1;
+            for (size_t d = 0; d < Rank; d++) n *= m_dims[d];
+            return n;
+        }
+
+        inline size_t rank() const
+        {
+            return Rank;
+        }
+
+        inline const extent_t &dimensions() const
+        {
+            return m_dims;
+        }
+
+        inline const extent_t &strides() const
+        {
+            return m_strides;
+        }
+
+        /** @return true if the index lies within the grid */
+        inline bool contains(const index_t &index) const
+        {
+            for (size_t d = 0; d < Rank; d++) {
+                if (index[d] < 0 || index[d] >= (int) m_dims[d]) return false;
+            }
+            return true;
+        }
+
+        inline size_t linear_index(const index_t &index) const
+        {
+            size_t li = 0;
+            for (size_t d = 0; d < Rank; d++) li += index[d] * m_strides[d];
+            return li;
+        }
+
+        /** Runtime-rank variant. The vector must have Rank entries. */
+        inline size_t linear_index(const vector<int> &index) const
+        {
+            size_t li = 0;
+            for (size_t d = 0; d < Rank; d++) li += index[d] * m_strides[d];
+            return li;
+        }
+
+        inline index_t grid_index(size_t linear_index) const
+        {
+            index_t index;
+            for (size_t d = 0; d < Rank; d++) {
+                index[d] = (int) (linear_index / m_strides[d]);
+                linear_index %= m_strides[d];
+            }
+            return index;
+        }
+
+#pragma mark -
+#pragma mark Accessors
+
+        inline T get(size_t linear_index) const
+        {
+            return (T) m_data[linear_index];
+        }
+
+        inline void set(size_t linear_index, const T &value)
+        {
+            m_data[linear_index] = (storage_t) value;
+        }
+
+        inline T get(const index_t &index) const
+        {
+            return (T) m_data[this->linear_index(index)];
+        }
+
+        inline void set(const index_t &index, const T &value)
+        {
+            m_data[this->linear_index(index)] = (storage_t) value;
+        }
+
+        inline T get(const vector<int> &index) const
+        {
+            return (T) m_data[this->linear_index(index)];
+        }
+
+        inline void set(const vector<int> &index, const T &value)
+        {
+            m_data[this->linear_index(index)] = (storage_t) value;
+        }
+
+        /** @return pointer to the contiguous storage (size() elements) */
+        inline storage_t *data()
+        {
+            return m_data.empty() ? NULL : &m_data[0];
+        }
+
+        inline const storage_t *data() const
+        {
+            return m_data.empty() ? NULL : &m_data[0];
+        }
+
+        void fill(const T &value)
+        {
+            std::fill(m_data.begin(), m_data.end(), (storage_t) value);
+        }
+
+        size_t count(const T &value) const
+        {
+            return std::count(m_data.begin(), m_data.end(), (storage_t) value);
+        }
+
+#pragma mark -
+#pragma mark Neighbourhood iteration
+
+        /** Iterates over the box of +/- radius[d] elements around
+         * an index, clipped to the grid, in row-major order:
+         *
+         *   typename DenseGrid<T,R>::neighbourhood_iterator it(grid, center, radius);
+         *   for (; it.valid(); ++it) { ... it.linear_index() ... }
+         */
+        class neighbourhood_iterator
+        {
+        private:
+
+            const DenseGrid<T, Rank> *m_grid;
+            index_t m_lower;
+            index_t m_upper;
+            index_t m_index;
+            size_t m_linear_index;
+            bool m_valid;
+
+        public:
+
+            neighbourhood_iterator(const DenseGrid<T, Rank> &grid,
+                    const index_t &center,
+                    const index_t &radius)
+            : m_grid(&grid)
+            , m_linear_index(0)
+            , m_valid(true)
+            {
+                for (size_t d = 0; d < Rank; d++) {
+                    m_lower[d] = std::max(center[d] - radius[d], 0);
+                    m_upper[d] = std::min(center[d] + radius[d], (int) grid.dimensions()[d] - 1);
+                    m_valid = m_valid && (m_lower[d] <= m_upper[d]);
+                }
+                m_index = m_lower;
+                m_linear_index = grid.linear_index(m_index);
+            }
+
+            inline bool valid() const
+            {
+                return m_valid;
+            }
+
+            inline const index_t &index() const
+            {
+                return m_index;
+            }
+
+            inline size_t linear_index() const
+            {
+                return m_linear_index;
+            }
+
+            inline T value() const
+            {
+                return m_grid->get(m_linear_index);
+            }
+
+            neighbourhood_iterator &operator++()
+            {
+                const extent_t &strides = m_grid->strides();
+                for (size_t d = Rank; d > 0; d--) {
+                    const size_t k = d - 1;
+                    if (m_index[k] < m_upper[k]) {
+                        m_index[k]++;
+                        m_linear_index += strides[k];
+                        return *this;
+                    }
+                    m_linear_index -= (m_index[k] - m_lower[k]) * strides[k];
+                    m_index[k] = m_lower[k];
+                }
+                m_valid = false;
+                return *this;
+            }
+        };
+    };
+}
+
+#endif
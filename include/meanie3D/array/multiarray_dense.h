@@ -0,0 +1,368 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef M3D_MULTIARRAY_DENSE_H
+#define M3D_MULTIARRAY_DENSE_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+
+#include <meanie3D/array/dense_grid.h>
+#include <meanie3D/array/multiarray.h>
+#include <meanie3D/array/multiarray_linear.h>
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+namespace m3D {
+
+    /** Adapter exposing a DenseGrid of fixed rank through the 
+     * runtime-rank MultiArray interface. Code that knows the rank 
+     * can get at the grid directly through grid().
+     */
+    template <typename T, size_t Rank>
+    class MultiArrayDense : public MultiArray<T>
+    {
+    private:
+
+        DenseGrid<T, Rank> m_grid;
+
+    public:
+
+#pragma mark -
+#pragma mark Constructors/Destructors
+
+        MultiArrayDense(const vector<size_t> &dims)
+        : MultiArray<T>(dims)
+        , m_grid(dims)
+        {
+        };
+
+        MultiArrayDense(const vector<size_t> &dims, T default_value)
+        : MultiArray<T>(dims, default_value)
+        , m_grid(dims, default_value)
+        {
+        };
+
+        ~MultiArrayDense()
+        {
+        };
+
+#pragma mark -
+#pragma mark Accessors
+
+        inline DenseGrid<T, Rank> &grid()
+        {
+            return m_grid;
+        }
+
+        inline const DenseGrid<T, Rank> &grid() const
+        {
+            return m_grid;
+        }
+
+        T get(const vector<int> &index) const
+        {
+            return m_grid.get(index);
+        }
+
+        void set(const vector<int> &index, const T &value)
+        {
+            m_grid.set(index, value);
+        }
+
+#pragma mark -
+#pragma mark Stuff
+
+        void resize(vector<size_t> dimensions)
+        {
+            assert(dimensions.size() == Rank);
+            this->m_dims = dimensions;
+            m_grid = DenseGrid<T, Rank>(dimensions);
+        }
+
+        void populate_array(const T& value)
+        {
+            m_grid.fill(value);
+        }
+
+        void copy_from(const MultiArray<T> *other)
+        {
+            assert(this->m_dims == other->get_dimensions());
+
+            const MultiArrayDense<T, Rank> *dense = dynamic_cast<const MultiArrayDense<T, Rank> *> (other);
+            if (dense != NULL) {
+                m_grid = dense->m_grid;
+                return;
+            }
+
+            for (size_t i = 0; i < m_grid.size(); i++) {
+                typename DenseGrid<T, Rank>::index_t index = m_grid.grid_index(i);
+                vector<int> gp(index.begin(), index.end());
+                m_grid.set(i, other->get(gp));
+            }
+        }
+
+        size_t count_value(const T &value)
+        {
+            return m_grid.count(value);
+        }
+    };
+
+    /** Creates a MultiArray for the given dimensions, backed by a 
+     * DenseGrid of matching rank where possible (rank 1 to 5).
+     * @param dimensions
+     * @param initial value
+     * @return new array (caller owns it)
+     */
+    template <typename T>
+    MultiArray<T> *
+    create_dense_multiarray(const vector<size_t> &dims, T default_value)
+    {
+        switch (dims.size()) {
+            case 1: return new MultiArrayDense<T, 1>(dims, default_value);
+            case 2: return new MultiArrayDense<T, 2>(dims, default_value);
+            case 3: return new MultiArrayDense<T, 3>(dims, default_value);
+            case 4: return new MultiArrayDense<T, 4>(dims, default_value);
+            case 5: return new MultiArrayDense<T, 5>(dims, default_value);
+            default: return new MultiArrayLinear<T>(dims, default_value);
+        }
+    }
+
+    /** Non-virtual access to the DenseGrid behind an array created by
+     * create_dense_multiarray(). Hot loops obtain a view once and
+     * then read and write the grid by linear index, rather than
+     * calling the virtual get/set of MultiArray for every element.
+     * The view does not own the grid. It is valid as long as the 
+     * array is neither deleted nor resized.
+     */
+    template <typename T>
+    class DenseGridView
+    {
+    public:
+
+        typedef typename dense_grid_storage<T>::type storage_t;
+
+    private:
+
+        storage_t *m_data;
+        size_t m_size;
+        vector<size_t> m_dims;
+        vector<size_t> m_strides;
+
+        template <size_t Rank>
+        bool
+        attach(MultiArray<T> *array)
+        {
+            MultiArrayDense<T, Rank> *dense = dynamic_cast<MultiArrayDense<T, Rank> *> (array);
+            if (dense == NULL) {
+                return false;
+            }
+            DenseGrid<T, Rank> &grid = dense->grid();
+            m_data = grid.data();
+            m_size = grid.size();
+            m_dims.assign(grid.dimensions().begin(), grid.dimensions().end());
+            m_strides.assign(grid.strides().begin(), grid.strides().end());
+            return true;
+        }
+
+    public:
+
+#pragma mark -
+#pragma mark Constructors
+
+        DenseGridView() : m_data(NULL), m_size(0)
+        {
+        }
+
+        /** @param array created by create_dense_multiarray()
+         * @throws std::invalid_argument if the array is not backed
+         * by a DenseGrid (rank 1 to 5)
+         */
+        DenseGridView(MultiArray<T> *array) : m_data(NULL), m_size(0)
+        {
+            if (!(attach<1>(array) || attach<2>(array) || attach<3>(array)
+                    || attach<4>(array) || attach<5>(array))) {
+                throw std::invalid_argument("array is not backed by a DenseGrid");
+            }
+        }
+
+#pragma mark -
+#pragma mark Accessors
+
+        inline size_t linear_index(const vector<int> &index) const
+        {
+            size_t li = 0;
+            for (size_t d = 0; d < m_strides.size(); d++) li += index[d] * m_strides[d];
+            return li;
+        }
+
+        /** @param pointer to rank() grid point components */
+        inline size_t linear_index(const int *index) const
+        {
+            size_t li = 0;
+            for (size_t d = 0; d < m_strides.size(); d++) li += index[d] * m_strides[d];
+            return li;
+        }
+
+        inline size_t rank() const
+        {
+            return m_strides.size();
+        }
+
+        /** @return number of elements */
+        inline size_t size() const
+        {
+            return m_size;
+        }
+
+        /** @return dimension sizes */
+        inline const vector<size_t> &dimensions() const
+        {
+            return m_dims;
+        }
+
+        /** @return strides (in elements) of each dimension */
+        inline const vector<size_t> &strides() const
+        {
+            return m_strides;
+        }
+
+        /** @return pointer to the contiguous storage (size() elements) */
+        inline storage_t *data() const
+        {
+            return m_data;
+        }
+
+        inline T get(size_t linear_index) const
+        {
+            return (T) m_data[linear_index];
+        }
+
+        inline void set(size_t linear_index, const T &value)
+        {
+            m_data[linear_index] = (storage_t) value;
+        }
+
+        inline T get(const vector<int> &index) const
+        {
+            return (T) m_data[this->linear_index(index)];
+        }
+
+        inline void set(const vector<int> &index, const T &value)
+        {
+            m_data[this->linear_index(index)] = (storage_t) value;
+        }
+
+#pragma mark -
+#pragma mark Neighbourhood iteration
+
+        /** Runtime rank counterpart of DenseGrid::neighbourhood_iterator.
+         * Iterates over the box of +/- radius elements around an index,
+         * clipped to the grid, in row-major order. The bounds are held
+         * in fixed size arrays, so iterating does not allocate.
+         */
+        class neighbourhood_iterator
+        {
+        private:
+
+            // Highest rank create_dense_multiarray() backs with a DenseGrid
+            static const size_t MAX_RANK = 5;
+
+            const DenseGridView<T> *m_view;
+            int m_lower[MAX_RANK];
+            int m_upper[MAX_RANK];
+            int m_index[MAX_RANK];
+            size_t m_linear_index;
+            bool m_valid;
+
+        public:
+
+            /** @param view
+             * @param center (rank() entries)
+             * @param radius
+             */
+            neighbourhood_iterator(const DenseGridView<T> &view,
+                    const vector<int> &center,
+                    int radius)
+            : m_view(&view)
+            , m_linear_index(0)
+            , m_valid(view.size() > 0)
+            {
+                const size_t rank = view.rank();
+                for (size_t d = 0; d < rank; d++) {
+                    m_lower[d] = std::max(center[d] - radius, 0);
+                    m_upper[d] = std::min(center[d] + radius, (int) view.dimensions()[d] - 1);
+                    m_valid = m_valid && (m_lower[d] <= m_upper[d]);
+                    m_index[d] = m_lower[d];
+                }
+                if (m_valid) {
+                    m_linear_index = view.linear_index(m_index);
+                }
+            }
+
+            inline bool valid() const
+            {
+                return m_valid;
+            }
+
+            /** @return current index (rank() entries) */
+            inline const int *index() const
+            {
+                return m_index;
+            }
+
+            inline size_t linear_index() const
+            {
+                return m_linear_index;
+            }
+
+            inline T value() const
+            {
+                return m_view->get(m_linear_index);
+            }
+
+            neighbourhood_iterator &operator++()
+            {
+                const vector<size_t> &strides = m_view->strides();
+                for (size_t d = m_view->rank(); d > 0; d--) {
+                    const size_t k = d - 1;
+                    if (m_index[k] < m_upper[k]) {
+                        m_index[k]++;
+                        m_linear_index += strides[k];
+                        return *this;
+                    }
+                    m_linear_index -= (m_index[k] - m_lower[k]) * strides[k];
+                    m_index[k] = m_lower[k];
+                }
+                m_valid = false;
+                return *this;
+            }
+        };
+    };
+}
+
+#endif
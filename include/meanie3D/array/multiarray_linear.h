@@ -0,0 +1,238 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_MULTIARRAY_LINEAR_H
+#define M3D_MULTIARRAY_LINEAR_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+
+#include <meanie3D/array/multiarray.h>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include <stdexcept>
+
+namespace m3D {
+
+    /** Implementation of MultiArray on a single contiguous buffer
+     * in row-major ('C') order, which is the same order the netCDF
+     * library uses. This allows reading data directly into the array
+     * (see data()) and accessing elements by their linear index. Any
+     * number of dimensions is supported.
+     */
+    template <typename T>
+    class MultiArrayLinear : public MultiArray<T>
+    {
+#pragma mark -
+#pragma mark Attributes
+
+    private:
+
+        vector<T> m_data;
+
+        vector<size_t> m_strides;
+
+        void
+        calculate_strides()
+        {
+            size_t rank = this->m_dims.size();
+
+            m_strides.assign(rank, 1);
+
+            for (int d = ((int) rank) - 2; d >= 0; d--) {
+                m_strides[d] = m_strides[d + 1] * this->m_dims[d + 1];
+            }
+        }
+
+#pragma mark -
+#pragma mark Constructors/Destructors
+
+    public:
+
+        MultiArrayLinear() : MultiArray<T>()
+        {
+        };
+
+        MultiArrayLinear(const vector<size_t> &dims)
+        : MultiArray<T>(dims)
+        , m_data(MultiArray<T>::size())
+        {
+            this->calculate_strides();
+        };
+
+        MultiArrayLinear(const vector<size_t> &dims, T default_value)
+        : MultiArray<T>(dims, default_value)
+        , m_data(MultiArray<T>::size(), default_value)
+        {
+            this->calculate_strides();
+        };
+
+        MultiArrayLinear(const MultiArrayLinear<T> &other)
+        : MultiArray<T>()
+        , m_data(other.m_data)
+        , m_strides(other.m_strides)
+        {
+            this->m_dims = other.get_dimensions();
+        }
+
+        MultiArrayLinear(const MultiArray<T> *other)
+        : MultiArray<T>()
+        {
+            this->m_dims = other->get_dimensions();
+            this->calculate_strides();
+            m_data.resize(MultiArray<T>::size());
+            this->copy_from(other);
+        }
+
+        /** Destructor
+         */
+        ~MultiArrayLinear()
+        {
+        };
+
+#pragma mark -
+#pragma mark Accessors
+
+        /** @param grid point
+         * @return linear index of the grid point
+         */
+        inline size_t
+        linear_index(const vector<int> &index) const
+        {
+            size_t linear_index = 0;
+            for (size_t d = 0; d < m_strides.size(); d++) {
+                linear_index += index[d] * m_strides[d];
+            }
+            return linear_index;
+        }
+
+        T get(const vector<int> &index) const
+        {
+            return m_data[this->linear_index(index)];
+        }
+
+        void
+        set(const vector<int> &index, const T &value)
+        {
+            m_data[this->linear_index(index)] = value;
+        }
+
+        /** @param linear index (0 .. size()-1)
+         * @return value at that index
+         */
+        inline T
+        get(size_t linear_index) const
+        {
+            return m_data[linear_index];
+        }
+
+        /** @param linear index (0 .. size()-1)
+         * @param value
+         */
+        inline void
+        set(size_t linear_index, const T &value)
+        {
+            m_data[linear_index] = value;
+        }
+
+        /** @return pointer to the contiguous data (size() elements)
+         */
+        inline T *
+        data()
+        {
+            return m_data.empty() ? NULL : &m_data[0];
+        }
+
+        inline const T *
+        data() const
+        {
+            return m_data.empty() ? NULL : &m_data[0];
+        }
+
+        /** @return strides (in elements) of each dimension
+         */
+        inline const vector<size_t> &
+        strides() const
+        {
+            return m_strides;
+        }
+
+#pragma mark -
+#pragma mark Stuff
+
+        void resize(vector<size_t> dimensions)
+        {
+            this->m_dims = dimensions;
+            this->calculate_strides();
+            m_data.resize(MultiArray<T>::size());
+        }
+
+        void populate_array(const T& value)
+        {
+            std::fill(m_data.begin(), m_data.end(), value);
+        }
+
+        void copy_from(const MultiArray<T> *other)
+        {
+            assert(this->m_dims == other->get_dimensions());
+
+            const MultiArrayLinear<T> *linear = dynamic_cast<const MultiArrayLinear<T> *> (other);
+
+            if (linear != NULL) {
+                m_data = linear->m_data;
+                return;
+            }
+
+            // Generic copy: iterate over the grid points, odometer style
+
+            size_t rank = this->m_dims.size();
+
+            vector<int> gp(rank, 0);
+
+            for (size_t i = 0; i < m_data.size(); i++) {
+                m_data[i] = other->get(gp);
+
+                for (int d = ((int) rank) - 1; d >= 0; d--) {
+                    if (++gp[d] < (int) this->m_dims[d]) {
+                        break;
+                    }
+                    gp[d] = 0;
+                }
+            }
+        }
+
+        /** Iterates over the array and counts the number
+         * of occurences of the given value
+         * @param value
+         * @return number of occurences
+         */
+        size_t count_value(const T &value)
+        {
+            return std::count(m_data.begin(), m_data.end(), value);
+        }
+    };
+}
+
+#endif
@@ -33,5 +33,6 @@
 #include <meanie3D/clustering/detection_commandline.h>
 #include <meanie3D/clustering/histogram.h>
 #include <meanie3D/clustering/id.h>
+#include <meanie3D/clustering/stored_cluster.h>
 
 #endif
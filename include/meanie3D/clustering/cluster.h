@@ -206,14 +206,14 @@ namespace m3D {
          * 
          * @return 
          */
-        size_t size() const;
+        virtual size_t size() const;
 
         /** Checks if the cluster has any points 
          * 
          * @return <code>true</code> points list is empty, <code>false</code>
          * otherwise. 
          */
-        bool empty() const;
+        virtual bool empty() const;
 
         /** Returns the point at the given index.
          * 
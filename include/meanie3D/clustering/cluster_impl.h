@@ -176,14 +176,15 @@ namespace m3D {
     typename Point<T>::ptr
     Cluster<T>::operator[](const size_t &index)
     {
-        return m_points.at(index);
+        return this->get_points().at(index);
     };
 
     template <typename T>
     typename Point<T>::ptr
     Cluster<T>::at(const size_t& index) const
     {
-        return m_points.at(index);
+        // Subclasses may read their points on first access
+        return const_cast<Cluster<T> *>(this)->get_points().at(index);
     }
 
     template <typename T>
@@ -254,7 +255,7 @@ namespace m3D {
         try {
             h = this->m_histograms.at(variable_index);
         } catch (const std::exception& e) {
-            h = Histogram<T>::create(m_points, variable_index, valid_min, valid_max, number_of_bins);
+            h = Histogram<T>::create(this->get_points(), variable_index, valid_min, valid_max, number_of_bins);
             this->m_histograms.insert(std::pair< size_t, typename Histogram<T>::ptr > (variable_index, h));
         }
 
@@ -409,7 +410,7 @@ namespace m3D {
         // pick the first point of this cluster to figure out the
         // spatial and value dimensions
 
-        if (!m_points.empty() && w != NULL) {
+        if (!this->empty() && w != NULL) {
             const CoordinateSystem<T> *cs = this->m_index->feature_space()->coordinate_system;
 
             // extract coordinate of the mode and do a reverse 
@@ -444,7 +445,7 @@ namespace m3D {
             result += w->operator()(p);
         }
 
-        if (m_points.empty()) {
+        if (!this->empty()) {
             result /= ((T)this->size());
         }
 
@@ -581,7 +582,7 @@ namespace m3D {
         if (m_bounding_box_min.empty()) {
             vector<T> inf(spatial_rank(), std::numeric_limits<T>::max());
             typename Point<T>::list::iterator pi;
-            for (pi = m_points.begin(); pi != m_points.end(); ++pi) {
+            for (pi = this->get_points().begin(); pi != this->get_points().end(); ++pi) {
                 typename Point<T>::ptr p = *pi;
                 for (size_t j = 0; j < spatial_rank(); j++) {
                     if (p->coordinate[j] < inf[j]) {
@@ -607,7 +608,7 @@ namespace m3D {
         if (m_bounding_box_max.empty()) {
             vector<T> sup(spatial_rank(), -std::numeric_limits<T>::max());
             typename Point<T>::list::iterator pi;
-            for (pi = m_points.begin(); pi != m_points.end(); ++pi) {
+            for (pi = this->get_points().begin(); pi != this->get_points().end(); ++pi) {
                 typename Point<T>::ptr p = *pi;
                 for (size_t j = 0; j < spatial_rank(); j++) {
                     if (p->coordinate[j] > sup[j]) {
@@ -103,6 +103,11 @@ namespace m3D {
         NcFile *file;
         string filename; // this is filled on read() or write()
 
+        // If true, write() records a reference to the source file
+        // (path and modification time) instead of copying the dimension
+        // and feature variables. Set on read() from the file.
+        bool source_by_reference;
+
 #pragma mark -
 #pragma mark Private members
 
@@ -112,6 +117,15 @@ namespace m3D {
         bool m_use_original_points_only;
         ClusterMap m_cluster_map;
 
+        // Coordinate system referenced by the clusters of a list
+        // read without points, if the caller did not ask for it
+        CoordinateSystem<T> *m_coordinate_system;
+
+        // Referenced source file, which holds the dimension variables
+        // of the coordinate system when the list was read from a file
+        // written with source_by_reference
+        NcFile *m_source_data_file;
+
 #pragma mark -
 #pragma mark Constructor/Destructor
 
@@ -169,6 +183,14 @@ namespace m3D {
                 delete file;
                 file = NULL;
             }
+            if (m_coordinate_system != NULL) {
+                delete m_coordinate_system;
+                m_coordinate_system = NULL;
+            }
+            if (m_source_data_file != NULL) {
+                delete m_source_data_file;
+                m_source_data_file = NULL;
+            }
         };
 
 #pragma mark -
@@ -220,6 +242,9 @@ namespace m3D {
          * If two or more points have the same distance to the shifted
          * coordinate, the point with the steeper vector (=longer) is
          * chosen. If
+         * 
+         * The graph is built in parallel into disjoint sets over the
+         * point indexes, which are compacted into clusters afterwards.
          */
         void aggregate_cluster_graph(FeatureSpace<T> *fs,
                 const WeightFunction<T> *weight_function,
@@ -290,20 +315,6 @@ namespace m3D {
                 const typename Point<T>::list &neighbours,
                 ArrayIndex<T> &index);
 
-        /**
-         * 
-         * @param fs
-         * @param weight_function
-         * @param index
-         * @param coalesceWithStrongestNeighbour
-         * @param show_progress
-         */
-        void aggregate_zeroshifts(FeatureSpace<T> *fs,
-                const WeightFunction<T> *weight_function,
-                ArrayIndex<T> &index,
-                bool coalesceWithStrongestNeighbour,
-                bool show_progress);
-
 #pragma mark -
 #pragma mark ID helpers
 
@@ -349,10 +360,100 @@ namespace m3D {
          * @param pointer to a pointer of coordinate system. 
          * If not null, this is initialized with an instance
          * of coordinate system after the reading
+         * @param load_points if <code>false</code>, only the meta-data
+         * of the list and the clusters is read. The clusters are of
+         * type StoredCluster and read their points from the file when
+         * get_points() is first called. This requires the list (which
+         * keeps the file open) and the coordinate system to stay alive.
+         * Files in the legacy layout are always read completely.
          */
         static
         typename ClusterList<T>::ptr
-        read(const string &path, CoordinateSystem<T> **cs_ptr = NULL);
+        read(const string &path,
+                CoordinateSystem<T> **cs_ptr = NULL,
+                bool load_points = true);
+
+        /** Opens the file holding the dimension variables and the
+         * feature variable meta-data of a cluster file. For files
+         * written with source_by_reference this is the referenced
+         * source file, which is looked up by its recorded path and
+         * next to the cluster file. Otherwise the cluster file itself
+         * is returned.
+         * @param path of the cluster file
+         * @param open cluster file
+         * @return data file. If it is not the given cluster file, the
+         * caller is responsible for deleting it.
+         * @throws runtime_error if the referenced file can't be found
+         * or was modified after the cluster file was written
+         */
+        static
+        NcFile *
+        open_data_file(const string &path, NcFile *file);
+
+    protected:
+
+        /** Finds a referenced source file. The path is tried as is and
+         * relative to the cluster file's directory.
+         * @param path of the cluster file
+         * @param recorded path of the source file
+         * @return path of the source file or empty string if not found
+         */
+        static
+        string
+        resolve_source_path(const string &path, const string &source);
+
+        /** The linear grid index of the points is written as 32 bit
+         * integer, unless the grid has more points than fit into one.
+         * @param dimension sizes of the spatial grid
+         * @return ncInt or ncInt64
+         */
+        static
+        NcType
+        point_index_type(const vector<size_t> &dimension_sizes);
+
+        /** Writes all clusters into one compressed-sparse-row point
+         * array (linear grid index plus value columns), indexed by
+         * per-cluster offsets. Cluster meta-data is stored in arrays
+         * along a 'clusters' dimension.
+         * @param file
+         * @param dimension sizes of the spatial grid
+         * @param type of the linear grid index (see point_index_type)
+         */
+        void write_clusters(NcFile *file,
+                const vector<size_t> &dimension_sizes,
+                const NcType &index_type);
+
+        /** Bulk-reads clusters from a file in the compact layout.
+         * Coordinates are reconstructed from the linear grid index.
+         * @param file
+         * @param coordinate system
+         * @param list to add the clusters to
+         * @param if <code>false</code>, StoredCluster instances are
+         * created that read their points on demand.
+         */
+        static
+        void
+        read_clusters(NcFile *file,
+                const CoordinateSystem<T> *cs,
+                typename Cluster<T>::list &list,
+                bool load_points);
+
+        /** Reads clusters from a file in the legacy layout, which
+         * holds one variable per cluster with the meta-data as
+         * string attributes.
+         * @param file
+         * @param ids of the clusters to read
+         * @param coordinate system
+         * @param list to add the clusters to
+         */
+        static
+        void
+        read_legacy_clusters(NcFile *file,
+                const id_set_t &cluster_ids,
+                const CoordinateSystem<T> *cs,
+                typename Cluster<T>::list &list);
+
+    public:
 
         /** 
          * Prints the cluster list out to console
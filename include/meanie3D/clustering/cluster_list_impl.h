@@ -28,7 +28,9 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/clustering/cluster.h>
+#include <meanie3D/clustering/stored_cluster.h>
 #include <meanie3D/utils/set_utils.h>
+#include <meanie3D/utils/union_find.h>
 
 #include <algorithm>
 #include <sstream>
@@ -67,6 +69,9 @@ namespace m3D {
             , tracking_performed(false)
             , highest_id(0)
             , highest_uuid(0) 
+            , source_by_reference(false)
+            , m_coordinate_system(NULL)
+            , m_source_data_file(NULL)
         {
         };
         
@@ -88,7 +93,10 @@ namespace m3D {
         , source_file(source)
         , time_index(ti)
         , timestamp(timestamp)
-        , m_use_original_points_only(orig_pts) {};
+        , m_use_original_points_only(orig_pts)
+        , source_by_reference(false)
+        , m_coordinate_system(NULL)
+        , m_source_data_file(NULL) {};
         
         template <typename T>
         ClusterList<T>::ClusterList(
@@ -111,6 +119,9 @@ namespace m3D {
         , time_index(ti)
         , timestamp(timestamp)
         , m_use_original_points_only(orig_pts)
+        , source_by_reference(false)
+        , m_coordinate_system(NULL)
+        , m_source_data_file(NULL)
         , clusters(list) {};
         
         template <typename T>
@@ -133,7 +144,10 @@ namespace m3D {
         , highest_uuid(o.highest_uuid)
         , timestamp(o.timestamp)
         , time_index(o.time_index)
-        , m_use_original_points_only(o.m_use_original_points_only) {};
+        , m_use_original_points_only(o.m_use_original_points_only)
+        , source_by_reference(o.source_by_reference)
+        , m_coordinate_system(NULL)
+        , m_source_data_file(NULL) {};
 
             
 #pragma mark -
@@ -261,6 +275,7 @@ namespace m3D {
 
             // write version attribute
             file->putAtt("version", m3D::VERSION);
+            file->putAtt("cluster_file_layout", ncInt, CLUSTER_FILE_LAYOUT);
 
             // Create feature-space variables
             vector<string> featurespace_variables = dimension_variables;
@@ -304,12 +319,6 @@ namespace m3D {
             unsigned long long huuid = boost::numeric_cast<unsigned long long>(this->highest_uuid);
             file->putAtt("highest_uuid", boost::lexical_cast<std::string>(huuid));
 
-            // Record IDs in attribute
-            id_set_t cluster_ids;
-            for (size_t ci = 0; ci < clusters.size(); ci++)
-                cluster_ids.insert(clusters[ci]->id);
-            file->putAtt("cluster_ids", sets::to_string(cluster_ids));
-
             // Add tracking meta-info
             if (this->tracking_performed) {
                 file->putAtt("tracking_performed", "yes");
@@ -321,130 +330,50 @@ namespace m3D {
                 file->putAtt("splits", maps::id_map_to_string(this->splits));
             }
 
-            // Copy dimension variables including data. This is required
-            // so that on reading a coordinate system can be constructed
-            
-            for (size_t i = 0; i < dimension_variables.size(); i++) {
-                string var = dimension_variables[i];
-                netcdf::copy_variable<T>(var,sourcefile,file,true);
-            }
-                
-            // Copy other variables without data
-            
-            for (size_t i = 0; i < variables.size(); i++) {
-                string var = variables[i];
-                netcdf::copy_variable<T>(var,sourcefile,file,false);
-            }
-
-            // Featurespace Variables
-            std::string fvarnames = to_string(variables);
-
-            // Add cluster dimensions and variables
-            for (size_t ci = 0; ci < clusters.size(); ci++) {
-                typename Cluster<T>::ptr cluster = clusters.at(ci);
-
-                // NOTE: some problem exists with the normal id_t used
-                // everywhere else and NetCDF. Using unsigned long long
-                // produces a compiler warning but also correct results.
-                unsigned long long cid = (unsigned long long) cluster->id;
-                unsigned long long uuid = (unsigned long long) cluster->uuid;
-
-                // Create a dimension
-                stringstream dim_name(stringstream::in | stringstream::out);
-                dim_name << "cluster_dim_" << cid;
-                NcDim cluster_dim;
-                try {
-                    cluster_dim = file->addDim(dim_name.str(), cluster->size());
-                } catch (const netCDF::exceptions::NcException &e) {
-                    cerr << "ERROR:exception creating dimension " << dim_name.str()
-                            << ":" << e.what() << endl;
-                    exit(EXIT_FAILURE);
+            if (this->source_by_reference) {
+                // Record a reference to the source file. Readers open it
+                // for the dimension variables when needed.
+                std::string resolved = ClusterList<T>::resolve_source_path(path, source_file);
+                long long mtime = 0;
+                if (!resolved.empty()) {
+                    mtime = (long long) boost::filesystem::last_write_time(resolved);
+                } else {
+                    cerr << "WARNING:source file " << source_file
+                         << " not found, can't record modification time" << endl;
                 }
+                file->putAtt("source_reference", "yes");
+                file->putAtt("source_mtime", ncInt64, mtime);
+            } else {
+                // The previous cluster file might only hold a reference
+                NcFile *datafile = ClusterList<T>::open_data_file(source_path, sourcefile);
 
-                // Create variable
-                stringstream var_name(stringstream::in | stringstream::out);
-                var_name << "cluster_" << cid;
-
-                vector<NcDim> dims(2);
-                dims[0] = cluster_dim;
-                dims[1] = dim;
+                // Copy dimension variables including data. This is required
+                // so that on reading a coordinate system can be constructed
 
-                NcVar var;
-                try {
-                    var = file->addVar(var_name.str(), ncDouble, dims);
-                    var.setCompression(false, true, 3);
-                } catch (const netCDF::exceptions::NcException &e) {
-                    cerr << "ERROR:exception creating dimension " << var_name.str()
-                            << ":" << e.what() << endl;
-                    continue;
+                for (size_t i = 0; i < dimension_variables.size(); i++) {
+                    string var = dimension_variables[i];
+                    netcdf::copy_variable<T>(var,datafile,file,true);
                 }
 
-                // size
-                var.putAtt("size", ncInt, (int) cluster->size());
-
-                // margin flag
-                std::string flag = (cluster->has_margin_points() ? "Y" : "N");
-                var.putAtt("has_margin_points", flag);
+                // Copy other variables without data
 
-                // check if there's any merge
-                id_map_t::iterator mi = this->merges.find(cluster->id);
-
-                if (mi != this->merges.end()) {
-                    std::string merged_from = utils::sets::to_string(mi->second);
-                    var.putAtt("merged_from", merged_from);
+                for (size_t i = 0; i < variables.size(); i++) {
+                    string var = variables[i];
+                    netcdf::copy_variable<T>(var,datafile,file,false);
                 }
 
-                // check if there's any split
-                for (mi = this->splits.begin(); mi != this->splits.end(); mi++) {
-                    id_set_t csplits = mi->second;
-                    if (csplits.find(cluster->id) != csplits.end()) {
-                        std::string split_from = boost::lexical_cast<string>(mi->first);
-                        var.putAtt("split_from", split_from);
-                        break;
-                    }
-                }
-
-                // id
-                var.putAtt("id", boost::lexical_cast<string>(cid));
-
-                // uuid
-                var.putAtt("uuid", boost::lexical_cast<string>(uuid));
-
-                // mode
-                string mode = to_string(cluster->mode);
-                var.putAtt("mode", mode);
-
-                // displacement
-                string displacement = to_string(cluster->displacement);
-                var.putAtt("displacement", displacement);
-
-                // bounding box min
-                string bound_min = to_string(cluster->get_bounding_box_min());
-                var.putAtt("bounding_box_min", bound_min);
-
-                // bounding box max
-                string bound_max = to_string(cluster->get_bounding_box_max());
-                var.putAtt("bounding_box_max", bound_max);
-
-                // Write cluster away
-
-                size_t numElements = cluster->size() * cluster->rank();
-                T *data = (T*) malloc(sizeof (T) * numElements);
-                if (data == NULL) {
-                    cerr << "FATAL:out of memory" << endl;
-                    exit(EXIT_FAILURE);
+                if (datafile != sourcefile) {
+                    delete datafile;
                 }
+            }
 
-                for (size_t pi = 0; pi < cluster->size(); pi++) {
-                    typename Point<T>::ptr p = cluster->at(pi);
-                    for (size_t di = 0; di < dim.getSize(); di++) {
-                        size_t index = pi * cluster->rank() + di;
-                        data[index] = p->values.at(di);
-                    }
-                }
-                var.putVar(data);
-                delete data;
+            // Add the clusters
+            vector<size_t> dimension_sizes;
+            for (size_t di = 0; di < ncDimensions.size(); di++) {
+                dimension_sizes.push_back(ncDimensions[di].getSize());
             }
+            this->write_clusters(file, dimension_sizes,
+                    ClusterList<T>::point_index_type(dimension_sizes));
 
             if (file_existed) {
                 // close the original and delete it
@@ -493,7 +422,7 @@ namespace m3D {
 
     template <typename T>
     typename ClusterList<T>::ptr
-    ClusterList<T>::read(const std::string& path, CoordinateSystem<T> **cs_ptr)
+    ClusterList<T>::read(const std::string& path, CoordinateSystem<T> **cs_ptr, bool load_points)
     {
         // meta-info
         vector<string> variables;
@@ -515,6 +444,9 @@ namespace m3D {
         m3D::uuid_t highest_uuid = NO_UUID;
         typename Cluster<T>::list list;
         NcFile *file = NULL;
+        NcFile *data_file = NULL;
+        CoordinateSystem<T> *cs = NULL;
+        bool keeps_coordinate_system = false;
 
         file = new NcFile(path, NcFile::read);
         try {
@@ -551,8 +483,6 @@ namespace m3D {
             file->getAtt("num_clusters").getValues(&number_of_clusters);
 
             std::string value;
-            file->getAtt("cluster_ids").getValues(value);
-            cluster_ids = sets::from_string<m3D::id_t>(value);
 
             // Tracking-related
             try {
@@ -596,111 +526,40 @@ namespace m3D {
             file->getAtt("featurespace_variables").getValues(value);
             featurespace_variables = vectors::from_string<string>(value);
 
+            // The dimension variables are either in the cluster
+            // file or in the referenced source file
+            data_file = ClusterList<T>::open_data_file(path, file);
+
             // Coordinate system wanted?
-            CoordinateSystem<T> *cs = new CoordinateSystem<T>(file, dimensions, dimension_variables);
+            cs = new CoordinateSystem<T>(data_file, dimensions, dimension_variables);
             if (cs_ptr != NULL) {
                 *cs_ptr = cs;
             }
 
-            // Read clusters one by one
-            id_set_t::iterator cid_iter;
-
-            for (cid_iter = cluster_ids.begin(); cid_iter != cluster_ids.end(); cid_iter++) {
-                // Identifier
-                m3D::id_t cid = *cid_iter;
-
-                // cluster dimension
-                stringstream dim_name(stringstream::in | stringstream::out);
-                dim_name << "cluster_dim_" << cid;
-                NcDim cluster_dim = file->getDim(dim_name.str().c_str());
-                size_t cluster_size = cluster_dim.getSize();
-
-                // Read the variable
-                stringstream var_name(stringstream::in | stringstream::out);
-                var_name << "cluster_" << cid;
-                NcVar var = file->getVar(var_name.str().c_str());
-
-                // mode
-                std::string mode_str;
-                var.getAtt("mode").getValues(mode_str);
-                vector<T> mode = vectors::from_string<T>(mode_str);
-                
-                var.getAtt("uuid").getValues(value);
-                m3D::uuid_t uuid = boost::lexical_cast<m3D::uuid_t>(value);
-
-                // displacement
-                std::string displacement_str;
-                var.getAtt("displacement").getValues(displacement_str);
-                vector<T> displacement = vectors::from_string<T>(displacement_str);
-
-                std::string bounds_min_str;
-                var.getAtt("bounding_box_min").getValues(bounds_min_str);
-                vector<T> bounds_min = vectors::from_string<T>(bounds_min_str);
-
-                std::string bounds_max_str;
-                var.getAtt("bounding_box_max").getValues(bounds_max_str);
-                vector<T> bounds_max = vectors::from_string<T>(bounds_max_str);
-                
-                // margin flag
-                std::string margin_char;
-                var.getAtt("has_margin_points").getValues(margin_char);
-                bool margin_flag = margin_char == "Y";
-
-                // Create a cluster object
-                typename Cluster<T>::ptr cluster = new Cluster<T>(mode, dimensions.size());
-                cluster->id = cid;
-                cluster->uuid = uuid;
-                cluster->mode = mode;
-                cluster->displacement = displacement;
-                cluster->set_bounding_box_min(bounds_min);
-                cluster->set_bounding_box_max(bounds_max);
-                cluster->set_has_margin_points(margin_flag);
-
-                // Read the cluster
-                size_t numElements = cluster_size * cluster->rank();
-                T *data = (T *) malloc(sizeof (T) * numElements);
-                if (data == NULL) {
-                    cerr << "FATAL:out of memory" << endl;
-                    exit(EXIT_FAILURE);
-                }
-
-                var.getVar(data);
-                for (size_t pi = 0; pi < cluster_size; pi++) {
-                    vector<T> values(cluster->rank(), 0.0);
-
-                    // copy point from data
-                    for (size_t di = 0; di < cluster->rank(); di++) {
-                        values[di] = data[pi * cluster->rank() + di];
-                    }
-
-                    // get coordinate subvector
-                    vector<T> coordinate(values.begin(), values.begin() + cs->rank());
-
-                    // transform to gridpoint
-                    try {
-                        vector<int> gp(cs->rank(), 0);
-                        cs->reverse_lookup(coordinate, gp);
-
-                        // only when this succeeds do we have the complete
-                        // set of data for the point
-                        typename Point<T>::ptr p = PointFactory<T>::get_instance()->create();
-                        p->values = values;
-                        p->coordinate = coordinate;
-                        p->gridpoint = gp;
-
-                        // add to cluster
-                        cluster->add_point(p);
-                    } catch (std::out_of_range &e) {
-                        cerr << "ERROR:reverse coordinate transformation failed for coordinate=" << coordinate << endl;
-                    }
+            // Files written before the compact layout was introduced
+            // have no layout attribute
+            int layout = 1;
+            try {
+                NcGroupAtt layout_att = file->getAtt("cluster_file_layout");
+                if (!layout_att.isNull()) {
+                    layout_att.getValues(&layout);
                 }
+            } catch (netCDF::exceptions::NcException &e) {
+            }
 
-                delete data;
-                list.push_back(cluster);
+            if (layout >= 2) {
+                ClusterList<T>::read_clusters(file, cs, list, load_points);
+                keeps_coordinate_system = !load_points;
+            } else {
+                // The legacy layout names its cluster variables by id
+                file->getAtt("cluster_ids").getValues(value);
+                cluster_ids = sets::from_string<m3D::id_t>(value);
+                ClusterList<T>::read_legacy_clusters(file, cluster_ids, cs, list);
             }
 
-            if (cs_ptr == NULL) {
+            if (cs_ptr == NULL && !keeps_coordinate_system) {
                 delete cs;
+                cs = NULL;
             }
         } catch (const std::exception &e) {
             cerr << "ERROR:exception " << e.what() << endl;
@@ -734,213 +593,489 @@ namespace m3D {
         cl->filename = path;
         cl->file = file;
 
+        // Clusters read without points reference the coordinate
+        // system, the list takes ownership if the caller did not.
+        if (cs_ptr == NULL && keeps_coordinate_system) {
+            cl->m_coordinate_system = cs;
+        }
+
+        // The coordinate system references the source file
+        if (data_file != file) {
+            if (cs != NULL) {
+                cl->m_source_data_file = data_file;
+            } else {
+                delete data_file;
+            }
+        }
+        cl->source_by_reference = (data_file != file);
+
         return cl;
     }
 
     template <typename T>
-    bool sortBySize(const typename Cluster<T>::ptr c1, const typename Cluster<T>::ptr c2) {
-        return c1->size() < c2->size();
+    std::string
+    ClusterList<T>::resolve_source_path(const std::string &path, const std::string &source)
+    {
+        if (boost::filesystem::exists(source)) {
+            return source;
+        }
+
+        boost::filesystem::path sibling = boost::filesystem::path(path).parent_path();
+        sibling /= boost::filesystem::path(source).filename();
+        if (boost::filesystem::exists(sibling)) {
+            return sibling.generic_string();
+        }
+
+        return std::string();
     }
 
     template <typename T>
-    void
-    ClusterList<T>::print(bool includePoints)
+    NcFile *
+    ClusterList<T>::open_data_file(const std::string &path, NcFile *file)
     {
-        std::sort(clusters.begin(),clusters.end(), sortBySize<T>);
+        std::string value;
+        try {
+            NcGroupAtt reference = file->getAtt("source_reference");
+            if (reference.isNull()) {
+                return file;
+            }
+            reference.getValues(value);
+        } catch (netCDF::exceptions::NcException &e) {
+            return file;
+        }
 
-        for (size_t ci = 0; ci < clusters.size(); ci++) {
-            typename Cluster<T>::ptr c = clusters[ci];
-            c->print(includePoints);
+        if (value != "yes") {
+            return file;
         }
-    }
 
-#pragma mark -
-#pragma mark Clustering by Graph Theory
+        std::string source;
+        file->getAtt("source").getValues(source);
+        std::string source_path = ClusterList<T>::resolve_source_path(path, source);
+        if (source_path.empty()) {
+            throw std::runtime_error("source file " + source
+                    + " referenced by " + path + " not found");
+        }
+
+        long long mtime = 0;
+        file->getAtt("source_mtime").getValues(&mtime);
+        if (mtime != 0 && mtime != (long long) boost::filesystem::last_write_time(source_path)) {
+            throw std::runtime_error("source file " + source_path
+                    + " was modified after " + path + " was written");
+        }
+
+        return new NcFile(source_path, NcFile::read);
+    }
 
     template <typename T>
-    T
-    ClusterList<T>::weight_function_tendency(typename Point<T>::ptr p,
-            const WeightFunction<T> *weight_function,
-            const typename Point<T>::list &neighbours,
-            ArrayIndex<T> &index)
+    NcType
+    ClusterList<T>::point_index_type(const vector<size_t> &dimension_sizes)
     {
-        T result = 0;
-        if (!neighbours.empty()) {
-            T wx = weight_function->operator()(p);
-            for (size_t ni = 0; ni < neighbours.size(); ni++) {
-                Point<T> *n = neighbours.at(ni);
-                if (n == p) continue;
-                result += (weight_function->operator()(n) - wx);
-            }
+        size_t grid_size = 1;
+        for (size_t di = 0; di < dimension_sizes.size(); di++) {
+            grid_size *= dimension_sizes[di];
         }
-        return result;
+        return (grid_size > (size_t) std::numeric_limits<int>::max()) ? ncInt64 : ncInt;
     }
 
     template <typename T>
     void
-    ClusterList<T>::aggregate_zeroshifts(FeatureSpace<T> *fs,
-            const WeightFunction<T> *weight_function,
-            ArrayIndex<T> &index,
-            bool coalesceWithStrongestNeighbour,
-            bool show_progress)
+    ClusterList<T>::write_clusters(NcFile *file,
+            const vector<size_t> &dimension_sizes,
+            const NcType &index_type)
     {
-        using namespace utils::vectors;
-        boost::progress_display *progress = NULL;
+        size_t spatial_rank = dimensions.size();
+        size_t value_rank = variables.size();
+        size_t rank = spatial_rank + value_rank;
+        size_t num_clusters = clusters.size();
+
+        // Offsets of each cluster's points in the point array. This
+        // also brings the points of clusters read without points into
+        // memory, before the file they come from is replaced.
+        vector<long long> offsets(num_clusters + 1, 0);
+        for (size_t ci = 0; ci < num_clusters; ci++) {
+            offsets[ci + 1] = offsets[ci] + clusters[ci]->get_points().size();
+        }
+        size_t num_points = (size_t) offsets[num_clusters];
 
-        // find the zero-shift points
-        typedef set< typename Point<T>::ptr > pset_t;
-        pset_t zeroshifts;
+        // Gather points. Only the value range is stored, the
+        // coordinates follow from the grid index.
+        vector<long long> point_index(num_points, 0);
+        vector<T> point_values(num_points * value_rank, 0.0);
 
 #if WITH_OPENMP
 #pragma omp parallel for schedule(dynamic)
 #endif
-        for (size_t i = 0; i < fs->points.size(); i++) {
-            Point<T> *current_point = fs->points[i];
+        for (size_t ci = 0; ci < num_clusters; ci++) {
+            typename Cluster<T>::ptr c = clusters[ci];
+            size_t offset = (size_t) offsets[ci];
+            for (size_t pi = 0; pi < c->size(); pi++) {
+                typename Point<T>::ptr p = c->at(pi);
+                long long li = 0;
+                for (size_t di = 0; di < spatial_rank; di++) {
+                    li = li * dimension_sizes[di] + p->gridpoint[di];
+                }
+                point_index[offset + pi] = li;
+                for (size_t vi = 0; vi < value_rank; vi++) {
+                    point_values[(offset + pi) * value_rank + vi] = p->values[spatial_rank + vi];
+                }
+            }
+        }
+
+        // Gather cluster meta-data. Vectors that have not been
+        // set (like the displacement of untracked clusters) are
+        // written as NaN.
+        T nan = std::numeric_limits<T>::quiet_NaN();
+        vector<unsigned long long> ids(num_clusters, 0);
+        vector<unsigned long long> uuids(num_clusters, 0);
+        vector<signed char> margins(num_clusters, 0);
+        vector<T> modes(num_clusters * rank, nan);
+        vector<T> displacements(num_clusters * spatial_rank, nan);
+        vector<T> bounds_min(num_clusters * spatial_rank, nan);
+        vector<T> bounds_max(num_clusters * spatial_rank, nan);
+
+        for (size_t ci = 0; ci < num_clusters; ci++) {
+            typename Cluster<T>::ptr c = clusters[ci];
+            ids[ci] = (unsigned long long) c->id;
+            uuids[ci] = (unsigned long long) c->uuid;
+            margins[ci] = c->has_margin_points() ? 1 : 0;
+
+            for (size_t di = 0; di < rank && di < c->mode.size(); di++) {
+                modes[ci * rank + di] = c->mode[di];
+            }
+
+            const vector<T> &bmin = c->get_bounding_box_min();
+            const vector<T> &bmax = c->get_bounding_box_max();
+            for (size_t di = 0; di < spatial_rank; di++) {
+                if (di < c->displacement.size()) {
+                    displacements[ci * spatial_rank + di] = c->displacement[di];
+                }
+                if (di < bmin.size()) {
+                    bounds_min[ci * spatial_rank + di] = bmin[di];
+                }
+                if (di < bmax.size()) {
+                    bounds_max[ci * spatial_rank + di] = bmax[di];
+                }
+            }
+        }
 
-#if REPLACE_ZEROSHIFT_VECTORS
+        try {
+            NcDim rank_dim = file->getDim("rank");
+            NcDim spatial_dim = file->addDim("spatial_rank", spatial_rank);
+            NcDim value_dim = file->addDim("value_rank", value_rank);
+            NcDim points_dim = file->addDim("cluster_points", num_points);
+            NcDim clusters_dim = file->addDim("clusters", num_clusters);
+            NcDim offsets_dim = file->addDim("cluster_offsets", num_clusters + 1);
+
+            vector<NcDim> dims(2);
+
+            // Points
+            NcVar index_var = file->addVar("point_index", index_type, points_dim);
+            index_var.setCompression(false, true, 3);
+
+            dims[0] = points_dim;
+            dims[1] = value_dim;
+            NcVar values_var = file->addVar("point_values", ncDouble, dims);
+            values_var.putAtt("variables", utils::vectors::to_string(variables));
+            values_var.setCompression(false, true, 3);
+
+            NcVar offset_var = file->addVar("cluster_offset", ncInt64, offsets_dim);
+
+            // Meta-data
+            NcVar id_var = file->addVar("cluster_id", ncUint64, clusters_dim);
+            NcVar uuid_var = file->addVar("cluster_uuid", ncUint64, clusters_dim);
+            NcVar margin_var = file->addVar("cluster_margin", ncByte, clusters_dim);
+
+            dims[0] = clusters_dim;
+            dims[1] = rank_dim;
+            NcVar mode_var = file->addVar("cluster_mode", ncDouble, dims);
+
+            dims[1] = spatial_dim;
+            NcVar displacement_var = file->addVar("cluster_displacement", ncDouble, dims);
+            NcVar bounds_min_var = file->addVar("cluster_bounding_box_min", ncDouble, dims);
+            NcVar bounds_max_var = file->addVar("cluster_bounding_box_max", ncDouble, dims);
+
+            offset_var.putVar(&offsets[0]);
+
+            if (num_points > 0) {
+                index_var.putVar(&point_index[0]);
+                if (value_rank > 0) {
+                    values_var.putVar(&point_values[0]);
+                }
+            }
 
-            //
-            // #209
-            //
-            // replace the zero-shift vectors with the average of their neighbours
+            if (num_clusters > 0) {
+                id_var.putVar(&ids[0]);
+                uuid_var.putVar(&uuids[0]);
+                margin_var.putVar(&margins[0]);
+                mode_var.putVar(&modes[0]);
+                if (spatial_rank > 0) {
+                    displacement_var.putVar(&displacements[0]);
+                    bounds_min_var.putVar(&bounds_min[0]);
+                    bounds_max_var.putVar(&bounds_max[0]);
+                }
+            }
+        } catch (const netCDF::exceptions::NcException &e) {
+            cerr << "FATAL:exception writing clusters: " << e.what() << endl;
+            exit(EXIT_FAILURE);
+        }
 
-            typename Point<T>::list neighbours = find_neighbours(current_point->gridpoint, index);
+        // Clusters read without points now read them from the new
+        // file, the file they came from is about to be replaced
+        for (size_t ci = 0; ci < num_clusters; ci++) {
+            StoredCluster<T> *sc = dynamic_cast<StoredCluster<T> *>(clusters[ci]);
+            if (sc != NULL) {
+                sc->relocate(file, (size_t) offsets[ci], (size_t) (offsets[ci + 1] - offsets[ci]));
+            }
+        }
+    }
 
-            if (!neighbours.empty()) {
-                vector<T> m(current_point->values.size(), 0.0);
+    /** Copies row ci of a [rows x cols] array into the given
+     * vector. Rows containing NaN were not set on writing and
+     * result in an empty vector.
+     */
+    template <typename T>
+    void
+    cluster_file_row(const vector<T> &data, size_t ci, size_t cols, vector<T> &result)
+    {
+        result.assign(data.begin() + ci * cols, data.begin() + (ci + 1) * cols);
+        for (size_t di = 0; di < cols; di++) {
+            if (isnan(result[di])) {
+                result.clear();
+                break;
+            }
+        }
+    }
+
+    template <typename T>
+    void
+    ClusterList<T>::read_clusters(NcFile *file,
+            const CoordinateSystem<T> *cs,
+            typename Cluster<T>::list &list,
+            bool load_points)
+    {
+        size_t spatial_rank = cs->rank();
+        size_t value_rank = file->getDim("value_rank").getSize();
+        size_t rank = spatial_rank + value_rank;
+        size_t num_points = file->getDim("cluster_points").getSize();
+        size_t num_clusters = file->getDim("clusters").getSize();
+
+        if (num_clusters == 0) {
+            return;
+        }
 
-                for (size_t ni = 0; ni < neighbours.size(); ni++) {
-                    M3DPoint<T> *n = (M3DPoint<T> *) neighbours.at(ni);
+        // Bulk-read the meta-data
+        vector<long long> offsets(num_clusters + 1, 0);
+        file->getVar("cluster_offset").getVar(&offsets[0]);
 
-                    if (n == current_point) continue;
+        vector<unsigned long long> ids(num_clusters, 0);
+        file->getVar("cluster_id").getVar(&ids[0]);
 
-                    m += n->shift;
-                }
+        vector<unsigned long long> uuids(num_clusters, 0);
+        file->getVar("cluster_uuid").getVar(&uuids[0]);
 
-                // average, rounded to grid
+        vector<signed char> margins(num_clusters, 0);
+        file->getVar("cluster_margin").getVar(&margins[0]);
 
-                m /= ((T) neighbours.size());
+        vector<T> modes(num_clusters * rank, 0.0);
+        file->getVar("cluster_mode").getVar(&modes[0]);
 
-                current_point->shift = fs->coordinate_system->round_to_grid(m);
+        vector<T> displacements(num_clusters * spatial_rank, 0.0);
+        file->getVar("cluster_displacement").getVar(&displacements[0]);
 
-                vector<T> spatial_shift = fs->spatial_component(m);
+        vector<T> bounds_min(num_clusters * spatial_rank, 0.0);
+        file->getVar("cluster_bounding_box_min").getVar(&bounds_min[0]);
 
-                current_point->gridded_shift = fs->coordinate_system->rounded_gridpoint(spatial_shift);
-            }
-#endif
-            // If the vector is (still) zero, add to the list of zeroshift points
+        vector<T> bounds_max(num_clusters * spatial_rank, 0.0);
+        file->getVar("cluster_bounding_box_max").getVar(&bounds_max[0]);
 
-            if (vector_norm(fs->spatial_component(current_point->shift)) == 0) {
-#if WITH_OPENMP
-#pragma omp critical
-#endif
-                zeroshifts.insert(current_point);
+        vector<long long> point_index;
+        vector<T> point_values;
+        if (load_points && num_points > 0) {
+            point_index.resize(num_points, 0);
+            file->getVar("point_index").getVar(&point_index[0]);
+            if (value_rank > 0) {
+                point_values.resize(num_points * value_rank, 0.0);
+                file->getVar("point_values").getVar(&point_values[0]);
             }
         }
 
-        if (show_progress) {
-            cout << endl << "Clustering zero-shift areas ...";
-            progress = new boost::progress_display(zeroshifts.size());
-            start_timer();
-        }
+        for (size_t ci = 0; ci < num_clusters; ci++) {
+            vector<T> mode(modes.begin() + ci * rank, modes.begin() + (ci + 1) * rank);
+            size_t offset = (size_t) offsets[ci];
+            size_t size = (size_t) (offsets[ci + 1] - offsets[ci]);
 
-        for (typename pset_t::iterator pi = zeroshifts.begin(); pi != zeroshifts.end(); pi++) {
-            if (show_progress) {
-                progress->operator++();
+            typename Cluster<T>::ptr cluster = NULL;
+            if (load_points) {
+                cluster = new Cluster<T>(mode, spatial_rank);
+            } else {
+                cluster = new StoredCluster<T>(mode, spatial_rank, file, cs, offset, size);
             }
-            Point<T> *current_point = *pi;
-            typename Point<T>::list neighbours = index.find_neighbours(current_point->gridpoint);
 
-            for (size_t ni = 0; ni < neighbours.size(); ni++) {
-                Point<T> *n = neighbours.at(ni);
-                if (n == current_point) continue;
-
-                // only consider neighbours that are zero-shift themselves
-                if (vector_norm(fs->spatial_component(n->shift)) == 0) {
-                    if (current_point->cluster == NULL && n->cluster == NULL) {
-                        // Neither current point nor neighbour have cluster
-                        // => create new cluster
-                        size_t spatial_dims = fs->coordinate_system->rank();
-                        typename Cluster<T>::ptr c = new Cluster<T>(current_point->values, spatial_dims);
-                        c->add_point(current_point);
-                        c->add_point(n);
-                        clusters.push_back(c);
-                    } else if (current_point->cluster == NULL && n->cluster != NULL) {
-                        // neighbour has cluster
-                        // => add current point to neighbour's cluster
-                        n->cluster->add_point(current_point);
-                    } else if (current_point->cluster != NULL && n->cluster == NULL) {
-                        // current point has cluster
-                        // => add neighbour to current point's cluster
-                        current_point->cluster->add_point(n);
-                    } else if ((current_point->cluster != NULL && n->cluster != NULL)
-                            && (current_point->cluster != n->cluster)) {
-                        // current point's cluster and neighbour's cluster
-                        // => merge current point's cluster into neighbour's cluster
-                        typename Cluster<T>::ptr c = current_point->cluster;
-                        n->cluster->add_points(c->get_points(), false);
-                        clusters.erase(find(clusters.begin(), clusters.end(), c));
-                        delete c;
-                    }
-                }
+            cluster->id = (m3D::id_t) ids[ci];
+            cluster->uuid = (m3D::uuid_t) uuids[ci];
+            cluster->set_has_margin_points(margins[ci] != 0);
+
+            vector<T> v;
+            cluster_file_row(displacements, ci, spatial_rank, v);
+            cluster->displacement = v;
+            cluster_file_row(bounds_min, ci, spatial_rank, v);
+            cluster->set_bounding_box_min(v);
+            cluster_file_row(bounds_max, ci, spatial_rank, v);
+            cluster->set_bounding_box_max(v);
+
+            if (load_points && size > 0) {
+                StoredCluster<T>::decode_points(cluster,
+                        &point_index[offset],
+                        point_values.empty() ? NULL : &point_values[offset * value_rank],
+                        size, value_rank, cs);
             }
-        }
 
-#if ADD_STRONGEST_NEIGHBOUR
-        // Find neighbours that are not part of the clusters yet
-        // and have a stronger weight function response. Assign those
-        // to the zero-shift cluster as 'crystallization' points
-        // TODO: if it works, incorporate into above loop to save time
-
-        for (size_t i = 0; i < clusters.size(); i++) {
-            typename Cluster<T>::ptr c = clusters.at(i);
+            list.push_back(cluster);
+        }
+    }
 
-            typename Point<T>::list::iterator pi;
+    template <typename T>
+    void
+    ClusterList<T>::read_legacy_clusters(NcFile *file,
+            const id_set_t &cluster_ids,
+            const CoordinateSystem<T> *cs,
+            typename Cluster<T>::list &list)
+    {
+        std::string value;
+        id_set_t::const_iterator cid_iter;
+
+        for (cid_iter = cluster_ids.begin(); cid_iter != cluster_ids.end(); cid_iter++) {
+            // Identifier
+            m3D::id_t cid = *cid_iter;
+
+            // cluster dimension
+            stringstream dim_name(stringstream::in | stringstream::out);
+            dim_name << "cluster_dim_" << cid;
+            NcDim cluster_dim = file->getDim(dim_name.str().c_str());
+            size_t cluster_size = cluster_dim.getSize();
+
+            // Read the variable
+            stringstream var_name(stringstream::in | stringstream::out);
+            var_name << "cluster_" << cid;
+            NcVar var = file->getVar(var_name.str().c_str());
+
+            // mode
+            std::string mode_str;
+            var.getAtt("mode").getValues(mode_str);
+            vector<T> mode = vectors::from_string<T>(mode_str);
+            
+            var.getAtt("uuid").getValues(value);
+            m3D::uuid_t uuid = boost::lexical_cast<m3D::uuid_t>(value);
 
-            T strongest_response = numeric_limits<T>::min();
+            // displacement
+            std::string displacement_str;
+            var.getAtt("displacement").getValues(displacement_str);
+            vector<T> displacement = vectors::from_string<T>(displacement_str);
 
-            T strongest_own_response = numeric_limits<T>::min();
+            std::string bounds_min_str;
+            var.getAtt("bounding_box_min").getValues(bounds_min_str);
+            vector<T> bounds_min = vectors::from_string<T>(bounds_min_str);
 
-            typename Point<T>::ptr strongest_point = NULL;
+            std::string bounds_max_str;
+            var.getAtt("bounding_box_max").getValues(bounds_max_str);
+            vector<T> bounds_max = vectors::from_string<T>(bounds_max_str);
+            
+            // margin flag
+            std::string margin_char;
+            var.getAtt("has_margin_points").getValues(margin_char);
+            bool margin_flag = margin_char == "Y";
+
+            // Create a cluster object
+            typename Cluster<T>::ptr cluster = new Cluster<T>(mode, cs->rank());
+            cluster->id = cid;
+            cluster->uuid = uuid;
+            cluster->mode = mode;
+            cluster->displacement = displacement;
+            cluster->set_bounding_box_min(bounds_min);
+            cluster->set_bounding_box_max(bounds_max);
+            cluster->set_has_margin_points(margin_flag);
+
+            // Read the cluster
+            size_t numElements = cluster_size * cluster->rank();
+            T *data = (T *) malloc(sizeof (T) * numElements);
+            if (data == NULL) {
+                cerr << "FATAL:out of memory" << endl;
+                exit(EXIT_FAILURE);
+            }
 
-            for (pi = c->points.begin(); pi != c->points.end(); pi++) {
-                typename Point<T>::ptr p = *pi;
+            var.getVar(data);
+            for (size_t pi = 0; pi < cluster_size; pi++) {
+                vector<T> values(cluster->rank(), 0.0);
 
-                // track own response
+                // copy point from data
+                for (size_t di = 0; di < cluster->rank(); di++) {
+                    values[di] = data[pi * cluster->rank() + di];
+                }
 
-                T own_response = weight_function->operator()(p);
+                // get coordinate subvector
+                vector<T> coordinate(values.begin(), values.begin() + cs->rank());
 
-                if (own_response > strongest_own_response) {
-                    strongest_own_response = own_response;
+                // transform to gridpoint
+                try {
+                    vector<int> gp(cs->rank(), 0);
+                    cs->reverse_lookup(coordinate, gp);
+
+                    // only when this succeeds do we have the complete
+                    // set of data for the point
+                    typename Point<T>::ptr p = PointFactory<T>::get_instance()->create();
+                    p->values = values;
+                    p->coordinate = coordinate;
+                    p->gridpoint = gp;
+
+                    // add to cluster
+                    cluster->add_point(p);
+                } catch (std::out_of_range &e) {
+                    cerr << "ERROR:reverse coordinate transformation failed for coordinate=" << coordinate << endl;
                 }
+            }
 
-                // Find the neighbour with the strongest response
+            delete data;
+            list.push_back(cluster);
+        }
+    }
 
-                typename Point<T>::list neighbours = find_neighbours(p->gridpoint, index);
+    template <typename T>
+    bool sortBySize(const typename Cluster<T>::ptr c1, const typename Cluster<T>::ptr c2) {
+        return c1->size() < c2->size();
+    }
 
-                for (size_t ni = 0; ni < neighbours.size(); ni++) {
-                    M3DPoint<T> *n = (M3DPoint<T> *) neighbours.at(ni);
+    template <typename T>
+    void
+    ClusterList<T>::print(bool includePoints)
+    {
+        std::sort(clusters.begin(),clusters.end(), sortBySize<T>);
 
-                    T response = weight_function->operator()(n);
+        for (size_t ci = 0; ci < clusters.size(); ci++) {
+            typename Cluster<T>::ptr c = clusters[ci];
+            c->print(includePoints);
+        }
+    }
 
-                    if (response > strongest_response) {
-                        strongest_response = response;
-                        strongest_point = n;
-                    }
-                }
-            }
+#pragma mark -
+#pragma mark Clustering by Graph Theory
 
-            if (strongest_response > strongest_own_response && strongest_point != NULL) {
-                // found a higher point in the vicinity
-                c->add_point(strongest_point);
+    template <typename T>
+    T
+    ClusterList<T>::weight_function_tendency(typename Point<T>::ptr p,
+            const WeightFunction<T> *weight_function,
+            const typename Point<T>::list &neighbours,
+            ArrayIndex<T> &index)
+    {
+        T result = 0;
+        if (!neighbours.empty()) {
+            T wx = weight_function->operator()(p);
+            for (size_t ni = 0; ni < neighbours.size(); ni++) {
+                Point<T> *n = neighbours.at(ni);
+                if (n == p) continue;
+                result += (weight_function->operator()(n) - wx);
             }
         }
-#endif
-        // Assign ID
-        if (show_progress) {
-            cout << "done (found " << clusters.size() << " zero-shift clusters in " << stop_timer() << "s)." << endl;
-            delete progress;
-        }
+        return result;
     }
 
     template <typename T>
@@ -951,325 +1086,293 @@ namespace m3D {
             bool show_progress)
     {
         using namespace utils::vectors;
-        // PointIndex<T>::write_index_searches = true;
-        boost::progress_display *progress = NULL;
-#if DEBUG_GRAPH_AGGREGATION
-        for (size_t i = 0; i < fs->points.size(); i++) {
-            Point<T> *p = fs->points[i];
-            if (p->coordinate.size() != p->gridpoint.size() || p->gridpoint.size() > 5) {
-                cerr << "ERROR: bogus point " << p << endl;
-            }
-
 
-        }
-#endif
-        vector<size_t> dimensions = fs->coordinate_system->get_dimension_sizes();
-        ArrayIndex<T> index(dimensions, fs->points, false);
-#if DEBUG_GRAPH_AGGREGATION
-        for (size_t i = 0; i < fs->points.size(); i++) {
-            Point<T> *p = fs->points[i];
-            if (p->coordinate.size() != p->gridpoint.size()) {
-                cerr << "ERROR: bogus point " << p << endl;
-            }
-        }
-#endif
-        this->aggregate_zeroshifts(fs, weight_function, index, coalesceWithStrongestNeighbour, show_progress);
+        const size_t N = fs->points.size();
+        const size_t spatial_rank = fs->coordinate_system->rank();
 
-#if DEBUG_GRAPH_AGGREGATION
-        for (size_t i = 0; i < fs->points.size(); i++) {
-            Point<T> *p = fs->points[i];
-            if (p->coordinate.size() != p->gridpoint.size()) {
-                cerr << "ERROR: bogus point " << p << endl;
-            }
-        }
-#endif
+        // Index the points by grid point. The id of a point in
+        // the index is its position in fs->points.
 
-#if WRITE_ZEROSHIFT_CLUSTERS
-        typename Cluster<T>::list::iterator ci;
-        size_t id = 0;
-        for (ci = clusters.begin(); ci != clusters.end(); ci++) {
-            typename Cluster<T>::ptr c = *ci;
-            c->id = id++;
-        }
+        ArrayIndex<T> index(fs->coordinate_system->get_dimension_sizes(), fs->points, false);
+        const size_t neighbourhood_size = index.neighbourhood_size();
 
-        NetCDFDataStore<T> *ds = (NetCDFDataStore<T> *) fs->data_store();
-        boost::filesystem::path path(ds->filename());
+        vector<unsigned char> is_zeroshift(N, 0);
 
-        std::string basename = path.stem().generic_string() + "-zeroshift";
-        VisitUtils<T>::write_clusters_vtu(this, fs->coordinate_system, basename);
-#endif
-        // Sanity checking
-        // this->check_clusters(fs,index);
-        size_t cluster_id = this->clusters.size();
         if (show_progress) {
             cout << endl << "Analysing meanshift vector graph ...";
             start_timer();
-            progress = new boost::progress_display(fs->points.size());
         }
 
-        //        #if WITH_OPENMP
-        //        #pragma omp parallel for schedule(dynamic)
-        //        #endif
-        for (size_t i = 0; i < fs->points.size(); i++) {
-            if (show_progress) {
-                //                #if WITH_OPENMP
-                //                #pragma omp critical
-                //                #endif
-                progress->operator++();
-            }
-
-            Point<T> *current_point = fs->points[i];
-            // skip zeroshift and non-original points
-            if (vector_norm(fs->spatial_component(current_point->shift)) == 0 || !current_point->isOriginalPoint)
-                continue;
-            // Find the predecessor through gridded shift
-            vector<int> gridpoint = current_point->gridpoint + current_point->gridded_shift;
-            Point<T> *predecessor = NULL;
-            try {
-                predecessor = index.get(gridpoint);
-            } catch (std::invalid_argument &e) {
-#if DEBUG_GRAPH_AGGREGATION
-                cout << "gridpoint=" << current_point->gridpoint
-                        << " + gridded_shift = " << current_point->gridded_shift
-                        << " = " << gridpoint
-                        << " which caused exception " << e.what() << endl;
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
 #endif
-            }
+        for (size_t i = 0; i < N; i++) {
+            is_zeroshift[i] = vector_norm(fs->spatial_component(fs->points[i]->shift)) == 0 ? 1 : 0;
+        }
 
-            // Start testing
-            if (predecessor != NULL) {
-                // we're pointing to somebody?
-                current_point->isBoundary = true;
+        // Build the graph. Zero-shift points are joined with their 
+        // zero-shift neighbours, all other original points with the
+        // point their gridded shift points to. Points that are part 
+        // of any edge are marked as linked.
 
-                // whoever we're pointing to, he's
-                // not a boundary point.
-                predecessor->isBoundary = false;
+        UnionFind sets(N);
+        vector<unsigned char> linked(N, 0);
+        vector<long> predecessor(N, -1);
 
-#if DEBUG_GRAPH_AGGREGATION
-                cout << endl;
-                cout << "current point : " << current_point << " @ " << current_point->gridpoint << " (" << current_point->cluster << ")" << endl;
-                cout << "predecessor   : " << predecessor << " @ " << predecessor->gridpoint << " (" << predecessor->cluster << ")" << endl;
-                // cout << "(reverse lookup of " << x << " = " << gp << ")" << endl;
+#if WITH_OPENMP
+#pragma omp parallel
 #endif
-                if (current_point->cluster == NULL && predecessor->cluster == NULL) {
-                    // Neither point has a cluster
-                    // => create new one
-
-                    //                    #if WITH_OPENMP
-                    //                    #pragma omp critical
-                    //                    #endif
-                    {
-                        typename Cluster<T>::ptr c = new Cluster<T>(current_point->values, fs->coordinate_system->rank());
-                        c->id = cluster_id++;
-                        c->add_point(current_point);
-                        c->add_point(predecessor);
-                        clusters.push_back(c);
-
-#if DEBUG_GRAPH_AGGREGATION
-                        cout << "created new cluster " << c
-                                << " (" << c->size()
-                                << " points)" << endl;
+        {
+            vector<typename ArrayIndex<T>::id_t> neighbours(neighbourhood_size);
+
+#if WITH_OPENMP
+#pragma omp for schedule(dynamic,1024)
 #endif
+            for (size_t i = 0; i < N; i++) {
+                if (!is_zeroshift[i])
+                    continue;
+                size_t count = index.find_neighbour_ids(fs->points[i]->gridpoint, &neighbours[0]);
+                for (size_t ni = 0; ni < count; ni++) {
+                    size_t n = neighbours[ni];
+                    if (n != i && is_zeroshift[n]) {
+                        linked[i] = 1;
+                        sets.unite(i, n);
                     }
-                } else if (current_point->cluster == NULL && predecessor->cluster != NULL) {
-                    // current point has no cluster, but predecessor has one
-                    // => add current point to predecessor's cluster
-
-                    //                    #if WITH_OPENMP
-                    //                    #pragma omp critical
-                    //                    #endif
-                    predecessor->cluster->add_point(current_point);
-
-#if DEBUG_GRAPH_AGGREGATION
-                    cout << "added current point to cluster "
-                            << predecessor->cluster << " ("
-                            << predecessor->cluster->size()
-                            << " points)" << endl;
-#endif
-                } else if (current_point->cluster != NULL && predecessor->cluster == NULL) {
-                    // current point has a cluster, but predecessor has none
-                    // => add predecessor to current point's cluster
-
-                    //                    #if WITH_OPENMP
-                    //                    #pragma omp critical
-                    //                    #endif
-                    current_point->cluster->add_point(predecessor);
-
-#if DEBUG_GRAPH_AGGREGATION
-                    cout << "added predecessor to cluster "
-                            << current_point->cluster
-                            << " (" << current_point->cluster->size()
-                            << " points)" << endl;
-#endif
-                } else if (current_point->cluster != predecessor->cluster) {
-                    // both points have different clusters
-                    // => merge current cluster's points to predecessor's cluster
-                    //    and delete current cluster
+                }
+            }
+        }
 
-                    // Save a little time by merging the smaller into the bigger cluster
+#if WRITE_ZEROSHIFT_CLUSTERS
+        {
+            map<size_t, typename Cluster<T>::ptr> zeroshift_clusters;
+            for (size_t i = 0; i < N; i++) {
+                if (!linked[i]) continue;
+                size_t root = sets.find(i);
+                if (zeroshift_clusters.find(root) == zeroshift_clusters.end()) {
+                    typename Cluster<T>::ptr c = new Cluster<T>(fs->points[root]->values, spatial_rank);
+                    c->id = clusters.size();
+                    zeroshift_clusters[root] = c;
+                    clusters.push_back(c);
+                }
+                zeroshift_clusters[root]->add_point(fs->points[i]);
+            }
 
-                    typename Cluster<T>::ptr merged;
-                    typename Cluster<T>::ptr mergee;
+            NetCDFDataStore<T> *ds = (NetCDFDataStore<T> *) fs->data_store();
+            boost::filesystem::path path(ds->filename());
+            std::string basename = path.stem().generic_string() + "-zeroshift";
+            VisitUtils<T>::write_clusters_vtu(this, fs->coordinate_system, basename);
 
-                    if (current_point->cluster->size() >= predecessor->cluster->size()) {
-                        merged = current_point->cluster;
-                        mergee = predecessor->cluster;
-                    } else {
-                        merged = predecessor->cluster;
-                        mergee = current_point->cluster;
-                    }
+            this->clear(false);
+        }
+#endif
 
-#if DEBUG_GRAPH_AGGREGATION
-                    cout << "merging cluster " << mergee << " (" << mergee->size() << " points)"
-                            << "into " << merged << " (" << merged->size() << " points)"
-                            << endl;
+#if WITH_OPENMP
+#pragma omp parallel
 #endif
-                    //                    #if WITH_OPENMP
-                    //                    #pragma omp critical
-                    //                    #endif
-                    {
-                        // absorb predecessor
-                        merged->add_points(mergee->get_points(), false);
-
-                        // remove it
-                        typename Cluster<T>::list::iterator fi = find(clusters.begin(), clusters.end(), mergee);
-                        clusters.erase(fi);
-                        delete mergee;
-                    }
-                } else {
-                    // both points are already part of the same cluster
-                    // => do nothing
+        {
+            vector<int> target(spatial_rank);
 
-#if DEBUG_GRAPH_AGGREGATION
-                    cout << "Both points are part of the same cluster. Skip." << endl;
+#if WITH_OPENMP
+#pragma omp for schedule(dynamic,1024)
 #endif
+            for (size_t i = 0; i < N; i++) {
+                Point<T> *current_point = fs->points[i];
+                if (is_zeroshift[i] || !current_point->isOriginalPoint)
+                    continue;
+
+                // Find the predecessor through gridded shift
+                for (size_t d = 0; d < spatial_rank; d++) {
+                    target[d] = current_point->gridpoint[d] + current_point->gridded_shift[d];
                 }
+                typename ArrayIndex<T>::id_t id = index.id(target);
+                if (id == ArrayIndex<T>::NO_POINT)
+                    continue;
+
+                predecessor[i] = id;
+                linked[i] = 1;
+                sets.unite(i, id);
+            }
+        }
+
+        // A point is a boundary point if it points to somebody 
+        // and nobody points to it
+
+        for (size_t i = 0; i < N; i++) {
+            fs->points[i]->isBoundary = (predecessor[i] >= 0);
+        }
+        for (size_t i = 0; i < N; i++) {
+            if (predecessor[i] >= 0) {
+                linked[predecessor[i]] = 1;
+                fs->points[predecessor[i]]->isBoundary = false;
+            }
+        }
+
+        // Compact the sets into lists of point indexes. The 
+        // representative of a set is its smallest point index,
+        // so the lists come out ordered by their first point.
+
+        vector< vector<size_t> > members;
+        vector<long> member_of(N, -1);
+        for (size_t i = 0; i < N; i++) {
+            if (!linked[i])
+                continue;
+            size_t root = sets.find(i);
+            if (member_of[root] < 0) {
+                member_of[root] = members.size();
+                members.push_back(vector<size_t>());
             }
+            member_of[i] = member_of[root];
+            members[member_of[i]].push_back(i);
         }
 
         if (show_progress) {
-            cout << "done. (Found " << clusters.size() << " clusters in " << stop_timer() << "s)" << endl;
-            delete progress;
+            cout << "done. (Found " << members.size() << " clusters in " << stop_timer() << "s)" << endl;
         }
 
-        // TODO: parallelize
         if (coalesceWithStrongestNeighbour) {
             if (show_progress) {
                 cout << endl << "Running coalescence post-procesing ";
                 start_timer();
             }
 
-            for (size_t i = 0; i < clusters.size(); i++) {
-                typename Cluster<T>::ptr c = clusters.at(i);
-                T strongest_response = numeric_limits<T>::min();
-                T strongest_own_response = numeric_limits<T>::min();
-                typename Cluster<T>::ptr strongest_cluster = NULL;
-                typename Point<T>::list::iterator pi;
-                for (pi = c->get_points().begin(); pi != c->get_points().end(); pi++) {
-                    typename Point<T>::ptr p = *pi;
-
-                    // track own response
-                    T own_response = weight_function->operator()(p);
-                    if (own_response > strongest_own_response) {
-                        strongest_own_response = own_response;
-                    }
+            vector<T> response(N);
+#if WITH_OPENMP
+#pragma omp parallel for schedule(dynamic,1024)
+#endif
+            for (size_t i = 0; i < N; i++) {
+                response[i] = weight_function->operator()(fs->points[i]);
+            }
 
-                    // Find the neighbour with the strongest response
-                    typename Point<T>::list neighbours = index.find_neighbours(p->gridpoint);
-                    for (size_t ni = 0; ni < neighbours.size(); ni++) {
-                        Point<T> *n = neighbours.at(ni);
+            // Each round, every cluster finds the neighbouring point
+            // with the strongest response outside of itself. If that
+            // point belongs to a cluster and is at least as strong as 
+            // the cluster's own strongest point, both are merged. 
+            // Repeat until nothing changes.
 
-                        // only interested in different clusters here
-                        if (n->cluster == c) {
-                            continue;
-                        }
+            bool merged = true;
+            while (merged) {
+                const size_t K = members.size();
+                vector<long> target(K, -1);
 
-                        // figure out the response
-                        T response = weight_function->operator()(n);
-                        if (response > strongest_response) {
-                            strongest_response = response;
-                            strongest_cluster = n->cluster;
+#if WITH_OPENMP
+#pragma omp parallel
+#endif
+                {
+                    vector<typename ArrayIndex<T>::id_t> neighbours(neighbourhood_size);
+
+#if WITH_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+                    for (size_t k = 0; k < K; k++) {
+                        T strongest_response = numeric_limits<T>::min();
+                        T strongest_own_response = numeric_limits<T>::min();
+                        long strongest_cluster = -1;
+                        for (size_t mi = 0; mi < members[k].size(); mi++) {
+                            size_t i = members[k][mi];
+                            if (response[i] > strongest_own_response) {
+                                strongest_own_response = response[i];
+                            }
+                            size_t count = index.find_neighbour_ids(fs->points[i]->gridpoint, &neighbours[0]);
+                            for (size_t ni = 0; ni < count; ni++) {
+                                size_t n = neighbours[ni];
+                                if (member_of[n] == (long) k)
+                                    continue;
+                                if (response[n] > strongest_response) {
+                                    strongest_response = response[n];
+                                    strongest_cluster = member_of[n];
+                                }
+                            }
+                        }
+                        if (strongest_response >= strongest_own_response && strongest_cluster >= 0) {
+                            target[k] = strongest_cluster;
                         }
                     }
                 }
 
-                if (strongest_response >= strongest_own_response && strongest_cluster != NULL) {
-                    // found a higher ranking cluster in the direct
-                    // vicinity. Merge!
-                    c->add_points(strongest_cluster->get_points(), false);
-
-                    typename Cluster<T>::list::iterator cfi = find(clusters.begin(), clusters.end(), strongest_cluster);
-                    if (cfi != clusters.end()) {
-                        clusters.erase(cfi);
-                        delete strongest_cluster;
+                UnionFind cluster_sets(K);
+                merged = false;
+                for (size_t k = 0; k < K; k++) {
+                    if (target[k] >= 0 && cluster_sets.unite(k, target[k])) {
+                        merged = true;
                     }
+                }
 
-                    // start over!
-                    // TODO: this could be done a little smarter, probably
-                    // by remembering the clusters to be deleted and skip
-                    // them in the above procedure, then remove them later
-                    // in bulk?
-                    cout << ".";
-                    i = 0;
+                if (merged) {
+                    // Move the points into the representative cluster
+                    // (the one with the smallest index) and re-number
+                    vector< vector<size_t> > coalesced;
+                    vector<long> renumbered(K, -1);
+                    for (size_t k = 0; k < K; k++) {
+                        size_t root = cluster_sets.find(k);
+                        if (renumbered[root] < 0) {
+                            renumbered[root] = coalesced.size();
+                            coalesced.push_back(vector<size_t>());
+                        }
+                        vector<size_t> &dest = coalesced[renumbered[root]];
+                        dest.insert(dest.end(), members[k].begin(), members[k].end());
+                    }
+                    for (size_t i = 0; i < N; i++) {
+                        if (member_of[i] >= 0) {
+                            member_of[i] = renumbered[cluster_sets.find(member_of[i])];
+                        }
+                    }
+                    members.swap(coalesced);
+                    if (show_progress) {
+                        cout << ".";
+                    }
                 }
             }
 
             if (show_progress) {
-                cout << "done. (Coalesced " << clusters.size() << " clusters in " << stop_timer() << "s)" << endl;
+                cout << "done. (Coalesced " << members.size() << " clusters in " << stop_timer() << "s)" << endl;
             }
         }
 
-        // Finally remove all points from all clusters, that were
-        // not part of the original data set, as well as make their
-        // modes the arithmetic mean of the remaining points
+        // Finally create the clusters. Only points, that were part of
+        // the original data set are kept. The modes are the arithmetic
+        // mean of the remaining points
 
         if (show_progress) {
             cout << endl << "Erasing non-original points ...";
             start_timer();
-            progress = new boost::progress_display(clusters.size());
         }
 
-        for (typename Cluster<T>::list::iterator clit = clusters.begin(); clit != clusters.end();) {
-            if (show_progress) {
-                progress->operator++();
-            }
-
-            typename Cluster<T>::ptr c = *clit;
+        for (size_t k = 0; k < members.size(); k++) {
             vector<T> mode = vector<T>(fs->rank(), 0.0);
-            typename Point<T>::list keepers;
-
-            // Make pointers unique
-            typedef std::set< typename Point<T>::ptr > point_set_t;
-            point_set_t point_set;
-            point_set.insert(c->get_points().begin(), c->get_points().end());
-
-            // Iterate over the unique set
-            for (typename point_set_t::iterator si = point_set.begin(); si != point_set.end(); ++si) {
-                typename Point<T>::ptr p = *si;
+            size_t keepers = 0;
+            for (size_t mi = 0; mi < members[k].size(); mi++) {
+                typename Point<T>::ptr p = fs->points[members[k][mi]];
                 if (p->isOriginalPoint) {
-                    keepers.push_back(p);
                     mode += p->values;
+                    keepers++;
                 }
             }
 
-            if (keepers.empty()) {
-                // removed them all? Kill cluster
-                clusters.erase(clit);
-                delete c;
-            } else {
-                mode /= ((T) keepers.size());
-                c->set_points(keepers);
-                c->mode = mode;
-                clit++;
+            if (keepers == 0) {
+                // removed them all? No cluster
+                for (size_t mi = 0; mi < members[k].size(); mi++) {
+                    fs->points[members[k][mi]]->cluster = NULL;
+                }
+                continue;
             }
+
+            mode /= ((T) keepers);
+            typename Cluster<T>::ptr c = new Cluster<T>(mode, spatial_rank);
+            c->id = clusters.size();
+            for (size_t mi = 0; mi < members[k].size(); mi++) {
+                typename Point<T>::ptr p = fs->points[members[k][mi]];
+                if (p->isOriginalPoint) {
+                    c->add_point(p);
+                } else {
+                    p->cluster = c;
+                }
+            }
+            clusters.push_back(c);
         }
 
         if (show_progress) {
             cout << "done. (Result: " << clusters.size() << " clusters in " << stop_timer() << "s)" << endl;
-            delete progress;
         }
-
-        // PointIndex<T>::write_index_searches = false;
     }
 
     template <typename T>
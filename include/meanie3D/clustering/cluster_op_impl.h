@@ -107,32 +107,59 @@ namespace m3D {
             return cluster_list;
         }
 
+        utils::Profiler &profiler = utils::Profiler::instance();
+
         MeanshiftOperation<T> meanshiftOperator(this->feature_space, this->point_index);
+        profiler.begin("index");
         meanshiftOperator.prime_index(m_context.search_params);
+        profiler.end();
+
+        profiler.begin("mean-shift");
+        profiler.count("points", this->feature_space->size());
+
+        // Process the points in blocks, using one set of scratch
+        // buffers per thread. This avoids contention on the heap.
+        typename Point<T>::list &points = this->feature_space->points;
+        const size_t batch_size = MeanshiftOperation<T>::DEFAULT_BATCH_SIZE;
+        const size_t num_points = points.size();
+        const size_t num_batches = (num_points + batch_size - 1) / batch_size;
+
+#if WITH_OPENMP
+#pragma omp parallel
+#endif
+        {
+            typename MeanshiftOperation<T>::Scratch scratch;
 
 #if WITH_OPENMP
-#pragma omp parallel for schedule(dynamic)
+#pragma omp for schedule(dynamic)
 #endif
-        for (size_t index = 0; index < this->feature_space->size(); index++) {
-            if (m_context.show_progress) {
+            for (size_t batch = 0; batch < num_batches; batch++) {
+                size_t begin = batch * batch_size;
+                size_t end = begin + batch_size;
+                if (end > num_points) {
+                    end = num_points;
+                }
+
+                meanshiftOperator.meanshift(points, begin, end,
+                        m_context.search_params,
+                        m_context.kernel,
+                        m_context.weight_function,
+                        scratch);
+
+                if (m_context.show_progress) {
 #if WITH_OPENMP
 #pragma omp critical
 #endif
-                m_progress_bar->operator++();
+                    m_progress_bar->operator+=(end - begin);
+                }
             }
-            
-            // Get the meanshift vector for this point
-            typename Point<T>::ptr x = this->feature_space->points[ index ];
-            x->shift = meanshiftOperator.meanshift(x->values, 
-                    m_context.search_params, 
-                    m_context.kernel, 
-                    m_context.weight_function);
-            
-            // Extract the spatial component and obtain the grid
-            vector<T> spatial_shift = this->feature_space->spatial_component(x->shift);
-            x->gridded_shift = this->feature_space->coordinate_system->to_gridpoints(spatial_shift);
+
+            profiler.count("searches", scratch.searches);
+            profiler.count("neighbours", scratch.neighbours);
         }
 
+        profiler.end();
+
         if (m_context.show_progress) {
             cout << "done. (" << stop_timer() << "s)" << endl;
             delete m_progress_bar;
@@ -140,13 +167,17 @@ namespace m3D {
         }
 
         // Analyse the graph and create clusters
+        profiler.begin("aggregation");
         cluster_list->aggregate_cluster_graph(
                 this->feature_space, 
                 m_context.weight_function, 
                 m_params.coalesceWithStrongestNeighbour, 
                 m_context.show_progress);
+        profiler.count("clusters", cluster_list->size());
+        profiler.end();
 
         // Provide fresh ids right away
+        profiler.begin("post-processing");
         m3D::uuid_t uuid = 0;
         ClusterUtils<T>::provideUuids(cluster_list,uuid);
         m3D::id_t id = 0;
@@ -162,6 +193,7 @@ namespace m3D {
 
         // Find margin points (#325)
         ClusterUtils<T>::obtain_margin_flag(cluster_list, this->feature_space);
+        profiler.end();
 
 #if WRITE_BOUNDARIES
         cluster_list.write_boundaries(weight_function, this->feature_space, this->point_index, resolution);
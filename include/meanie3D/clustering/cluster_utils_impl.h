@@ -45,7 +45,8 @@ namespace m3D {
                                                    CoordinateSystem <T> *coord_system,
                                                    WeightFunction <T> *weight_function,
                                                    const Verbosity verbosity) {
-        using utils::SimpleMatrix;
+        using utils::ClusterOverlap;
+        using utils::SparseMatrix;
         using namespace utils::vectors;
 
         if (verbosity >= VerbosityNormal) {
@@ -61,43 +62,30 @@ namespace m3D {
             }
         }
 
-        // Provide index for overlap calculations
-        ClusterIndex<T> index_of_previous(previous->clusters, coord_system->get_dimension_sizes());
-        size_t new_count = current->clusters.size();
+        // Overlap of previous (rows) and current (columns) clusters
+        ClusterOverlap<T> overlap(previous->clusters, current->clusters, 
+                coord_system->get_dimension_sizes());
         size_t old_count = previous->clusters.size();
         id_t current_id = current->clusters[current->clusters.size() - 1]->id;
 
-        typename SimpleMatrix<T>::matrix_t coverOldByNew = SimpleMatrix<T>::create_matrix(new_count, old_count);
-        typename SimpleMatrix<T>::matrix_t coverNewByOld = SimpleMatrix<T>::create_matrix(new_count, old_count);
-
-        // compute overlap
         size_t n, m;
+        SparseMatrix<size_t>::row_t::const_iterator ri;
 
         boost::progress_display *progress = NULL;
 
         if (verbosity >= VerbosityNormal) {
-            progress = new boost::progress_display(2 * old_count);
+            progress = new boost::progress_display(old_count);
         }
 
-        for (m = 0; m < old_count; m++) {
-            typename Cluster<T>::ptr oldCluster = previous->clusters[m];
-
-            if (verbosity >= VerbosityNormal) {
-                progress->operator++();
-            }
-
-            for (n = 0; n < new_count; n++) {
-                typename Cluster<T>::ptr newCluster = current->clusters[n];
-
-                // Calculate overlap
-
-                T overlap = index_of_previous.occupation_ratio(newCluster, oldCluster);
-
-                if (overlap > 0 && verbosity >= VerbosityDetails) {
-                    printf("old #%4lu with new #%4lu overlap = %3.2f\n", oldCluster->id, newCluster->id, overlap);
+        if (verbosity >= VerbosityDetails) {
+            for (m = 0; m < old_count; m++) {
+                typename Cluster<T>::ptr oldCluster = previous->clusters[m];
+                const SparseMatrix<size_t>::row_t &row = overlap.counts().row(m);
+                for (ri = row.begin(); ri != row.end(); ++ri) {
+                    typename Cluster<T>::ptr newCluster = current->clusters[ri->first];
+                    printf("old #%4lu with new #%4lu overlap = %3.2f\n", 
+                            oldCluster->id, newCluster->id, overlap.ratio_b(m, ri->first));
                 }
-
-                coverNewByOld[n][m] = overlap;
             }
         }
 
@@ -117,10 +105,10 @@ namespace m3D {
 
             // figure out the largest candidate
             // TODO: do we still need this here?
-            for (n = 0; n < current->clusters.size(); n++) {
-                T overlap = coverNewByOld[n][m];
-
-                if (overlap >= 0.33) {
+            const SparseMatrix<size_t>::row_t &row = overlap.counts().row(m);
+            for (ri = row.begin(); ri != row.end(); ++ri) {
+                n = ri->first;
+                if (overlap.ratio_b(m, n) >= 0.33) {
                     candidates.push_back(n);
                 }
             }
@@ -218,6 +206,7 @@ namespace m3D {
                                         typename FeatureSpace<T>::ptr fs) {
         vector<size_t> dims = fs->coordinate_system->get_dimension_sizes();
         ArrayIndex<T> index(dims, fs->points, false);
+        vector<typename ArrayIndex<T>::id_t> neighbors(index.neighbourhood_size(1));
         typename Cluster<T>::list::iterator ci;
         for (ci = list->clusters.begin(); ci != list->clusters.end(); ++ci) {
             typename Cluster<T>::ptr c = *ci;
@@ -225,12 +214,10 @@ namespace m3D {
             for (pi = c->get_points().begin(); pi != c->get_points().end() && !c->has_margin_points(); ++pi) {
                 typename Point<T>::ptr p = *pi;
                 if (!p->isOriginalPoint) continue;
-                typename Point<T>::list neighbors;
-                neighbors = index.find_neighbours(p->gridpoint, 1);
-                typename Point<T>::list::iterator ni;
-                for (ni = neighbors.begin(); ni != neighbors.end(); ++ni) {
-                    typename Point<T>::ptr n = *ni;
-                    if (fs->off_limits()->get(n->gridpoint)) {
+                size_t num_neighbors = index.find_neighbour_ids(p->gridpoint, &neighbors[0], 1);
+                for (size_t ni = 0; ni < num_neighbors; ++ni) {
+                    typename Point<T>::ptr n = index.point(neighbors[ni]);
+                    if (fs->off_limits_grid().get(n->gridpoint)) {
                         c->set_has_margin_points(true);
                         break;
                     }
@@ -95,6 +95,15 @@ namespace m3D {
         // weight function, please give it a unique name and add
         // the code to create it to the class WeightFunctionFactory
         std::string weight_function_name;
+
+        // Expression for the weight function 'expression'. See
+        // WeightExpression for the syntax.
+        std::string weight_function_expression;
+        
+        // Index used for the mean-shift range searches. The following
+        // names are allowed: 'grid' (stencil search on the rectilinear
+        // grid), 'flann', 'kdtree' or 'linear'.
+        std::string index_name;
         
         // Lower threshold for weight function filtering. Values at 
         // coordinates in Featurespace where the weight function is lower
@@ -152,6 +161,23 @@ namespace m3D {
         // flag will be enforced
         bool inline_tracking;
 
+        // Flag indicating if the process was started with --reference-source.
+        // The cluster file refers to the source file instead of carrying
+        // copies of its variables.
+        bool reference_source;
+
+        // Flag indicating if the process was started with --series. The
+        // input files are processed one after the other in the same
+        // process, keeping coordinate system, kernel and the previous
+        // results in memory.
+        bool series;
+
+        // Input files of a series, ordered by timestamp.
+        vector<std::string> series_filenames;
+
+        // Directory the cluster files of a series are written to.
+        std::string series_output_directory;
+
         // ---------------------------------------------------------------
         // Replacement filtering.
         // ---------------------------------------------------------------
@@ -300,6 +326,10 @@ namespace m3D {
         
         // In case previous clusters are loaded, this contains those
         typename ClusterList<T>::ptr previous_clusters;
+
+        // When processing a series, the previous clusters point into
+        // the feature-space of the previous step, which is kept here.
+        FeatureSpace<T> *previous_fs;
     };
     
      /** This class contains the tracking code.
@@ -351,6 +381,23 @@ namespace m3D {
             cleanup(detection_params_t<T> &params,
                     detection_context_t<T> &context);
     
+            /**
+             * Prepares an existing context for processing the next file
+             * of a series (params.filename). The results of the last run
+             * become the previous results. The coordinate system, kernel
+             * and search parameters are kept. So are the weight function
+             * and the index, which the next run re-calculates in place
+             * where possible. Everything else depending on the data is
+             * discarded.
+             * 
+             * @param parameters
+             * @param (initialised) context after a run
+             */
+            static
+            void
+            advance(const detection_params_t<T> &params,
+                    detection_context_t<T> &ctx);
+
             /**
              * Perform a detection run with the given parameters.
              * @param parameters 
@@ -11,6 +11,7 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/filters/replacement_filter.h>
+#include <meanie3D/weights/weight_expression.h>
 
 #include <boost/tokenizer.hpp>
 #include <boost/program_options.hpp>
@@ -19,6 +20,8 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/exception/info.hpp>
 
+#include <algorithm>
+#include <fstream>
 #include <map>
 #include <netcdf>
 #include <string>
@@ -80,19 +83,40 @@ namespace m3D {
         ("kernel-name,k", 
             program_options::value<string>()->default_value(params.kernel_name),
             "uniform,gauss,epanechnikov or none")
+        ("index", 
+            program_options::value<string>()->default_value(params.index_name),
+            "Index used for mean-shift range searches: grid, flann, kdtree or linear. "
+            "grid requires a (approximately) uniform rectilinear grid.")
         ("weight-function-name,w", 
             program_options::value<string>()->default_value(params.weight_function_name),
-            "default,inverse,pow10 or oase")
+            "default,inverse,pow10,oase or expression")
+        ("weight-function-expression",
+            program_options::value<string>(),
+            "Expression for the weight function 'expression' over the variables, "
+            "e.g. \"scaled(zh) + 10 * (nbmax(linet_oase_tl) > 0)\". Operators: "
+            "+ - * / ^ ! && || == != < <= > >=. Functions: abs, sqrt, exp, log, log10, "
+            "pow, min, max, if(c,a,b), min(var), max(var), scaled(var) and the "
+            "neighbourhood aggregates nbmean(var), nbmin(var), nbmax(var). "
+            "Implies --weight-function-name expression.")
         ("wwf-lower-threshold", 
             program_options::value<T>()->default_value(params.wwf_lower_threshold),
             "Lower threshold for weight function filter.")
         ("wwf-upper-threshold",
             program_options::value<T>()->default_value(params.wwf_upper_threshold),
             "Upper threshold for weight function filter.")
+        ("series",
+            "If present, --file is a directory of NetCDF files or a text file "
+            "listing one file per line. The files are processed in order of "
+            "their timestamps within one process, each result being tracked "
+            "against the previous one. --output must be a directory then.")
         ("inline-tracking", 
             "If present, tracking step is performed immediately after "
             "clustering. Required --previous-output and other "
             "clustering parameters to be set (check meanie3D-track)")
+        ("reference-source",
+            "If present, the cluster file refers to the source file (path "
+            "and modification time) instead of copying the dimension and "
+            "feature variables into it.")
         ("replacement-filter", 
             program_options::value<string>(),
             "Comma-separated list varname-<lowest|highest|median>-[percentage],"
@@ -166,6 +190,75 @@ namespace m3D {
         ;
     }
 
+    /**
+     * Collects the files of a series. The source is either a directory
+     * (all .nc files in it are used) or a text file listing one file
+     * per line. The result is sorted by timestamp.
+     * 
+     * @param directory or list file
+     * @param time index for obtaining the timestamps
+     * @param files (filled)
+     */
+    inline
+    void get_series_files(const std::string &source,
+            int time_index,
+            vector<std::string> &files)
+    {
+        namespace fs = boost::filesystem;
+        
+        fs::path source_path(source);
+        vector<std::string> candidates;
+        if (fs::is_directory(source_path)) {
+            fs::directory_iterator dir_iter(source_path);
+            fs::directory_iterator end;
+            for (; dir_iter != end; ++dir_iter) {
+                fs::path f = dir_iter->path();
+                if (fs::is_regular_file(f) && f.extension() == ".nc") {
+                    candidates.push_back(f.generic_string());
+                }
+            }
+        } else if (fs::is_regular_file(source_path)) {
+            std::ifstream list(source.c_str());
+            std::string line;
+            while (std::getline(list, line)) {
+                boost::algorithm::trim(line);
+                if (!line.empty()) {
+                    candidates.push_back(line);
+                }
+            }
+        } else {
+            cerr << "FATAL:illegal value for parameter --file: with --series "
+                 << "this must be a directory or a list file" << endl;
+            exit(EXIT_FAILURE);
+        }
+        
+        vector< pair<timestamp_t, std::string> > timed;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            timestamp_t t = netcdf::get_time_checked<timestamp_t>(candidates[i], time_index);
+            timed.push_back(make_pair(t, candidates[i]));
+        }
+        std::sort(timed.begin(), timed.end());
+        
+        files.clear();
+        for (size_t i = 0; i < timed.size(); i++) {
+            files.push_back(timed[i].second);
+        }
+    }
+
+    /**
+     * @param series output directory
+     * @param input file
+     * @return path of the cluster file for the given input file
+     */
+    inline
+    std::string series_output_filename(const std::string &directory,
+            const std::string &filename)
+    {
+        boost::filesystem::path path(directory);
+        path /= boost::filesystem::path(filename).stem().string() + "-clusters.nc";
+        return path.generic_string();
+    }
+
     template <typename T>
     void get_detection_parameters(program_options::variables_map vm,
             detection_params_t<T> &params) {
@@ -181,6 +274,29 @@ namespace m3D {
             exit(EXIT_FAILURE);
         }
 
+        // Series? Replace the input with the first file
+        // of the series and the output with its result file.
+        params.series = vm.count("series") > 0;
+        if (params.series) {
+            get_series_files(params.filename, 
+                    vm["time-index"].as<int>(), 
+                    params.series_filenames);
+            if (params.series_filenames.empty()) {
+                cerr << "FATAL:no files found in " << params.filename << endl;
+                exit(EXIT_FAILURE);
+            }
+            boost::filesystem::path output_path(params.output_filename);
+            if (!boost::filesystem::is_directory(output_path)) {
+                cerr << "FATAL:illegal value for parameter --output: with "
+                     << "--series this must be an existing directory" << endl;
+                exit(EXIT_FAILURE);
+            }
+            params.series_output_directory = params.output_filename;
+            params.filename = params.series_filenames[0];
+            params.output_filename = series_output_filename(
+                    params.series_output_directory, params.filename);
+        }
+
         // Open NetCDF file
         NcFile *file = NULL;
         try {
@@ -450,17 +566,42 @@ namespace m3D {
             exit(EXIT_FAILURE);
         }
 
+        // Index
+        params.index_name = vm["index"].as<string>();
+
+        if (!(params.index_name == "grid"
+                || params.index_name == "flann"
+                || params.index_name == "kdtree"
+                || params.index_name == "linear")) {
+            cerr << "Illegal index name " << params.index_name <<
+                    ". Only 'grid','flann','kdtree' or 'linear' are accepted." << endl;
+            exit(EXIT_FAILURE);
+        }
+
         // Weight Function
         params.weight_function_name = vm["weight-function-name"].as<string>();
+        if (vm.count("weight-function-expression") > 0) {
+            params.weight_function_expression = vm["weight-function-expression"].as<string>();
+            params.weight_function_name = "expression";
+        }
         if (!(params.weight_function_name == "default"
                 || params.weight_function_name == "inverse"
                 || params.weight_function_name == "pow10"
                 || params.weight_function_name == "oase"
-                || params.weight_function_name == "oase-ci")) {
+                || params.weight_function_name == "oase-ci"
+                || params.weight_function_name == "expression")) {
             cerr << "Illegal weight function name " << params.weight_function_name <<
-                    ". Only 'default','inverse','pow10' or 'oase' are known." << endl;
+                    ". Only 'default','inverse','pow10','oase' or 'expression' are known." << endl;
             exit(EXIT_FAILURE);
         }
+        if (params.weight_function_name == "expression") {
+            try {
+                WeightExpression<T> expression(params.weight_function_expression, params.variables);
+            } catch (std::invalid_argument &e) {
+                cerr << "FATAL:" << e.what() << endl;
+                exit(EXIT_FAILURE);
+            }
+        }
         params.wwf_lower_threshold = vm["wwf-lower-threshold"].as<T>();
         params.wwf_upper_threshold = vm["wwf-upper-threshold"].as<T>();
 
@@ -545,6 +686,9 @@ namespace m3D {
         
         // Inline tracking?
         params.inline_tracking = vm.count("inline-tracking") > 0;
+
+        // Refer to source instead of copying variables?
+        params.reference_source = vm.count("reference-source") > 0;
         
         if (params.inline_tracking && params.previous_clusters_filename == NULL) {
             cerr << "FATAL:when --inline-tracking is set you must give "
@@ -590,7 +734,12 @@ namespace m3D {
             const detection_context_t<T> &ctx,
             const program_options::variables_map &vm) 
     {
-        cout << "\tinput file = " << params.filename << endl;
+        if (params.series) {
+            cout << "\tseries of " << params.series_filenames.size() 
+                 << " files, starting with " << params.filename << endl;
+        } else {
+            cout << "\tinput file = " << params.filename << endl;
+        }
         if (params.time_index >= 0) {
             cout << "\tusing point in time at index " << params.time_index
                     << " (timestamp=" << ctx.timestamp << ")" << endl;
@@ -624,7 +773,11 @@ namespace m3D {
         }
 
         cout << "\tkernel:" << params.kernel_name << endl;
+        cout << "\tindex:" << params.index_name << endl;
         cout << "\tweight-function:" << params.weight_function_name << endl;
+        if (params.weight_function_name == "expression") {
+            cout << "\t\texpression: " << params.weight_function_expression << endl;
+        }
         cout << "\t\tlower weight-function threshold: "
                 << params.wwf_lower_threshold << endl;
         cout << "\t\tupper weight-function threshold: "
@@ -681,7 +834,12 @@ namespace m3D {
                 << (params.coalesceWithStrongestNeighbour ? "yes" : "no") <<
                 endl;
 
-        cout << "\toutput written to file: " << params.output_filename << endl;
+        if (params.series) {
+            cout << "\toutput written to directory: " 
+                 << params.series_output_directory << endl;
+        } else {
+            cout << "\toutput written to file: " << params.output_filename << endl;
+        }
 
     #if WITH_VTK
         if (!params.vtk_variables.empty()) {
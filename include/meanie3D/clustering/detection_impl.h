@@ -37,6 +37,7 @@
 #include <boost/cast.hpp>
 
 #include <meanie3D/utils/verbosity.h>
+#include <meanie3D/utils/profiler.h>
 #include <meanie3D/filters/convection_filter.h>
 #include <meanie3D/filters/replacement_filter.h>
 #include <meanie3D/filters/scalespace_filter.h>
@@ -74,9 +75,11 @@ namespace m3D {
         p.time_index = -1;
         p.min_cluster_size = 1u;
         p.weight_function_name = "default";
+        p.weight_function_expression = "";
         p.wwf_lower_threshold = 0;
         p.wwf_upper_threshold = std::numeric_limits<T>::max();
         p.kernel_name = "uniform";
+        p.index_name = "grid";
         p.previous_clusters_filename = NULL;
         p.postprocess_with_previous_output = false;
         p.ci_comparison_file = NULL;
@@ -93,6 +96,8 @@ namespace m3D {
         p.scale = Detection<T>::NO_SCALE;
         p.verbosity = VerbosityNormal;
         p.inline_tracking = false;
+        p.reference_source = false;
+        p.series = false;
         return p;
     }
 
@@ -103,6 +108,7 @@ namespace m3D {
         ctx.file = NULL;
         ctx.clusters = NULL;
         ctx.previous_clusters = NULL;
+        ctx.previous_fs = NULL;
         ctx.search_params = NULL;
         ctx.kernel = NULL;
         ctx.kernel_width = 0.0;
@@ -135,11 +141,25 @@ namespace m3D {
             exit(EXIT_FAILURE);
         }
         
-        ctx.data_store = new NetCDFDataStore<T>(params.filename,
-                params.variables,
-                params.dimensions,
-                params.dimension_variables,
-                params.time_index);
+        if (params.series) {
+            // The coordinate system is shared by all files of the 
+            // series and owned by the context
+            ctx.coord_system = new CoordinateSystem<T>(ctx.file,
+                    params.dimensions,
+                    params.dimension_variables);
+            ctx.data_store = new NetCDFDataStore<T>(params.filename,
+                    ctx.coord_system,
+                    params.variables,
+                    params.dimensions,
+                    params.dimension_variables,
+                    params.time_index);
+        } else {
+            ctx.data_store = new NetCDFDataStore<T>(params.filename,
+                    params.variables,
+                    params.dimensions,
+                    params.dimension_variables,
+                    params.time_index);
+        }
                 
         ctx.show_progress = (params.verbosity > VerbositySilent);
 
@@ -181,7 +201,9 @@ namespace m3D {
 
         // Construct a coordinate system object from the dimensions
         // and dimension variables given
-        ctx.coord_system = ctx.data_store->coordinate_system();
+        if (!params.series) {
+            ctx.coord_system = ctx.data_store->coordinate_system();
+        }
         
         ctx.wwf_apply = (params.wwf_lower_threshold != 0 
             || params.wwf_upper_threshold != std::numeric_limits<T>::max());
@@ -196,12 +218,14 @@ namespace m3D {
         }
         
         if (params.inline_tracking || params.postprocess_with_previous_output) {
-            if (params.previous_clusters_filename == NULL) {
+            if (params.previous_clusters_filename != NULL) {
+                ctx.previous_clusters = ClusterList<T>::read(*params.previous_clusters_filename);
+            } else if (!params.series) {
+                // in a series, the first file may go without
                 cerr << "inline tracking or postprocessing with previous output"
                      << " wanted but previous output is missing" << endl;
                 exit(EXIT_FAILURE);
             }
-            ctx.previous_clusters = ClusterList<T>::read(*params.previous_clusters_filename);
         }
 
         ctx.initialised = true;
@@ -217,9 +241,17 @@ namespace m3D {
         // context
         ctx.clusters->clear();
         ctx.fs->clear();
+        if (ctx.previous_fs != NULL) {
+            ctx.previous_clusters->clear();
+            ctx.previous_fs->clear();
+        }
         delete_and_clear(ctx.search_params)
         delete_and_clear(ctx.data_store);
+        if (params.series) {
+            delete_and_clear(ctx.coord_system);
+        }
         delete_and_clear(ctx.fs);
+        delete_and_clear(ctx.previous_fs);
         delete_and_clear(ctx.weight_function);
         delete_and_clear(ctx.sf);
         delete_and_clear(ctx.kernel);
@@ -234,6 +266,55 @@ namespace m3D {
         delete_and_clear(params.ci_comparison_protocluster_file);
     }
     
+    template <typename T>
+    void
+    Detection<T>::advance(const detection_params_t<T> &params,
+                          detection_context_t<T> &ctx)
+    {
+        // Discard the previous results. If they were read from
+        // a file, the clusters own their points, otherwise the
+        // points belong to the previous feature-space
+        if (ctx.previous_clusters != NULL) {
+            ctx.previous_clusters->clear(ctx.previous_fs == NULL);
+        }
+        delete_and_clear(ctx.previous_clusters);
+        if (ctx.previous_fs != NULL) {
+            ctx.previous_fs->clear();
+        }
+        delete_and_clear(ctx.previous_fs);
+
+        // Current results become previous results
+        ctx.previous_clusters = ctx.clusters;
+        ctx.previous_fs = ctx.fs;
+        ctx.clusters = NULL;
+        ctx.fs = NULL;
+
+        // Discard everything depending on the data. The weight 
+        // function and the index are kept: run() re-calculates them 
+        // for the next feature-space, re-using their arrays.
+        delete_and_clear(ctx.sf);
+        delete_and_clear(ctx.data_store);
+        delete_and_clear(ctx.file);
+
+        // Open the next file, re-using the coordinate system
+        try {
+            ctx.file = new NcFile(params.filename, NcFile::read);
+        } catch (const netCDF::exceptions::NcException &e) {
+            cerr << "ERROR: could not open file '" << params.filename 
+                 << "' for reading: " << e.what() << endl;
+            exit(EXIT_FAILURE);
+        }
+
+        ctx.data_store = new NetCDFDataStore<T>(params.filename,
+                ctx.coord_system,
+                params.variables,
+                params.dimensions,
+                params.dimension_variables,
+                params.time_index);
+
+        ctx.timestamp = netcdf::get_time_checked<timestamp_t>(params.filename, params.time_index);
+    }
+
     template <typename T>
     void
     Detection<T>::run(const detection_params_t<T> &params, 
@@ -245,8 +326,12 @@ namespace m3D {
 
         // used in writing out debug data
         boost::filesystem::path path(params.filename);
+
+        utils::Profiler &profiler = utils::Profiler::instance();
+        utils::ScopedTimer run_timer("detection");
         
         // Construct Featurespace from data
+        profiler.begin("featurespace");
         ctx.fs = new FeatureSpace<T>(
                 ctx.coord_system,
                 ctx.data_store,
@@ -254,10 +339,13 @@ namespace m3D {
                 params.upper_thresholds,
                 params.replacement_values,
                 ctx.show_progress);
+        profiler.count("points", ctx.fs->size());
+        profiler.end();
         
         // Run replacement filters
         if (!params.replacementFilterVariableIndex.empty()) 
         {
+            utils::ScopedTimer timer("replacement filter");
             size_t rfvi_length = params.replacementFilterVariableIndex.size(); 
             for (size_t i = 0; i < rfvi_length; i++) 
             {
@@ -288,6 +376,7 @@ namespace m3D {
 
         // Convection Filter?
         if (params.convection_filter_index >= 0) {
+            utils::ScopedTimer timer("convection filter");
             if (params.verbosity >= VerbosityNormal) {
                 start_timer("Applying convection filter");
             }
@@ -302,6 +391,7 @@ namespace m3D {
         // Scale-Space smoothing
         if (params.scale != NO_SCALE) {
             
+            utils::ScopedTimer timer("scale-space filter");
             vector<T> resolution = ctx.fs->coordinate_system->resolution();
             ctx.sf = new ScaleSpaceFilter<T>(params.scale, 
                     resolution, 
@@ -309,6 +399,7 @@ namespace m3D {
                     ctx.decay, 
                     ctx.show_progress);
             ctx.sf->apply(ctx.fs);
+            profiler.count("points", ctx.fs->size());
 
             #if WRITE_FEATURESPACE
             std::string fn = path.stem().string() + "_scale_" + boost::lexical_cast<string>(scale) + ".vtk";
@@ -320,13 +411,16 @@ namespace m3D {
         if (params.verbosity > VerbositySilent) {
             start_timer("Constructing weight function: " + params.weight_function_name);
         }
-        ctx.weight_function = WeightFunctionFactory<T>::create(params,ctx);
+        profiler.begin("weight function");
+        ctx.weight_function = WeightFunctionFactory<T>::create(params, ctx, ctx.weight_function);
+        profiler.end();
         if (params.verbosity > VerbositySilent) {
             stop_timer("done");
         }
 
         // Apply weight function filtering
         if (ctx.wwf_apply) {
+            utils::ScopedTimer timer("weight function filter");
             if (params.verbosity > VerbositySilent) {
                 start_timer("Applying weight function filter ...");
             }
@@ -379,12 +473,21 @@ namespace m3D {
         #endif
 
         // Create the quick lookup index to speed up mean-shift
-        // clustering. By default this is FLANN K/D-tree implementation.
-        ctx.index = PointIndex<T>::create(ctx.fs->get_points(), ctx.fs->rank());
+        // clustering. By default this is the stencil search on the
+        // rectilinear grid. In a series, the index of the previous
+        // step is pointed to the new feature-space.
+        if (ctx.index != NULL) {
+            ctx.index->reset(ctx.fs);
+        } else {
+            ctx.index = PointIndex<T>::create(ctx.fs, 
+                    PointIndex<T>::index_type_from_name(params.index_name));
+        }
         
         // Perform the actual clustering
+        profiler.begin("clustering");
         ClusterOperation<T> cop(params,ctx);
         ctx.clusters = cop.cluster();
+        profiler.end();
 
 #if WITH_VTK
         if (params.write_meanshift_vectors) {
@@ -415,7 +518,7 @@ namespace m3D {
         ctx.clusters->highest_uuid = uuid;
 
         // Collate with previous clusters, if provided
-        if (params.previous_clusters_filename != NULL 
+        if (ctx.previous_clusters != NULL 
                 && params.postprocess_with_previous_output) 
         {
             cout << endl << "Collating with previous results:" << endl;
@@ -489,9 +592,11 @@ namespace m3D {
 
         // Set the timestamp!!
         ctx.clusters->timestamp = ctx.timestamp;
+        ctx.clusters->source_by_reference = params.reference_source;
 
         if (!params.inline_tracking) {
             
+            utils::ScopedTimer timer("write");
             if (params.verbosity > VerbositySilent) {
                 std::string msg = "Writing clusters to NetCDF file " + params.output_filename + " ...";
                 start_timer(msg);
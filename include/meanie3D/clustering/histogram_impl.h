@@ -87,6 +87,8 @@ namespace m3D {
         float *h2 = o->bins_as_float_array();
         float d, zd, probd, probrs, rho;
         spear(h1, h2, this->size(), &d, &zd, &probd, &rho, &probrs);
+        free(h1);
+        free(h2);
         return isnan(rho) ? (T) - 1.0 : (T) rho;
     }
 
@@ -99,6 +101,8 @@ namespace m3D {
         float *h2 = o->bins_as_float_array();
         float z, prob, tau;
         kendl1(h1, h2, (int) this->size(), &tau, &z, &prob);
+        free(h1);
+        free(h2);
         return isnan(tau) ? (T) - 1.0 : (T) tau;
     }
 
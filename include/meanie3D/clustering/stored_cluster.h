@@ -0,0 +1,245 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_STORED_CLUSTER_H
+#define M3D_STORED_CLUSTER_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+#include <meanie3D/clustering/cluster.h>
+#include <meanie3D/featurespace/coordinate_system.h>
+#include <meanie3D/featurespace/point.h>
+#include <meanie3D/featurespace/point_factory.h>
+
+#include <vector>
+#include <netcdf>
+
+namespace m3D {
+
+    using namespace netCDF;
+
+    /** A cluster read from a cluster file, whose points stay in the
+     * file until they are first accessed through get_points(). All
+     * meta-data (id, uuid, mode, displacement, bounding box, margin
+     * flag and size) is available without touching the points.
+     *
+     * Clearing the cluster with deletion flag frees the points and
+     * re-arms the lazy reading. The cluster file and the coordinate
+     * system must stay alive as long as the cluster is used. Writing
+     * the list re-points the clusters at the new file. NetCDF
+     * is not thread safe, so points must not be materialised from
+     * several threads at the same time.
+     */
+    template<typename T>
+    class StoredCluster : public Cluster<T>
+    {
+    public:
+
+        typedef StoredCluster<T> *ptr;
+
+    private:
+
+        NcFile *m_file;
+        const CoordinateSystem<T> *m_coordinate_system;
+        size_t m_offset;
+        size_t m_size;
+        bool m_needs_reading;
+
+    public:
+
+#pragma mark -
+#pragma mark Constructor/Destructor
+
+        /** Constructor
+         * @param the cluster mode in feature-space
+         * @param number of spatial dimensions
+         * @param cluster file (compact layout)
+         * @param coordinate system of the cluster file
+         * @param offset of the cluster's first point in the point array
+         * @param number of points
+         */
+        StoredCluster(const vector<T> &mode,
+                size_t spatial_rank,
+                NcFile *file,
+                const CoordinateSystem<T> *cs,
+                size_t offset,
+                size_t size)
+        : Cluster<T>(mode, spatial_rank)
+        , m_file(file)
+        , m_coordinate_system(cs)
+        , m_offset(offset)
+        , m_size(size)
+        , m_needs_reading(true)
+        {
+        }
+
+        ~StoredCluster()
+        {
+            this->clear(true);
+        }
+
+#pragma mark -
+#pragma mark Overrides
+
+        typename Point<T>::list &get_points()
+        {
+            if (m_needs_reading) {
+                this->read_points();
+            }
+            return Cluster<T>::get_points();
+        }
+
+        size_t size() const
+        {
+            return m_needs_reading ? m_size : Cluster<T>::size();
+        }
+
+        bool empty() const
+        {
+            return this->size() == 0;
+        }
+
+        void clear(bool deletion_flag = false)
+        {
+            Cluster<T>::clear(deletion_flag);
+            m_needs_reading = deletion_flag;
+        }
+
+        /** @return <code>true</code> if the points are currently
+         * held in memory.
+         */
+        bool points_loaded() const
+        {
+            return !m_needs_reading;
+        }
+
+        /** Points the cluster at its slice of another file in the
+         * compact layout. Used when the list is written, because the
+         * file the cluster was read from is replaced.
+         * @param cluster file
+         * @param offset of the cluster's first point in the point array
+         * @param number of points
+         */
+        void relocate(NcFile *file, size_t offset, size_t size)
+        {
+            m_file = file;
+            m_offset = offset;
+            m_size = size;
+        }
+
+#pragma mark -
+#pragma mark Decoding
+
+        /** Creates points from the compact cluster file layout and
+         * adds them to the given cluster. The grid point is decoded
+         * from the linear index, the coordinate is looked up in the
+         * coordinate system.
+         *
+         * @param cluster
+         * @param linear grid indexes (count entries)
+         * @param values (count * value_rank entries, point by point)
+         * @param number of points
+         * @param number of values per point
+         * @param coordinate system
+         */
+        static
+        void
+        decode_points(Cluster<T> *cluster,
+                const long long *point_index,
+                const T *point_values,
+                size_t count,
+                size_t value_rank,
+                const CoordinateSystem<T> *cs)
+        {
+            size_t spatial_rank = cs->rank();
+            size_t rank = spatial_rank + value_rank;
+            const vector<size_t> dimension_sizes = cs->get_dimension_sizes();
+            long long grid_size = 1;
+            for (size_t di = 0; di < spatial_rank; di++) {
+                grid_size *= dimension_sizes[di];
+            }
+
+            typename CoordinateSystem<T>::GridPoint gp(spatial_rank, 0);
+            typename CoordinateSystem<T>::Coordinate coordinate(spatial_rank, 0.0);
+
+            for (size_t pi = 0; pi < count; pi++) {
+                long long li = point_index[pi];
+                if (li < 0 || li >= grid_size) {
+                    cerr << "ERROR:grid index " << li << " out of range in cluster "
+                         << cluster->id << endl;
+                    continue;
+                }
+
+                // linear index to gridpoint
+                for (size_t di = spatial_rank; di > 0; di--) {
+                    gp[di - 1] = (int) (li % dimension_sizes[di - 1]);
+                    li /= dimension_sizes[di - 1];
+                }
+                cs->lookup(gp, coordinate);
+
+                typename Point<T>::ptr p = PointFactory<T>::get_instance()->create();
+                p->values.resize(rank);
+                for (size_t di = 0; di < spatial_rank; di++) {
+                    p->values[di] = coordinate[di];
+                }
+                for (size_t vi = 0; vi < value_rank; vi++) {
+                    p->values[spatial_rank + vi] = point_values[pi * value_rank + vi];
+                }
+                p->coordinate = coordinate;
+                p->gridpoint = gp;
+                cluster->add_point(p);
+            }
+        }
+
+    private:
+
+        /** Reads the cluster's slice of the point arrays. */
+        void read_points()
+        {
+            m_needs_reading = false;
+            if (m_size == 0) {
+                return;
+            }
+
+            size_t value_rank = this->value_rank();
+
+            vector<size_t> start(1, m_offset);
+            vector<size_t> count(1, m_size);
+            vector<long long> point_index(m_size, 0);
+            m_file->getVar("point_index").getVar(start, count, &point_index[0]);
+
+            vector<T> point_values(m_size * value_rank, 0.0);
+            if (value_rank > 0) {
+                start.push_back(0);
+                count.push_back(value_rank);
+                m_file->getVar("point_values").getVar(start, count, &point_values[0]);
+            }
+
+            decode_points(this, &point_index[0],
+                    point_values.empty() ? NULL : &point_values[0],
+                    m_size, value_rank, m_coordinate_system);
+        }
+    };
+}
+
+#endif
@@ -50,6 +50,12 @@
 // 'off limits' in feature-space construction
 #define SCALE_SPACE_SKIPS_NON_ORIGINAL_POINTS 0
 
+// Number of contiguous array elements processed as
+// one tile in the scale-space filter passes along
+// strided axes. Should be chosen such, that a tile
+// times the filter window fits into L2 cache.
+#define SCALE_SPACE_TILE_SIZE 1024
+
 // Method for rounding vectors to grid resolution
 
 #define GRID_ROUNDING_METHOD_FLOOR 0
@@ -58,6 +64,17 @@
 #define GRID_ROUNDING_METHOD_RINT 0
 #define GRID_ROUNDING_METHOD_NONE 0
 
+// Number of linear indexes processed as one unit
+// in the parallel feature-space construction. The
+// resulting point order does not depend on this.
+#define FEATURESPACE_BUILD_CHUNK_SIZE 4096
+
+// Number of points evaluated as one block when
+// pre-computing weight functions. The values of
+// one variable are gathered into a contiguous
+// array of this size per block.
+#define WEIGHT_FUNCTION_BLOCK_SIZE 1024
+
 // ---------------------------------------------------- //
 // Debugging Flags(stdout)
 // ---------------------------------------------------- //
@@ -85,4 +102,10 @@
 // step into separate files.
 #define WRITE_ZEROSHIFT_CLUSTERS 0
 
+// Layout version of cluster files. Version 2 stores the points
+// of all clusters in one array with per-cluster offsets. Files
+// without the 'cluster_file_layout' attribute are version 1
+// (one variable per cluster).
+#define CLUSTER_FILE_LAYOUT 2
+
 #endif
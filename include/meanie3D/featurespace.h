@@ -31,6 +31,7 @@
 #include <meanie3D/featurespace/point.h>
 #include <meanie3D/featurespace/point_default_factory.h>
 #include <meanie3D/featurespace/point_factory.h>
+#include <meanie3D/featurespace/point_store.h>
 #include <meanie3D/featurespace/timestamp.h>
 
 #endif	
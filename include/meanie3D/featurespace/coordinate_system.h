@@ -150,7 +150,9 @@ namespace m3D {
          */
         void lookup(const GridPoint &gridpoint, Coordinate &coordinate) const;
 
-        /** Reverse Lookup.
+        /** Reverse Lookup. Only the first rank() components of the
+         * coordinate are used, so a full feature-space vector can be
+         * passed. Does not allocate if gridpoint has size rank().
          * @throws std::out_of_range
          */
         void reverse_lookup(const Coordinate &coordinate, GridPoint &gridpoint) const;
@@ -181,6 +183,17 @@ namespace m3D {
         vector<T>
         round_to_grid(const vector<T> &v) const;
 
+        /** Rounds the given coordinate to the closest grid coordinate
+         * and writes the result into the given vector. Does not allocate
+         * if result has the correct size already. v and result may be
+         * the same object.
+         *
+         * @param point
+         * @param rounded point (out)
+         */
+        void
+        round_to_grid(const vector<T> &v, vector<T> &result) const;
+
         /** Returns the grid index of the closest grid point
          * 
          * @param point
@@ -189,6 +202,16 @@ namespace m3D {
         vector<int>
         rounded_gridpoint(const vector<T> &v) const;
 
+        /** Writes the grid index of the closest grid point into the
+         * given vector. Does not allocate if result has the correct
+         * size (rank) already.
+         *
+         * @param point
+         * @param grid index (out)
+         */
+        void
+        rounded_gridpoint(const vector<T> &v, vector<int> &result) const;
+
         /** Uses resolution to convert the given vector
          * into number of grid index points. 
          * 
@@ -198,6 +221,16 @@ namespace m3D {
         vector<int>
         to_gridpoints(const vector<T> &v) const;
 
+        /** Uses resolution to convert the spatial components of the 
+         * given vector into number of grid index points. Does not 
+         * allocate if result has the correct size (rank) already.
+         * 
+         * @param vector in coordinate space
+         * @param vector in grid index space (out)
+         */
+        void
+        to_gridpoints(const vector<T> &v, vector<int> &result) const;
+
 #pragma mark -
 #pragma mark Factory methods
 
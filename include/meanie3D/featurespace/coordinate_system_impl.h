@@ -271,24 +271,33 @@ namespace m3D {
     template <typename T>
     void CoordinateSystem<T>::reverse_lookup(const Coordinate &coordinate, GridPoint &gridpoint) const
     {
-        vector<int> result = this->rounded_gridpoint(coordinate);
+        this->rounded_gridpoint(coordinate, gridpoint);
 
-        for (size_t index = 0; index < coordinate.size(); index++) {
-            if (result[index] < 0 || result[index] >= this->m_dimension_sizes[index]) {
+        for (size_t index = 0; index < this->rank(); index++) {
+            if (gridpoint[index] < 0 || gridpoint[index] >= this->m_dimension_sizes[index]) {
                 throw std::out_of_range("coordinate out of range");
             }
-
-            gridpoint[index] = result[index];
         }
     }
 
     template <typename T>
     vector<T>
     CoordinateSystem<T>::round_to_grid(const vector<T> &v) const
+    {
+        vector<T> result = v;
+        this->round_to_grid(v, result);
+        return result;
+    }
+
+    template <typename T>
+    void
+    CoordinateSystem<T>::round_to_grid(const vector<T> &v, vector<T> &result) const
     {
         assert(v.size() >= this->rank());
 
-        vector<T> result = v;
+        if (&result != &v) {
+            result.assign(v.begin(), v.end());
+        }
 
         // Normalize the vector's spatial components to align with the grid
 
@@ -308,17 +317,26 @@ namespace m3D {
 #endif
             result[ci] = multiplier * this->resolution()[ci];
         }
-
-        return result;
     }
 
     template <typename T>
     vector<int>
     CoordinateSystem<T>::rounded_gridpoint(const vector<T> &v) const
+    {
+        vector<int> result(this->rank(), 0);
+        this->rounded_gridpoint(v, result);
+        return result;
+    }
+
+    template <typename T>
+    void
+    CoordinateSystem<T>::rounded_gridpoint(const vector<T> &v, vector<int> &result) const
     {
         assert(v.size() >= this->rank());
 
-        vector<int> result(this->rank(), 0);
+        if (result.size() != this->rank()) {
+            result.resize(this->rank());
+        }
 
         for (size_t ci = 0; ci < this->rank(); ci++) {
             T corner = m_dimension_data[ci][0];
@@ -340,8 +358,6 @@ namespace m3D {
 #endif
             result[ci] = multiplier;
         }
-
-        return result;
     }
 
     template <typename T>
@@ -349,6 +365,18 @@ namespace m3D {
     CoordinateSystem<T>::to_gridpoints(const vector<T> &v) const
     {
         vector<int> result(v.size());
+        this->to_gridpoints(v, result);
+        return result;
+    }
+
+    template <typename T>
+    void
+    CoordinateSystem<T>::to_gridpoints(const vector<T> &v, vector<int> &result) const
+    {
+        if (result.size() < this->rank()) {
+            result.resize(this->rank());
+        }
+
         for (size_t ci = 0; ci < this->rank(); ci++) {
             T value = v.at(ci);
 
@@ -367,8 +395,6 @@ namespace m3D {
 #endif
             result[ci] = number_of_points;
         }
-
-        return result;
     }
 
     template <typename T>
@@ -29,8 +29,10 @@
 #include <meanie3D/namespaces.h>
 
 #include <meanie3D/array/multiarray.h>
+#include <meanie3D/array/multiarray_dense.h>
 #include <meanie3D/featurespace/coordinate_system.h>
 #include <meanie3D/featurespace/point.h>
+#include <meanie3D/featurespace/point_store.h>
 #include <meanie3D/featurespace/data_store.h>
 
 #include <boost/progress.hpp>
@@ -135,6 +137,7 @@ namespace m3D {
         // had '_fillValue' or values outside of valid_range.
         // Note: only applicaple for gridded data!
         MultiArray<bool> *m_off_limits;
+        DenseGridView<bool> m_off_limits_grid;
 
         // Factual limits
 
@@ -241,6 +244,17 @@ namespace m3D {
             return &(this->points);
         }
 
+        /** Copies the values and grid points of the current points
+         * into columns. Use this for tight loops over single components
+         * of all points. The store refers to this feature-space's point
+         * list, which must not change while the store is in use.
+         * @param store (re-built)
+         */
+        void gather(PointStore<T> &store) const
+        {
+            store.gather(this->points, this->spatial_rank());
+        }
+
         /** @return rank of featurespace, which is rank of the
          * spatial range plus rank of the value range.
          */
@@ -291,6 +305,13 @@ namespace m3D {
             return m_off_limits;
         }
 
+        /** Linear access to the same flags, for use in tight loops.
+         */
+        const DenseGridView<bool> &off_limits_grid() const
+        {
+            return m_off_limits_grid;
+        }
+
         /** Contains the inf of all points in the featurespace.
          */
         const map<size_t, T> &min() const
@@ -28,6 +28,7 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/parallel.h>
+#include <meanie3D/array/multiarray_dense.h>
 
 #include <algorithm>
 #include <limits>
@@ -90,6 +91,7 @@ namespace m3D {
     , m_lower_thresholds(other.m_lower_thresholds)
     , m_upper_thresholds(other.m_upper_thresholds)
     , m_off_limits(other.m_off_limits)
+    , m_off_limits_grid(other.m_off_limits_grid)
     {
         if (with_points) {
             // Copy points
@@ -113,6 +115,7 @@ namespace m3D {
     , m_lower_thresholds(other->m_lower_thresholds)
     , m_upper_thresholds(other->m_upper_thresholds)
     , m_off_limits(other->m_off_limits)
+    , m_off_limits_grid(other->m_off_limits_grid)
     {
         if (with_points) {
             typename Point<T>::list::const_iterator pi;
@@ -180,118 +183,187 @@ namespace m3D {
     template <typename T>
     void FeatureSpace<T>::build()
     {
-        m_off_limits = new MultiArrayBlitz<bool>(this->coordinate_system->get_dimension_sizes(), false);
+        m_off_limits = create_dense_multiarray<bool>(this->coordinate_system->get_dimension_sizes(), false);
+        m_off_limits_grid = DenseGridView<bool>(m_off_limits);
 
-        size_t size = this->m_data_store->size();
+        const size_t size = this->m_data_store->size();
+
+        const size_t value_rank = this->m_data_store->rank();
 
         LinearIndexMapping mapping(m_data_store->coordinate_system()->get_dimension_sizes());
 
+        // The construction is done in two passes over fixed size chunks 
+        // of the linear index range. In the first pass each chunk collects
+        // it's valid points and min/max values locally. After a prefix sum
+        // over the chunk sizes, the second pass moves the points to their
+        // final place. The order of points therefore is always the order
+        // of the linear index, regardless of the number of threads used.
+
+        const size_t chunk_size = FEATURESPACE_BUILD_CHUNK_SIZE;
+
+        const size_t num_chunks = (size + chunk_size - 1) / chunk_size;
+
+        vector< typename Point<T>::list > chunk_points(num_chunks);
+
+        vector< vector<T> > chunk_min(num_chunks);
+
+        vector< vector<T> > chunk_max(num_chunks);
+
+        // Copy initial min/max out of the maps for read access
+        // from multiple threads
+
+        vector<T> initial_min(value_rank), initial_max(value_rank);
+
+        for (size_t vi = 0; vi < value_rank; vi++) {
+            initial_min[vi] = m_min[vi];
+            initial_max[vi] = m_max[vi];
+        }
+
 #if WITH_OPENMP
-#pragma omp parallel for schedule(dynamic,10) 
-#endif
-        for (size_t linear_index = 0; linear_index < size; linear_index++) {
-            // Get the variables together and construct the cartesian coordinate
-            if (m_progress_bar != NULL) {
-#if WITH_OPENMP
-#pragma omp critical
+#pragma omp parallel for schedule(dynamic)
 #endif
-                m_progress_bar->operator++();
-            }
+        for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+            const size_t begin = chunk * chunk_size;
 
-            vector<int> gridpoint = mapping.linear_to_grid(linear_index);
+            const size_t end = (begin + chunk_size < size) ? (begin + chunk_size) : size;
 
-            typename CoordinateSystem<T>::Coordinate coordinate(gridpoint.size());
+            typename Point<T>::list &local_points = chunk_points[chunk];
 
-            coordinate_system->lookup(gridpoint, coordinate);
+            vector<T> &local_min = chunk_min[chunk];
 
-            // Iterate over the variables
+            vector<T> &local_max = chunk_max[chunk];
 
-            bool isPointValid = true;
+            local_min = initial_min;
 
-            // start the entry by copying the dimension variables
+            local_max = initial_max;
 
-            vector<T> values = coordinate;
+            for (size_t linear_index = begin; linear_index < end; linear_index++) {
+                // Get the variables together and construct the cartesian coordinate
 
-            // iterate over the variables
+                vector<int> gridpoint = mapping.linear_to_grid(linear_index);
 
-            for (size_t var_index = 0; var_index < this->m_data_store->rank() && isPointValid; var_index++) {
-                typename std::map<int, double>::const_iterator replacement;
-                replacement = this->m_replacement_values.find(var_index);
+                typename CoordinateSystem<T>::Coordinate coordinate(gridpoint.size());
 
-                // is this contribution valid?
+                coordinate_system->lookup(gridpoint, coordinate);
 
-                T value = data_store()->get(var_index, gridpoint, isPointValid);
+                // Iterate over the variables
 
-                if (!isPointValid) {
-                    // Reading routine marked this point 'off limits'
-#if WITH_OPENMP
-#pragma omp critical
-#endif
-                    this->m_off_limits->set(gridpoint, true);
-                }
-                if (isPointValid) {
-                    values.push_back(value);
-
-                    // apply upper/lower thresholding to the value, if asked
-
-                    map<int, double>::const_iterator fi;
-                    fi = m_lower_thresholds.find(var_index);
-                    if (fi != m_lower_thresholds.end()) {
-                        if (value < fi->second) {
-                            if (replacement != this->m_replacement_values.end()) {
-                                value = replacement->second;
-                            } else {
-                                isPointValid = false;
+                bool isPointValid = true;
+
+                // start the entry by copying the dimension variables
+
+                vector<T> values = coordinate;
+
+                // iterate over the variables
+
+                for (size_t var_index = 0; var_index < value_rank && isPointValid; var_index++) {
+                    typename std::map<int, double>::const_iterator replacement;
+                    replacement = this->m_replacement_values.find(var_index);
+
+                    // is this contribution valid?
+
+                    T value = data_store()->get(var_index, linear_index, isPointValid);
+
+                    if (!isPointValid) {
+                        // Reading routine marked this point 'off limits'.
+                        // Each grid point is only visited once, so no
+                        // synchronisation is required here.
+                        this->m_off_limits_grid.set(linear_index, true);
+                    }
+                    if (isPointValid) {
+                        values.push_back(value);
+
+                        // apply upper/lower thresholding to the value, if asked
+
+                        map<int, double>::const_iterator fi;
+                        fi = m_lower_thresholds.find(var_index);
+                        if (fi != m_lower_thresholds.end()) {
+                            if (value < fi->second) {
+                                if (replacement != this->m_replacement_values.end()) {
+                                    value = replacement->second;
+                                } else {
+                                    isPointValid = false;
+                                }
                             }
                         }
-                    }
 
-                    fi = m_upper_thresholds.find(var_index);
-                    if (fi != m_upper_thresholds.end()) {
-                        if (value > fi->second) {
-                            if (replacement != this->m_replacement_values.end()) {
-                                value = replacement->second;
-                            } else {
-                                isPointValid = false;
+                        fi = m_upper_thresholds.find(var_index);
+                        if (fi != m_upper_thresholds.end()) {
+                            if (value > fi->second) {
+                                if (replacement != this->m_replacement_values.end()) {
+                                    value = replacement->second;
+                                } else {
+                                    isPointValid = false;
+                                }
                             }
                         }
+                    } else if (replacement != this->m_replacement_values.end()) {
+                        // check for replacement value and use after all
+                        value = replacement->second;
+                        values.push_back(value);
+                        isPointValid = true;
                     }
-                } else if (replacement != this->m_replacement_values.end()) {
-                    // check for replacement value and use after all
-                    value = replacement->second;
-                    isPointValid = true;
                 }
-            }
 
-            // if the point is still valid (all variables measured up to criteria)
-            // add it to the feature-space
+                // if the point is still valid (all variables measured up to criteria)
+                // add it to the chunk
 
-            if (isPointValid) {
-                typename Point<T>::ptr p = NULL;
-
-#if WITH_OPENMP
-#pragma omp critical
-#endif
-                {
-                    p = PointFactory<T>::get_instance()->create(gridpoint, coordinate, values);
+                if (isPointValid) {
+                    typename Point<T>::ptr p = PointFactory<T>::get_instance()->create(gridpoint, coordinate, values);
                     p->isOriginalPoint = true;
-                    this->points.push_back(p);
+                    local_points.push_back(p);
+
+                    for (size_t vi = 0; vi < value_rank; vi++) {
+                        T v = p->values[coordinate.size() + vi];
+                        if (v < local_min[vi]) {
+                            local_min[vi] = v;
+                        }
+                        if (v > local_max[vi]) {
+                            local_max[vi] = v;
+                        }
+                    }
                 }
+            }
 
-                for (size_t vi = 0; vi < data_store()->rank(); vi++) {
-                    if (p->values[coordinate.size() + vi] < m_min[vi]) {
+            if (m_progress_bar != NULL) {
 #if WITH_OPENMP
 #pragma omp critical
 #endif
-                        m_min[vi] = p->values[coordinate.size() + vi];
-                    }
+                m_progress_bar->operator+=(end - begin);
+            }
+        }
+
+        // Prefix sum over the chunk sizes gives each chunk's
+        // offset in the final points array
+
+        vector<size_t> offsets(num_chunks + 1, 0);
+
+        for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+            offsets[chunk + 1] = offsets[chunk] + chunk_points[chunk].size();
+        }
+
+        const size_t existing = this->points.size();
+
+        this->points.resize(existing + offsets[num_chunks], NULL);
 
-                    if (p->values[coordinate.size() + vi] > m_max[vi]) {
 #if WITH_OPENMP
-#pragma omp critical
+#pragma omp parallel for schedule(static)
 #endif
-                        m_max[vi] = p->values[coordinate.size() + vi];
-                    }
+        for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+            std::copy(chunk_points[chunk].begin(),
+                    chunk_points[chunk].end(),
+                    this->points.begin() + existing + offsets[chunk]);
+        }
+
+        // Reduce min/max in chunk order
+
+        for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+            for (size_t vi = 0; vi < value_rank; vi++) {
+                if (chunk_min[chunk][vi] < m_min[vi]) {
+                    m_min[vi] = chunk_min[chunk][vi];
+                }
+                if (chunk_max[chunk][vi] > m_max[vi]) {
+                    m_max[vi] = chunk_max[chunk][vi];
                 }
             }
         }
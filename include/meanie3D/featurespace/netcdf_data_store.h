@@ -31,6 +31,7 @@
 #include <meanie3D/parallel.h>
 
 #include <meanie3D/array/multiarray_blitz.h>
+#include <meanie3D/array/multiarray_linear.h>
 #include <meanie3D/featurespace/data_store.h>
 
 #include <boost/filesystem.hpp>
@@ -82,6 +83,11 @@ namespace m3D {
          */
         CoordinateSystem<T> *m_coordinate_system;
 
+        /** false if the coordinate system was handed in
+         * and is owned by somebody else.
+         */
+        bool m_owns_coordinate_system;
+
         /** Index of the time(time) variable to use. If -1, it is assumed
          * that there is no time variable and it is omitted.
          */
@@ -103,6 +109,13 @@ namespace m3D {
 
         multiarray_map_t m_buffered_data;
 
+        /** Direct pointers to the data of those variables which are
+         * held in a MultiArrayLinear (NULL otherwise), indexed by 
+         * variable index. Allows for access by linear index without
+         * map lookup or virtual call.
+         */
+        vector<MultiArrayLinear<T> *> m_linear_data;
+
     public:
 
 #pragma mark -
@@ -124,20 +137,83 @@ namespace m3D {
                 const int time_index = -1)
         : DataStore<T>(variables, dimensions, dimension_variables)
         , m_filename(filename)
+        , m_coordinate_system(NULL)
+        , m_owns_coordinate_system(true)
+        , m_time_index(time_index)
+        , m_linear_data(variables.size(), (MultiArrayLinear<T> *) NULL)
+        {
+            this->open_file();
+            m_coordinate_system = new CoordinateSystem<T>(m_file,
+                    dimensions,dimension_variables);
+            this->initialise();
+        }
+
+        /**
+         * Constructs a DataStore instance based on NetCDF files, using
+         * an existing coordinate system. The coordinate system is not 
+         * owned by the data store and is not deleted with it. This is
+         * used when processing a series of files on the same grid. The
+         * variables in the file must match the coordinate system's 
+         * dimensions.
+         * 
+         * @param filename
+         * @param coordinate system
+         * @param variables
+         * @param dimensions
+         * @param dimension_variables
+         * @param time_index
+         */
+        NetCDFDataStore(const std::string filename,
+                CoordinateSystem<T> *coordinate_system,
+                const std::vector<std::string> &variables,
+                const std::vector<std::string> &dimensions,
+                const std::vector<std::string> &dimension_variables,
+                const int time_index = -1)
+        : DataStore<T>(variables, dimensions, dimension_variables)
+        , m_filename(filename)
+        , m_coordinate_system(coordinate_system)
+        , m_owns_coordinate_system(false)
         , m_time_index(time_index)
+        , m_linear_data(variables.size(), (MultiArrayLinear<T> *) NULL)
         {
+            this->open_file();
+            this->initialise();
+        }
+
+        /** Destructor
+         */
+        ~NetCDFDataStore() {
+            this->discard_buffer();
+            delete[] m_offset;
+            delete[] m_scale_factor;
+            delete[] m_fill_value;
+            delete[] m_valid_min;
+            delete[] m_valid_max;
+            delete[] m_min;
+            delete[] m_max;
+            if (m_owns_coordinate_system) {
+                delete m_coordinate_system;
+            }
+        }
+
+    private:
+
+        void
+        open_file() {
             m_file = NULL;
             try {
-                m_file = new NcFile(filename.c_str(), NcFile::read);
+                m_file = new NcFile(m_filename.c_str(), NcFile::read);
             } catch (const netCDF::exceptions::NcException &e) {
                 cerr << "FATAL:could not open file '" << m_filename 
                      << "' for reading" << endl;
                 exit(EXIT_FAILURE);
             }
-            
-            m_coordinate_system = new CoordinateSystem<T>(m_file,
-                    dimensions,dimension_variables);
-            
+        }
+
+        void
+        initialise() {
+            const std::vector<std::string> &variables = this->m_variables;
+
             m_scale_factor = new T[variables.size()];
             m_offset = new T[variables.size()];
             m_valid_min = new T[variables.size()];
@@ -176,19 +252,7 @@ namespace m3D {
             this->read();
         }
 
-        /** Destructor
-         */
-        ~NetCDFDataStore() {
-            this->discard_buffer();
-            delete[] m_offset;
-            delete[] m_scale_factor;
-            delete[] m_fill_value;
-            delete[] m_valid_min;
-            delete[] m_valid_max;
-            delete[] m_min;
-            delete[] m_max;
-            delete m_coordinate_system;
-        }
+    public:
 
 #pragma mark -
 #pragma mark Accessors
@@ -243,346 +307,125 @@ namespace m3D {
 
     private:
 
+        /** Calculates start and count vectors for reading or writing
+         * the given variable at the data store's time index.
+         * @param variable
+         * @param start (filled)
+         * @param count (filled)
+         * @param spatial dimension sizes (filled)
+         */
         void
-        read_buffer(size_t variable_index) {
+        hyperslab(const NcVar &variable,
+                  vector<size_t> &start,
+                  vector<size_t> &count,
+                  vector<size_t> &dims) const {
             bool time_is_an_issue = this->m_time_index >= 0;
 
-            NcFile file(this->m_filename, NcFile::read);
-            NcVar variable = file.getVar(this->m_variables[variable_index]);
-
             // If we have to take time into the picture,
             // the number of dimensions for the data is
             // one more
 
-            int spatial_dims = time_is_an_issue
-                               ? variable.getDimCount() - 1
-                               : variable.getDimCount();
-
-            vector<size_t> dims(spatial_dims);
-            for (size_t i = 0; i < spatial_dims; i++) {
-                dims[i] = coordinate_system()->get_dimension_sizes()[i];
-            }
-
-            MultiArray<T> *index = new MultiArrayBlitz<T>(dims, 0);
-
-            vector<int> gp(spatial_dims);
-
-            if (spatial_dims == 1) {
-                // 1D
-                int N = time_is_an_issue
-                        ? variable.getDim(1).getSize()
-                        : variable.getDim(0).getSize();
-
-                T *values = (T *) calloc(N, sizeof(T));
-
-                // where to start reading?
-                vector<size_t> start(variable.getDimCount(), 0);
-                if (time_is_an_issue) start[0] = this->m_time_index;
-
-                // how much to read?
-                vector<size_t> count(variable.getDimCount(), 0);
-                if (time_is_an_issue) {
-                    count[0] = 1;
-                    count[1] = N;
-                } else {
-                    count[0] = N;
-                }
-
-                // read the chunk
-                variable.getVar(start, count, values);
-                for (int i = 0; i < N; i++) {
-                    gp[0] = i;
-                    index->set(gp, values[i]);
-                }
-
-                // Clean up
-                delete values;
-
-            } else if (spatial_dims == 2) {
-                // 2D
-                int N, M;
-                if (time_is_an_issue) {
-                    N = variable.getDim(1).getSize();
-                    M = variable.getDim(2).getSize();
-                } else {
-                    N = variable.getDim(0).getSize();
-                    M = variable.getDim(1).getSize();
-                }
-
-                // Create buffer to hold data
-                T *values = (T *) calloc(N * M, sizeof(T));
-                if (values == NULL) {
-                    cerr << "FATAL:out of memory" << endl;
-                    exit(EXIT_FAILURE);
-                }
-
-                // where to start reading?
-                vector<size_t> start(variable.getDimCount(), 0);
-                if (time_is_an_issue) start[0] = this->m_time_index;
-
-                // how much to read?
-                vector<size_t> count(variable.getDimCount(), 0);
-                if (time_is_an_issue) {
-                    count[0] = 1;
-                    count[1] = N;
-                    count[2] = M;
-                } else {
-                    count[0] = N;
-                    count[1] = M;
-                }
-
-                // read the chunk
-                variable.getVar(start, count, values);
+            size_t dim_count = variable.getDimCount();
+            size_t first_spatial_dim = time_is_an_issue ? 1 : 0;
 
-                // re-package
-                for (int i = 0; i < N; i++) {
-                    for (int j = 0; j < M; j++) {
-                        gp[0] = i;
-                        gp[1] = j;
-                        index->set(gp, values[i * M + j]);
-                    }
-                }
+            start.assign(dim_count, 0);
+            count.assign(dim_count, 1);
+            dims.clear();
 
-                // Clean up
-                delete[] values;
+            if (time_is_an_issue) {
+                start[0] = this->m_time_index;
+            }
 
-            } else if (spatial_dims == 3) {
-                // 3D
-                int N, M, K;
-                if (time_is_an_issue) {
-                    N = variable.getDim(1).getSize();
-                    M = variable.getDim(2).getSize();
-                    K = variable.getDim(3).getSize();
-                } else {
-                    N = variable.getDim(0).getSize();
-                    M = variable.getDim(1).getSize();
-                    K = variable.getDim(2).getSize();
-                }
+            for (size_t i = first_spatial_dim; i < dim_count; i++) {
+                count[i] = variable.getDim(i).getSize();
+                dims.push_back(count[i]);
+            }
+        }
 
-                // Read this as a succession of 2D slices
-                // Allocate buffer for 2D slices
-                T *values = (T *) calloc(N * M * K, sizeof(T));
-                if (values == NULL) {
-                    cerr << "FATAL:out of memory" << endl;
-                    exit(EXIT_FAILURE);
-                }
+        /** Reads the variable's data straight into the contiguous
+         * buffer of a MultiArrayLinear (netCDF and MultiArrayLinear
+         * both use row-major order), so no intermediate copy
+         * is required. Any number of dimensions is supported.
+         * @param variable index
+         */
+        void
+        read_buffer(size_t variable_index) {
+            NcFile file(this->m_filename, NcFile::read);
+            NcVar variable = file.getVar(this->m_variables[variable_index]);
 
-                // where to start reading?
-                vector<size_t> start(variable.getDimCount(), 0);
-                if (time_is_an_issue) {
-                    start[0] = this->m_time_index;
-                    start[1] = 0;
-                } else {
-                    start[0] = 0;
-                }
+            vector<size_t> start, count, dims;
+            this->hyperslab(variable, start, count, dims);
 
-                // how much to read?
-                vector<size_t> count;
-                if (time_is_an_issue) {
-                    count.push_back(1);
-                }
-                count.push_back(N);
-                count.push_back(M);
-                count.push_back(K);
-
-                // read the chunk
-                variable.getVar(start, count, values);
-
-                // Re-package
-                for (int i = 0; i < N; i++) {
-                    for (int j = 0; j < M; j++) {
-                        for (int k = 0; k < K; k++) {
-                            gp[0] = i;
-                            gp[1] = j;
-                            gp[2] = k;
-
-                            index->set(gp, values[M * K * i + K * j + k]);
-                        }
-                    }
-                }
+            if (dims.empty()) {
+                cerr << "FATAL: variable " << this->m_variables[variable_index]
+                     << " has no spatial dimensions" << endl;
+                exit(EXIT_FAILURE);
+            }
 
-                // Clean up
-                delete values;
+            if (dims != m_coordinate_system->get_dimension_sizes()) {
+                cerr << "FATAL: dimensions of variable " 
+                     << this->m_variables[variable_index]
+                     << " in file " << m_filename 
+                     << " do not match the coordinate system" << endl;
+                exit(EXIT_FAILURE);
+            }
 
-            } else {
-                cerr << "FATAL: Variables with " << spatial_dims << " spatial dimensions are not currently handled" <<
-                endl;
+            MultiArrayLinear<T> *data = NULL;
+            try {
+                data = new MultiArrayLinear<T>(dims);
+            } catch (std::bad_alloc &e) {
+                cerr << "FATAL:out of memory" << endl;
                 exit(EXIT_FAILURE);
             }
 
+            // read the chunk
+            variable.getVar(start, count, data->data());
+
             // Store result in map
-            this->m_buffered_data[variable_index] = index;
+            this->set_data(variable_index, data);
         }
 
         void
         write_buffered_data(size_t variable_index) {
-            bool time_is_an_issue = this->m_time_index >= 0;
-
             // Open file for writing
             NcFile file(this->m_filename, NcFile::write);
             NcVar variable = file.getVar(this->m_variables[variable_index]);
 
-            // If we have to take time into the picture,
-            // the number of dimensions for the data is
-            // one more
-            int spatial_dims = time_is_an_issue
-                               ? variable.getDimCount() - 1
-                               : variable.getDimCount();
-
-            vector<size_t> dims(spatial_dims);
-            for (size_t i = 0; i < spatial_dims; i++) {
-                dims[i] = coordinate_system()->dimensions()[i].getSize();
-            }
-
-            MultiArray<T> *index = this->get_data(variable_index);
-            vector<int> gp(spatial_dims);
-            if (spatial_dims == 1) {
-                // 1D
-                int N = time_is_an_issue ? variable.getDim(1).getSize() : variable.getDim(0).getSize();
-
-                // where to start reading?
-                vector<size_t> start(variable.getDimCount(), 0);
-                if (time_is_an_issue) start[0] = this->m_time_index;
-
-                // how much to write?
-                vector<size_t> count(variable.getDimCount(), 0);
-                if (time_is_an_issue) {
-                    count[0] = 1;
-                    count[1] = N;
-                } else {
-                    count[0] = N;
-                }
-
-                // copy the data into the buffer
-                T *values = (T *) calloc(N, sizeof(T));
-                if (values == NULL) {
-                    cerr << "FATAL:out of memory" << endl;
-                    exit(EXIT_FAILURE);
-                }
-
-                for (int i = 0; i < N; i++) {
-                    values[i] = index->get(gp);
-                }
-
-                // write the chunk
-                variable.putVar(values);
-
-                // Clean up
-                delete[] values;
-
-            } else if (spatial_dims == 2) {
-
-                // 2D
-                int N, M;
-                if (time_is_an_issue) {
-                    N = variable.getDim(1).getSize();
-                    M = variable.getDim(2).getSize();
-                } else {
-                    N = variable.getDim(0).getSize();
-                    M = variable.getDim(1).getSize();
-                }
-
-                // Create buffer to hold data
-                T *values = (T *) calloc(N * M, sizeof(T));
-                if (values == NULL) {
-                    cerr << "FATAL:out of memory" << endl;
-                    exit(EXIT_FAILURE);
-                }
-
-                // where to start reading?
-                vector<size_t> start(variable.getDimCount(), 0);
-                if (time_is_an_issue) start[0] = this->m_time_index;
-
-                // how much to read?
-                vector<size_t> count(variable.getDimCount(), 0);
-                if (time_is_an_issue) {
-                    count[0] = 1;
-                    count[1] = N;
-                    count[2] = M;
-                } else {
-                    count[0] = N;
-                    count[1] = M;
-                }
-
-                // re-package
-                for (int i = 0; i < N; i++) {
-                    for (int j = 0; j < M; j++) {
-                        gp[0] = i;
-                        gp[1] = j;
-
-                        values[i * M + j] = index->get(gp);
-                    }
-                }
-
-                // write
-                variable.putVar(&values[0]);
-
-                // Clean up
-                delete[] values;
-
-            } else if (spatial_dims == 3) {
-                // 3D
-                int N, M, K;
-                if (time_is_an_issue) {
-                    N = variable.getDim(1).getSize();
-                    M = variable.getDim(2).getSize();
-                    K = variable.getDim(3).getSize();
-                } else {
-                    N = variable.getDim(0).getSize();
-                    M = variable.getDim(1).getSize();
-                    K = variable.getDim(2).getSize();
-                }
-
-                // Read this as a succession of 2D slices
-                // Allocate buffer for 2D slices
-                T *values = (T *) calloc(N * M * K, sizeof(T));
-                if (values == NULL) {
-                    cerr << "FATAL:out of memory" << endl;
-                    exit(EXIT_FAILURE);
-                }
+            vector<size_t> start, count, dims;
+            this->hyperslab(variable, start, count, dims);
 
-                // where to start reading?
-                vector<size_t> start(variable.getDimCount(), 0);
-                if (time_is_an_issue) {
-                    start[0] = this->m_time_index;
-                    start[1] = 0;
-                } else {
-                    start[0] = 0;
-                }
+            MultiArray<T> *data = this->get_data(variable_index);
 
-                // how much to read?
-                vector<size_t> count;
-                if (time_is_an_issue) {
-                    count.push_back(1);
-                }
-                count.push_back(N);
-                count.push_back(M);
-                count.push_back(K);
-
-                // Re-package
-                for (int i = 0; i < N; i++) {
-                    for (int j = 0; j < M; j++) {
-                        for (int k = 0; k < K; k++) {
-                            gp[0] = i;
-                            gp[1] = j;
-                            gp[2] = k;
-
-                            values[M * K * i + K * j + k] = index->get(gp);
-                        }
-                    }
-                }
-
-                // write
-                variable.putVar(values);
+            MultiArrayLinear<T> *linear = m_linear_data.at(variable_index);
 
-                // Clean up
-                delete[] values;
+            if (linear != NULL && linear->get_dimensions() == dims) {
+                // write directly from the buffer
+                variable.putVar(start, count, linear->data());
+            } else {
+                // re-package into a contiguous buffer first
+                MultiArrayLinear<T> buffer(dims);
+                buffer.copy_from(data);
+                variable.putVar(start, count, buffer.data());
+            }
+        }
 
+        /** Checks validity and unpacks the given raw value
+         * @param variable index
+         * @param raw value
+         * @param validity flag (set)
+         * @return unpacked value
+         */
+        inline T
+        unpack(size_t variable_index, T value, bool &is_valid) const {
+            if (m_fill_value[variable_index] != NO_VALUE) {
+                is_valid = (value != m_fill_value[variable_index]);
             } else {
-                cerr << "FATAL: Variables with " << spatial_dims << " spatial dimensions are not currently handled" <<
-                endl;
-                exit(EXIT_FAILURE);
+                is_valid = (value >= m_valid_min[variable_index])
+                           && (value <= m_valid_max[variable_index]);
             }
+
+            // scale first, then offset
+            return m_scale_factor[variable_index] * value + m_offset[variable_index];
         }
 
     public:
@@ -594,6 +437,8 @@ namespace m3D {
                 i->second = NULL;
                 delete indexPtr;
             }
+            m_buffered_data.clear();
+            std::fill(m_linear_data.begin(), m_linear_data.end(), (MultiArrayLinear<T> *) NULL);
         }
 
         void
@@ -711,42 +556,64 @@ namespace m3D {
          */
         T get(size_t variable_index, const vector<int> &gridpoint, bool &is_valid) const {
             T value = 0.0;
-            T unpacked_value = 0.0;
-            typename multiarray_map_t::const_iterator i;
-            i = m_buffered_data.find(variable_index);
 
-            if (i != m_buffered_data.end()) {
-                MultiArray<T> *indexPtr = i->second;
+            const MultiArrayLinear<T> *linear = m_linear_data[variable_index];
 
-                value = indexPtr->get(gridpoint);
+            if (linear != NULL) {
+                value = linear->get(gridpoint);
             } else {
-                cerr << "FATAL: no buffered data for variable with index " << variable_index << endl;
-                exit(EXIT_FAILURE);
-            }
+                typename multiarray_map_t::const_iterator i;
+                i = m_buffered_data.find(variable_index);
 
-            if (m_fill_value[variable_index] != NO_VALUE) {
-                is_valid = (value != m_fill_value[variable_index]);
-            } else {
-                is_valid = (value >= m_valid_min[variable_index])
-                           && (value <= m_valid_max[variable_index]);
-            }
+                if (i != m_buffered_data.end()) {
+                    MultiArray<T> *indexPtr = i->second;
 
-            // scale first, then offset
-            unpacked_value = m_scale_factor[variable_index]
-                             * value + m_offset[variable_index];
+                    value = indexPtr->get(gridpoint);
+                } else {
+                    cerr << "FATAL: no buffered data for variable with index " << variable_index << endl;
+                    exit(EXIT_FAILURE);
+                }
+            }
 
-            return unpacked_value;
+            return this->unpack(variable_index, value, is_valid);
         }
 
         /** Gets a point by it's linear index. The index may run
          * from 0 ... (N-1) where N is the total number of points
-         * in the grid.
+         * in the grid (in row-major order).
          */
         virtual
         T get(size_t variable_index,
               size_t index,
               bool &is_valid) const {
-            return 0;
+            T value = 0.0;
+
+            const MultiArrayLinear<T> *linear = m_linear_data[variable_index];
+
+            if (linear != NULL) {
+                value = linear->get(index);
+            } else {
+                typename multiarray_map_t::const_iterator i;
+                i = m_buffered_data.find(variable_index);
+
+                if (i == m_buffered_data.end()) {
+                    cerr << "FATAL: no buffered data for variable with index " << variable_index << endl;
+                    exit(EXIT_FAILURE);
+                }
+
+                // Convert to grid point
+                const vector<size_t> &dims = i->second->get_dimensions();
+                vector<int> gridpoint(dims.size());
+                size_t remainder = index;
+                for (int d = ((int) dims.size()) - 1; d >= 0; d--) {
+                    gridpoint[d] = remainder % dims[d];
+                    remainder /= dims[d];
+                }
+
+                value = i->second->get(gridpoint);
+            }
+
+            return this->unpack(variable_index, value, is_valid);
         }
 
         /** Values in memory buffer are 'packed'. When retrieving values
@@ -838,6 +705,8 @@ namespace m3D {
             }
 
             m_buffered_data[index] = data;
+
+            m_linear_data.at(index) = dynamic_cast<MultiArrayLinear<T> *> (data);
         }
 
         void
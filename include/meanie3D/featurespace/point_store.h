@@ -0,0 +1,256 @@
+/* The MIT License (MIT)
+ *
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_POINT_STORE_H
+#define M3D_POINT_STORE_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+#include <meanie3D/featurespace/point.h>
+
+#include <vector>
+
+namespace m3D {
+
+    /** Temporary columnar copy of the values and grid points of a
+     * list of points, for loops that read single components of all
+     * points (range searches, weights). Each value component is held
+     * in one contiguous array (column), grid points in a flat array 
+     * with 'spatial rank' entries per point.
+     *
+     * This is not the feature-space storage. The Point objects own 
+     * their data and are allocated individually, and the store adds
+     * rank() * sizeof(T) + spatial_rank() * sizeof(int) per point on
+     * top of them. Build it where a loop needs contiguous columns and
+     * release it when done.
+     *
+     * Index i in the store refers to points[i] of the list it was
+     * gathered from. The store refers to that list rather than 
+     * copying it, so the list must outlive the store and must not be
+     * changed until the store is gathered again.
+     */
+    template <typename T>
+    class PointStore
+    {
+    private:
+
+        size_t m_size;
+        size_t m_rank;
+        size_t m_spatial_rank;
+
+        /** values, column by column: m_values[d * m_size + i] */
+        vector<T> m_values;
+
+        /** grid points, point by point: m_gridpoints[i * m_spatial_rank + d] */
+        vector<int> m_gridpoints;
+
+        /** The points the data was gathered from */
+        const typename Point<T>::list *m_points;
+
+    public:
+
+#pragma mark -
+#pragma mark Constructors
+
+        PointStore()
+        : m_size(0)
+        , m_rank(0)
+        , m_spatial_rank(0)
+        , m_points(NULL)
+        {
+        }
+
+        /** Gathers the given points into columnar storage.
+         * @param points
+         * @param rank of the spatial range
+         */
+        PointStore(const typename Point<T>::list &points, size_t spatial_rank)
+        : m_size(0)
+        , m_rank(0)
+        , m_spatial_rank(0)
+        , m_points(NULL)
+        {
+            this->gather(points, spatial_rank);
+        }
+
+#pragma mark -
+#pragma mark Gather
+
+        /** (Re-)builds the store from the given points. Existing
+         * buffers are re-used where possible.
+         * @param points
+         * @param rank of the spatial range
+         */
+        void
+        gather(const typename Point<T>::list &points, size_t spatial_rank)
+        {
+            m_points = &points;
+            m_size = points.size();
+            m_rank = m_size > 0 ? points[0]->values.size() : 0;
+            m_spatial_rank = spatial_rank;
+
+            m_values.resize(m_rank * m_size);
+            m_gridpoints.resize(m_spatial_rank * m_size);
+
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t i = 0; i < m_size; i++) {
+                const typename Point<T>::ptr p = points[i];
+                for (size_t d = 0; d < m_rank; d++) {
+                    m_values[d * m_size + i] = p->values[d];
+                }
+                for (size_t d = 0; d < m_spatial_rank && d < p->gridpoint.size(); d++) {
+                    m_gridpoints[i * m_spatial_rank + d] = p->gridpoint[d];
+                }
+            }
+        }
+
+#pragma mark -
+#pragma mark Accessors
+
+        /** @return number of points */
+        inline size_t size() const
+        {
+            return m_size;
+        }
+
+        /** @return number of components per point */
+        inline size_t rank() const
+        {
+            return m_rank;
+        }
+
+        /** @return number of spatial components per point */
+        inline size_t spatial_rank() const
+        {
+            return m_spatial_rank;
+        }
+
+        /** @param component index
+         * @return pointer to the contiguous array of values
+         * of the given component (size() elements)
+         */
+        inline const T *column(size_t d) const
+        {
+            return &m_values[d * m_size];
+        }
+
+        inline T *column(size_t d)
+        {
+            return &m_values[d * m_size];
+        }
+
+        /** @return d-th component of point i */
+        inline T value(size_t i, size_t d) const
+        {
+            return m_values[d * m_size + i];
+        }
+
+        /** Copies the values of point i into the given vector.
+         * @param point index
+         * @param vector (resized to rank() if necessary)
+         */
+        inline void values(size_t i, vector<T> &result) const
+        {
+            result.resize(m_rank);
+            for (size_t d = 0; d < m_rank; d++) {
+                result[d] = m_values[d * m_size + i];
+            }
+        }
+
+        /** @return pointer to the spatial_rank() grid point
+         * components of point i.
+         */
+        inline const int *gridpoint(size_t i) const
+        {
+            return &m_gridpoints[i * m_spatial_rank];
+        }
+
+        /** @return the original point object at index i */
+        inline typename Point<T>::ptr point(size_t i) const
+        {
+            return (*m_points)[i];
+        }
+
+        /** @return the point list this store was gathered from */
+        inline const typename Point<T>::list &points() const
+        {
+            return *m_points;
+        }
+
+#pragma mark -
+#pragma mark Searching
+
+        /** Brute-force range search in the given components. Finds all
+         * points for which sum((x_d - p_d)^2/h_d^2) <= 1. The search
+         * is performed in blocks, column by column, which keeps the
+         * inner loops contiguous and allows the compiler to vectorize
+         * them.
+         *
+         * @param x search origin (one value per entry in components)
+         * @param h bandwidth (one value per entry in components)
+         * @param indexes of the components to use
+         * @param result (cleared and filled with point indexes). Does
+         *        not allocate once the vector has grown large enough.
+         */
+        void
+        range_search(const vector<T> &x,
+                const vector<T> &h,
+                const vector<size_t> &components,
+                vector<size_t> &result) const
+        {
+            static const size_t BLOCK_SIZE = 256;
+
+            result.clear();
+
+            T r[BLOCK_SIZE];
+
+            for (size_t begin = 0; begin < m_size; begin += BLOCK_SIZE) {
+                size_t n = (m_size - begin < BLOCK_SIZE) ? (m_size - begin) : BLOCK_SIZE;
+
+                for (size_t k = 0; k < n; k++) {
+                    r[k] = 0.0;
+                }
+
+                for (size_t ci = 0; ci < components.size(); ci++) {
+                    const T *col = this->column(components[ci]) + begin;
+                    const T xc = x[ci];
+                    const T c = (h[ci] > 0) ? 1.0 / (h[ci] * h[ci]) : 0.0;
+                    for (size_t k = 0; k < n; k++) {
+                        T dist = col[k] - xc;
+                        r[k] += dist * dist * c;
+                    }
+                }
+
+                for (size_t k = 0; k < n; k++) {
+                    if (r[k] <= 1.0) {
+                        result.push_back(begin + k);
+                    }
+                }
+            }
+        }
+    };
+}
+
+#endif
@@ -29,6 +29,7 @@
 #include <meanie3D/filters/replacement_filter.h>
 #include <meanie3D/filters/scalespace_kernel.h>
 #include <meanie3D/filters/scalespace_filter.h>
+#include <meanie3D/filters/separable_convolution.h>
 #include <meanie3D/filters/threshold_filter.h>
 #include <meanie3D/filters/weight_filter.h>
 
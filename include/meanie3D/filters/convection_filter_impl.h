@@ -78,95 +78,110 @@ namespace m3D {
 
         // Create a point index with spatial components only
 
-        PointIndex<T> *index = PointIndex<T>::create(fs->get_points(), fs->rank());
+        vector<size_t> spatial_indexes = fs->spatial_range_indexes();
 
-        PointIndex<T> *convective_radius_index = PointIndex<T>::create(fs->get_points(), fs->rank());
+        PointIndex<T> *index = PointIndex<T>::create(fs->get_points(), spatial_indexes);
 
-        // params for index search
+        PointIndex<T> *convective_radius_index = PointIndex<T>::create(fs->get_points(), spatial_indexes);
 
-        RangeSearchParams<T> params(this->m_bandwidth);
+        // params for index search (spatial part of the bandwidth)
 
-        // convective 'radius'
+        vector<T> spatial_bandwidth(m_bandwidth.begin(), m_bandwidth.begin() + fs->spatial_rank());
 
-        RangeSearchParams<T> convective_radius_params(m_convective_radius_factor * m_bandwidth);
+        RangeSearchParams<T> params(spatial_bandwidth);
 
-        // Create a field to hold the convection mask
+        // convective 'radius'
 
-        MultiArrayBlitz<bool> convective_mask(fs->coordinate_system->get_dimension_sizes(), false);
+        RangeSearchParams<T> convective_radius_params(m_convective_radius_factor * spatial_bandwidth);
 
-        // Iterate over the feature-space to create the convective mask
+        // Build both indexes up front, which allows
+        // searching them concurrently below
 
-        typename Point<T>::list::iterator pit;
+        index->build(&params);
 
-        for (size_t k = 0; k < fs->points.size(); k++) {
-            if (this->show_progress()) {
-                progress_bar->operator++();
-            }
+        convective_radius_index->build(&convective_radius_params);
 
-            Point<T> *p = fs->points.at(k);
+        // Create a field to hold the convection mask
 
-            typename Point<T>::list *sample = NULL;
+        MultiArray<bool> *convective_mask = create_dense_multiarray<bool>(fs->coordinate_system->get_dimension_sizes(), false);
 
-            sample = index->search(p->coordinate, &params, NULL);
+        DenseGridView<bool> convective_grid(convective_mask);
 
-            // Check if the convective threshold is met
+        // Iterate over the feature-space to create the convective mask
 
-            bool is_convective = false;
+#if WITH_OPENMP
+#pragma omp parallel
+#endif
+        {
+            typename Point<T>::list sample;
+
+#if WITH_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (size_t k = 0; k < fs->points.size(); k++) {
+                if (this->show_progress()) {
+#if WITH_OPENMP
+#pragma omp critical
+#endif
+                    progress_bar->operator++();
+                }
 
-            T z_p = p->values.at(m_index_of_z);
+                Point<T> *p = fs->points.at(k);
 
-            if (z_p >= m_convective_threshold) {
-                is_convective = true;
-            } else {
-                // Obtain the background reflectivity for this point
+                // Check if the convective threshold is met
 
-                T z_background = 0.0;
+                bool is_convective = false;
 
-                for (size_t i = 0; i < sample->size(); i++) {
-                    Point<T> *p = sample->at(i);
+                T z_p = p->values.at(m_index_of_z);
 
-                    T z = p->values.at(m_index_of_z);
+                if (z_p >= m_convective_threshold) {
+                    is_convective = true;
+                } else {
+                    // Obtain the background reflectivity for this point
 
-                    z_background += z;
-                }
+                    index->search_into(p->coordinate, &params, sample, NULL);
 
-                // linear average
+                    T z_background = 0.0;
 
-                z_background = z_background / boost::numeric_cast<T>(sample->size());
+                    for (size_t i = 0; i < sample.size(); i++) {
+                        T z = sample[i]->values.at(m_index_of_z);
 
-                // Now figure if this point classifies as 'convective' according to
-                // the scheme
+                        z_background += z;
+                    }
 
-                // implicit: if z_background < 0
-                // implicit: z_background < m_convective_threshold
+                    // linear average
 
-                T deltaZ = 10.0;
+                    z_background = z_background / boost::numeric_cast<T>(sample.size());
 
-                if (z_background >= 0 && z_background <= m_convective_threshold) {
-                    deltaZ = 10.0 - (z_background * z_background) / 180.0;
-                }
+                    // Now figure if this point classifies as 'convective' according to
+                    // the scheme
 
-                if (deltaZ > m_critical_delta_z) {
-                    is_convective = true;
-                }
-            }
+                    // implicit: if z_background < 0
+                    // implicit: z_background < m_convective_threshold
 
-            delete sample;
+                    T deltaZ = 10.0;
 
-            if (is_convective) {
-                // Mark all points within convective radius
+                    if (z_background >= 0 && z_background <= m_convective_threshold) {
+                        deltaZ = 10.0 - (z_background * z_background) / 180.0;
+                    }
 
-                typename Point<T>::list *sample = NULL;
+                    if (deltaZ > m_critical_delta_z) {
+                        is_convective = true;
+                    }
+                }
 
-                sample = convective_radius_index->search(p->coordinate, &convective_radius_params, NULL);
+                if (is_convective) {
+                    // Mark all points within convective radius
 
-                for (size_t i = 0; i < sample->size(); i++) {
-                    Point<T> *sp = sample->at(i);
+                    convective_radius_index->search_into(p->coordinate, &convective_radius_params, sample, NULL);
 
-                    convective_mask.set(sp->gridpoint, true);
+#if WITH_OPENMP
+#pragma omp critical
+#endif
+                    for (size_t i = 0; i < sample.size(); i++) {
+                        convective_grid.set(sample[i]->gridpoint, true);
+                    }
                 }
-
-                delete sample;
             }
         }
 
@@ -189,7 +204,7 @@ namespace m3D {
             Point<T> *p = fs->points.at(k);
 
             if (m_erase_non_convective) {
-                if (convective_mask.get(p->gridpoint)) {
+                if (convective_grid.get(p->gridpoint)) {
                     accepted.push_back(p);
                 } else {
                     erased.push_back(p);
@@ -199,6 +214,8 @@ namespace m3D {
             }
         }
 
+        delete convective_mask;
+
         if (m_erase_non_convective) {
             // replace feature-space points with those accepted
             // only and delete the rest
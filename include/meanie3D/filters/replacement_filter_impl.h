@@ -50,10 +50,14 @@ namespace m3D {
     void ReplacementFilter<T>::apply(FeatureSpace<T> *fs) {
 
         // Create a spatial index for the copied feature space
-        PointIndex<T> *index = PointIndex<T>::create(fs->get_points(), fs->rank());
-        SearchParameters *params = new RangeSearchParams<T>(m_bandwidth);
+        PointIndex<T> *index = PointIndex<T>::create(fs->get_points(), fs->spatial_range_indexes());
+        vector<T> spatial_bandwidth(m_bandwidth.begin(), m_bandwidth.begin() + fs->spatial_rank());
+        SearchParameters *params = new RangeSearchParams<T>(spatial_bandwidth);
         size_t value_index = fs->spatial_rank() + m_variable_index;
 
+        // Build up front, the searches below run concurrently
+        index->build(params);
+
         vector<T> filteredValues;
         filteredValues.resize(fs->size());
 
@@ -67,16 +71,8 @@ namespace m3D {
             // Get the values around the point (original index)
             T result = fs->points[i]->values[value_index];
 
-            typename Point<T>::list *neighbours = NULL;
+            typename Point<T>::list *neighbours = index->search(fs->points[i]->coordinate,params);
 
-#if WITH_OPENMP
-#pragma omp critical 
-            {
-#endif
-            neighbours = index->search(fs->points[i]->coordinate,params);
-#if WITH_OPENMP
-            }
-#endif          
             if (!(neighbours == NULL || neighbours->size()==0)) {
 
                 vector<T> values;
@@ -112,6 +108,8 @@ namespace m3D {
                 }
             }
 
+            delete neighbours;
+
             filteredValues[i] = result;
         }
 
@@ -26,17 +26,12 @@
 
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
-#include <meanie3D/array/array_index.h>
 #include <meanie3D/filters/filter.h>
 #include <meanie3D/filters/scalespace_kernel.h>
-
-#include <boost/progress.hpp>
+#include <meanie3D/filters/separable_convolution.h>
 
 namespace m3D {
 
-    template <class T>
-    class ArrayIndex;
-
     /** Smoothes the data with a scale-space filter. This filter does NOT create
      * new points. Only the existing points are smoothed out.
      */
@@ -55,37 +50,18 @@ namespace m3D {
         map<size_t, T> m_min; /// minimum tracker
         map<size_t, T> m_max; /// maximum tracker
 
-        boost::progress_display *m_progress_bar; /// Progress meter
         vector<string> m_excluded_vars;
 
-        void
-        applyWithArrayIndexRecursive(FeatureSpace<T> *fs,
-                ArrayIndex<T> *originalIndex,
-                ArrayIndex<T> *filteredPoints,
-                vector<size_t> &dimensionIndexes,
-                size_t dimensionIndex,
-                typename CoordinateSystem<T>::GridPoint& gridpoint);
-
-        void
-        applyWithArrayIndexForDimension(FeatureSpace<T> *fs,
-                ArrayIndex<T> *originalIndex,
-                ArrayIndex<T> *filteredPoints,
-                size_t fixedDimensionIndex);
-
-        void
-        applyWithArrayIndex(FeatureSpace<T> *fs);
-
 #pragma mark -
-#pragma mark Paralellized versions
-
-        void
-        apply_parallellized_on_dimension(FeatureSpace<T> *fs,
-                ArrayIndex<T> *originalIndex,
-                ArrayIndex<T> *filteredPoints,
-                size_t fixedDimensionIndex);
+#pragma mark Separable version on flat arrays
 
+        /** Copies the feature-space values into flat arrays, runs
+         * one convolution pass per dimension on them and rebuilds
+         * the feature-space points from the result.
+         * @param feature space
+         */
         void
-        apply_parallellized(FeatureSpace<T> *fs);
+        apply_separable(FeatureSpace<T> *fs);
 
     public:
 
@@ -35,8 +35,6 @@
 #include <map>
 #include <string>
 
-#include <boost/progress.hpp>
-
 #include "scalespace_filter.h"
 
 namespace m3D {
@@ -70,7 +68,6 @@ namespace m3D {
     : FeatureSpaceFilter<T>(show_progress)
     , m_scale(scale)
     , m_decay(decay)
-    , m_progress_bar(NULL)
     , m_excluded_vars(excluded_vars)
     {
         if (scale < 0) {
@@ -114,524 +111,174 @@ namespace m3D {
 
     template <typename T>
     void
-    ScaleSpaceFilter<T>::applyWithArrayIndexRecursive(FeatureSpace<T> *fs,
-            ArrayIndex<T> *originalIndex,
-            ArrayIndex<T> *filteredPoints,
-            vector<size_t> &dimensionIndexes,
-            size_t dimensionIndex,
-            typename CoordinateSystem<T>::GridPoint& gridpoint)
+    ScaleSpaceFilter<T>::apply_separable(FeatureSpace<T> *fs)
     {
-        // loop over the dimension with the given index. For each
-        // coordinate, loop over the other two. At Each point, apply
-        // the one-dimensional kernel
-
         using namespace std;
 
         const CoordinateSystem<T> *cs = fs->coordinate_system;
+        const vector<size_t> dims = cs->get_dimension_sizes();
+        const size_t spatial_rank = fs->spatial_rank();
+        const size_t value_rank = fs->value_rank();
 
-        size_t realDimIndex = dimensionIndexes[dimensionIndex];
-
-        NcDim dim = cs->dimensions()[realDimIndex];
-
-        // iterate over dimensions
-
-        for (int index = 0; index < dim.getSize(); index++) {
-            gridpoint[realDimIndex] = index;
-
-            if (dimensionIndex < (gridpoint.size() - 1)) {
-                applyWithArrayIndexRecursive(fs, originalIndex, filteredPoints, dimensionIndexes, dimensionIndex + 1, gridpoint);
-            } else {
-                // we reached the fixed dimension
-
-                if (this->show_progress()) {
-                    m_progress_bar->operator++();
-                }
-
-                // exclude points that were off limits
-                // in any of the original data sets
-
-                //if (fs->off_limits()->get(gridpoint))
-                //    continue;
-
-                ScaleSpaceKernel<T> g = this->m_kernels[realDimIndex];
-
-                // Find the boundaries. Take care not to step
-                // outside the bounds of the array
-
-                int width = g.values().size() - 1;
-                int gpIndex = (int) gridpoint[realDimIndex];
-                int minIndex = (gpIndex - width >= 0) ? (gpIndex - width) : 0;
-                int maxIndex = ((gpIndex + width) < (dim.getSize() - 1)) ? (gpIndex + width) : (dim.getSize() - 1);
-
-                // Convolute in 1D around the given point with
-                // the mask size determined by the kernel
-                // Run the convolution for each feature variable
-
-                typename CoordinateSystem<T>::GridPoint gridIter = gridpoint;
-
-                vector<T> sum(fs->value_rank(), 0.0);
-
-                size_t sumCount = 0;
-
-                for (int i = minIndex; i < maxIndex; i++) {
-                    // set gridpoint to current position
-
-                    gridIter[realDimIndex] = i;
-
-                    // Again, make sure no points originally marked as
-                    // off limits are used
-
-                    //                    if (fs->off_limits()->get(gridIter))
-                    //                        continue;
-
-                    // get the point at the iterated position
-
-                    Point<T> *pIter = originalIndex->get(gridIter);
-
-                    if (pIter == NULL)
-                        continue;
-
-                    // apply the pre-sampled gaussian and sum up
-
-                    size_t d = (i <= index) ? (index - i) : (i - index);
-
-                    for (int varIndex = 0; varIndex < fs->value_rank(); varIndex++) {
-                        T value = pIter->values[cs->rank() + varIndex];
-                        sum[varIndex] += g.value(d) * value;
-                    }
-
-                    sumCount++;
-                }
-
-                // No muss, no fuss
-
-                if (sumCount == 0)
-                    continue;
-
-                // Fuss! Fetch the point from the array index
-
-                Point<T> *p = filteredPoints->get(gridpoint);
-
-                // If no point existed, decide if we need to create one
-
-                if (p == NULL) {
-                    // Create a new point with default values
-                    // and insert into array index
-
-                    typename CoordinateSystem<T>::Coordinate coordinate = cs->newCoordinate();
-                    cs->lookup(gridpoint, coordinate);
-                    vector<T> values = coordinate;
-                    values.resize(fs->rank(), 0.0);
-
-                    p = PointFactory<T>::get_instance()->create(gridpoint, coordinate, values);
-
-                    // Did this exist in the original index?
-
-                    Point<T> *op = originalIndex->get(gridpoint);
-                    p->isOriginalPoint = ((op == NULL) ? false : op->isOriginalPoint);
-
-                    // Since we just created this point, there
-                    // is no need to copy it again when adding
-                    // it to the array index
-
-                    filteredPoints->set(gridpoint, p, false);
-                }
-
-                // If we have a point after all that, update it with the
-                // filtered value
-
-                if (p != NULL) {
-                    // copy values and track limits
-
-                    for (int varIndex = 0; varIndex < fs->value_rank(); varIndex++) {
-                        p->values[fs->spatial_rank() + varIndex] = sum[varIndex];
-
-                        if (sum[varIndex] < m_min[varIndex])
-                            m_min[varIndex] = sum[varIndex];
-
-                        if (sum[varIndex] > m_max[varIndex])
-                            m_max[varIndex] = sum[varIndex];
-                    }
-                }
-            }
-        }
-    }
-
-    template <typename T>
-    void
-    ScaleSpaceFilter<T>::applyWithArrayIndexForDimension(FeatureSpace<T> *fs,
-            ArrayIndex<T> *originalIndex,
-            ArrayIndex<T> *filteredPoints,
-            size_t fixedDimensionIndex)
-    {
-        // iterate over the other two
-
-        // Create a vector, that enumerates the dimensions such, that the
-        // fixed dimension comes last
-
-        vector<size_t> dimensionIndexes;
-
-        for (size_t j = 0; j < fs->coordinate_system->rank(); j++) {
-            if (j == fixedDimensionIndex) continue;
-            dimensionIndexes.push_back(j);
+        vector< vector<T> > kernels(m_kernels.size());
+        for (size_t i = 0; i < m_kernels.size(); i++) {
+            kernels[i] = m_kernels[i].values();
         }
 
-        dimensionIndexes.push_back(fixedDimensionIndex);
-
-        typename CoordinateSystem<T>::GridPoint gridpoint = fs->coordinate_system->newGridPoint();
-
-        // Now recurse into the structure, bearing in mind that
-        // the dimensions have been re-ordered
-
-        applyWithArrayIndexRecursive(fs, originalIndex, filteredPoints, dimensionIndexes, 0, gridpoint);
-    }
-
-    template <typename T>
-    void
-    ScaleSpaceFilter<T>::applyWithArrayIndex(FeatureSpace<T> *fs)
-    {
-        using namespace std;
-
-        const CoordinateSystem<T> *cs = fs->coordinate_system;
-
-        // index the original
+        SeparableConvolution<T> convolution(dims, kernels);
+        const size_t N = convolution.size();
 
         if (this->show_progress()) {
-            cout << endl << "Constructing array indexes ...";
-
+            cout << endl << "Applying scale filter t=" << m_scale << " decay=" << m_decay << " ... ";
             start_timer();
         }
 
-        ArrayIndex<T> *originalIndex = new ArrayIndex<T>(cs->get_dimension_sizes(), fs->points, true);
-
-        ArrayIndex<T> *filteredIndex = new ArrayIndex<T>(cs->get_dimension_sizes(), false);
+        // Copy the values into one flat array per variable. Grid 
+        // points without a point in feature-space are zero and 
+        // marked as absent in the mask.
 
-        if (this->show_progress()) {
-            cout << "done. (" << stop_timer() << "s)" << endl;
-        }
+        vector<T> data(value_rank * N, 0.0);
+        vector<T> buffer(value_rank * N);
+        vector<unsigned char> present(N, 0);
+        vector<unsigned char> present_buffer(N);
+        vector<unsigned char> original(N, 0);
 
-        if (this->show_progress()) {
-            cout << endl << "Applying scale filter t=" << m_scale << " decay=" << m_decay << " ... " << endl;
-
-            long numPoints = 1;
-
-            for (size_t i = 0; i < fs->coordinate_system->rank(); i++) {
-                numPoints *= fs->coordinate_system->dimensions()[i].getSize();
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (size_t pi = 0; pi < fs->points.size(); pi++) {
+            typename Point<T>::ptr p = fs->points[pi];
+#if SCALE_SPACE_SKIPS_NON_ORIGINAL_POINTS
+            if (fs->off_limits_grid().get(p->gridpoint))
+                continue;
+#endif
+            size_t index = 0;
+            for (size_t d = 0; d < spatial_rank; d++) {
+                index = index * dims[d] + p->gridpoint[d];
             }
-
-            m_progress_bar = new boost::progress_display(fs->spatial_rank() * numPoints);
-
-            start_timer();
-        }
-
-        // initialize min/max and re-set counts
-
-        for (size_t varIndex = 0; varIndex < fs->value_rank(); varIndex++) {
-            m_min[varIndex] = std::numeric_limits<T>::max();
-            m_max[varIndex] = std::numeric_limits<T>::min();
-        }
-
-        // Apply dimension by dimension (exploiting separability)
-
-        for (size_t dimIndex = 0; dimIndex < fs->spatial_rank(); dimIndex++) {
-            applyWithArrayIndexForDimension(fs, originalIndex, filteredIndex, dimIndex);
-
-            delete originalIndex;
-
-            if (dimIndex < (fs->spatial_rank() - 1)) {
-                originalIndex = filteredIndex;
-
-                filteredIndex = new ArrayIndex<T>(cs->get_dimension_sizes(), false);
+            present[index] = 1;
+            original[index] = p->isOriginalPoint ? 1 : 0;
+            for (size_t vi = 0; vi < value_rank; vi++) {
+                data[vi * N + index] = p->values[spatial_rank + vi];
             }
         }
 
-        // replace the points in the original with the filtered
-        // array index results
-        filteredIndex->replace_points(fs->points);
-
-        size_t originalPoints = 0;
-        for (size_t i = 0; i < fs->points.size(); i++) {
-            if (fs->points[i]->isOriginalPoint) originalPoints++;
-        }
-
-        if (this->show_progress()) {
-            cout << "done. (" << stop_timer() << "s)" << endl;
-            cout << "Filtered featurespace contains " << fs->size() << " points (" << originalPoints << " original points, "
-                    << "(" << (fs->size() - originalPoints) << " new points))" << endl;
-            delete m_progress_bar;
-            m_progress_bar = NULL;
-        }
-
-        // Clean up
-
-        delete filteredIndex;
-    }
-
-    template <typename T>
-    void
-    ScaleSpaceFilter<T>::apply_parallellized_on_dimension(FeatureSpace<T> *fs,
-            ArrayIndex<T> *originalIndex,
-            ArrayIndex<T> *filteredPoints,
-            size_t fixedDimension)
-    {
-        using namespace std;
-
-        const CoordinateSystem<T> *cs = fs->coordinate_system;
-        const vector<size_t> dim_sizes = cs->get_dimension_sizes();
-        const size_t numDims = cs->rank();
-        const size_t value_rank = fs->value_rank();
-
-        // Collate the dimension sizes for the linear mapping
-        // and the dimension indexes
-
-        std::vector<size_t> iter_dimensions;
-
-        for (size_t i = 0; i < dim_sizes.size(); i++)
-            if (i != fixedDimension)
-                iter_dimensions.push_back(dim_sizes[i]);
-
-        LinearIndexMapping mapping(iter_dimensions);
-        size_t N = mapping.size();
+        LinearIndexMapping mapping(dims);
 
+#if SCALE_SPACE_SKIPS_NON_ORIGINAL_POINTS
+        vector<unsigned char> off_limits(N, 0);
 #if WITH_OPENMP
-#pragma omp parallel for schedule(dynamic)
+#pragma omp parallel for schedule(static)
 #endif
-        for (size_t n = 0; n < N; n++) {
-            // re-assemble the starting point for the iteration from
-            // the mapping's components
-
-            vector<int> truncatedGridPoint = mapping.linear_to_grid(n);
-            vector<int> startPoint(cs->rank());
-
-            size_t runningIndex = 0;
-            for (size_t i = 0; i < cs->rank(); i++)
-                if (i != fixedDimension)
-                    startPoint[i] = truncatedGridPoint[runningIndex++];
-
-            size_t fixedDimSize = dim_sizes[fixedDimension];
-
-            // Now iterate over the remaining dimension
-            // TODO: consider to nest this depending on 
-            // problem size
-
-            for (size_t k = 0; k < dim_sizes[fixedDimension]; k++) {
-                if (this->show_progress()) {
-#if WITH_OPENMP
-#pragma omp critical
+        for (size_t i = 0; i < N; i++) {
+            off_limits[i] = fs->off_limits_grid().get(i) ? 1 : 0;
+        }
 #endif
-                    m_progress_bar->operator++();
-                }
-
-                // construct position
 
-                vector<int> gridpoint(startPoint);
-                gridpoint[fixedDimension] = k;
+        // Apply dimension by dimension (exploiting separability).
+        // A grid point receives a value if any point within the
+        // window of the kernel existed in the previous pass.
 
-#if SCALE_SPACE_SKIPS_NON_ORIGINAL_POINTS
-                if (fs->off_limits()->get(gridpoint))
-                    continue;
-#endif  
-
-                ScaleSpaceKernel<T> g = this->m_kernels[fixedDimension];
-
-                // Find the boundaries. Take care not to step
-                // outside the bounds of the array
-
-                int width = g.values().size() - 1;
-                int gpIndex = (int) gridpoint[fixedDimension];
-                int minIndex = (gpIndex - width >= 0) ? (gpIndex - width) : 0;
-                int maxIndex = ((gpIndex + width) < (fixedDimSize - 1)) ? (gpIndex + width) : (fixedDimSize - 1);
-
-                // Convolute in 1D around the given point with
-                // the mask size determined by the kernel
-                // Run the convolution for each feature variable
-
-                typename CoordinateSystem<T>::GridPoint gridIter = gridpoint;
-
-                vector<T> sum(value_rank, 0.0);
-
-                size_t sumCount = 0;
-
-                for (int i = minIndex; i < maxIndex; i++) {
-                    gridIter[fixedDimension] = i;
-
-                    // Again, make sure no points originally marked as
-                    // off limits are used
+        for (size_t dimIndex = 0; dimIndex < spatial_rank; dimIndex++) {
+            for (size_t vi = 0; vi < value_rank; vi++) {
+                convolution.convolve(dimIndex, &data[vi * N], &buffer[vi * N]);
+            }
+            convolution.dilate(dimIndex, &present[0], &present_buffer[0]);
 
 #if SCALE_SPACE_SKIPS_NON_ORIGINAL_POINTS
-                    if (fs->off_limits()->get(gridpoint))
-                        continue;
-#endif  
-
-                    // get the point at the iterated position
-
-                    Point<T> *pIter = originalIndex->get(gridIter);
-
-                    if (pIter == NULL)
-                        continue;
-
-                    // apply the pre-sampled gaussian and sum up
-                    // in each variable in the feature-space
-
-                    size_t d = (i <= k) ? (k - i) : (i - k);
-
-                    for (int varIndex = 0; varIndex < value_rank; varIndex++) {
-                        T value = pIter->values[cs->rank() + varIndex];
-                        sum[varIndex] += g.value(d) * value;
+            for (size_t i = 0; i < N; i++) {
+                if (off_limits[i]) {
+                    present_buffer[i] = 0;
+                    for (size_t vi = 0; vi < value_rank; vi++) {
+                        buffer[vi * N + i] = 0.0;
                     }
-
-                    sumCount++;
                 }
-
-                // No muss, no fuss
-
-                if (sumCount == 0)
-                    continue;
-
-                // Fuss! Fetch the point from the array index
-
-                Point<T> *p = filteredPoints->get(gridpoint);
-
-                // If no point existed, decide if we need to create one
-
-                if (p == NULL) {
-                    // Create a new point with default values
-                    // and insert into array index
-
-                    typename CoordinateSystem<T>::Coordinate coordinate = cs->newCoordinate();
-                    cs->lookup(gridpoint, coordinate);
-                    vector<T> values = coordinate;
-                    values.resize(fs->rank(), 0.0);
-
-                    p = PointFactory<T>::get_instance()->create(gridpoint, coordinate, values);
-
-                    // Did this exist in the original index?
-
-                    Point<T> *op = originalIndex->get(gridpoint);
-                    p->isOriginalPoint = ((op == NULL) ? false : op->isOriginalPoint);
-
-                    // Since we just created this point, there
-                    // is no need to copy it again when adding
-                    // it to the array index
-
-#if WITH_OPENMP
-#pragma omp critical
-                    {
-#endif
-                    filteredPoints->set(gridpoint, p, false);
-#if WITH_OPENMP
-                    }
+            }
 #endif
-                }
-
-                // If we have a point after all that, update it with the
-                // filtered value
+            data.swap(buffer);
+            present.swap(present_buffer);
+        }
 
-                if (p != NULL) {
-                    // copy values and track limits
+        // Rebuild the feature-space from the filtered arrays. Each
+        // chunk counts its points first, so that the points can be 
+        // created in parallel and still end up in linear index order.
 
-                    for (int varIndex = 0; varIndex < value_rank; varIndex++) {
-                        p->values[numDims + varIndex] = sum[varIndex];
+        const size_t chunk_size = FEATURESPACE_BUILD_CHUNK_SIZE;
+        const size_t num_chunks = (N + chunk_size - 1) / chunk_size;
+        vector<size_t> chunk_offsets(num_chunks + 1, 0);
 
-                        if (sum[varIndex] < m_min[varIndex]) {
 #if WITH_OPENMP
-#pragma omp critical
+#pragma omp parallel for schedule(static)
 #endif
-                            m_min[varIndex] = sum[varIndex];
-                        }
-
-                        if (sum[varIndex] > m_max[varIndex]) {
-#if WITH_OPENMP
-#pragma omp critical
-#endif
-                            m_max[varIndex] = sum[varIndex];
-                        }
-                    }
-                }
+        for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+            const size_t end = (chunk + 1) * chunk_size < N ? (chunk + 1) * chunk_size : N;
+            size_t count = 0;
+            for (size_t i = chunk * chunk_size; i < end; i++) {
+                count += present[i];
             }
+            chunk_offsets[chunk + 1] = count;
         }
-    }
-
-    template <typename T>
-    void
-    ScaleSpaceFilter<T>::apply_parallellized(FeatureSpace<T> *fs)
-    {
-        LinearIndexMapping mapping(fs->coordinate_system->get_dimension_sizes());
-        size_t N = mapping.size();
-        const size_t value_rank = fs->value_rank();
-
-        using namespace std;
-
-        const CoordinateSystem<T> *cs = fs->coordinate_system;
-
-        // index the original
-
-        if (this->show_progress()) {
-            cout << endl << "Constructing array indexes ...";
-            start_timer();
-        }
-
-        ArrayIndex<T> *originalIndex = new ArrayIndex<T>(cs->get_dimension_sizes(), fs->points, true);
-        ArrayIndex<T> *filteredIndex = new ArrayIndex<T>(cs->get_dimension_sizes(), false);
-
-        if (this->show_progress()) {
-            cout << "done. (" << stop_timer() << "s)" << endl;
-        }
-
-        if (this->show_progress()) {
-            cout << endl << "Applying scale filter t=" << m_scale << " decay=" << m_decay << " ... " << endl;
-
-            long numPoints = 1;
-            for (size_t i = 0; i < fs->coordinate_system->rank(); i++) {
-                numPoints *= fs->coordinate_system->dimensions()[i].getSize();
-            }
-            m_progress_bar = new boost::progress_display(fs->spatial_rank() * numPoints);
-            start_timer();
+        for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+            chunk_offsets[chunk + 1] += chunk_offsets[chunk];
         }
 
-        // initialize min/max and re-set counts
-        for (size_t varIndex = 0; varIndex < value_rank; varIndex++) {
-            m_min[varIndex] = std::numeric_limits<T>::max();
-            m_max[varIndex] = std::numeric_limits<T>::min();
+        for (size_t pi = 0; pi < fs->points.size(); pi++) {
+            delete fs->points[pi];
         }
+        fs->points.assign(chunk_offsets[num_chunks], NULL);
 
-        //
-        // Apply dimension by dimension (exploiting separability)
-        //
-
-        for (size_t dimIndex = 0; dimIndex < fs->spatial_rank(); dimIndex++) {
-            apply_parallellized_on_dimension(fs, originalIndex, filteredIndex, dimIndex);
+        vector< vector<T> > chunk_min(num_chunks, vector<T>(value_rank, std::numeric_limits<T>::max()));
+        vector< vector<T> > chunk_max(num_chunks, vector<T>(value_rank, -std::numeric_limits<T>::max()));
 
-            delete originalIndex;
+#if WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+            const size_t end = (chunk + 1) * chunk_size < N ? (chunk + 1) * chunk_size : N;
+            size_t pi = chunk_offsets[chunk];
+            for (size_t i = chunk * chunk_size; i < end; i++) {
+                if (!present[i])
+                    continue;
 
-            if (dimIndex < (fs->spatial_rank() - 1)) {
-                originalIndex = filteredIndex;
+                vector<int> gridpoint = mapping.linear_to_grid(i);
+                typename CoordinateSystem<T>::Coordinate coordinate(spatial_rank);
+                cs->lookup(gridpoint, coordinate);
+                vector<T> values = coordinate;
+                values.resize(spatial_rank + value_rank);
+                for (size_t vi = 0; vi < value_rank; vi++) {
+                    T value = data[vi * N + i];
+                    values[spatial_rank + vi] = value;
+                    if (value < chunk_min[chunk][vi])
+                        chunk_min[chunk][vi] = value;
+                    if (value > chunk_max[chunk][vi])
+                        chunk_max[chunk][vi] = value;
+                }
 
-                filteredIndex = new ArrayIndex<T>(cs->get_dimension_sizes(), false);
+                typename Point<T>::ptr p = PointFactory<T>::get_instance()->create(gridpoint, coordinate, values);
+                p->isOriginalPoint = (original[i] != 0);
+                fs->points[pi++] = p;
             }
         }
 
-        // replace the points in the original with the filtered
-        // array index results
-
-        filteredIndex->replace_points(fs->points);
+        // filtered value ranges
 
-        size_t originalPoints = 0;
-        for (size_t i = 0; i < fs->points.size(); i++) {
-            if (fs->points[i]->isOriginalPoint) originalPoints++;
+        for (size_t vi = 0; vi < value_rank; vi++) {
+            m_min[vi] = std::numeric_limits<T>::max();
+            m_max[vi] = -std::numeric_limits<T>::max();
+            for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+                if (chunk_min[chunk][vi] < m_min[vi])
+                    m_min[vi] = chunk_min[chunk][vi];
+                if (chunk_max[chunk][vi] > m_max[vi])
+                    m_max[vi] = chunk_max[chunk][vi];
+            }
         }
 
         if (this->show_progress()) {
+            size_t originalPoints = fs->count_original_points();
             cout << "done. (" << stop_timer() << "s)" << endl;
             cout << "Filtered featurespace contains " << fs->size() << " points (" << originalPoints << " original points, "
                     << "(" << (fs->size() - originalPoints) << " new points))" << endl;
-            delete m_progress_bar;
-            m_progress_bar = NULL;
         }
-
-        // Clean up
-
-        delete filteredIndex;
     }
 
     template <typename T>
@@ -640,9 +287,8 @@ namespace m3D {
     {
         this->m_unfiltered_min = fs->min();
         this->m_unfiltered_max = fs->max();
-        //this->applyWithArrayIndex(fs);
 
-        this->apply_parallellized(fs);
+        this->apply_separable(fs);
     }
 
 #pragma mark -
@@ -0,0 +1,259 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_SEPARABLE_CONVOLUTION_H
+#define M3D_SEPARABLE_CONVOLUTION_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+
+#include <cstring>
+#include <vector>
+
+namespace m3D {
+
+    using namespace std;
+
+    /** Applies a separable, symmetric convolution to flat arrays
+     * in row-major order, one axis at a time. The kernel for each 
+     * axis is given as sampled values by distance (kernel[0] is the 
+     * center, kernel[d] the value at distance d), and the window is
+     * truncated at the borders of the array.
+     *
+     * Passes along a strided axis are run in tiles of 
+     * SCALE_SPACE_TILE_SIZE contiguous elements, so that the rows 
+     * of the window stay in cache and the innermost loops are
+     * contiguous and can be vectorized.
+     */
+    template <typename T>
+    class SeparableConvolution
+    {
+    private:
+
+        vector<size_t> m_dimensions;
+        vector< vector<T> > m_kernels;
+        size_t m_size;
+
+        /** Calculates the geometry of a pass along the given axis.
+         * @param axis
+         * @param number of slices before the axis (filled)
+         * @param length of the axis (filled)
+         * @param stride of the axis (filled)
+         */
+        void
+        geometry(size_t axis, size_t &outer, size_t &n, size_t &stride) const
+        {
+            outer = 1;
+            for (size_t i = 0; i < axis; i++) {
+                outer *= m_dimensions[i];
+            }
+            n = m_dimensions[axis];
+            stride = 1;
+            for (size_t i = axis + 1; i < m_dimensions.size(); i++) {
+                stride *= m_dimensions[i];
+            }
+        }
+
+    public:
+
+#pragma mark -
+#pragma mark Constructor
+
+        /** @param dimension sizes of the arrays
+         * @param one kernel per dimension, sampled by distance. An
+         * empty kernel leaves the data unchanged along that axis.
+         */
+        SeparableConvolution(const vector<size_t> &dimensions,
+                const vector< vector<T> > &kernels)
+        : m_dimensions(dimensions)
+        , m_kernels(kernels)
+        , m_size(1)
+        {
+            for (size_t i = 0; i < m_dimensions.size(); i++) {
+                m_size *= m_dimensions[i];
+            }
+        }
+
+#pragma mark -
+#pragma mark Accessors
+
+        /** @return number of elements in the arrays */
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        const vector<size_t> &dimensions() const
+        {
+            return m_dimensions;
+        }
+
+#pragma mark -
+#pragma mark Passes
+
+        /** Convolves the data along the given axis.
+         * @param axis
+         * @param input (size() elements)
+         * @param output (size() elements, must not overlap input)
+         */
+        void
+        convolve(size_t axis, const T *in, T *out) const
+        {
+            const vector<T> &g = m_kernels[axis];
+            if (g.empty()) {
+                memcpy(out, in, m_size * sizeof(T));
+                return;
+            }
+
+            const long w = g.size() - 1;
+            size_t outer, n, stride;
+            this->geometry(axis, outer, n, stride);
+
+            if (stride == 1) {
+                // Contiguous axis. Accumulate the row, shifted
+                // by each offset within the window.
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+                for (size_t o = 0; o < outer; o++) {
+                    const T *src = in + o * n;
+                    T *dst = out + o * n;
+                    for (size_t k = 0; k < n; k++) {
+                        dst[k] = 0.0;
+                    }
+                    for (long d = -w; d <= w; d++) {
+                        const T gd = g[d < 0 ? -d : d];
+                        const long k_begin = d < 0 ? -d : 0;
+                        const long k_end = d > 0 ? (long) n - d : (long) n;
+                        for (long k = k_begin; k < k_end; k++) {
+                            dst[k] += gd * src[k + d];
+                        }
+                    }
+                }
+            } else {
+                const size_t tile = SCALE_SPACE_TILE_SIZE;
+                const size_t tiles = (stride + tile - 1) / tile;
+#if WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+                for (size_t t = 0; t < outer * tiles; t++) {
+                    const size_t o = t / tiles;
+                    const size_t j0 = (t % tiles) * tile;
+                    const size_t jn = (stride - j0 < tile) ? (stride - j0) : tile;
+                    const T *src = in + o * n * stride + j0;
+                    T *dst = out + o * n * stride + j0;
+                    for (long k = 0; k < (long) n; k++) {
+                        T *dk = dst + k * stride;
+                        for (size_t j = 0; j < jn; j++) {
+                            dk[j] = 0.0;
+                        }
+                        const long lo = (k - w > 0) ? (k - w) : 0;
+                        const long hi = (k + w < (long) n - 1) ? (k + w) : ((long) n - 1);
+                        for (long i = lo; i <= hi; i++) {
+                            const T gd = g[i < k ? k - i : i - k];
+                            const T *si = src + i * stride;
+                            for (size_t j = 0; j < jn; j++) {
+                                dk[j] += gd * si[j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        /** Dilates a 0/1 mask along the given axis: an element is set
+         * in the output, if any element within the window of the
+         * kernel is set in the input.
+         * @param axis
+         * @param input (size() elements)
+         * @param output (size() elements, must not overlap input)
+         */
+        void
+        dilate(size_t axis, const unsigned char *in, unsigned char *out) const
+        {
+            const vector<T> &g = m_kernels[axis];
+            if (g.empty()) {
+                memcpy(out, in, m_size);
+                return;
+            }
+
+            const long w = g.size() - 1;
+            size_t outer, n, stride;
+            this->geometry(axis, outer, n, stride);
+
+            if (stride == 1) {
+                // Contiguous axis. Slide the window along the row,
+                // counting the set elements within it.
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+                for (size_t o = 0; o < outer; o++) {
+                    const unsigned char *src = in + o * n;
+                    unsigned char *dst = out + o * n;
+                    long count = 0;
+                    for (long i = 0; i <= w && i < (long) n; i++) {
+                        count += (src[i] != 0);
+                    }
+                    for (long k = 0; k < (long) n; k++) {
+                        dst[k] = (count > 0) ? 1 : 0;
+                        if (k - w >= 0) {
+                            count -= (src[k - w] != 0);
+                        }
+                        if (k + w + 1 < (long) n) {
+                            count += (src[k + w + 1] != 0);
+                        }
+                    }
+                }
+            } else {
+                const size_t tile = SCALE_SPACE_TILE_SIZE;
+                const size_t tiles = (stride + tile - 1) / tile;
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+                for (size_t t = 0; t < outer * tiles; t++) {
+                    const size_t o = t / tiles;
+                    const size_t j0 = (t % tiles) * tile;
+                    const size_t jn = (stride - j0 < tile) ? (stride - j0) : tile;
+                    const unsigned char *src = in + o * n * stride + j0;
+                    unsigned char *dst = out + o * n * stride + j0;
+                    for (long k = 0; k < (long) n; k++) {
+                        unsigned char *dk = dst + k * stride;
+                        for (size_t j = 0; j < jn; j++) {
+                            dk[j] = 0;
+                        }
+                        const long lo = (k - w > 0) ? (k - w) : 0;
+                        const long hi = (k + w < (long) n - 1) ? (k + w) : ((long) n - 1);
+                        for (long i = lo; i <= hi; i++) {
+                            const unsigned char *si = src + i * stride;
+                            for (size_t j = 0; j < jn; j++) {
+                                dk[j] |= si[j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    };
+}
+
+#endif
@@ -45,7 +45,7 @@
 #include<meanie3D/operations/kernels_impl.h>
 #include<meanie3D/operations/meanshift_op_impl.h>
 #include<meanie3D/tracking/tracking_impl.h>
-#include<meanie3D/utils/cluster_index_impl.h>
+#include<meanie3D/utils/cluster_overlap_impl.h>
 #include<meanie3D/utils/matrix_impl.h>
 #include<meanie3D/utils/visit_impl.h>
 #include<meanie3D/weights/weight_function_factory_impl.h>
@@ -62,12 +62,52 @@ namespace m3D {
          */
         vector<size_t> m_index_variable_indexes;
 
+        /** The ranges the index was last built with. Only valid
+         * if m_built is true.
+         */
+        vector<T> m_built_ranges;
+
+        /** Flag indicating that the index structure is up to date
+         */
+        bool m_built;
+
         /** Debugging method. Writes out the search window and found points to files.
          */
         void
         write_search(const vector<T>& x,
                 const vector<T> &ranges,
-                typename Point<T>::list *result);
+                const typename Point<T>::list *result) const;
+
+        /** Makes sure the index was built for the given ranges. If
+         * it was not, the index is built lazily. This fallback exists
+         * for serial callers only: called from within a parallel region
+         * on an index that was not built for the ranges, it throws
+         * std::logic_error. Callers searching from several threads
+         * must call build(..) up front with the same parameters they
+         * search with, after which the check only reads the index.
+         *
+         * @throws std::logic_error
+         * @param ranges
+         */
+        void
+        ensure_built(const vector<T> &ranges) const;
+
+        /** Marks the index as out of date. Subclasses call this when
+         * points are added or removed.
+         */
+        inline
+        void invalidate()
+        {
+            m_built = false;
+        }
+
+        /** @param search parameters
+         * @return the ranges an index has to be built with to serve
+         * searches with the given parameters (bandwidth for range
+         * searches, 1.0 in each dimension otherwise)
+         */
+        vector<T>
+        build_ranges(const SearchParameters *params) const;
 
     public:
 
@@ -103,6 +143,22 @@ namespace m3D {
 
         } IndexType;
 
+        /** Per-thread scratch buffers for searches. Each thread
+         * searching the index should hold its own instance and hand
+         * it to search_into(..) with every query. Implementations
+         * keep their intermediate results (grid point of the search
+         * origin, hit lists) in it, so that after the first few queries
+         * no further heap allocation takes place.
+         */
+        struct SearchScratch
+        {
+            /** Grid point of the search origin */
+            vector<int> gridpoint;
+
+            /** Indexes of the points found */
+            vector<size_t> hits;
+        };
+
 #pragma mark -
 #pragma mark Defaults
 
@@ -110,10 +166,44 @@ namespace m3D {
          */
         static const IndexType DefaultIndexType = IndexTypeFLANN;
 
+#pragma mark -
+#pragma mark Building
+
+        /** Builds the index structure for searches with the given
+         * parameters. After this call, search(..) and search_into(..)
+         * with the same parameters do not modify the index and can
+         * be called concurrently from any number of threads. Adding
+         * or removing points requires building again.
+         *
+         * @param search parameters the index will be queried with
+         */
+        void
+        build(const SearchParameters *params);
+
+        /** @return true if the index was built and can serve searches
+         * with the given parameters without (re-)building.
+         */
+        bool
+        is_built_for(const SearchParameters *params) const;
+
+        /** Points the index to the points of another feature-space on
+         * the same grid, as in the steps of a series. The index has to
+         * be built again before searching, but implementations may keep
+         * what does not depend on the points, such as allocated arrays
+         * or search stencils.
+         *
+         * @param feature-space
+         */
+        virtual
+        void
+        reset(FeatureSpace<T> *fs);
+
 #pragma mark -
 #pragma mark Public Abstract Methods
 
         /** Searches the index according to the given search parameters.
+         * The search is const and reentrant, provided the index was
+         * built for the given parameters (see build(..)).
          * @abstract
          * @param x
          * @param search parameters
@@ -122,7 +212,43 @@ namespace m3D {
          */
         virtual
         typename Point<T>::list *
-        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL) = 0;
+        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL) const = 0;
+
+        /** Searches the index according to the given search parameters and
+         * writes the result into a caller-owned list. The list is cleared
+         * first, but keeps its capacity. Re-using the same list for many
+         * searches therefore avoids a heap allocation per query. The default
+         * implementation delegates to search(..) and copies the result.
+         * 
+         * @param x
+         * @param search parameters
+         * @param result list (cleared and filled in place)
+         * @param distances (optional, cleared and filled in place)
+         */
+        virtual
+        void
+        search_into(const vector<T> &x,
+                const SearchParameters *params,
+                typename Point<T>::list &result,
+                vector<T> *distances = NULL) const;
+
+        /** Same as search_into(..) above, but keeps all intermediate
+         * results in the given scratch buffers. The default
+         * implementation ignores the scratch buffers.
+         *
+         * @param x
+         * @param search parameters
+         * @param result list (cleared and filled in place)
+         * @param scratch buffers (per thread)
+         * @param distances (optional, cleared and filled in place)
+         */
+        virtual
+        void
+        search_into(const vector<T> &x,
+                const SearchParameters *params,
+                typename Point<T>::list &result,
+                SearchScratch &scratch,
+                vector<T> *distances = NULL) const;
 
         /** Add a new point to the index. If the point already exists, it is
          * replaced with the new point
@@ -162,7 +288,7 @@ namespace m3D {
          * @return true or false
          */
         bool
-        has_value(vector<T> &value);
+        has_value(vector<T> &value) const;
 
         /** Picks the component defined by the index variables 
          * from the given point's values.
@@ -170,19 +296,19 @@ namespace m3D {
          * @return vector for search
          */
         vector<T>
-        indexed_components(typename Point<T>::ptr p);
+        indexed_components(typename Point<T>::ptr p) const;
 
         /** Accesor
          * @return feature space
          */
         inline
-        const FeatureSpace<T> *feature_space()
+        const FeatureSpace<T> *feature_space() const
         {
             return m_fs;
         };
 
         inline
-        const vector<size_t> index_variable_indexes()
+        const vector<size_t> index_variable_indexes() const
         {
             return m_index_variable_indexes;
         }
@@ -190,7 +316,7 @@ namespace m3D {
         /** @return dimensionality of index
          */
         inline
-        const size_t dimension()
+        size_t dimension() const
         {
             return m_index_variable_indexes.size();
         }
@@ -198,7 +324,7 @@ namespace m3D {
         /** @return size of index (number of indexed points)
          */
         inline
-        size_t size()
+        size_t size() const
         {
             return this->m_points->size();
         }
@@ -240,6 +366,25 @@ namespace m3D {
                 const vector<size_t> &indexes,
                 IndexType index_type = DefaultIndexType);
 
+        /** Creates an index for all points of the given feature-space,
+         * using all variables. This is required for index types that
+         * make use of the coordinate system (IndexTypeRectilinearGrid).
+         * @param feature-space
+         * @param index type
+         */
+        static PointIndex<T> *
+        create(FeatureSpace<T> *fs,
+                IndexType index_type = DefaultIndexType);
+
+        /** Maps a name ('linear','kdtree','flann','grid') to the
+         * corresponding index type.
+         * @param name
+         * @return index type
+         * @throws std::invalid_argument if the name is not known
+         */
+        static IndexType
+        index_type_from_name(const std::string &name);
+
 
 #pragma mark -
 #pragma mark Protected Constructors
@@ -255,6 +400,7 @@ namespace m3D {
         PointIndex(typename Point<T>::list *points, size_t dimension)
         : m_points(points)
         , m_fs(NULL)
+        , m_built(false)
         {
             this->m_index_variable_indexes = vector<size_t>(dimension);
 
@@ -273,6 +419,7 @@ namespace m3D {
         : m_points(points)
         , m_fs(NULL)
         , m_index_variable_indexes(indexes)
+        , m_built(false)
         {
         };
 
@@ -282,6 +429,7 @@ namespace m3D {
         PointIndex(FeatureSpace<T> *fs)
         : m_points(&fs->points)
         , m_fs(fs)
+        , m_built(false)
         {
             this->retrieve_variables_indexes();
         };
@@ -292,6 +440,7 @@ namespace m3D {
         : m_points(o.m_points)
         , m_fs(o.m_fs)
         , m_index_variable_indexes(o.index_variable_indexes())
+        , m_built(false)
         {
         };
 
@@ -27,10 +27,12 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/index.h>
+#include <meanie3D/parallel.h>
 #include <meanie3D/utils/visit.h>
 
 #include <exception>
 #include <algorithm>
+#include <stdexcept>
 
 #include <boost/lexical_cast.hpp>
 
@@ -99,12 +101,168 @@ namespace m3D {
         return instance;
     }
 
+    template <typename T>
+    PointIndex<T> *
+    PointIndex<T>::create(FeatureSpace<T> *fs, IndexType index_type)
+    {
+        PointIndex<T> *instance = NULL;
+
+        switch (index_type) {
+            case IndexTypeLinear:
+                instance = new LinearIndex<T>(fs);
+                break;
+
+            case IndexTypeFLANN:
+                instance = new FLANNIndex<T>(fs);
+                break;
+
+            case IndexTypeKDTree:
+                instance = new KDTreeIndex<T>(fs);
+                break;
+
+            case IndexTypeRectilinearGrid:
+                instance = new RectilinearGridIndex<T>(fs);
+                break;
+        }
+
+        return instance;
+    }
+
+    template <typename T>
+    typename PointIndex<T>::IndexType
+    PointIndex<T>::index_type_from_name(const std::string &name)
+    {
+        if (name == "linear") {
+            return IndexTypeLinear;
+        } else if (name == "kdtree") {
+            return IndexTypeKDTree;
+        } else if (name == "flann") {
+            return IndexTypeFLANN;
+        } else if (name == "grid") {
+            return IndexTypeRectilinearGrid;
+        }
+
+        throw std::invalid_argument("unknown index type '" + name + "'");
+    }
+
+#pragma mark -
+#pragma mark Building
+
+    template <typename T>
+    vector<T>
+    PointIndex<T>::build_ranges(const SearchParameters *params) const
+    {
+        if (params->search_type() == SearchTypeRange) {
+            const RangeSearchParams<T> *p = (const RangeSearchParams<T> *) params;
+            return p->bandwidth;
+        }
+
+        return vector<T>(this->dimension(), 1.0);
+    }
+
     template <typename T>
     void
-    PointIndex<T>::write_search(const vector<T>& x, const vector<T> &ranges, typename Point<T>::list *result)
+    PointIndex<T>::build(const SearchParameters *params)
+    {
+        vector<T> ranges = this->build_ranges(params);
+
+        this->build_index(ranges);
+
+        m_built_ranges = ranges;
+
+        m_built = true;
+    }
+
+    template <typename T>
+    void
+    PointIndex<T>::reset(FeatureSpace<T> *fs)
+    {
+        m_fs = fs;
+
+        m_points = &fs->points;
+
+        this->invalidate();
+    }
+
+    template <typename T>
+    bool
+    PointIndex<T>::is_built_for(const SearchParameters *params) const
+    {
+        return m_built && m_built_ranges == this->build_ranges(params);
+    }
+
+    template <typename T>
+    void
+    PointIndex<T>::ensure_built(const vector<T> &ranges) const
+    {
+        if (m_built && m_built_ranges == ranges) {
+            return;
+        }
+
+#if WITH_OPENMP
+        // Building while other threads may be searching would be a
+        // data race, no matter how the build itself is guarded.
+
+        if (omp_in_parallel()) {
+            throw std::logic_error("PointIndex was not built for the search parameters. Call build(..) before searching from a parallel region.");
+        }
+#endif
+
+        PointIndex<T> *self = const_cast<PointIndex<T> *> (this);
+
+        self->build_index(ranges);
+
+        self->m_built_ranges = ranges;
+
+        self->m_built = true;
+    }
+
+#pragma mark -
+#pragma mark Searching
+
+    template <typename T>
+    void
+    PointIndex<T>::search_into(const vector<T> &x,
+            const SearchParameters *params,
+            typename Point<T>::list &result,
+            vector<T> *distances) const
+    {
+        result.clear();
+        if (distances != NULL) {
+            distances->clear();
+        }
+
+        typename Point<T>::list *sample = this->search(x, params, distances);
+        if (sample != NULL) {
+            result.insert(result.end(), sample->begin(), sample->end());
+            delete sample;
+        }
+    }
+
+    template <typename T>
+    void
+    PointIndex<T>::search_into(const vector<T> &x,
+            const SearchParameters *params,
+            typename Point<T>::list &result,
+            SearchScratch &scratch,
+            vector<T> *distances) const
+    {
+        this->search_into(x, params, result, distances);
+    }
+
+    template <typename T>
+    void
+    PointIndex<T>::write_search(const vector<T>& x, const vector<T> &ranges, const typename Point<T>::list *result) const
     {
         static size_t search_count = 0;
 
+        size_t count;
+
+#if WITH_OPENMP
+#pragma omp critical(m3D_point_index_write_search)
+#endif
+        count = search_count++;
+
         size_t dim = x.size();
 
         // Write search window
@@ -113,7 +271,7 @@ namespace m3D {
 
         string extension = (dim == 2 ? ".curve" : ".3D");
 
-        string fn = "search_window_" + boost::lexical_cast<string>(search_count) + extension;
+        string fn = "search_window_" + boost::lexical_cast<string>(count) + extension;
 
         if (dim == 3) {
 #if WITH_VTK
@@ -126,10 +284,9 @@ namespace m3D {
         }
 
 #if WITH_VTK
-        fn = "search_result_" + boost::lexical_cast<string>(search_count) + ".vtk";
-        VisitUtils<T>::write_pointlist_vtk(fn, result, dim, "search_result");
+        fn = "search_result_" + boost::lexical_cast<string>(count) + ".vtk";
+        VisitUtils<T>::write_pointlist_vtk(fn, const_cast<typename Point<T>::list *> (result), dim, "search_result");
 #endif
-        search_count++;
     }
 
     template <typename T>
@@ -148,7 +305,7 @@ namespace m3D {
 
     template <typename T>
     vector<T>
-    PointIndex<T>::indexed_components(typename Point<T>::ptr p)
+    PointIndex<T>::indexed_components(typename Point<T>::ptr p) const
     {
         vector<T> result(m_index_variable_indexes.size());
 
@@ -175,12 +332,14 @@ namespace m3D {
             have_point = (result->front() == p);
         }
 
+        delete result;
+
         return have_point;
     }
 
     template <typename T>
     bool
-    PointIndex<T>::has_value(vector<T> &x)
+    PointIndex<T>::has_value(vector<T> &x) const
     {
         bool have_point = false;
 
@@ -194,6 +353,8 @@ namespace m3D {
             have_point = (xr == x);
         }
 
+        delete result;
+
         return have_point;
     }
 }
@@ -107,7 +107,7 @@ namespace m3D {
 
         virtual
         typename Point<T>::list *
-        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL) = 0;
+        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL) const = 0;
 
         virtual
         void
@@ -204,7 +204,7 @@ namespace m3D {
          * @param vector
          * @return vector
          */
-        vector<T> transform_vector(const vector<T> &x)
+        vector<T> transform_vector(const vector<T> &x) const
         {
             vector<T> r(x.size());
 
@@ -99,7 +99,7 @@ namespace m3D {
             }
 
             if (m_dataset.ptr()) {
-                delete[] m_dataset.ptr();
+                free(m_dataset.ptr());
             }
         };
 
@@ -182,23 +182,27 @@ namespace m3D {
         }
 
         typename Point<T>::list *
-        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL)
+        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL) const
         {
-            // Check if the index needs re-building
-
-            vector<T> h;
-
-            if (params->search_type() == SearchTypeRange) {
-                RangeSearchParams<T> *p = (RangeSearchParams<T> *) params;
+            typename Point<T>::list * result = new typename Point<T>::list();
+            this->search_into(x, params, *result, distances);
+            return result;
+        }
 
-                h = p->bandwidth;
-            } else {
-                h = vector<T>(x.size(), 1.0);
+        void
+        search_into(const vector<T> &x,
+                const SearchParameters *params,
+                typename Point<T>::list &result,
+                vector<T> *distances = NULL) const
+        {
+            result.clear();
+            if (distances != NULL) {
+                distances->clear();
             }
 
-            if (this->white_range != h || m_index == NULL) {
-                build_index(h);
-            }
+            // Check if the index needs re-building
+
+            this->ensure_built(this->build_ranges(params));
 
             // FLANN Search Parameters
 
@@ -228,18 +232,16 @@ namespace m3D {
             }
 
             // re-wrap results
-            typename Point<T>::list * result = new typename Point<T>::list();
             for (size_t row = 0; row < indices.size(); row++) {
-                vector <int> _indices = indices[row];
+                const vector <int> &_indices = indices[row];
                 for (size_t col = 0; col < _indices.size(); col++) {
-                    typename Point<T>::ptr p = this->m_points->at(_indices[col]);
-                    result->push_back(p);
+                    result.push_back(this->m_points->at(_indices[col]));
                 }
             }
 
             if (distances) {
                 for (size_t row = 0; row < dists.size(); row++) {
-                    vector <T> _dists = dists[row];
+                    const vector <T> &_dists = dists[row];
                     for (size_t col = 0; col < _dists.size(); col++) {
                         distances->push_back((T) _dists[ col ]);
                     }
@@ -249,14 +251,12 @@ namespace m3D {
             if (PointIndex<T>::write_index_searches) {
                 if (params->search_type() == SearchTypeRange) {
                     RangeSearchParams<T> *p = (RangeSearchParams<T> *) params;
-                    this->write_search(x, p->bandwidth, result);
+                    this->write_search(x, p->bandwidth, &result);
                 } else {
                     vector<T> white_ranges(x_t.size(), this->white_radius);
-                    this->write_search(x_t, white_ranges, result);
+                    this->write_search(x_t, white_ranges, &result);
                 }
             }
-
-            return result;
         }
 
 #pragma mark
@@ -285,6 +285,10 @@ namespace m3D {
          */
         void construct_dataset()
         {
+            if (m_dataset.ptr()) {
+                free(m_dataset.ptr());
+            }
+
             // re-package data for FLANN
             size_t count = this->size() * this->dimension();
             T* data = (T *) malloc(count * sizeof (T));
@@ -170,26 +170,37 @@ namespace m3D {
         }
 
         typename Point<T>::list *
-        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL)
+        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL) const
+        {
+            typename Point<T>::list *result = new typename Point<T>::list();
+            this->search_into(x, params, *result, distances);
+            return result;
+        }
+
+        void
+        search_into(const vector<T> &x,
+                const SearchParameters *params,
+                typename Point<T>::list &result,
+                vector<T> *distances = NULL) const
         {
             if (params->search_type() == SearchTypeKNN) {
                 std::cerr << "FATAL:KNN not supported by KDTree yet" << std::endl;
                 exit(EXIT_FAILURE);
             }
 
-            // Check if the index needs re-building
+            result.clear();
+            if (distances != NULL) {
+                distances->clear();
+            }
 
-            if (params->search_type() == SearchTypeRange) {
-                RangeSearchParams<T> *p = (RangeSearchParams<T> *) & params;
+            // Check if the index needs re-building
 
-                if (this->white_range != p->bandwidth || m_index == NULL) {
-                    build_index(p->bandwidth);
-                }
-            }
+            this->ensure_built(this->build_ranges(params));
 
-            // Compile the sample
+            // Compile the sample. kd_nearest_range allocates its
+            // own result set and does not modify the tree, which
+            // makes concurrent searches safe.
 
-            typename Point<T>::list *result = new typename Point<T>::list();
             struct kdres *presults;
 
             // tranform coordinate
@@ -206,30 +217,21 @@ namespace m3D {
             // Re-package results
             while (!kd_res_end(presults)) {
                 typename Point<T>::ptr ptr = (typename Point<T>::ptr) kd_res_item(presults, &pos[0]);
-                result->push_back(ptr);
+                result.push_back(ptr);
                 kd_res_next(presults);
             }
 
-            // calculate distances
-//            if (distances != NULL) {
-//                typename Point<T>::list::iterator li;
-//                for (li = result->begin(); li != result->end(); li++) {
-//                    vector<T> dx = vector_subtract(<#vector<T> &v1#>, <#vector<T> &v2#>);
-//                }
-//            }
-
             kd_res_free(presults);
 
             if (PointIndex<T>::write_index_searches) {
                 if (params->search_type() == SearchTypeRange) {
                     RangeSearchParams<T> *p = (RangeSearchParams<T> *) params;
-                    this->write_search(x, p->bandwidth, result);
+                    this->write_search(x, p->bandwidth, &result);
                 } else {
                     vector<T> white_ranges(xt.size(), this->white_radius);
-                    this->write_search(xt, white_ranges, result);
+                    this->write_search(xt, white_ranges, &result);
                 }
             }
-            return result;
         }
     };
 }
@@ -28,6 +28,7 @@
 #include <meanie3D/namespaces.h>
 #include <meanie3D/index.h>
 #include <meanie3D/featurespace/point.h>
+#include <meanie3D/featurespace/point_store.h>
 
 #include <iostream>
 #include <algorithm>
@@ -35,42 +36,50 @@
 namespace m3D {
 
     /** Implementation of FeatureSpace which simply searches the feature-space vector
-     * brute-force style when sampling around points.
-     * 
-     * TODO: this implementation is NOT UP TO DATE
+     * brute-force style when sampling around points. The values are copied
+     * into columns (PointStore) when the index is built, which makes the
+     * distance calculations contiguous per component.
      */
     template <typename T>
     class LinearIndex : public PointIndex<T>
     {
         friend class PointIndex<T>;
 
+    private:
+
+        /** Columnar copy of the indexed points */
+        PointStore<T> m_store;
+
+        /** Flag indicating that the store needs re-building */
+        bool m_store_valid;
+
     protected:
 
 #pragma mark -
 #pragma mark Constructor/Destructor
 
         inline
-        LinearIndex(typename Point<T>::list *points, size_t dimension) : PointIndex<T>(points, dimension)
+        LinearIndex(typename Point<T>::list *points, size_t dimension) : PointIndex<T>(points, dimension), m_store_valid(false)
         {
         };
 
         inline
-        LinearIndex(typename Point<T>::list *points, const vector<size_t> &indexes) : PointIndex<T>(points, indexes)
+        LinearIndex(typename Point<T>::list *points, const vector<size_t> &indexes) : PointIndex<T>(points, indexes), m_store_valid(false)
         {
         };
 
         inline
-        LinearIndex(FeatureSpace<T> *fs) : PointIndex<T>(fs)
+        LinearIndex(FeatureSpace<T> *fs) : PointIndex<T>(fs), m_store_valid(false)
         {
         };
 
         inline
-        LinearIndex(FeatureSpace<T> *fs, const vector<netCDF::NcVar> &index_variables) : PointIndex<T>(fs, index_variables)
+        LinearIndex(FeatureSpace<T> *fs, const vector<netCDF::NcVar> &index_variables) : PointIndex<T>(fs, index_variables), m_store_valid(false)
         {
         };
 
         inline
-        LinearIndex(const LinearIndex<T> &o) : PointIndex<T>(o)
+        LinearIndex(const LinearIndex<T> &o) : PointIndex<T>(o), m_store_valid(false)
         {
         };
 
@@ -80,9 +89,14 @@ namespace m3D {
         void
         build_index(const vector<T> &ranges)
         {
-            // nothing to do. Index is the feature space itself
+            // Index is the columnar copy of the points. It does
+            // not depend on the ranges.
 
-            // TODO: construct feature space from index variables
+            if (!m_store_valid) {
+                m_store.gather(*this->m_points, 0);
+
+                m_store_valid = true;
+            }
         };
 
     public:
@@ -105,75 +119,95 @@ namespace m3D {
 #pragma mark -
 #pragma mark Overwritten Public Methods
 
-        typename Point<T>::list *
-        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL)
+        void
+        reset(FeatureSpace<T> *fs)
         {
-            using std::cerr;
-            using std::endl;
+            PointIndex<T>::reset(fs);
 
-            typename Point<T>::list *result = new typename Point<T>::list();
+            m_store_valid = false;
+        }
 
-            // Test if a point is within the given ellipsoid
+        typename Point<T>::list *
+        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL) const
+        {
+            typename Point<T>::list *result = new typename Point<T>::list();
+            this->search_into(x, params, *result, distances);
+            return result;
+        };
 
-            // x1^2/a1^2 + .... + xn^2/an^2 <= 1
+        void
+        search_into(const vector<T> &x,
+                const SearchParameters *params,
+                typename Point<T>::list &result,
+                vector<T> *distances = NULL) const
+        {
+            typename PointIndex<T>::SearchScratch scratch;
+            this->search_into(x, params, result, scratch, distances);
+        }
 
-            // pre-calculate the denominators
+        void
+        search_into(const vector<T> &x,
+                const SearchParameters *params,
+                typename Point<T>::list &result,
+                typename PointIndex<T>::SearchScratch &scratch,
+                vector<T> *distances = NULL) const
+        {
+            using std::cerr;
+            using std::endl;
 
             if (params->search_type() == SearchTypeKNN) {
-                //                KNNSearchParams *p = (KNNSearchParams *)  &params;
-
                 cerr << "FATAL:KNN is not supported yet in LinearIndex" << endl;
                 exit(EXIT_FAILURE);
             }
 
-            RangeSearchParams<T> *p = (RangeSearchParams<T> *) & params;
-
-            vector<T> coefficients(p->bandwidth);
-
-            for (size_t index = 0; index < p->bandwidth.size(); index++) {
-                coefficients[index] = 1.0 / (coefficients[index] * coefficients[index]);
+            result.clear();
+            if (distances != NULL) {
+                distances->clear();
             }
 
-            typename Point<T>::list::const_iterator it = this->m_fs->points.begin();
-
-            while (it != this->m_fs->points.end()) {
-                typename Point<T>::ptr p = *it;
+            RangeSearchParams<T> *p = (RangeSearchParams<T> *) params;
 
-                // r = x1^2/a1^2 + .... + xn^2/an^2
+            this->ensure_built(p->bandwidth);
 
-                float r = 0.0;
-
-                vector<T> coordinate = p->coordinate;
+            // Test if a point is within the given ellipsoid
+            // x1^2/a1^2 + .... + xn^2/an^2 <= 1
 
-                for (size_t index = 0; index < coordinate.size(); index++) {
-                    float dist = coordinate[index] - x[index];
+            vector<size_t> &hits = scratch.hits;
 
-                    r += (dist * dist * coefficients[index]);
-                }
+            m_store.range_search(x, p->bandwidth, this->m_index_variable_indexes, hits);
 
-                if (r <= 1.0) {
-                    result->push_back(p);
-                }
+            result.reserve(hits.size());
 
-                it++;
+            for (size_t i = 0; i < hits.size(); i++) {
+                result.push_back(m_store.point(hits[i]));
             }
 
-            return result;
+            if (PointIndex<T>::write_index_searches) {
+                this->write_search(x, p->bandwidth, &result);
+            }
         };
 
         void
         add_point(typename Point<T>::ptr p)
         {
-            this->m_fs->points.push_back(p);
+            this->m_points->push_back(p);
+
+            m_store_valid = false;
+
+            this->invalidate();
         }
 
         void
         remove_point(typename Point<T>::ptr p)
         {
-            typename Point<T>::list::iterator f = find(this->m_fs->points.begin(), this->m_fs->points.end(), p);
+            typename Point<T>::list::iterator f = find(this->m_points->begin(), this->m_points->end(), p);
+
+            if (f != this->m_points->end()) {
+                this->m_points->erase(f);
+
+                m_store_valid = false;
 
-            if (f != this->m_fs->points.end()) {
-                this->m_fs->points.erase(f);
+                this->invalidate();
             }
         }
     };
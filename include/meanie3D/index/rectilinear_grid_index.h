@@ -27,12 +27,33 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/index.h>
+#include <meanie3D/featurespace/point_store.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
 
 namespace m3D {
 
-    /** Implementation of index using ArrayIndex and searching by grid points 
-     * rather than using a KD-Tree. Condition: rectilinear and (approximately)
-     * uniform grid (in each dimension)
+    /** Implementation of index searching by grid points rather than 
+     * using a KD-Tree. Condition: rectilinear and (approximately)
+     * uniform grid (in each dimension). 
+     * 
+     * The index keeps a flat array of point ids over the whole grid
+     * and a columnar copy of the points. For each bandwidth, a stencil 
+     * of linear offsets is calculated once. It covers the spatial search
+     * ellipsoid around any position within one grid cell of the node
+     * closest to the search origin, so the origin does not have to sit
+     * on a grid node. A search visits the neighbours by adding the 
+     * stencil offsets to the linear index of that node and tests the
+     * distance on the contiguous columns of the store.
+     * 
+     * The sample is the same as a range search with a KD-Tree: all 
+     * points with sum((x_i - p_i)^2 / h_i^2) <= 1. 
+     * 
+     * Requires the first spatial_rank() index variables to be the 
+     * spatial dimensions of the feature-space's coordinate system.
      */
     template <typename T>
     class RectilinearGridIndex : public PointIndex<T>
@@ -44,7 +65,35 @@ namespace m3D {
 #pragma mark -
 #pragma mark Member variables
 
-        ArrayIndex<T> *m_index;
+        /** Columnar copy of the indexed points */
+        PointStore<T> m_store;
+
+        /** Flat (row-major) array over the grid, containing the 
+         * index of the point in m_store or -1 for empty cells.
+         */
+        vector<int> m_grid;
+
+        /** Grid dimensions and strides */
+        vector<size_t> m_dim_sizes;
+        vector<size_t> m_strides;
+
+        /** Flag indicating if the grid needs (re-)building */
+        bool m_grid_valid;
+
+        /** Bandwidth the stencil was calculated for */
+        vector<T> m_stencil_bandwidth;
+
+        /** Maximum offset in grid points per dimension */
+        vector<int> m_stencil_extent;
+
+        /** Offsets in grid points, spatial_rank() entries per element */
+        vector<int> m_stencil_offsets;
+
+        /** Linear offset per stencil element */
+        vector<long> m_stencil_linear;
+
+        /** 1/h^2 per index dimension (0 where h is 0) */
+        vector<T> m_stencil_coefficients;
 
     protected:
 
@@ -52,22 +101,22 @@ namespace m3D {
 #pragma mark Protected Constructor/Destructor
 
         inline
-        RectilinearGridIndex(typename Point<T>::list *points, size_t dimension) : PointIndex<T>(points, dimension), m_index(NULL)
+        RectilinearGridIndex(typename Point<T>::list *points, size_t dimension) : PointIndex<T>(points, dimension), m_grid_valid(false)
         {
         };
 
         inline
-        RectilinearGridIndex(typename Point<T>::list *points, const vector<size_t> &indexes) : PointIndex<T>(points, indexes), m_index(NULL)
+        RectilinearGridIndex(typename Point<T>::list *points, const vector<size_t> &indexes) : PointIndex<T>(points, indexes), m_grid_valid(false)
         {
         };
 
         inline
-        RectilinearGridIndex(FeatureSpace<T> *fs) : PointIndex<T>(fs), m_index(NULL)
+        RectilinearGridIndex(FeatureSpace<T> *fs) : PointIndex<T>(fs), m_grid_valid(false)
         {
         };
 
         inline
-        RectilinearGridIndex(FeatureSpace<T> *fs, const vector<netCDF::NcVar> &index_variables) : PointIndex<T>(fs, index_variables), m_index(NULL)
+        RectilinearGridIndex(FeatureSpace<T> *fs, const vector<netCDF::NcVar> &index_variables) : PointIndex<T>(fs, index_variables), m_grid_valid(false)
         {
         };
 
@@ -78,11 +127,6 @@ namespace m3D {
 
         ~RectilinearGridIndex()
         {
-            if (m_index != NULL) {
-                delete m_index;
-
-                m_index = NULL;
-            }
         };
 
 #pragma mark -
@@ -98,19 +142,20 @@ namespace m3D {
         void
         build_index(const vector<T> &ranges)
         {
-            // Dispose of previous indexes but inform user
-
-            if (m_index != NULL) {
-                cerr << "WARNING:called RectilinearGridIndex::build_index twice. Disposing of previous array index" << endl;
+            if (this->m_fs == NULL) {
+                throw std::logic_error("RectilinearGridIndex requires a feature-space (use PointIndex::create(FeatureSpace*,...))");
+            }
 
-                delete m_index;
+            // The grid does not depend on the ranges, only
+            // the stencil has to be re-calculated
 
-                m_index = NULL;
+            if (!m_grid_valid) {
+                this->build_grid();
             }
 
-            vector<size_t> dimensions = this->m_fs->coordinate_system->get_dimension_sizes();
-
-            m_index = new ArrayIndex<T>(dimensions, this->m_fs->points, false);
+            if (!ranges.empty() && ranges != m_stencil_bandwidth) {
+                this->build_stencil(ranges);
+            }
         }
 
     public:
@@ -118,48 +163,104 @@ namespace m3D {
 #pragma mark -
 #pragma mark Overwritten Public Methods
 
+        /** Keeps the grid array and the stencil, if the new
+         * feature-space lives on the same coordinate system.
+         */
+        void
+        reset(FeatureSpace<T> *fs)
+        {
+            if (this->m_fs == NULL || fs->coordinate_system != this->m_fs->coordinate_system) {
+                m_stencil_bandwidth.clear();
+            }
+
+            PointIndex<T>::reset(fs);
+
+            m_grid_valid = false;
+        }
+
         void
         remove_point(typename Point<T>::ptr p)
         {
-            m_index->set(p->gridpoint, NULL);
+            typename Point<T>::list::iterator f = find(this->m_points->begin(), this->m_points->end(), p);
+
+            if (f != this->m_points->end()) {
+                this->m_points->erase(f);
+
+                // The store refers to the point list, whose indexes
+                // have just shifted. Gather the remaining points again.
+
+                m_grid_valid = false;
+
+                this->invalidate();
+            }
         }
 
         void
         add_point(typename Point<T>::ptr p)
         {
-            m_index->set(p->gridpoint, p);
+            this->m_points->push_back(p);
+
+            m_grid_valid = false;
+
+            this->invalidate();
         }
 
         typename Point<T>::list *
-        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL)
+        search(const vector<T> &x, const SearchParameters *params, vector<T> *distances = NULL) const
+        {
+            typename Point<T>::list *result = new typename Point<T>::list();
+            this->search_into(x, params, *result, distances);
+            return result;
+        }
+
+        void
+        search_into(const vector<T> &x,
+                const SearchParameters *params,
+                typename Point<T>::list &result,
+                vector<T> *distances = NULL) const
         {
-            vector<T> h;
+            typename PointIndex<T>::SearchScratch scratch;
+            this->search_into(x, params, result, scratch, distances);
+        }
 
-            if (params->search_type() == SearchTypeRange) {
-                RangeSearchParams<T> *p = (RangeSearchParams<T> *) params;
+        void
+        search_into(const vector<T> &x,
+                const SearchParameters *params,
+                typename Point<T>::list &result,
+                typename PointIndex<T>::SearchScratch &scratch,
+                vector<T> *distances = NULL) const
+        {
+            result.clear();
+            if (distances != NULL) {
+                distances->clear();
+            }
 
-                h = p->bandwidth;
-            } else {
+            if (params->search_type() != SearchTypeRange) {
                 throw "RectilinearGridIndex does not support knn search at this time";
             }
 
-            // spatial realm
+            const vector<T> &h = ((RangeSearchParams<T> *) params)->bandwidth;
 
-            typename CoordinateSystem<T>::GridPoint gp = this->m_fs->coordinate_system->newGridPoint();
+            // spatial realm. The spatial components are the first
+            // rank() components of x. Origins off the grid are
+            // clamped to the closest node on the grid's boundary,
+            // the stencil still covers their neighbourhood.
 
-            vector<T> x_spatial = this->m_fs->spatial_component(x);
+            this->ensure_built(h);
 
-            typename Point<T>::list *result = NULL;
+            vector<int> &gp = scratch.gridpoint;
 
-            try {
-                this->m_fs->coordinate_system->reverse_lookup(x_spatial, gp);
+            this->m_fs->coordinate_system->rounded_gridpoint(x, gp);
 
-                result = this->search(x, gp, h, distances);
-            } catch (std::out_of_range& e) {
-                cerr << "ERROR:reverse coordinate transformation failed for coordinate=" << x_spatial << endl;
+            for (size_t d = 0; d < gp.size(); d++) {
+                if (gp[d] < 0) {
+                    gp[d] = 0;
+                } else if (gp[d] >= (int) m_dim_sizes[d]) {
+                    gp[d] = (int) m_dim_sizes[d] - 1;
+                }
             }
 
-            return result;
+            this->search_into(x, gp, h, result, distances);
         }
 
 #pragma mark -
@@ -169,53 +270,93 @@ namespace m3D {
         search(const vector<T> &x,
                 const typename CoordinateSystem<T>::GridPoint &gp,
                 const vector<T> &h,
-                vector<T> *distances = NULL)
+                vector<T> *distances = NULL) const
         {
-            if (m_index == NULL) {
-                this->build_index(h);
-            }
+            typename Point<T>::list *result = new typename Point<T>::list();
+            this->search_into(x, gp, h, *result, distances);
+            return result;
+        }
+
+        /** Searches around the given grid point and writes the result 
+         * into the given list (cleared first).
+         * @param x
+         * @param grid point of x
+         * @param bandwidth
+         * @param result list (cleared and filled in place)
+         * @param distances (optional)
+         */
+        void
+        search_into(const vector<T> &x,
+                const typename CoordinateSystem<T>::GridPoint &gp,
+                const vector<T> &h,
+                typename Point<T>::list &result,
+                vector<T> *distances = NULL) const
+        {
+            this->ensure_built(h);
 
-            // Calculate the grid points
+            result.clear();
 
-            typename Point<T>::list *result = new typename Point<T>::list();
+            const size_t rank = m_dim_sizes.size();
 
-            vector<size_t> lower_index_bounds(h.size(), 0);
+            const size_t dim = this->dimension();
 
-            vector<size_t> upper_index_bounds(h.size(), 0);
+            // If the stencil lies completely within the grid
+            // around the origin, the bounds checks can be skipped
 
-            const CoordinateSystem<T> *cs = this->m_fs->coordinate_system;
+            bool interior = true;
 
-            vector<T> resolution = cs->resolution();
+            long origin = 0;
 
-            for (size_t i = 0; i < resolution.size(); i++) {
-                size_t num_gridpoints = h[i] / resolution[i];
+            for (size_t d = 0; d < rank; d++) {
+                origin += gp[d] * m_strides[d];
+                interior = interior
+                        && (gp[d] - m_stencil_extent[d] >= 0)
+                        && (gp[d] + m_stencil_extent[d] < (int) m_dim_sizes[d]);
+            }
 
-                // bound against underrun
+            const size_t stencil_size = m_stencil_linear.size();
 
-                lower_index_bounds[i] = ((gp[i] - num_gridpoints) <= 0)
-                        ? 0
-                        : lower_index_bounds[i] = gp[i] - num_gridpoints;
+            for (size_t k = 0; k < stencil_size; k++) {
+                if (!interior) {
+                    bool inside = true;
+                    const int *offset = &m_stencil_offsets[k * rank];
+                    for (size_t d = 0; d < rank && inside; d++) {
+                        int g = gp[d] + offset[d];
+                        inside = (g >= 0 && g < (int) m_dim_sizes[d]);
+                    }
+                    if (!inside) continue;
+                }
 
-                // bound against overrun
+                int id = m_grid[origin + m_stencil_linear[k]];
 
-                size_t max_index = cs->dimensions()[i].getSize() - 1;
+                if (id < 0) continue;
 
-                upper_index_bounds[i] = ((gp[i] + num_gridpoints) >= max_index)
-                        ? max_index
-                        : upper_index_bounds[i] = gp[i] + num_gridpoints;
-            }
+                // exact distance from x, spatial and value realm
 
-            // Start the recursion
+                T r = 0.0;
 
-            typename CoordinateSystem<T>::GridPoint gridpoint = cs->newGridPoint();
+                for (size_t ci = 0; ci < dim && r <= 1.0; ci++) {
+                    T dist = x[ci] - m_store.value(id, this->m_index_variable_indexes[ci]);
+                    r += dist * dist * m_stencil_coefficients[ci];
+                }
 
-            search_recursive(0, x, gridpoint, h, lower_index_bounds, upper_index_bounds, result, distances);
+                if (r <= 1.0) {
+                    result.push_back(m_store.point(id));
 
-            if (PointIndex<T>::write_index_searches) {
-                this->write_search(x, h, result);
+                    if (distances != NULL) {
+                        T sum = 0.0;
+                        for (size_t ci = 0; ci < dim; ci++) {
+                            T dist = x[ci] - m_store.value(id, this->m_index_variable_indexes[ci]);
+                            sum += dist * dist;
+                        }
+                        distances->push_back(sqrt(sum));
+                    }
+                }
             }
 
-            return result;
+            if (PointIndex<T>::write_index_searches) {
+                this->write_search(x, h, &result);
+            }
         }
 
 #pragma mark
@@ -223,65 +364,124 @@ namespace m3D {
 
     protected:
 
+        /** @return linear index of the given grid point in m_grid */
+        inline size_t
+        linear_index(const vector<int> &gridpoint) const
+        {
+            size_t linear_index = 0;
+            for (size_t d = 0; d < m_strides.size(); d++) {
+                linear_index += gridpoint[d] * m_strides[d];
+            }
+            return linear_index;
+        }
+
+        /** Sorts the points into the linear grid.
+         */
         void
-        search_recursive(size_t dim_index,
-                const vector<T> &x,
-                typename CoordinateSystem<T>::GridPoint &gridpoint,
-                const vector<T> &h,
-                const vector<size_t> &lower_index_bounds,
-                const vector<size_t> &upper_index_bounds,
-                typename Point<T>::list *result,
-                vector<T> *distances = NULL)
+        build_grid()
         {
-            if (dim_index < (gridpoint.size() - 1)) {
-                for (size_t index = lower_index_bounds[dim_index]; index <= upper_index_bounds[dim_index]; index++) {
-                    gridpoint[dim_index] = index;
+            const CoordinateSystem<T> *cs = this->m_fs->coordinate_system;
 
-                    search_recursive(dim_index + 1, x, gridpoint, h, lower_index_bounds, upper_index_bounds, result, distances);
+            m_dim_sizes = cs->get_dimension_sizes();
+
+            size_t rank = m_dim_sizes.size();
+
+            m_strides.assign(rank, 1);
+
+            for (int d = ((int) rank) - 2; d >= 0; d--) {
+                m_strides[d] = m_strides[d + 1] * m_dim_sizes[d + 1];
+            }
+
+            size_t grid_size = (rank == 0) ? 0 : m_strides[0] * m_dim_sizes[0];
+
+            m_store.gather(*this->m_points, rank);
+
+            m_grid.assign(grid_size, -1);
+
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t i = 0; i < m_store.size(); i++) {
+                const int *gp = m_store.gridpoint(i);
+                size_t linear_index = 0;
+                for (size_t d = 0; d < rank; d++) {
+                    linear_index += gp[d] * m_strides[d];
                 }
-            } else {
-                for (size_t index = lower_index_bounds[dim_index]; index <= upper_index_bounds[dim_index]; index++) {
-                    gridpoint[dim_index] = index;
+                m_grid[linear_index] = (int) i;
+            }
+
+            m_grid_valid = true;
+        }
 
-                    typename Point<T>::ptr p = m_index->get(gridpoint);
+        /** Calculates the stencil for the given bandwidth. The stencil
+         * contains all offsets whose cell may intersect the spatial part
+         * of the search ellipsoid around a position up to one grid 
+         * resolution away from the origin node, together with their
+         * linear offset. The exact distance is tested during the search.
+         * 
+         * @param bandwidth
+         */
+        void
+        build_stencil(const vector<T> &h)
+        {
+            const vector<T> &resolution = this->m_fs->coordinate_system->resolution();
 
-                    if (p != NULL) {
-                        // value realm will have to be calculated with a
-                        // simple euclidean metric for now
+            const size_t rank = m_dim_sizes.size();
 
-                        bool within_range = true;
+            m_stencil_bandwidth = h;
+            m_stencil_extent.assign(rank, 0);
+            m_stencil_offsets.clear();
+            m_stencil_linear.clear();
+            m_stencil_coefficients.assign(h.size(), 0.0);
+
+            for (size_t d = 0; d < h.size(); d++) {
+                if (h[d] > 0) {
+                    m_stencil_coefficients[d] = 1.0 / (h[d] * h[d]);
+                }
+            }
 
-                        vector<T> dists(x.size(), 0.0);
+            size_t count = 1;
 
-                        for (size_t hi = gridpoint.size(); (hi < h.size()) && within_range; hi++) {
-                            T dist = boost::numeric_cast<T>(abs(x[hi] - p->values[hi]));
+            for (size_t d = 0; d < rank; d++) {
+                // one extra node on each side for origins between nodes
+                m_stencil_extent[d] = (h[d] > 0) ? (int) floor(h[d] / resolution[d]) + 1 : 0;
+                count *= (2 * m_stencil_extent[d] + 1);
+            }
 
-                            if (distances != NULL) {
-                                dists[hi] = dist;
-                            }
+            // Iterate over the box enclosing the ellipsoid, odometer style
 
-                            within_range = (dist <= h[hi]);
-                        }
+            vector<int> offset(rank);
 
-                        if (within_range) {
-                            result->push_back(p);
+            for (size_t d = 0; d < rank; d++) {
+                offset[d] = -m_stencil_extent[d];
+            }
 
-                            if (distances != NULL) {
-                                // fill out the spatial realm part of the dists vector
+            for (size_t n = 0; n < count; n++) {
+                T r = 0.0;
+                long linear = 0;
+
+                for (size_t d = 0; d < rank; d++) {
+                    // closest possible distance of this node to an
+                    // origin within one resolution of the center node
+                    int steps = std::max(0, abs(offset[d]) - 1);
+                    T dist = steps * resolution[d];
+                    r += dist * dist * m_stencil_coefficients[d];
+                    linear += offset[d] * (long) m_strides[d];
+                }
 
-                                for (size_t i = 0; i < gridpoint.size(); i++) {
-                                    dists[i] = boost::numeric_cast<T>(abs(x[i] - p->values[i]));
-                                }
+                if (r <= 1.0) {
+                    m_stencil_offsets.insert(m_stencil_offsets.end(), offset.begin(), offset.end());
+                    m_stencil_linear.push_back(linear);
+                }
 
-                                // distances is a component stretching across the whole realm
-                                // in what way this still makes sense, must be questioned. In
-                                // a future implementation the distance should be given for
-                                // each component individually?
+                // advance
 
-                                distances->push_back(utils::vectors::vector_norm<T>(dists));
-                            }
-                        }
+                for (int d = ((int) rank) - 1; d >= 0; d--) {
+                    if (offset[d] < m_stencil_extent[d]) {
+                        offset[d]++;
+                        break;
                     }
+                    offset[d] = -m_stencil_extent[d];
                 }
             }
         }
@@ -41,6 +41,39 @@ namespace m3D {
 
         //static const int NO_WEIGHT;
 
+        /** Scratch buffers for the allocation-free variant of the 
+         * meanshift calculation. Each thread should hold it's own 
+         * instance and re-use it for all queries. After the first
+         * few queries the buffers have grown to the required size
+         * and no further heap allocation takes place.
+         */
+        struct Scratch
+        {
+            /** Sample as filled in by the index */
+            typename Point<T>::list sample;
+
+            /** Scratch buffers of the index search */
+            typename PointIndex<T>::SearchScratch search;
+
+            /** Weighed sum of the sample values */
+            vector<T> numerator;
+
+            /** Number of searches performed with this scratch */
+            size_t searches;
+
+            /** Total number of points found by these searches */
+            size_t neighbours;
+
+            Scratch() : searches(0), neighbours(0)
+            {
+            }
+        };
+
+        /** Default size of the blocks of points handed to 
+         * the batched meanshift by the cluster operation.
+         */
+        static const size_t DEFAULT_BATCH_SIZE = 1024;
+
         MeanshiftOperation(FeatureSpace<T> *fs,
                 PointIndex<T> *index) : Operation<T>(fs, index)
         {
@@ -52,6 +85,7 @@ namespace m3D {
 
 
         /** Call this up-front to preempt lazy index construction.
+         * Required before calling meanshift(..) from several threads.
          * @param search parameters
          */
         void prime_index(const SearchParameters *params);
@@ -73,6 +107,53 @@ namespace m3D {
                 const Kernel<T> *kernel = new GaussianNormalKernel<T>(),
                 const WeightFunction<T> *w = NULL,
                 const bool normalize_shift = true);
+
+        /** Allocation-free meanshift calculation at point x. The sample
+         * is obtained through PointIndex::search_into, using the given
+         * scratch buffers. 
+         * 
+         * @param feature space coordinate x (origin)
+         * @param search parameters
+         * @param kernel (may be NULL)
+         * @param weight function (may be NULL)
+         * @param scratch buffers (per thread)
+         * @param mean shift vector (out). Resized to the feature-space 
+         *        dimension if necessary.
+         * @param flag, indicating if the returned vector should be rounded
+         *        to the coordinate system's resolution
+         */
+        void
+        meanshift(const vector<T> &x,
+                const SearchParameters *params,
+                const Kernel<T> *kernel,
+                const WeightFunction<T> *w,
+                Scratch &scratch,
+                vector<T> &shift,
+                const bool normalize_shift = true);
+
+        /** Batched meanshift calculation. Calculates the meanshift for
+         * the points [begin,end) in the given list and stores the result
+         * in each point's shift and gridded_shift property. The shifts 
+         * are always rounded to the grid resolution. The method itself 
+         * is not parallelized, callers are expected to hand blocks of 
+         * points with one scratch object per thread.
+         * 
+         * @param point list
+         * @param index of first point in block
+         * @param index after the last point in block
+         * @param search parameters
+         * @param kernel (may be NULL)
+         * @param weight function (may be NULL)
+         * @param scratch buffers (per thread)
+         */
+        void
+        meanshift(typename Point<T>::list &points,
+                size_t begin,
+                size_t end,
+                const SearchParameters *params,
+                const Kernel<T> *kernel,
+                const WeightFunction<T> *w,
+                Scratch &scratch);
     };
 }
 
@@ -36,9 +36,7 @@ namespace m3D {
     void
     MeanshiftOperation<T>::prime_index(const SearchParameters *params)
     {
-        vector<T> x(this->feature_space->rank());
-        typename Point<T>::list *sample = this->point_index->search(x, params, NULL);
-        delete sample;
+        this->point_index->build(params);
     }
 
     template <typename T>
@@ -121,6 +119,88 @@ namespace m3D {
 
         return shift;
     }
+
+    template <typename T>
+    void
+    MeanshiftOperation<T>::meanshift(const vector<T> &x,
+            const SearchParameters *params,
+            const Kernel<T> *kernel,
+            const WeightFunction<T> *w,
+            Scratch &scratch,
+            vector<T> &shift,
+            const bool normalize_shift)
+    {
+        using namespace utils::vectors;
+
+        if (params->search_type() != SearchTypeRange) {
+            throw "Not Implemented";
+        }
+
+        const size_t dim = this->feature_space->dimension;
+
+        shift.assign(dim, 0.0);
+
+        this->point_index->search_into(x, params, scratch.sample, scratch.search, NULL);
+
+        // If the sample is empty, no shift can be calculated.
+        // Returns a shift of 0
+        const size_t size = scratch.sample.size();
+        scratch.searches++;
+        scratch.neighbours += size;
+        if (size == 0) {
+            return;
+        }
+
+        vector<T> &numerator = scratch.numerator;
+        numerator.assign(dim, 0.0);
+        T denominator = 0.0;
+
+        const vector<T> &h = ((RangeSearchParams<T> *) params)->bandwidth;
+        for (size_t index = 0; index < size; index++) {
+            const typename Point<T>::ptr p = scratch.sample[index];
+            const vector<T> &values = p->values;
+            T weight = 1.0;
+            if (kernel != NULL) {
+                weight *= kernel->apply(mahalabonis_distance_sqr(x, values, h));
+            }
+            if (w != NULL) {
+                weight *= w->operator()(p);
+            }
+            denominator += weight;
+            for (size_t i = 0; i < dim; i++) {
+                numerator[i] += weight * values[i];
+            }
+        }
+
+        for (size_t i = 0; i < dim; i++) {
+            shift[i] = numerator[i] / denominator - x[i];
+        }
+
+        if (normalize_shift) {
+            this->feature_space->coordinate_system->round_to_grid(shift, shift);
+        }
+    }
+
+    template <typename T>
+    void
+    MeanshiftOperation<T>::meanshift(typename Point<T>::list &points,
+            size_t begin,
+            size_t end,
+            const SearchParameters *params,
+            const Kernel<T> *kernel,
+            const WeightFunction<T> *w,
+            Scratch &scratch)
+    {
+        const CoordinateSystem<T> *cs = this->feature_space->coordinate_system;
+        for (size_t index = begin; index < end; index++) {
+            typename Point<T>::ptr x = points[index];
+            this->meanshift(x->values, params, kernel, w, scratch, x->shift, true);
+            // The spatial component are the first rank()
+            // components of the shift
+            cs->to_gridpoints(x->shift, x->gridded_shift);
+            x->gridded_shift.resize(cs->rank());
+        }
+    }
 }
 
 #endif
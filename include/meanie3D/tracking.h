@@ -24,6 +24,7 @@
 #ifndef M3D_TRACKING_INCLUDES_H
 #define M3D_TRACKING_INCLUDES_H
 
+#include <meanie3D/tracking/point_spill_file.h>
 #include <meanie3D/tracking/track.h>
 #include <meanie3D/tracking/track_cluster.h>
 #include <meanie3D/tracking/tracking.h>
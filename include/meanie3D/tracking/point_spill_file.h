@@ -0,0 +1,259 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_POINT_SPILL_FILE_H
+#define M3D_POINT_SPILL_FILE_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+#include <meanie3D/featurespace/point.h>
+#include <meanie3D/featurespace/point_factory.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace m3D {
+
+    /** Append-only binary file that takes the points of many clusters
+     * out of memory. Each cluster is stored as one record: the point
+     * values (rank per point) followed by the grid points (spatial rank
+     * per point). Records are aligned to 16 bytes.
+     *
+     * For reading, the file is memory-mapped. values() and gridpoints()
+     * return views into the mapping, read() creates point objects from
+     * them. Views remain valid until the next append() followed by a
+     * read access that grows the mapping.
+     *
+     * The file is unlinked right after it is created, so it vanishes
+     * when the process ends, however that happens.
+     */
+    template <typename T>
+    class PointSpillFile
+    {
+    public:
+
+        /** Location of a cluster's points in the spill file */
+        typedef struct
+        {
+            size_t offset;
+            size_t count;
+            size_t rank;
+            size_t spatial_rank;
+        } record_t;
+
+    private:
+
+        int m_fd;
+        size_t m_size;
+        void *m_map;
+        size_t m_mapped_size;
+
+        static const size_t ALIGNMENT = 16;
+
+        /** Makes sure the mapping covers the whole file */
+        void map()
+        {
+            if (m_map != NULL && m_mapped_size == m_size) {
+                return;
+            }
+
+            if (m_map != NULL) {
+                munmap(m_map, m_mapped_size);
+                m_map = NULL;
+                m_mapped_size = 0;
+            }
+
+            if (m_size == 0) {
+                return;
+            }
+
+            void *map = mmap(NULL, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+            if (map == MAP_FAILED) {
+                std::cerr << "FATAL:could not map spill file: " << strerror(errno) << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            m_map = map;
+            m_mapped_size = m_size;
+        }
+
+        void write_fully(const char *data, size_t length)
+        {
+            while (length > 0) {
+                ssize_t written = ::write(m_fd, data, length);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    std::cerr << "FATAL:could not write to spill file: " << strerror(errno) << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                data += written;
+                length -= written;
+                m_size += written;
+            }
+        }
+
+        // Not copyable
+        PointSpillFile(const PointSpillFile &);
+        PointSpillFile &operator=(const PointSpillFile &);
+
+    public:
+
+#pragma mark -
+#pragma mark Constructor/Destructor
+
+        /** Creates the spill file in the given directory.
+         * @param directory
+         */
+        PointSpillFile(const std::string &directory = "/tmp")
+        : m_fd(-1)
+        , m_size(0)
+        , m_map(NULL)
+        , m_mapped_size(0)
+        {
+            std::string path = directory + "/meanie3D-points-XXXXXX";
+            std::vector<char> name(path.begin(), path.end());
+            name.push_back('\0');
+
+            m_fd = mkstemp(&name[0]);
+            if (m_fd < 0) {
+                std::cerr << "FATAL:could not create spill file in " << directory
+                          << ": " << strerror(errno) << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            unlink(&name[0]);
+        }
+
+        ~PointSpillFile()
+        {
+            if (m_map != NULL) {
+                munmap(m_map, m_mapped_size);
+            }
+            if (m_fd >= 0) {
+                close(m_fd);
+            }
+        }
+
+#pragma mark -
+#pragma mark Writing/Reading
+
+        /** Appends the points to the file.
+         * @param points
+         * @param number of values per point
+         * @param number of grid point components per point
+         * @return record for reading the points back
+         */
+        record_t append(const typename Point<T>::list &points,
+                size_t rank,
+                size_t spatial_rank)
+        {
+            record_t record;
+            record.offset = m_size;
+            record.count = points.size();
+            record.rank = rank;
+            record.spatial_rank = spatial_rank;
+
+            size_t values_size = sizeof(T) * rank * points.size();
+            size_t gridpoints_size = sizeof(int) * spatial_rank * points.size();
+            size_t length = values_size + gridpoints_size;
+            length = (length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+            std::vector<char> buffer(length, 0);
+            T *values = (T *) &buffer[0];
+            int *gridpoints = (int *) (&buffer[0] + values_size);
+
+            for (size_t pi = 0; pi < points.size(); pi++) {
+                const typename Point<T>::ptr p = points[pi];
+                for (size_t di = 0; di < rank; di++) {
+                    values[pi * rank + di] = p->values[di];
+                }
+                for (size_t di = 0; di < spatial_rank; di++) {
+                    gridpoints[pi * spatial_rank + di] = p->gridpoint[di];
+                }
+            }
+
+            if (length > 0) {
+                this->write_fully(&buffer[0], length);
+            }
+
+            return record;
+        }
+
+        /** @return view of the record's values (count * rank) */
+        const T *values(const record_t &record)
+        {
+            this->map();
+            return (const T *) ((const char *) m_map + record.offset);
+        }
+
+        /** @return view of the record's grid points (count * spatial rank) */
+        const int *gridpoints(const record_t &record)
+        {
+            this->map();
+            return (const int *) ((const char *) m_map + record.offset
+                    + sizeof(T) * record.rank * record.count);
+        }
+
+        /** Creates point objects for the record. The coordinate is
+         * the spatial range of the values.
+         * @param record
+         * @param list the points are appended to
+         */
+        void read(const record_t &record, typename Point<T>::list &points)
+        {
+            if (record.count == 0) {
+                return;
+            }
+
+            const T *values = this->values(record);
+            const int *gridpoints = this->gridpoints(record);
+
+            points.reserve(points.size() + record.count);
+            for (size_t pi = 0; pi < record.count; pi++) {
+                const T *v = values + pi * record.rank;
+                const int *g = gridpoints + pi * record.spatial_rank;
+
+                typename Point<T>::ptr p = PointFactory<T>::get_instance()->create();
+                p->values.assign(v, v + record.rank);
+                p->gridpoint.assign(g, g + record.spatial_rank);
+                p->coordinate.assign(v, v + record.spatial_rank);
+                points.push_back(p);
+            }
+        }
+
+        /** @return size of the file in bytes */
+        size_t size() const
+        {
+            return m_size;
+        }
+    };
+}
+
+#endif
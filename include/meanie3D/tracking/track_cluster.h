@@ -29,15 +29,14 @@
 
 #include <meanie3D/featurespace/point.h>
 #include <meanie3D/featurespace/point_factory.h>
+#include <meanie3D/tracking/point_spill_file.h>
 
-#include <fstream>
 #include <exception>
-#include <boost/lexical_cast.hpp>
 
 namespace m3D {
 
-    /** A subclass of Cluster that facilitates storing and reading
-     * individual clusters from a NetCDF file. Used to make tracking
+    /** A subclass of Cluster that moves its points into a spill
+     * file and reads them back on demand. Used to make tracking
      * statistics more memory efficient.
      */
     template<typename T>
@@ -63,19 +62,15 @@ namespace m3D {
 
     private:
 
-        // The file containing the actual data
-        std::string m_filename;
+        // Holds the points while they are not needed (or NULL)
+        PointSpillFile<T> *m_spill_file;
 
-        // name of the cluster's variable in external memory
-        std::string m_variable_name;
+        // Location of the points in the spill file
+        typename PointSpillFile<T>::record_t m_record;
 
         // copied from the cluster list
         int m_tracking_time_difference;
 
-        // Flag indicating if points need writing off
-        // or whether they can remain in memory]
-        bool m_writes_points_to_disk;
-
         // Flag indicating if the data is available in system
         // memory or if it needs reading from external memory
         bool m_needs_reading;
@@ -88,64 +83,14 @@ namespace m3D {
 #pragma mark -
 #pragma mark Private member functions
 
-        /**  Write point list out to file.
-         * 
-         * TODO: perhaps find a faster, binary file format
-         * 
-         * @param points
-         */
-        void write_points(typename Point<T>::list points)
-        {
-            std::ofstream f(m_filename.c_str(), ios::out);
-            if (!f.is_open()) {
-                cerr << "FATAL:failed to open file " << m_filename << " for writing." << endl;
-                exit(EXIT_FAILURE);
-            }
-
-            // three lines per point: values, gridpoint, coordinate
-
-            typename Point<T>::list::iterator pi;
-            for (pi = points.begin(); pi != points.end(); pi++) {
-                typename Point<T>::ptr p = *pi;
-                f << p->values << endl;
-                f << p->gridpoint << endl;
-            }
-
-            f.close();
-        }
-
-        /** Reads points from file.
-         * 
-         * @param list
+        /** Reads points back from the spill file.
          */
         void read_points()
         {
-            using m3D::utils::vectors::from_string;
-
-            ifstream f(m_filename.c_str(), ios::in);
-            if (!f.is_open()) {
-                cerr << "FATAL:failed to open file " << m_filename << " for reading." << endl;
-                exit(EXIT_FAILURE);
-            }
-
-            std::string line;
-            while (getline(f, line)) {
-                // values
-                typename Point<T>::ptr p = PointFactory<T>::get_instance()->create();
-                p->values = from_string<T>(line);
-
-                // grid point
-                if (!getline(f, line)) {
-                    cerr << "FATAL:failed to read line from " << m_filename << endl;
-                    exit(EXIT_FAILURE);
-                }
-                p->gridpoint = from_string<int>(line);
-
-                // reconstruct coordinate from spatial range
-                p->coordinate = std::vector<T>(p->values.begin(),
-                        p->values.begin() + p->gridpoint.size());
-
-                this->add_point(p);
+            typename Point<T>::list points;
+            m_spill_file->read(m_record, points);
+            for (size_t pi = 0; pi < points.size(); pi++) {
+                this->add_point(points[pi]);
             }
         }
 
@@ -159,13 +104,15 @@ namespace m3D {
          * @param c_id this id must be unique.
          * @param tracking time difference from cluster list
          * @param cluster 
+         * @param spill file to move the points to. If <code>NULL</code>,
+         * the points are not kept.
          */
         TrackCluster(typename Cluster<T>::ptr cluster,
                      int timeDifference,
-                     bool write_points_to_disk = false)
-        : m_writes_points_to_disk(write_points_to_disk)
-        , m_needs_reading(true)
+                     PointSpillFile<T> *spill_file = NULL)
+        : m_spill_file(spill_file)
         , m_tracking_time_difference(timeDifference)
+        , m_needs_reading(true)
         {
             this->id = cluster->id;
             this->uuid = cluster->uuid;
@@ -177,12 +124,10 @@ namespace m3D {
             this->m_geometrical_center = cluster->geometrical_center();
             this->set_bounding_box_min(cluster->get_bounding_box_min());
             this->set_bounding_box_max(cluster->get_bounding_box_max());
-            std::string num_postfix = boost::lexical_cast<string>(cluster->uuid);
-            // name of the external 'memory'
-            m_filename = "/tmp/cluster_" + num_postfix + ".txt";
             // write out to external memory
-            if (m_writes_points_to_disk) {
-                this->write_points(cluster->get_points());
+            if (m_spill_file != NULL) {
+                m_record = m_spill_file->append(cluster->get_points(),
+                        cluster->rank(), cluster->spatial_rank());
             }
         }
 
@@ -199,7 +144,7 @@ namespace m3D {
         }
 
         typename Point<T>::list &get_points() {
-            if (m_writes_points_to_disk && this->m_needs_reading) {
+            if (m_spill_file != NULL && this->m_needs_reading) {
                 this->read_points();
                 this->m_needs_reading = false;
             }
@@ -210,7 +155,7 @@ namespace m3D {
             return this->m_geometrical_center;
         }
 
-        size_t size() {
+        size_t size() const {
             return this->m_size;
         }
 
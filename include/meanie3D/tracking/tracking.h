@@ -29,6 +29,7 @@
 #include <meanie3D/array/linear_index_mapping.h>
 #include <meanie3D/clustering/cluster.h>
 #include <meanie3D/clustering/cluster_list.h>
+#include <meanie3D/utils/cluster_overlap.h>
 #include <meanie3D/utils/matrix.h>
 #include <meanie3D/utils/time_utils.h>
 
@@ -82,6 +83,12 @@ namespace m3D {
         typedef pair<size_t, T> match_t;
         typedef vector<match_t> matchlist_t;
 
+        typedef pair<size_t, size_t> candidate_t;   // (n,m)
+        typedef vector<candidate_t> candidatelist_t;
+
+        typedef vector< vector<int> > adjacency_t;      // neighbour indexes per node
+        typedef map<m3D::id_t, vector<int> > id_index_t; // cluster indexes by id
+
         /**
          * Bundles data that constitutes a tracking run. These are mostly
          * things derived at the beginning, such as bounds, derived parameters
@@ -93,7 +100,10 @@ namespace m3D {
             typename ClusterList<T>::ptr previous; // current cluster list
             size_t N,M;                     // Shortcuts for lenghts of previous and current lists.
             const CoordinateSystem<T> *cs;  // Coordinate system (for transformations)
-            LinearIndexMapping mapping;     // maps i <-> (n,m)
+            bool owns_cs;                   // true if cs was created by the run
+            NcFile *info_file;              // referenced source file opened by the run (or NULL)
+            candidatelist_t candidates;     // (n,m) pairs that are scored, ordered by n,m
+            vector<size_t> candidateRows;   // candidates of n are [candidateRows[n],candidateRows[n+1])
 
             m3D::id_t highestId;        // Stores the highest used ID
             m3D::uuid_t highestUuid;    // Stores the highest used UUID
@@ -113,17 +123,25 @@ namespace m3D {
             ::units::values::meters_per_second overlap_constraint_velocity;
 
             id_set_t matched_uuids;             // uuid of new clusters that were matched
-            matchlist_t matches;                // final matching result
+            matchlist_t matches;                // final matching result (index into candidates)
             id_set_t scheduled_for_removal;     // Set of ids to be removed at the end of the run.
 
-            // Correlation data
-            typename SimpleMatrix<T>::matrix_t rankCorrelation;
-            typename SimpleMatrix< ::units::values::m >::matrix_t midDisplacement;
-            typename SimpleMatrix<T>::matrix_t sizeDifference;
-            typename SimpleMatrix<T>::matrix_t likelihood;
-            typename SimpleMatrix<T>::matrix_t coverOldByNew;
-            typename SimpleMatrix<T>::matrix_t coverNewByOld;
-            typename SimpleMatrix<T>::flag_matrix_t matchPossible;
+            // Correlation data (N x M, only candidate pairs are stored)
+            SparseMatrix<T> rankCorrelation;
+            SparseMatrix< ::units::values::m > midDisplacement;
+            SparseMatrix<T> sizeDifference;
+            SparseMatrix<T> likelihood;
+            SparseMatrix<T> coverOldByNew;
+            SparseMatrix<T> coverNewByOld;
+            SparseMatrix<int> matchPossible;
+
+            // Bipartite overlap graph for merges and splits
+            adjacency_t previousOverlaps;       // overlapping previous clusters m of each n (ascending)
+            adjacency_t currentOverlaps;        // overlapping current clusters n of each m (ascending)
+            vector<double> maxMergeCriterion;   // highest merge criterion of each m over its overlaps
+            vector<double> maxSplitCriterion;   // highest split criterion of each n over its overlaps
+            id_index_t previousById;            // previous cluster indexes by id
+            id_index_t currentById;             // current cluster indexes by id (updated on re-tagging)
 
         } tracking_run_t;
 
@@ -155,9 +173,12 @@ namespace m3D {
          * Runs the meanie3D tracking algorithm.
          * @param current
          * @param previous
+         * @param coordinate system. If NULL, the coordinate system
+         * is constructed from the cluster files for the run.
          */
         void track(typename ClusterList<T>::ptr previous,
-                   typename ClusterList<T>::ptr current);
+                   typename ClusterList<T>::ptr current,
+                   const CoordinateSystem<T> *cs = NULL);
 
     protected:
 
@@ -179,13 +200,31 @@ namespace m3D {
         bool initialise(typename Tracking<T>::tracking_run_t &run);
 
         /**
-         * Calculates data to base match probabilities on.
+         * Finds the pairs of current and previous clusters that can
+         * possibly be related: those which overlap and those whose 
+         * centers are no further apart than the maximum displacement.
+         * The latter are found through a uniform grid over the
+         * previous cluster centers with a cell size of maxDisplacement,
+         * so that only neighbouring cells need to be searched. Fills
+         * run.candidates, run.candidateRows and the coverage matrices.
+         *
+         * @param run
+         * @param overlap of current (first) and previous (second) clusters
+         */
+        void findCandidates(typename Tracking<T>::tracking_run_t &run,
+                            const ClusterOverlap<T> &overlap);
+
+        /**
+         * Calculates data to base match probabilities on. Only
+         * the candidate pairs are scored. The rows (current clusters)
+         * are scored in parallel, after the per-cluster caches
+         * (center, radius, histogram) have been filled.
          * @param run
          */
         void calculateCorrelationData(typename Tracking<T>::tracking_run_t &run);
 
         /**
-         * Calculates match probabilities.
+         * Calculates match probabilities (in parallel by rows).
          * @param run
          */
         void calculateProbabilities(typename Tracking<T>::tracking_run_t &run);
@@ -196,6 +235,16 @@ namespace m3D {
          */
         void matchmaking(typename Tracking<T>::tracking_run_t &run);
 
+        /**
+         * Called after matchmaking. Builds the bipartite overlap graph
+         * between current and previous clusters from the coverage data,
+         * along with the highest merge/split criterion per node. This
+         * allows merges and splits to be analysed from adjacency lists
+         * instead of scanning all N x M pairs.
+         * @param run
+         */
+        void buildOverlapGraph(typename Tracking<T>::tracking_run_t &run);
+
         /**
          * Called after matchmaking. Analyses and tags splits.
          * @param run
@@ -33,6 +33,7 @@
 
 #include <algorithm>
 #include <boost/bind.hpp>
+#include <map>
 #include <math.h>
 #include <netcdf>
 #include <set>
@@ -107,7 +108,6 @@ namespace m3D {
     {
         bool skip_tracking = false;
         bool logDetails = m_params.verbosity >= VerbosityDetails;
-        run.cs = NULL;
 
         if (logDetails) {
             cout << endl;
@@ -160,15 +160,23 @@ namespace m3D {
             cout << "\thighest used uuid is " << run.highestUuid << endl;
         }
 
-        // Get us a coordinate system
-        NcFile *infoFile = run.current->file == NULL
-            ? run.previous->file : run.current->file;
-        
         if (!skip_tracking) {
 
-            run.cs = new CoordinateSystem<T>(infoFile,
-                                             run.current->dimensions,
-                                             run.current->dimension_variables);
+            // Get us a coordinate system. The dimension variables are
+            // either in the cluster file or in its referenced source.
+            typename ClusterList<T>::ptr infoList = run.current->file == NULL
+                ? run.previous : run.current;
+            NcFile *infoFile = ClusterList<T>::open_data_file(infoList->filename, infoList->file);
+            if (infoFile != infoList->file) {
+                run.info_file = infoFile;
+            }
+
+            if (run.cs == NULL) {
+                run.cs = new CoordinateSystem<T>(infoFile,
+                                                 run.current->dimensions,
+                                                 run.current->dimension_variables);
+                run.owns_cs = true;
+            }
 
             // Check cluster sizes
             for (size_t i = 0; i < run.M; i++) {
@@ -254,12 +262,6 @@ namespace m3D {
                      << endl;
             }
 
-            // Provide a mapping for matchmaking and parallelisation
-            vector<size_t> index_dims;
-            index_dims.push_back(run.N);
-            index_dims.push_back(run.M);
-            run.mapping = LinearIndexMapping(index_dims);
-            
             // Bestow the current cluster list with fresh uuids
             ClusterUtils<T>::provideUuids(run.current, run.highestUuid);
 
@@ -277,6 +279,69 @@ namespace m3D {
 #pragma mark -
 #pragma mark Matching
 
+    template <typename T>
+    void
+    Tracking<T>::findCandidates(typename Tracking<T>::tracking_run_t &run,
+                                const ClusterOverlap<T> &overlap)
+    {
+        using namespace utils::vectors;
+
+        set<candidate_t> candidates;
+
+        // Overlapping pairs and their coverage ratios
+        for (size_t n = 0; n < run.N; n++) {
+            const SparseMatrix<size_t>::row_t &row = overlap.counts().row(n);
+            SparseMatrix<size_t>::row_t::const_iterator ri;
+            for (ri = row.begin(); ri != row.end(); ++ri) {
+                size_t m = ri->first;
+                run.coverOldByNew.set(n, m, overlap.ratio_b(n, m));
+                run.coverNewByOld.set(n, m, overlap.ratio_a(n, m));
+                candidates.insert(candidate_t(n, m));
+            }
+        }
+
+        // Pairs within reach. The previous cluster centers are
+        // hashed into a uniform grid (in meters) with cells of
+        // maxDisplacement, so any center within reach lies in
+        // one of the 3^rank cells around the current center. 
+        vector< vector<T> > centers;
+        vector<size_t> ids;
+        for (size_t m = 0; m < run.M; m++) {
+            typename Cluster<T>::ptr p = run.previous->clusters[m];
+            if (p->size() == 0) continue;
+            centers.push_back(run.cs->to_meters(p->geometrical_center()));
+            ids.push_back(m);
+        }
+
+        utils::CellHash<T> grid(centers, ids, run.maxDisplacement.get());
+
+        vector<size_t> neighbours;
+        for (size_t n = 0; n < run.N; n++) {
+            typename Cluster<T>::ptr c = run.current->clusters[n];
+            if (c->size() == 0) continue;
+            grid.neighbours(run.cs->to_meters(c->geometrical_center()), neighbours);
+            for (size_t i = 0; i < neighbours.size(); i++) {
+                size_t m = neighbours[i];
+                typename Cluster<T>::ptr p = run.previous->clusters[m];
+                vector<T> dx = c->geometrical_center() - p->geometrical_center();
+                ::units::values::m dR = ::units::values::m(vector_norm(run.cs->to_meters(dx)));
+                if (dR <= run.maxDisplacement) {
+                    candidates.insert(candidate_t(n, m));
+                }
+            }
+        }
+
+        run.candidates.assign(candidates.begin(), candidates.end());
+
+        run.candidateRows.assign(run.N + 1, 0);
+        for (size_t ci = 0; ci < run.candidates.size(); ci++) {
+            run.candidateRows[run.candidates[ci].first + 1]++;
+        }
+        for (size_t n = 0; n < run.N; n++) {
+            run.candidateRows[n + 1] += run.candidateRows[n];
+        }
+    }
+
     template <typename T>
     void
     Tracking<T>::calculateCorrelationData(typename Tracking<T>::tracking_run_t &run)
@@ -287,157 +352,226 @@ namespace m3D {
         }
 
         // Allocate the correlation data
-        run.rankCorrelation = SimpleMatrix<T>::create_matrix(run.N, run.M);
-        run.midDisplacement = SimpleMatrix< ::units::values::m >::create_matrix(run.N, run.M);
-        run.sizeDifference = SimpleMatrix<T>::create_matrix(run.N, run.M);
-        run.coverOldByNew = SimpleMatrix<T>::create_matrix(run.N, run.M);
-        run.coverNewByOld = SimpleMatrix<T>::create_matrix(run.N, run.M);
-        run.matchPossible = SimpleMatrix<T>::create_flag_matrix(run.N, run.M);
-        run.likelihood = SimpleMatrix<T>::create_matrix(run.N, run.M);
+        run.rankCorrelation.resize(run.N, run.M);
+        run.midDisplacement.resize(run.N, run.M);
+        run.sizeDifference.resize(run.N, run.M);
+        run.coverOldByNew.resize(run.N, run.M);
+        run.coverNewByOld.resize(run.N, run.M);
+        run.matchPossible.resize(run.N, run.M);
+        run.likelihood.resize(run.N, run.M);
 
         run.maxSizeDifference = numeric_limits<int>::min();
         run.maxMidDisplacement = ::units::values::m(numeric_limits<T>::min());
 
-        // Index the cluster lists for quick overlap calculations
-
-        // need to label the clusters with a unique id before we
-        // index them, otherwise the area calculations will be nonsense
-        for (size_t n = 0; n < run.N; n++) {
-            run.current->clusters[n]->id = n;
+        // Shared grid points of all current/previous pairs
+        ClusterOverlap<T> overlap(run.current->clusters, 
+                run.previous->clusters, 
+                run.cs->get_dimension_sizes());
+
+        // Only pairs which overlap or are within reach can
+        // be matched. All others are left out entirely.
+        findCandidates(run, overlap);
+        utils::Profiler::instance().count("candidates", run.candidates.size());
+
+        // Fill the cached properties of all clusters up front. The
+        // scoring below only reads them and can run concurrently.
+        const bool useHistograms = run.haveHistogramInfo 
+                && run.tracking_var_index >= 0
+                && m_params.correlation_weight != 0.0;
+        const size_t clusterCount = run.N + run.M;
+#if WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (size_t i = 0; i < clusterCount; i++) {
+            bool isPrevious = (i >= run.N);
+            typename Cluster<T>::ptr c = isPrevious 
+                ? run.previous->clusters[i - run.N] 
+                : run.current->clusters[i];
+            if (c->size() == 0) continue;
+            c->geometrical_center();
+            if (isPrevious && m_params.useOverlapConstraint) {
+                c->radius(run.cs);
+            }
+            if (useHistograms) {
+                c->histogram(run.tracking_var_index, run.valid_min, run.valid_max);
+            }
         }
-        ClusterIndex<T> index_c(run.current->clusters, run.cs->get_dimension_sizes());
-        ClusterIndex<T> index_p(run.previous->clusters, run.cs->get_dimension_sizes());
-
-        // Employ a mapping to parallelize
 
-        for (size_t idx = 0; idx < run.mapping.size(); idx++) {
-            vector<int> index_pair = run.mapping.linear_to_grid(idx);
+        // Pairs that were left out still take part in the normalisation
+        // of the size difference if they pass the overlap constraint.
+        // The largest difference for a previous cluster is attained at
+        // the smallest or largest current cluster.
+        if (m_params.size_weight != 0.0 && run.N > 0) {
+            size_t minSize = numeric_limits<size_t>::max();
+            size_t maxSize = 0;
+            for (size_t n = 0; n < run.N; n++) {
+                size_t size = run.current->clusters[n]->size();
+                if (size < minSize) minSize = size;
+                if (size > maxSize) maxSize = size;
+            }
+            for (size_t m = 0; m < run.M; m++) {
+                typename Cluster<T>::ptr p = run.previous->clusters[m];
+                if (m_params.useOverlapConstraint 
+                        && p->radius(run.cs) >= run.overlap_constraint_radius) {
+                    continue;
+                }
+                size_t extremes[2] = {minSize, maxSize};
+                for (size_t i = 0; i < 2; i++) {
+                    T largest = (T) max(p->size(), extremes[i]);
+                    T smallest = (T) min(p->size(), extremes[i]);
+                    T sizeDiff = (largest == 0) ? 1.0 : (largest - smallest);
+                    if (sizeDiff > run.maxSizeDifference) {
+                        run.maxSizeDifference = sizeDiff;
+                    }
+                }
+            }
+        }
 
-            int n = index_pair[0];
-            int m = index_pair[1];
+        // Score the rows in parallel. Each thread writes only into
+        // the rows it was handed and tracks its own maxima. Detailed
+        // logging forces a serial run to keep the output readable.
+#if WITH_OPENMP
+#pragma omp parallel if (!logDetails)
+#endif
+        {
+            int maxSizeDifference = run.maxSizeDifference;
+            ::units::values::m maxMidDisplacement = run.maxMidDisplacement;
 
-            // set all constraint flags to false to start with
-            run.matchPossible[n][m] = false;
+#if WITH_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (size_t n = 0; n < run.N; n++) {
+                for (size_t ci = run.candidateRows[n]; ci < run.candidateRows[n + 1]; ci++) {
+                    int m = run.candidates[ci].second;
 
-            typename Cluster<T>::ptr c = run.current->clusters[n];
-            typename Cluster<T>::ptr p = run.previous->clusters[m];
-            if (logDetails) {
-                cout << "\tmatch uuid:" << p->uuid
-                << " id:" << p->id
-                << " with uuid:" << c->uuid << " ";
-            }
+                    // set all constraint flags to false to start with
+                    run.matchPossible.set(n, m, false);
 
-            // How many percent of old cluster's points are shared by
-            // the new cluster?
-            run.coverOldByNew[n][m] = index_c.occupation_ratio(p, c);
-
-            // How many percent of the new cluster's points are shared
-            // by the old cluster
-            run.coverNewByOld[n][m] = index_p.occupation_ratio(c, p);
-
-            // Calculate this for merge/splits
-            vector<T> oldCenter, newCenter;
-            vector<T> dx = c->geometrical_center() - p->geometrical_center();
-            run.midDisplacement[n][m] = ::units::values::m(vector_norm(run.cs->to_meters(dx)));
-
-            //
-            // Overlap constraint
-            //
-            // if the object is so big, that overlap is required at the given advection velocity
-            // then check if that is the case. If no overlap exists, prohibit the match by setting
-            // the constraint to false. If no overlap is required, the constraint is simply set to
-            // true, thus allowing a match.
-
-            if (m_params.useOverlapConstraint) {
-                ::units::values::m radius = p->radius(run.cs);
-                bool requires_overlap = (radius >= run.overlap_constraint_radius);
-                if (requires_overlap && run.coverOldByNew[n][m] == 0.0) {
+                    typename Cluster<T>::ptr c = run.current->clusters[n];
+                    typename Cluster<T>::ptr p = run.previous->clusters[m];
                     if (logDetails) {
-                        cout << "precluded: violation of overlap constraint." << endl;
+                        cout << "\tmatch uuid:" << p->uuid
+                        << " id:" << p->id
+                        << " with uuid:" << c->uuid << " ";
                     }
-                    continue;
-                }
-            }
 
-            //
-            // Growth/shrink rate constraint
-            //
-            // Processes in nature develop within certain bounds. It is
-            // not possible that a cloud covers 10 pixels in one scan
-            // and 10.000 in the next. The size deviation constraint is
-            // created to prohibit matches between objects, which vary
-            // too much in size
-            T maxSize = (T) max(p->size(), c->size());
-            T minSize = (T) min(p->size(), c->size());
-            T sizeDiff =  (maxSize == 0) ? 1.0 : (maxSize - minSize);
-            run.sizeDifference[n][m] = sizeDiff;
-            if (m_params.size_weight != 0.0) {
-                if (run.sizeDifference[n][m] > run.maxSizeDifference) {
-                    run.maxSizeDifference = run.sizeDifference[n][m];
-                }
-            }
-            T sizeDeviation = (maxSize - minSize) / minSize;
-            if (sizeDeviation > m_params.max_size_deviation) {
-                if (logDetails) {
-                    cout << "precluded: violation of size constraint"
-                    << " (dH:" << sizeDeviation << " values"
-                    << " ,dH_max:" << m_params.max_size_deviation << " values)."
-                    << endl;
-                }
-                continue;
-            }
+                    // The coverage of old cluster's points by the new cluster
+                    // and vice versa was calculated in findCandidates
+
+                    // Calculate this for merge/splits
+                    vector<T> dx = c->geometrical_center() - p->geometrical_center();
+                    ::units::values::m midDisplacement = ::units::values::m(vector_norm(run.cs->to_meters(dx)));
+                    run.midDisplacement.set(n, m, midDisplacement);
+
+                    //
+                    // Overlap constraint
+                    //
+                    // if the object is so big, that overlap is required at the given advection velocity
+                    // then check if that is the case. If no overlap exists, prohibit the match by setting
+                    // the constraint to false. If no overlap is required, the constraint is simply set to
+                    // true, thus allowing a match.
+
+                    if (m_params.useOverlapConstraint) {
+                        ::units::values::m radius = p->radius(run.cs);
+                        bool requires_overlap = (radius >= run.overlap_constraint_radius);
+                        if (requires_overlap && run.coverOldByNew.get(n, m) == 0.0) {
+                            if (logDetails) {
+                                cout << "precluded: violation of overlap constraint." << endl;
+                            }
+                            continue;
+                        }
+                    }
 
-            //
-            // Maximum velocity constraint
-            //
+                    //
+                    // Growth/shrink rate constraint
+                    //
+                    // Processes in nature develop within certain bounds. It is
+                    // not possible that a cloud covers 10 pixels in one scan
+                    // and 10.000 in the next. The size deviation constraint is
+                    // created to prohibit matches between objects, which vary
+                    // too much in size
+                    T maxSize = (T) max(p->size(), c->size());
+                    T minSize = (T) min(p->size(), c->size());
+                    T sizeDiff =  (maxSize == 0) ? 1.0 : (maxSize - minSize);
+                    run.sizeDifference.set(n, m, sizeDiff);
+                    if (m_params.size_weight != 0.0) {
+                        if (sizeDiff > maxSizeDifference) {
+                            maxSizeDifference = sizeDiff;
+                        }
+                    }
+                    T sizeDeviation = (maxSize - minSize) / minSize;
+                    if (sizeDeviation > m_params.max_size_deviation) {
+                        if (logDetails) {
+                            cout << "precluded: violation of size constraint"
+                            << " (dH:" << sizeDeviation << " values"
+                            << " ,dH_max:" << m_params.max_size_deviation << " values)."
+                            << endl;
+                        }
+                        continue;
+                    }
 
-            if (run.midDisplacement[n][m] > run.maxDisplacement) {
-                if (logDetails) {
-                    cout << "precluded: violation of max displacement"
-                         << " (dR:" << run.midDisplacement[n][m]
-                         << " dR_max:" << run.maxDisplacement
-                         << ")." << endl;
-                }
-                continue;
-            }
+                    //
+                    // Maximum velocity constraint
+                    //
 
-            //
-            // Histogram correlation values
-            //
-
-            // Just as the number of values will have some continuity,
-            // so will the distribution of values for a cluster. This
-            // fact is checked by creating a correlation between the
-            // histograms of the two clusters. Perfect match means
-            // a value of 1. No correlation at all means a value of 0.
-
-            if (run.haveHistogramInfo && m_params.correlation_weight != 0.0) {
-                typename Histogram<T>::ptr hist_p
-                        = p->histogram(run.tracking_var_index, run.valid_min, run.valid_max);
-                typename Histogram<T>::ptr hist_c
-                        = c->histogram(run.tracking_var_index, run.valid_min, run.valid_max);
-                run.rankCorrelation[n][m] = hist_c->correlate_kendall(hist_p);
-            }
+                    if (midDisplacement > run.maxDisplacement) {
+                        if (logDetails) {
+                            cout << "precluded: violation of max displacement"
+                                 << " (dR:" << midDisplacement
+                                 << " dR_max:" << run.maxDisplacement
+                                 << ")." << endl;
+                        }
+                        continue;
+                    }
 
-            //
-            // only if all constraints are passed, the flag is set to true
-            //
-            run.matchPossible[n][m] = true;
+                    //
+                    // Histogram correlation values
+                    //
+
+                    // Just as the number of values will have some continuity,
+                    // so will the distribution of values for a cluster. This
+                    // fact is checked by creating a correlation between the
+                    // histograms of the two clusters. Perfect match means
+                    // a value of 1. No correlation at all means a value of 0.
+
+                    if (useHistograms) {
+                        typename Histogram<T>::ptr hist_p
+                                = p->histogram(run.tracking_var_index, run.valid_min, run.valid_max);
+                        typename Histogram<T>::ptr hist_c
+                                = c->histogram(run.tracking_var_index, run.valid_min, run.valid_max);
+                        run.rankCorrelation.set(n, m, hist_c->correlate_kendall(hist_p));
+                    }
 
-            // Keep track of the largest distance in all possible
-            // matches for making values relative later.
-            if (run.midDisplacement[n][m] > run.maxMidDisplacement) {
-                run.maxMidDisplacement = run.midDisplacement[n][m];
-            }
+                    //
+                    // only if all constraints are passed, the flag is set to true
+                    //
+                    run.matchPossible.set(n, m, true);
 
-            if (logDetails) {
-                cout << "possible." << endl;
-            }
+                    // Keep track of the largest distance in all possible
+                    // matches for making values relative later.
+                    if (midDisplacement > maxMidDisplacement) {
+                        maxMidDisplacement = midDisplacement;
+                    }
 
-        } // done finishing correlation table
+                    if (logDetails) {
+                        cout << "possible." << endl;
+                    }
 
-        // Now re-tag new clusters with no id
-        run.current->erase_identifiers();
+                }
+            } // done finishing correlation table
+
+#if WITH_OPENMP
+#pragma omp critical
+#endif
+            {
+                if (maxSizeDifference > run.maxSizeDifference) {
+                    run.maxSizeDifference = maxSizeDifference;
+                }
+                if (maxMidDisplacement > run.maxMidDisplacement) {
+                    run.maxMidDisplacement = maxMidDisplacement;
+                }
+            }
+        }
 
         // Can't have zeros here
         if (run.maxSizeDifference == 0) {
@@ -454,45 +588,44 @@ namespace m3D {
             cout << endl;
         }
 
-        for (size_t idx = 0; idx < run.mapping.size(); idx++) {
-            vector<int> index_pair = run.mapping.linear_to_grid(idx);
-
-            int n = index_pair[0];
-            int m = index_pair[1];
-
-            typename Cluster<T>::ptr c = run.current->clusters[n];
-            typename Cluster<T>::ptr p = run.previous->clusters[m];
-
-            // Only calculate values for pairs, that satisfy the
-            // overlap constraint
-
-            if (run.matchPossible[n][m]) {
-                // The probability of the distance based matching estimate
-                // is the 
-                float prob_r = erfc(run.midDisplacement[n][m].get() / run.maxMidDisplacement.get());
-
-                float prob_h = 0;
-                float prob_t = 0;
-
-                if (run.tracking_var_index >= 0) {
-                    // The probability for the histogram match is 
-                    // the complementary error function of the relative
-                    // histogram difference. The larger it is, the smaller
-                    // the value will be
-                    prob_h = erfc(run.sizeDifference[n][m] / run.maxSizeDifference);
+#if WITH_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (size_t n = 0; n < run.N; n++) {
+                for (size_t ci = run.candidateRows[n]; ci < run.candidateRows[n + 1]; ci++) {
+                int m = run.candidates[ci].second;
+
+                // Only calculate values for pairs, that satisfy the
+                // overlap constraint
+
+                if (run.matchPossible.get(n, m)) {
+                    // The probability of the distance based matching estimate
+                    // is the 
+                    float prob_r = erfc(run.midDisplacement.get(n, m).get() / run.maxMidDisplacement.get());
+
+                    float prob_h = 0;
+                    float prob_t = 0;
+
+                    if (run.tracking_var_index >= 0) {
+                        // The probability for the histogram match is 
+                        // the complementary error function of the relative
+                        // histogram difference. The larger it is, the smaller
+                        // the value will be
+                        prob_h = erfc(run.sizeDifference.get(n, m) / run.maxSizeDifference);
+
+                        // The probability of the 'signature' match is the
+                        // raw output of the kendall's tau correlation of 
+                        // the cluster histograms
+                        prob_t = run.rankCorrelation.get(n, m);
+                    }
 
-                    // The probability of the 'signature' match is the
-                    // raw output of the kendall's tau correlation of 
-                    // the cluster histograms
-                    prob_t = run.rankCorrelation[n][m];
+                    // The final matching probability is a 
+                    // weighed sum of all three factors. 
+                    run.likelihood.set(n, m, 
+                              m_params.range_weight * prob_r
+                            + m_params.size_weight * prob_h
+                            + m_params.correlation_weight * prob_t);
                 }
-
-                // The final matching probability is a 
-                // weighed sum of all three factors. 
-                run.likelihood[n][m]
-                        = m_params.range_weight * prob_r
-                        + m_params.size_weight * prob_h
-                        + m_params.correlation_weight * prob_t;
             }
         }
 
@@ -511,19 +644,21 @@ namespace m3D {
                         << ")" << endl;
                 }
 
-                for (int m = 0; m < run.M; m++) {
-                    if (run.matchPossible[n][m]) {
+                SparseMatrix<int>::row_t::const_iterator ri;
+                for (ri = run.matchPossible.row(n).begin(); ri != run.matchPossible.row(n).end(); ++ri) {
+                    int m = ri->first;
+                    if (ri->second) {
                         typename Cluster<T>::ptr p = run.previous->clusters[m];
                         printf("\t\tuuid:%4llu \tid:%4lu\t(|H|=%5lu)\t\tdR=%4.1f\tdH=%5.4f\ttau=%7.4f\tsum=%6.4f\t\tcovON=%3.2f\t\tcovNO=%3.2f\n",
                                 p->uuid,
                                 p->id,
                                 p->size(),
-                                run.midDisplacement[n][m].get(),
-                                run.sizeDifference[n][m],
-                                run.rankCorrelation[n][m],
-                                run.likelihood[n][m],
-                                run.coverOldByNew[n][m],
-                                run.coverNewByOld[n][m]);
+                                run.midDisplacement.get(n, m).get(),
+                                run.sizeDifference.get(n, m),
+                                run.rankCorrelation.get(n, m),
+                                run.likelihood.get(n, m),
+                                run.coverOldByNew.get(n, m),
+                                run.coverNewByOld.get(n, m));
                     }
                 }
             }
@@ -548,12 +683,11 @@ namespace m3D {
         int iterations = 0;
 
         // put the matches in a special data structure
-        for (size_t idx = 0; idx < run.mapping.size(); idx++) {
-            vector<int> index_pair = run.mapping.linear_to_grid(idx);
-            int n = index_pair[0];
-            int m = index_pair[1];
-            if (!run.matchPossible[n][m]) continue;
-            run.matches.push_back(match_t(idx, run.likelihood[n][m]));
+        for (size_t ci = 0; ci < run.candidates.size(); ci++) {
+            int n = run.candidates[ci].first;
+            int m = run.candidates[ci].second;
+            if (!run.matchPossible.get(n, m)) continue;
+            run.matches.push_back(match_t(ci, run.likelihood.get(n, m)));
         }
 
         // sort the matches in descending order of probability
@@ -576,9 +710,8 @@ namespace m3D {
             match_t match = run.matches.at(mi);
 
             // back to n/m indexes
-            vector<int> pairing = run.mapping.linear_to_grid(match.first);
-            int n = pairing[0];
-            int m = pairing[1];
+            int n = run.candidates[match.first].first;
+            int m = run.candidates[match.first].second;
 
             typename Cluster<T>::ptr c = run.current->clusters[n];
             typename Cluster<T>::ptr p = run.previous->clusters[m];
@@ -623,7 +756,7 @@ namespace m3D {
             run.matched_uuids.insert(c->uuid);
 
             // Update for mean velocity calculation
-            ::units::values::meters_per_second velocity = run.midDisplacement[n][m] / run.deltaT;
+            ::units::values::meters_per_second velocity = run.midDisplacement.get(n, m) / run.deltaT;
             velocitySum += velocity;
             velocityClusterCount++;
 
@@ -690,9 +823,9 @@ namespace m3D {
     Tracking<T>::getMergeCriterion(typename Tracking<T>::tracking_run_t &run, const int &n, const int &m) {
         typename Cluster<T>::ptr c = run.current->clusters[n];
         typename Cluster<T>::ptr p = run.previous->clusters[m];
-        double nbo = run.coverNewByOld[n][m];
-        double dR = run.midDisplacement[n][m].get();
-        double dH = run.sizeDifference[n][m];
+        double nbo = run.coverNewByOld.get(n, m);
+        double dR = run.midDisplacement.get(n, m).get();
+        double dH = run.sizeDifference.get(n, m);
         double s = nbo * (erfc(dR/run.maxMidDisplacement.get()) + erfc(dH/run.maxSizeDifference));
         return s;
     }
@@ -707,7 +840,7 @@ namespace m3D {
         bool maxIsTied = false;
         for (size_t i=0; i < candidates.size(); i++) {
             int m = candidates[i];
-            if (run.coverNewByOld[n][m] >= m_params.mergeSplitContinuationThreshold) {
+            if (run.coverNewByOld.get(n, m) >= m_params.mergeSplitContinuationThreshold) {
                 double s = getMergeCriterion(run, n, m);
                 if (s >= maxS) {
                     if (s==maxS) maxIsTied = true;
@@ -719,6 +852,49 @@ namespace m3D {
         return maxIsTied ? -1 : maxM;
     }
 
+    template <typename T>
+    void
+    Tracking<T>::buildOverlapGraph(typename Tracking<T>::tracking_run_t &run)
+    {
+        run.previousOverlaps.assign(run.N, vector<int>());
+        run.currentOverlaps.assign(run.M, vector<int>());
+
+        // Only overlapping pairs have non-zero coverage. All others
+        // have a merge/split criterion of 0 and can't compete.
+        for (size_t n = 0; n < run.N; n++) {
+            const typename SparseMatrix<T>::row_t &row = run.coverOldByNew.row(n);
+            typename SparseMatrix<T>::row_t::const_iterator ri;
+            for (ri = row.begin(); ri != row.end(); ++ri) {
+                size_t m = ri->first;
+                if (ri->second > 0 || run.coverNewByOld.get(n, m) > 0) {
+                    run.previousOverlaps[n].push_back(m);
+                    run.currentOverlaps[m].push_back(n);
+                }
+            }
+        }
+
+        run.maxMergeCriterion.assign(run.M, -1.0);
+        run.maxSplitCriterion.assign(run.N, -1.0);
+        for (size_t n = 0; n < run.N; n++) {
+            for (size_t i = 0; i < run.previousOverlaps[n].size(); i++) {
+                int m = run.previousOverlaps[n][i];
+                double s = getMergeCriterion(run, n, m);
+                if (s > run.maxMergeCriterion[m]) {
+                    run.maxMergeCriterion[m] = s;
+                }
+                s = getSplitCriterion(run, n, m);
+                if (s > run.maxSplitCriterion[n]) {
+                    run.maxSplitCriterion[n] = s;
+                }
+            }
+        }
+
+        run.previousById.clear();
+        for (size_t m = 0; m < run.M; m++) {
+            run.previousById[run.previous->clusters[m]->id].push_back(m);
+        }
+    }
+
     template <typename T>
     void
     Tracking<T>::getMergeCandidates(typename Tracking<T>::tracking_run_t &run,
@@ -728,42 +904,44 @@ namespace m3D {
                                     id_set_t &candidateIds)
     {
         typename Cluster<T>::ptr c = run.current->clusters.at(n);
-        for (size_t m = 0; m < run.M; m++) {
-            typename Cluster<T>::ptr p = run.previous->clusters.at(m);
-            if (c->id == p->id) {
-                candidates.push_back(m);
-                candidateIds.insert(p->id);
+
+        // Previous clusters carrying the same id
+        typename id_index_t::const_iterator ii = run.previousById.find(c->id);
+        if (ii != run.previousById.end()) {
+            for (size_t i = 0; i < ii->second.size(); i++) {
+                candidates.push_back(ii->second[i]);
+                candidateIds.insert(c->id);
                 track_flag = true;
-            } else {
+            }
+        }
 
-                // Check if this (previous) cluster was already associated
-                // with a cluster from the current set? If so, exclude it
-                id_set_t::const_iterator fi = run.current->tracked_ids.find(p->id);
-                if (fi != run.current->tracked_ids.end()) continue;
-
-                // Not tracked
-                T obn = run.coverOldByNew[n][m];
-                if (obn >= m_params.mergeSplitThreshold) {
-
-                    // Check for each of the candidates what the merge criteria
-                    // s is and find out if there is another combination with
-                    // higher s. If so, do not add the candidate here.
-                    double s1 = getMergeCriterion(run, n, m);
-                    bool foundBetter = false;
-                    for (int nn = 0; nn < run.N && !foundBetter; nn++) {
-                        if (nn == n) continue;
-                        double s2 = getMergeCriterion(run, nn, m);
-                        if (s2 > s1) {
-                            foundBetter = true;
-                        }
-                    }
-                    if (!foundBetter) {
-                        candidateIds.insert(p->id);
-                        candidates.push_back(m);
-                    }
+        const vector<int> &overlaps = run.previousOverlaps[n];
+        for (size_t i = 0; i < overlaps.size(); i++) {
+            int m = overlaps[i];
+            typename Cluster<T>::ptr p = run.previous->clusters.at(m);
+            if (c->id == p->id) continue;
+
+            // Check if this (previous) cluster was already associated
+            // with a cluster from the current set? If so, exclude it
+            id_set_t::const_iterator fi = run.current->tracked_ids.find(p->id);
+            if (fi != run.current->tracked_ids.end()) continue;
+
+            // Not tracked
+            T obn = run.coverOldByNew.get(n, m);
+            if (obn >= m_params.mergeSplitThreshold) {
+
+                // Only add the candidate if no other current cluster
+                // has a higher merge criterion with it
+                double s1 = getMergeCriterion(run, n, m);
+                if (!(run.maxMergeCriterion[m] > s1)) {
+                    candidateIds.insert(p->id);
+                    candidates.push_back(m);
                 }
             }
         }
+
+        // Candidates are expected in index order
+        std::sort(candidates.begin(), candidates.end());
     }
 
     template <typename T>
@@ -828,9 +1006,9 @@ namespace m3D {
     Tracking<T>::getSplitCriterion(typename Tracking<T>::tracking_run_t &run, const int &n, const int &m) {
         typename Cluster<T>::ptr c = run.current->clusters[n];
         typename Cluster<T>::ptr p = run.previous->clusters[m];
-        double obn = run.coverOldByNew[n][m];
-        double dR = run.midDisplacement[n][m].get();
-        double dH = run.sizeDifference[n][m];
+        double obn = run.coverOldByNew.get(n, m);
+        double dR = run.midDisplacement.get(n, m).get();
+        double dH = run.sizeDifference.get(n, m);
         double s = obn * (erfc(dR/run.maxMidDisplacement.get()) + erfc(dH/run.maxSizeDifference));
         return s;
     }
@@ -845,7 +1023,7 @@ namespace m3D {
         bool maxIsTied = false;
         for (size_t i=0; i < candidates.size(); i++) {
             int n = candidates[i];
-            if (run.coverOldByNew[n][m] >= m_params.mergeSplitContinuationThreshold) {
+            if (run.coverOldByNew.get(n, m) >= m_params.mergeSplitContinuationThreshold) {
                 double s = getSplitCriterion(run, n, m);
                 if (s >= maxS) {
                     if (s==maxS) maxIsTied = true;
@@ -866,43 +1044,45 @@ namespace m3D {
                                     uuid_set_t &candidateUuids)
     {
         typename Cluster<T>::ptr p = run.previous->clusters.at(m);
-        for (size_t n = 0; n < run.N; n++) {
-            typename Cluster<T>::ptr c = run.current->clusters.at(n);
-            if (c->id == p->id) {
+
+        // Current clusters carrying the same id
+        typename id_index_t::const_iterator ii = run.currentById.find(p->id);
+        if (ii != run.currentById.end()) {
+            for (size_t i = 0; i < ii->second.size(); i++) {
+                int n = ii->second[i];
                 candidates.push_back(n);
-                candidateUuids.insert(c->uuid);
+                candidateUuids.insert(run.current->clusters.at(n)->uuid);
                 track_flag = true;
-            } else {
+            }
+        }
 
-                // Check if this (current) cluster was already associated
-                // with a cluster from the previous set? If so, exclude it
-                id_set_t::const_iterator fi = run.current->tracked_ids.find(c->id);
-                if (fi != run.current->tracked_ids.end()) continue;
-
-                // Not tracked
-                T obn = run.coverNewByOld[n][m];
-                if (obn >= m_params.mergeSplitThreshold) {
-
-                    // Check for each of the candidates what the split criteria
-                    // s is and find out if there is another combination with
-                    // higher s. If so, do not add the candidate here.
-
-                    double s1 = getSplitCriterion(run, n, m);
-                    bool foundBetter = false;
-                    for (int mm = 0; mm < run.M && !foundBetter; mm++) {
-                        if (mm == m) continue;
-                        double s2 = getSplitCriterion(run, n, mm);
-                        if (s2 > s1) {
-                            foundBetter = true;
-                        }
-                    }
-                    if (!foundBetter) {
-                        candidateUuids.insert(c->uuid);
-                        candidates.push_back(n);
-                    }
+        const vector<int> &overlaps = run.currentOverlaps[m];
+        for (size_t i = 0; i < overlaps.size(); i++) {
+            int n = overlaps[i];
+            typename Cluster<T>::ptr c = run.current->clusters.at(n);
+            if (c->id == p->id) continue;
+
+            // Check if this (current) cluster was already associated
+            // with a cluster from the previous set? If so, exclude it
+            id_set_t::const_iterator fi = run.current->tracked_ids.find(c->id);
+            if (fi != run.current->tracked_ids.end()) continue;
+
+            // Not tracked
+            T obn = run.coverNewByOld.get(n, m);
+            if (obn >= m_params.mergeSplitThreshold) {
+
+                // Only add the candidate if no other previous cluster
+                // has a higher split criterion with it
+                double s1 = getSplitCriterion(run, n, m);
+                if (!(run.maxSplitCriterion[n] > s1)) {
+                    candidateUuids.insert(c->uuid);
+                    candidates.push_back(n);
                 }
             }
         }
+
+        // Candidates are expected in index order
+        std::sort(candidates.begin(), candidates.end());
     }
 
 
@@ -916,6 +1096,14 @@ namespace m3D {
         }
         bool had_splits = false;
         size_t n, m;
+
+        // Ids of current clusters change while re-tagging, so the
+        // index is built here and kept up to date below
+        run.currentById.clear();
+        for (n = 0; n < run.N; n++) {
+            run.currentById[run.current->clusters[n]->id].push_back(n);
+        }
+
         for (m = 0; m < run.M; m++) {
             typename Cluster<T>::ptr p = run.previous->clusters[m];
 
@@ -942,7 +1130,11 @@ namespace m3D {
                         }
                         run.current->new_ids.erase(c->id);
                         run.current->tracked_ids.insert(c->id);
+                        vector<int> &previous_owners = run.currentById[c->id];
+                        previous_owners.erase(std::remove(previous_owners.begin(),
+                                previous_owners.end(), winner), previous_owners.end());
                         c->id = p->id;
+                        run.currentById[c->id].push_back(winner);
                     }
                 }
 
@@ -978,19 +1170,36 @@ namespace m3D {
     template <typename T>
     void
     Tracking<T>::track(typename ClusterList<T>::ptr previous,
-            typename ClusterList<T>::ptr current)
+            typename ClusterList<T>::ptr current,
+            const CoordinateSystem<T> *cs)
     {
         bool logNormal = m_params.verbosity >= VerbosityNormal;
 
         if (logNormal) cout << "Tracking:" << endl;
 
+        utils::Profiler &profiler = utils::Profiler::instance();
+        utils::ScopedTimer track_timer("tracking");
+
         tracking_run_t run;
         run.previous = previous;
         run.current = current;
+        run.cs = cs;
+        run.owns_cs = false;
+        run.info_file = NULL;
         if (logNormal) start_timer("-- Calculating preliminaries ... ");
+        profiler.begin("preliminaries");
         bool skip_tracking = initialise(run);
+        profiler.count("previous clusters", previous->size());
+        profiler.count("current clusters", current->size());
+        profiler.end();
         if (logNormal) stop_timer("done");
         if (skip_tracking) {
+            if (run.owns_cs && run.cs != NULL) {
+                delete run.cs;
+            }
+            if (run.info_file != NULL) {
+                delete run.info_file;
+            }
             return;
         }
 
@@ -1004,7 +1213,9 @@ namespace m3D {
         // utils::VisitUtils<T>::write_clusters_vtu_wholesale(previous, cs, "unshifted");
         if (m_params.useDisplacementVectors) {
             if (logNormal) start_timer("-- Shifting clusters ... ");
+            profiler.begin("advection");
             advectClusters(run);
+            profiler.end();
             if (logNormal) stop_timer("done");
 
         }
@@ -1014,22 +1225,31 @@ namespace m3D {
         current->erase_identifiers();
 
         if (logNormal) start_timer("-- Calculating correlation data ... ");
+        profiler.begin("correlation");
         calculateCorrelationData(run);
+        profiler.end();
         if (logNormal) stop_timer("done");
 
         if (logNormal) start_timer("-- Calculating match probabilities ... ");
+        profiler.begin("probabilities");
         calculateProbabilities(run);
+        profiler.end();
         if (logNormal) stop_timer("done");
 
         if (logNormal) start_timer("-- Matchmaking ... ");
+        profiler.begin("matchmaking");
         matchmaking(run);
+        profiler.end();
         if (logNormal) stop_timer("done");
 
         if (logNormal) start_timer("-- Merging and splitting ... ");
         // Calculate merges and splits
+        profiler.begin("merges and splits");
+        buildOverlapGraph(run);
         handleMerges(run);
         handleSplits(run);
         removeScheduled(run);
+        profiler.end();
         if (logNormal) stop_timer("done");
 
         // Restore save precision
@@ -1040,10 +1260,14 @@ namespace m3D {
         current->highest_uuid = run.highestUuid;
 
         // Clean up
-        if (run.cs != NULL) {
+        if (run.owns_cs && run.cs != NULL) {
             delete run.cs;
             run.cs = NULL;
         }
+        if (run.info_file != NULL) {
+            delete run.info_file;
+            run.info_file = NULL;
+        }
     }
 }
 
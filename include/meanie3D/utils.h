@@ -26,7 +26,8 @@
 
 #include <meanie3D/utils/verbosity.h>
 #include <meanie3D/utils/array_utils.h>
-#include <meanie3D/utils/cluster_index.h>
+#include <meanie3D/utils/cell_hash.h>
+#include <meanie3D/utils/cluster_overlap.h>
 #include <meanie3D/utils/commandline.h>
 #include <meanie3D/utils/file_utils.h>
 #include <meanie3D/utils/gaussian_normal.h>
@@ -34,9 +35,12 @@
 #include <meanie3D/utils/matrix.h>
 #include <meanie3D/utils/netcdf_utils.h>
 #include <meanie3D/utils/opencv_utils.h>
+#include <meanie3D/utils/ordered_queue.h>
+#include <meanie3D/utils/profiler.h>
 #include <meanie3D/utils/rand_utils.h>
 #include <meanie3D/utils/set_utils.h>
 #include <meanie3D/utils/time_utils.h>
+#include <meanie3D/utils/union_find.h>
 #include <meanie3D/utils/vector_utils.h>
 #include <meanie3D/utils/visit.h>
 
@@ -0,0 +1,160 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_CELL_HASH_H
+#define M3D_CELL_HASH_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace m3D {
+    namespace utils {
+
+        /** Sorts positions into a uniform grid of cubic cells, hashed 
+         * by the linear index of the cell within the bounding box of 
+         * all cells. Any position within cell_size of a given position 
+         * lies in one of the 3^rank cells around that position's cell.
+         */
+        template <typename T>
+        class CellHash
+        {
+        private:
+
+            typedef boost::unordered_map<size_t, std::vector<size_t> > cell_map_t;
+
+            T m_cell_size;
+            std::vector<long> m_origin;
+            std::vector<long> m_extent;
+            std::vector<size_t> m_strides;
+            cell_map_t m_cells;
+
+            /** @return index of the cell containing x in dimension d */
+            inline long cell(const std::vector<T> &x, size_t d) const
+            {
+                return (m_cell_size > 0) ? (long) floor(x[d] / m_cell_size) : 0;
+            }
+
+        public:
+
+            /** @param positions (all of the same rank)
+             * @param id of each position
+             * @param edge length of the cells. If it is not positive,
+             * all positions end up in one cell.
+             */
+            CellHash(const std::vector< std::vector<T> > &positions,
+                    const std::vector<size_t> &ids,
+                    T cell_size)
+            : m_cell_size(cell_size)
+            {
+                if (positions.empty()) {
+                    return;
+                }
+
+                const size_t rank = positions[0].size();
+
+                std::vector<long> upper(rank);
+                m_origin.resize(rank);
+                for (size_t d = 0; d < rank; d++) {
+                    m_origin[d] = upper[d] = this->cell(positions[0], d);
+                }
+                for (size_t i = 1; i < positions.size(); i++) {
+                    for (size_t d = 0; d < rank; d++) {
+                        long c = this->cell(positions[i], d);
+                        if (c < m_origin[d]) m_origin[d] = c;
+                        if (c > upper[d]) upper[d] = c;
+                    }
+                }
+
+                m_extent.resize(rank);
+                m_strides.resize(rank);
+                size_t stride = 1;
+                for (size_t d = rank; d > 0; d--) {
+                    m_extent[d - 1] = upper[d - 1] - m_origin[d - 1] + 1;
+                    m_strides[d - 1] = stride;
+                    stride *= m_extent[d - 1];
+                }
+
+                for (size_t i = 0; i < positions.size(); i++) {
+                    size_t key = 0;
+                    for (size_t d = 0; d < rank; d++) {
+                        key += (this->cell(positions[i], d) - m_origin[d]) * m_strides[d];
+                    }
+                    m_cells[key].push_back(ids[i]);
+                }
+            }
+
+            /** @return number of occupied cells */
+            size_t size() const
+            {
+                return m_cells.size();
+            }
+
+            /** Collects the ids of the positions in the cells around
+             * the cell of x. These are candidates only, their distance
+             * to x is not tested.
+             * @param position
+             * @param ids (cleared first)
+             */
+            void neighbours(const std::vector<T> &x, std::vector<size_t> &result) const
+            {
+                result.clear();
+
+                if (m_cells.empty()) {
+                    return;
+                }
+
+                const size_t rank = m_origin.size();
+
+                size_t num_neighbours = 1;
+                for (size_t d = 0; d < rank; d++) {
+                    num_neighbours *= 3;
+                }
+
+                for (size_t k = 0; k < num_neighbours; k++) {
+                    size_t code = k;
+                    size_t key = 0;
+                    bool inside = true;
+                    for (size_t d = 0; d < rank && inside; d++) {
+                        long c = this->cell(x, d) + ((long) (code % 3)) - 1 - m_origin[d];
+                        code /= 3;
+                        inside = (c >= 0 && c < m_extent[d]);
+                        key += c * m_strides[d];
+                    }
+                    if (!inside) continue;
+
+                    typename cell_map_t::const_iterator ci = m_cells.find(key);
+                    if (ci != m_cells.end()) {
+                        result.insert(result.end(), ci->second.begin(), ci->second.end());
+                    }
+                }
+            }
+        };
+    }
+}
+
+#endif
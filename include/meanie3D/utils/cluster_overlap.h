@@ -0,0 +1,110 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_CLUSTEROVERLAP_H
+#define M3D_CLUSTEROVERLAP_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+#include <meanie3D/clustering/cluster.h>
+#include <meanie3D/utils/matrix.h>
+
+#include <utility>
+#include <vector>
+
+namespace m3D {
+    namespace utils {
+
+        using std::vector;
+
+        /** Computes the pairwise overlap between the clusters of two
+         * lists. The grid points of each list are turned into a stream
+         * of (linear grid index, cluster index) pairs, which is sorted
+         * once. A single merge pass over both streams then yields the
+         * number of shared grid points for all pairs of clusters. Time
+         * and memory are proportional to the number of points in the
+         * clusters, not to the size of the domain.
+         */
+        template <typename T>
+        class ClusterOverlap
+        {
+        public:
+
+            typedef std::pair<size_t, size_t> label_t;
+            typedef vector<label_t> stream_t;
+
+        private:
+
+            vector<size_t> m_sizes_a;
+            vector<size_t> m_sizes_b;
+
+            /** m_common.get(a,b) = number of grid points shared
+             * by cluster a of the first and b of the second list */
+            SparseMatrix<size_t> m_common;
+
+            /** Creates the sorted label stream of a cluster list
+             */
+            static void
+            label_stream(const typename Cluster<T>::list &list,
+                    const vector<size_t> &dimensions,
+                    stream_t &stream,
+                    vector<size_t> &sizes);
+
+        public:
+
+            /** Calculates the overlap of all clusters in list a with
+             * all clusters in list b.
+             * 
+             * @param first cluster list
+             * @param second cluster list
+             * @param dimensions of the grid the clusters live on
+             */
+            ClusterOverlap(const typename Cluster<T>::list &a,
+                    const typename Cluster<T>::list &b,
+                    const vector<size_t> &dimensions);
+
+            /** @return number of grid points shared by cluster
+             * i of the first list and j of the second list
+             */
+            size_t common(size_t i, size_t j) const;
+
+            /** @return which part of cluster i of the first list is
+             * covered by cluster j of the second list (0..1)
+             */
+            double ratio_a(size_t i, size_t j) const;
+
+            /** @return which part of cluster j of the second list is
+             * covered by cluster i of the first list (0..1)
+             */
+            double ratio_b(size_t i, size_t j) const;
+
+            /** @return sparse matrix of shared grid point counts. Row i 
+             * holds the overlapping clusters of the second list for
+             * cluster i of the first list.
+             */
+            const SparseMatrix<size_t> &counts() const;
+        };
+    }
+}
+
+#endif
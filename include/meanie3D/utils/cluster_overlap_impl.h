@@ -0,0 +1,136 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_CLUSTEROVERLAP_IMPL_H
+#define M3D_CLUSTEROVERLAP_IMPL_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+#include <meanie3D/featurespace/point.h>
+
+#include <algorithm>
+
+#include "cluster_overlap.h"
+
+namespace m3D {
+    namespace utils {
+
+        template <typename T>
+        void
+        ClusterOverlap<T>::label_stream(const typename Cluster<T>::list &list,
+                const vector<size_t> &dimensions,
+                stream_t &stream,
+                vector<size_t> &sizes)
+        {
+            size_t total = 0;
+            sizes.resize(list.size());
+            for (size_t ci = 0; ci < list.size(); ci++) {
+                sizes[ci] = list[ci]->size();
+                total += sizes[ci];
+            }
+
+            stream.clear();
+            stream.reserve(total);
+            for (size_t ci = 0; ci < list.size(); ci++) {
+                typename Cluster<T>::ptr c = list[ci];
+                for (size_t pi = 0; pi < c->size(); pi++) {
+                    const vector<int> &gp = c->at(pi)->gridpoint;
+                    size_t index = 0;
+                    for (size_t d = 0; d < dimensions.size(); d++) {
+                        index = index * dimensions[d] + gp[d];
+                    }
+                    stream.push_back(label_t(index, ci));
+                }
+            }
+
+            std::sort(stream.begin(), stream.end());
+        }
+
+        template <typename T>
+        ClusterOverlap<T>::ClusterOverlap(const typename Cluster<T>::list &a,
+                const typename Cluster<T>::list &b,
+                const vector<size_t> &dimensions)
+        : m_common(a.size(), b.size(), 0)
+        {
+            stream_t stream_a, stream_b;
+            label_stream(a, dimensions, stream_a, m_sizes_a);
+            label_stream(b, dimensions, stream_b, m_sizes_b);
+
+            // Merge pass. Runs of equal grid indexes are paired up
+            // with each other.
+            size_t i = 0, j = 0;
+            while (i < stream_a.size() && j < stream_b.size()) {
+                size_t index_a = stream_a[i].first;
+                size_t index_b = stream_b[j].first;
+                if (index_a < index_b) {
+                    i++;
+                } else if (index_b < index_a) {
+                    j++;
+                } else {
+                    size_t end_a = i, end_b = j;
+                    while (end_a < stream_a.size() && stream_a[end_a].first == index_a) end_a++;
+                    while (end_b < stream_b.size() && stream_b[end_b].first == index_b) end_b++;
+                    for (size_t ia = i; ia < end_a; ia++) {
+                        for (size_t ib = j; ib < end_b; ib++) {
+                            size_t ca = stream_a[ia].second;
+                            size_t cb = stream_b[ib].second;
+                            m_common.set(ca, cb, m_common.get(ca, cb) + 1);
+                        }
+                    }
+                    i = end_a;
+                    j = end_b;
+                }
+            }
+        }
+
+        template <typename T>
+        size_t
+        ClusterOverlap<T>::common(size_t i, size_t j) const
+        {
+            return m_common.get(i, j);
+        }
+
+        template <typename T>
+        double
+        ClusterOverlap<T>::ratio_a(size_t i, size_t j) const
+        {
+            return m_sizes_a[i] == 0 ? 0.0 : ((double) m_common.get(i, j)) / ((double) m_sizes_a[i]);
+        }
+
+        template <typename T>
+        double
+        ClusterOverlap<T>::ratio_b(size_t i, size_t j) const
+        {
+            return m_sizes_b[j] == 0 ? 0.0 : ((double) m_common.get(i, j)) / ((double) m_sizes_b[j]);
+        }
+
+        template <typename T>
+        const SparseMatrix<size_t> &
+        ClusterOverlap<T>::counts() const
+        {
+            return m_common;
+        }
+    }
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 
+#include <map>
 #include <vector>
 
 namespace m3D {
@@ -54,6 +55,58 @@ namespace m3D {
             static flag_matrix_t
             create_flag_matrix(size_t width, size_t height, int defaultValue = 0);
         };
+
+        // Sparse Matrix
+
+        /** Row-wise sparse matrix. Only explicitly set entries are
+         * stored, all other entries read as the default value. Rows
+         * can be written concurrently by different threads as long
+         * as no two threads write into the same row.
+         */
+        template <typename V>
+        class SparseMatrix
+        {
+        public:
+
+            typedef std::map<size_t, V> row_t;
+
+        private:
+
+            vector<row_t> m_rows;
+            size_t m_cols;
+            V m_default;
+
+        public:
+
+            SparseMatrix(size_t rows = 0, size_t cols = 0, const V &defaultValue = V());
+
+            /** Discards all entries and changes the dimensions
+             */
+            void resize(size_t rows, size_t cols);
+
+            /** @return entry (i,j) or the default value if that
+             * entry was never set.
+             */
+            const V &get(size_t i, size_t j) const;
+
+            void set(size_t i, size_t j, const V &value);
+
+            /** @return true if entry (i,j) was set
+             */
+            bool contains(size_t i, size_t j) const;
+
+            /** @return stored entries of row i (ordered by column)
+             */
+            const row_t &row(size_t i) const;
+
+            size_t rows() const;
+
+            size_t cols() const;
+
+            /** @return number of stored entries
+             */
+            size_t stored() const;
+        };
     }
 }
 
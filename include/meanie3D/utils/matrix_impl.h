@@ -61,6 +61,80 @@ namespace m3D {
 
             return matrix;
         }
+
+#pragma mark -
+#pragma mark SparseMatrix
+
+        template <typename V>
+        SparseMatrix<V>::SparseMatrix(size_t rows, size_t cols, const V &defaultValue)
+        : m_rows(rows)
+        , m_cols(cols)
+        , m_default(defaultValue)
+        {
+        }
+
+        template <typename V>
+        void
+        SparseMatrix<V>::resize(size_t rows, size_t cols)
+        {
+            m_rows.clear();
+            m_rows.resize(rows);
+            m_cols = cols;
+        }
+
+        template <typename V>
+        const V &
+        SparseMatrix<V>::get(size_t i, size_t j) const
+        {
+            typename row_t::const_iterator fi = m_rows[i].find(j);
+            return (fi == m_rows[i].end()) ? m_default : fi->second;
+        }
+
+        template <typename V>
+        void
+        SparseMatrix<V>::set(size_t i, size_t j, const V &value)
+        {
+            m_rows[i][j] = value;
+        }
+
+        template <typename V>
+        bool
+        SparseMatrix<V>::contains(size_t i, size_t j) const
+        {
+            return m_rows[i].find(j) != m_rows[i].end();
+        }
+
+        template <typename V>
+        const typename SparseMatrix<V>::row_t &
+        SparseMatrix<V>::row(size_t i) const
+        {
+            return m_rows[i];
+        }
+
+        template <typename V>
+        size_t
+        SparseMatrix<V>::rows() const
+        {
+            return m_rows.size();
+        }
+
+        template <typename V>
+        size_t
+        SparseMatrix<V>::cols() const
+        {
+            return m_cols;
+        }
+
+        template <typename V>
+        size_t
+        SparseMatrix<V>::stored() const
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < m_rows.size(); i++) {
+                count += m_rows[i].size();
+            }
+            return count;
+        }
     }
 }
 
@@ -263,7 +263,7 @@ namespace m3D {
 
                 // Initialize new array with a value for 'not found'
 
-                MultiArray<T> *dest = new MultiArrayBlitz<T>(dims, NOT_SET);
+                MultiArray<T> *dest = new MultiArrayLinear<T>(dims, NOT_SET);
 
                 for (int y = 0; y < flow.rows; y += 1) {
                     for (int x = 0; x < flow.cols; x += 1) {
@@ -0,0 +1,176 @@
+/* The MIT License (MIT)
+ *
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_ORDERED_QUEUE_H
+#define M3D_ORDERED_QUEUE_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <map>
+
+namespace m3D {
+    namespace utils {
+
+        /** Bounded queue for a fixed number of jobs (0..count-1),
+         * which are produced concurrently and consumed in order.
+         * Producers claim the next job number, produce the item and
+         * put it. The consumer takes the items by job number. At most
+         * 'capacity' jobs are claimed but not yet taken, which bounds
+         * the number of items held at any time.
+         *
+         * A consumer that also produces must only use the try_
+         * variants before blocking in take(), otherwise it can wait
+         * for room that only it can make.
+         */
+        template <typename T>
+        class OrderedQueue
+        {
+        private:
+
+            typedef std::map<size_t, T> item_map_t;
+
+            boost::mutex m_mutex;
+            boost::condition_variable m_room;
+            boost::condition_variable m_ready;
+
+            size_t m_count;
+            size_t m_capacity;
+            size_t m_claimed;
+            size_t m_taken;
+            item_map_t m_items;
+
+            // Not copyable
+            OrderedQueue(const OrderedQueue &);
+            OrderedQueue &operator=(const OrderedQueue &);
+
+            /** @return true if a job can be claimed right now
+             * (call with the mutex locked) */
+            bool can_claim() const
+            {
+                return m_claimed < m_count && m_claimed - m_taken < m_capacity;
+            }
+
+        public:
+
+            /** @param number of jobs
+             * @param maximum number of jobs claimed but not taken (> 0)
+             */
+            OrderedQueue(size_t count, size_t capacity)
+            : m_count(count)
+            , m_capacity(capacity > 0 ? capacity : 1)
+            , m_claimed(0)
+            , m_taken(0)
+            {
+            }
+
+            /** Claims the next job. Blocks while the queue is full.
+             * @param job number (out)
+             * @return <code>false</code> if all jobs are claimed
+             */
+            bool claim(size_t &job)
+            {
+                boost::unique_lock<boost::mutex> lock(m_mutex);
+                while (m_claimed < m_count && !can_claim()) {
+                    m_room.wait(lock);
+                }
+                if (m_claimed == m_count) {
+                    return false;
+                }
+                job = m_claimed++;
+                return true;
+            }
+
+            /** Claims the next job if there is room.
+             * @param job number (out)
+             * @return <code>false</code> if the queue is full or all
+             * jobs are claimed
+             */
+            bool try_claim(size_t &job)
+            {
+                boost::unique_lock<boost::mutex> lock(m_mutex);
+                if (!can_claim()) {
+                    return false;
+                }
+                job = m_claimed++;
+                return true;
+            }
+
+            /** Hands in the item of a claimed job.
+             * @param job number
+             * @param item
+             */
+            void put(size_t job, const T &item)
+            {
+                boost::unique_lock<boost::mutex> lock(m_mutex);
+                m_items[job] = item;
+                m_ready.notify_all();
+            }
+
+            /** Takes the item of the next job in order. Blocks until
+             * it was put.
+             * @param item (out)
+             * @return <code>false</code> if all jobs were taken
+             */
+            bool take(T &item)
+            {
+                boost::unique_lock<boost::mutex> lock(m_mutex);
+                while (m_taken < m_count && m_items.find(m_taken) == m_items.end()) {
+                    m_ready.wait(lock);
+                }
+                if (m_taken == m_count) {
+                    return false;
+                }
+                typename item_map_t::iterator ii = m_items.find(m_taken);
+                item = ii->second;
+                m_items.erase(ii);
+                m_taken++;
+                m_room.notify_all();
+                return true;
+            }
+
+            /** Takes the item of the next job in order, if it was put.
+             * @param item (out)
+             * @return <code>false</code> if the item is not available
+             */
+            bool try_take(T &item)
+            {
+                boost::unique_lock<boost::mutex> lock(m_mutex);
+                typename item_map_t::iterator ii = m_items.find(m_taken);
+                if (ii == m_items.end()) {
+                    return false;
+                }
+                item = ii->second;
+                m_items.erase(ii);
+                m_taken++;
+                m_room.notify_all();
+                return true;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,432 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_UTILS_PROFILER_H
+#define M3D_UTILS_PROFILER_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+#include <meanie3D/parallel.h>
+
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace m3D {
+    namespace utils {
+
+        /** Simple phase profiler. Stages are opened and closed with
+         * begin()/end() (or a ScopedTimer) and nest into a tree, which
+         * is identified by the path of stage names ("detection/index").
+         * For every stage the number of calls, the wall time, the CPU
+         * time of the process (all threads) and the peak resident set
+         * size at the end of the stage are recorded. Counters can be
+         * added to the current stage with count().
+         * 
+         * Each thread has its own stack of open stages. A thread is 
+         * identified by its thread number in every enclosing team, so
+         * that threads of different nested teams do not share a stack.
+         * Threads which have not opened a stage themselves (workers 
+         * inside a parallel region) attribute their counters to the 
+         * innermost stage of the thread that started their team, or
+         * of its ancestors.
+         * 
+         * The profiler is disabled by default, in which case all calls
+         * return immediately.
+         */
+        class Profiler
+        {
+        public:
+
+            /** Aggregated data of one stage */
+            struct Stage
+            {
+                std::string name;
+                size_t calls;
+                double wall_time;
+                double cpu_time;
+                long peak_rss_kb;
+                std::map<std::string, double> counters;
+                std::vector<std::string> children;
+
+                Stage() : calls(0), wall_time(0.0), cpu_time(0.0), peak_rss_kb(0)
+                {
+                }
+            };
+
+        private:
+
+            /** An open stage on a thread's stack */
+            struct Frame
+            {
+                std::string path;
+                double wall_start;
+                double cpu_start;
+            };
+
+            /** Thread numbers from the outermost to the innermost team.
+             * Empty outside of parallel regions. */
+            typedef std::vector<int> thread_key_t;
+
+            typedef std::map<std::string, Stage> stage_map_t;
+            typedef std::map<thread_key_t, std::vector<Frame> > stack_map_t;
+
+            bool m_enabled;
+            double m_start_time;
+            stage_map_t m_stages;
+            std::vector<std::string> m_roots;
+            stack_map_t m_stacks;
+
+            Profiler() : m_enabled(false), m_start_time(wall_clock())
+            {
+            }
+
+            Profiler(const Profiler &other);
+            Profiler &operator=(const Profiler &other);
+
+            static thread_key_t thread_key()
+            {
+                thread_key_t key;
+#if WITH_OPENMP
+                int level = omp_get_level();
+                for (int l = 1; l <= level; l++) {
+                    key.push_back(omp_get_ancestor_thread_num(l));
+                }
+#endif
+                return key;
+            }
+
+            /** Path of the innermost open stage for the calling
+             * thread, falling back on the stacks of the threads that
+             * started the enclosing teams. Must be called from within
+             * the critical section.
+             */
+            std::string current_path(const thread_key_t &thread)
+            {
+                thread_key_t key = thread;
+                while (true) {
+                    stack_map_t::iterator si = m_stacks.find(key);
+                    if (si != m_stacks.end() && !si->second.empty()) {
+                        return si->second.back().path;
+                    }
+                    if (key.empty()) {
+                        return "";
+                    }
+                    key.pop_back();
+                }
+            }
+
+            /** @return the string escaped for use in a JSON string */
+            static std::string json_escape(const std::string &s)
+            {
+                std::ostringstream os;
+                for (size_t i = 0; i < s.size(); i++) {
+                    unsigned char c = s[i];
+                    switch (c) {
+                        case '"': os << "\\\""; break;
+                        case '\\': os << "\\\\"; break;
+                        case '\b': os << "\\b"; break;
+                        case '\f': os << "\\f"; break;
+                        case '\n': os << "\\n"; break;
+                        case '\r': os << "\\r"; break;
+                        case '\t': os << "\\t"; break;
+                        default:
+                            if (c < 0x20) {
+                                os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec;
+                            } else {
+                                os << s[i];
+                            }
+                    }
+                }
+                return os.str();
+            }
+
+            void write_stage(std::ostream &os, const std::string &path, int indent) const
+            {
+                stage_map_t::const_iterator si = m_stages.find(path);
+                if (si == m_stages.end()) {
+                    return;
+                }
+                const Stage &s = si->second;
+                std::string pad(indent, ' ');
+
+                os << pad << "{" << std::endl;
+                os << pad << "  \"name\": \"" << json_escape(s.name) << "\"," << std::endl;
+                os << pad << "  \"calls\": " << s.calls << "," << std::endl;
+                os << pad << "  \"wall_time\": " << s.wall_time << "," << std::endl;
+                os << pad << "  \"cpu_time\": " << s.cpu_time << "," << std::endl;
+                os << pad << "  \"peak_rss_kb\": " << s.peak_rss_kb << "," << std::endl;
+
+                // Average neighbours per search is derived rather than
+                // summed, so that it stays correct over several calls
+                std::map<std::string, double> counters = s.counters;
+                std::map<std::string, double>::const_iterator searches = counters.find("searches");
+                std::map<std::string, double>::const_iterator neighbours = counters.find("neighbours");
+                if (searches != counters.end() && neighbours != counters.end() && searches->second > 0) {
+                    counters["neighbours_per_search"] = neighbours->second / searches->second;
+                }
+
+                os << pad << "  \"counters\": {";
+                std::map<std::string, double>::const_iterator ci;
+                for (ci = counters.begin(); ci != counters.end(); ++ci) {
+                    os << (ci == counters.begin() ? "" : ",") << std::endl;
+                    os << pad << "    \"" << json_escape(ci->first) << "\": " << ci->second;
+                }
+                os << (counters.empty() ? "" : "\n" + pad + "  ") << "}," << std::endl;
+
+                os << pad << "  \"stages\": [";
+                for (size_t i = 0; i < s.children.size(); i++) {
+                    os << (i == 0 ? "" : ",") << std::endl;
+                    write_stage(os, path + "/" + s.children[i], indent + 4);
+                }
+                os << (s.children.empty() ? "" : "\n" + pad + "  ") << "]" << std::endl;
+                os << pad << "}";
+            }
+
+        public:
+
+            /** @return the shared profiler instance */
+            static Profiler &instance()
+            {
+                static Profiler profiler;
+                return profiler;
+            }
+
+            /** @return wall clock time in seconds */
+            static double wall_clock()
+            {
+                timeval tv;
+                gettimeofday(&tv, NULL);
+                return double(tv.tv_sec) + double(tv.tv_usec) / 1000000.0;
+            }
+
+            /** @return user and system time of the process in seconds */
+            static double cpu_clock()
+            {
+                rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+                return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+                        + double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+            }
+
+            /** @return peak resident set size of the process in kB */
+            static long peak_rss_kb()
+            {
+                rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+                return usage.ru_maxrss / 1024;
+#else
+                return usage.ru_maxrss;
+#endif
+            }
+
+            void set_enabled(bool enabled)
+            {
+                m_enabled = enabled;
+            }
+
+            bool enabled() const
+            {
+                return m_enabled;
+            }
+
+            /** Discards all recorded data */
+            void reset()
+            {
+#if WITH_OPENMP
+#pragma omp critical(m3D_profiler)
+#endif
+                {
+                    m_stages.clear();
+                    m_roots.clear();
+                    m_stacks.clear();
+                    m_start_time = wall_clock();
+                }
+            }
+
+            /** Opens a stage below the calling thread's current stage.
+             * @param name of the stage
+             */
+            void begin(const std::string &name)
+            {
+                if (!m_enabled) return;
+
+                Frame frame;
+                frame.wall_start = wall_clock();
+                frame.cpu_start = cpu_clock();
+                thread_key_t thread = thread_key();
+
+#if WITH_OPENMP
+#pragma omp critical(m3D_profiler)
+#endif
+                {
+                    std::string parent = current_path(thread);
+                    frame.path = parent.empty() ? name : parent + "/" + name;
+
+                    stage_map_t::iterator si = m_stages.find(frame.path);
+                    if (si == m_stages.end()) {
+                        Stage stage;
+                        stage.name = name;
+                        m_stages[frame.path] = stage;
+                        if (parent.empty()) {
+                            m_roots.push_back(name);
+                        } else {
+                            m_stages[parent].children.push_back(name);
+                        }
+                    }
+                    m_stacks[thread].push_back(frame);
+                }
+            }
+
+            /** Closes the calling thread's current stage */
+            void end()
+            {
+                if (!m_enabled) return;
+
+                double wall = wall_clock();
+                double cpu = cpu_clock();
+                long rss = peak_rss_kb();
+                thread_key_t thread = thread_key();
+
+#if WITH_OPENMP
+#pragma omp critical(m3D_profiler)
+#endif
+                {
+                    std::vector<Frame> &stack = m_stacks[thread];
+                    if (!stack.empty()) {
+                        Frame frame = stack.back();
+                        stack.pop_back();
+                        Stage &stage = m_stages[frame.path];
+                        stage.calls++;
+                        stage.wall_time += wall - frame.wall_start;
+                        stage.cpu_time += cpu - frame.cpu_start;
+                        if (rss > stage.peak_rss_kb) {
+                            stage.peak_rss_kb = rss;
+                        }
+                    }
+                }
+            }
+
+            /** Adds the given value to a counter of the current stage.
+             * Counters outside of any stage are ignored.
+             * @param name of the counter
+             * @param value to add
+             */
+            void count(const std::string &name, double value = 1.0)
+            {
+                if (!m_enabled) return;
+
+                thread_key_t thread = thread_key();
+
+#if WITH_OPENMP
+#pragma omp critical(m3D_profiler)
+#endif
+                {
+                    std::string path = current_path(thread);
+                    if (!path.empty()) {
+                        m_stages[path].counters[name] += value;
+                    }
+                }
+            }
+
+            /** @param path of the stage ("a/b/c")
+             * @return pointer to the stage data or NULL
+             */
+            const Stage *stage(const std::string &path) const
+            {
+                stage_map_t::const_iterator si = m_stages.find(path);
+                return (si == m_stages.end()) ? NULL : &(si->second);
+            }
+
+            /** Writes the stage tree as JSON.
+             * @param output stream
+             */
+            void write_json(std::ostream &os) const
+            {
+                os << std::setprecision(6) << std::fixed;
+                os << "{" << std::endl;
+                os << "  \"wall_time\": " << (wall_clock() - m_start_time) << "," << std::endl;
+                os << "  \"cpu_time\": " << cpu_clock() << "," << std::endl;
+                os << "  \"peak_rss_kb\": " << peak_rss_kb() << "," << std::endl;
+#if WITH_OPENMP
+                os << "  \"threads\": " << omp_get_max_threads() << "," << std::endl;
+#else
+                os << "  \"threads\": 1," << std::endl;
+#endif
+                os << "  \"stages\": [";
+                for (size_t i = 0; i < m_roots.size(); i++) {
+                    os << (i == 0 ? "" : ",") << std::endl;
+                    write_stage(os, m_roots[i], 4);
+                }
+                os << (m_roots.empty() ? "" : "\n  ") << "]" << std::endl;
+                os << "}" << std::endl;
+            }
+
+            /** Writes the stage tree as JSON to the given file.
+             * @param path of the file
+             */
+            void write_json(const std::string &filename) const
+            {
+                std::ofstream file(filename.c_str());
+                if (!file.is_open()) {
+                    std::cerr << "ERROR: could not open " << filename 
+                         << " for writing the profile" << std::endl;
+                    return;
+                }
+                write_json(file);
+            }
+        };
+
+        /** Opens a profiler stage for the lifetime of the object.
+         */
+        class ScopedTimer
+        {
+        public:
+
+            ScopedTimer(const std::string &name)
+            {
+                Profiler::instance().begin(name);
+            }
+
+            ~ScopedTimer()
+            {
+                Profiler::instance().end();
+            }
+
+        private:
+
+            ScopedTimer(const ScopedTimer &other);
+            ScopedTimer &operator=(const ScopedTimer &other);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,120 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M3D_UNION_FIND_H
+#define M3D_UNION_FIND_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+
+#include <vector>
+
+namespace m3D {
+    namespace utils {
+
+        /** Disjoint sets over the indexes 0..N-1, which can be 
+         * joined from multiple threads concurrently without locks.
+         * Roots are linked by compare-and-swap, always attaching the 
+         * higher root to the lower one. The representative of each 
+         * set therefore is its smallest index, regardless of the 
+         * order in which the unions were performed.
+         */
+        class UnionFind
+        {
+        private:
+
+            std::vector<size_t> m_parent;
+
+            inline size_t parent(size_t x) const
+            {
+                return *((volatile const size_t *) &m_parent[x]);
+            }
+
+        public:
+
+            /** @param number of elements. Each element
+             * starts out in its own set.
+             */
+            UnionFind(size_t size)
+            : m_parent(size)
+            {
+                for (size_t i = 0; i < size; i++) {
+                    m_parent[i] = i;
+                }
+            }
+
+            /** @return number of elements */
+            size_t size() const
+            {
+                return m_parent.size();
+            }
+
+            /** Finds the representative of the set containing x.
+             * Compresses the path by halving on the way.
+             * @param element
+             * @return representative (smallest index in the set)
+             */
+            size_t find(size_t x)
+            {
+                size_t p = parent(x);
+                while (p != x) {
+                    size_t gp = parent(p);
+                    if (gp != p) {
+                        __sync_bool_compare_and_swap(&m_parent[x], p, gp);
+                    }
+                    x = gp;
+                    p = parent(x);
+                }
+                return x;
+            }
+
+            /** Joins the sets containing a and b.
+             * @param a
+             * @param b
+             * @return true if the sets were different
+             */
+            bool unite(size_t a, size_t b)
+            {
+                while (true) {
+                    a = find(a);
+                    b = find(b);
+                    if (a == b) {
+                        return false;
+                    }
+                    if (a < b) {
+                        size_t tmp = a;
+                        a = b;
+                        b = tmp;
+                    }
+                    // attach the higher root a to b, unless a 
+                    // stopped being a root in the meantime
+                    if (__sync_bool_compare_and_swap(&m_parent[a], a, b)) {
+                        return true;
+                    }
+                }
+            }
+        };
+    }
+}
+
+#endif
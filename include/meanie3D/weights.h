@@ -24,10 +24,13 @@
 #ifndef M3D_WEIGHT_INCLUDES_H
 #define M3D_WEIGHT_INCLUDES_H
 
+#include <meanie3D/weights/precomputed_weight_function.h>
 #include <meanie3D/weights/default_weights.h>
 #include <meanie3D/weights/inverse_default.h>
 #include <meanie3D/weights/oase_weights.h>
 #include <meanie3D/weights/exp10_weight.h>
+#include <meanie3D/weights/weight_expression.h>
+#include <meanie3D/weights/expression_weights.h>
 #include <meanie3D/weights/brightband_evidence.h>
 #include <meanie3D/weights/ci_weights.h>
 #include <meanie3D/weights/example_wf.h>
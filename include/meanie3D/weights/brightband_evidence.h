@@ -27,8 +27,7 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/utils/netcdf_utils.h>
-#include <meanie3D/weights/weight_function.h>
-#include <meanie3D/array/multiarray.h>
+#include <meanie3D/weights/precomputed_weight_function.h>
 
 #include <netcdf>
 #include <vector>
@@ -40,29 +39,33 @@ namespace m3D {
      * bright band detection
      */
     template <class T>
-    class BrightBandWeight : public WeightFunction<T>
+    class BrightBandWeight : public PrecomputedWeightFunction<T>
     {
     private:
 
         vector<NcVar> m_vars; // variables for weighting
-        map<size_t, T> m_min; // [index,min]
-        map<size_t, T> m_max; // [index,max]
-
-        MultiArray<T> *m_weight;
         CoordinateSystem<T> *m_coordinate_system;
 
-        void
-        calculate_weight_function(FeatureSpace<T> *fs)
+        /** Contributions of zh, zdr and kdp (to be done) */
+        struct WeightKernel
         {
-            for (size_t i = 0; i < fs->points.size(); i++) {
-                Point<T> *p = fs->points[i];
-
-                T saliency = this->compute_weight(p);
+            inline T term(size_t var_index, T value) const
+            {
+                return 0.0;
+            }
 
-                m_weight->set(p->gridpoint, saliency);
+            inline T finish(T sum, const Point<T> *p) const
+            {
+                return sum;
             }
         };
 
+        void
+        calculate_weight_function(FeatureSpace<T> *fs)
+        {
+            this->precompute(fs, WeightKernel());
+        };
+
     public:
 
         /** Construct the weight function, using the default values
@@ -70,17 +73,19 @@ namespace m3D {
          * @param featurespace
          */
         BrightBandWeight(FeatureSpace<T> *fs, const NetCDFDataStore<T> *data_store)
-        : m_vars(data_store->variables())
-        , m_weight(new MultiArrayBlitz<T>(fs->coordinate_system->get_dimension_sizes(), 0.0))
+        : PrecomputedWeightFunction<T>(fs->coordinate_system->get_dimension_sizes())
+        , m_vars(data_store->variables())
         , m_coordinate_system(fs->coordinate_system)
         {
             // Get original limits
 
+            this->m_min.resize(m_vars.size());
+            this->m_max.resize(m_vars.size());
             for (size_t index = 0; index < m_vars.size(); index++) {
                 T min_value, max_value;
                 utils::netcdf::unpacked_limits(m_vars[index], min_value, max_value);
-                m_min[index] = min_value;
-                m_max[index] = max_value;
+                this->m_min[index] = min_value;
+                this->m_max[index] = max_value;
             }
 
             calculate_weight_function(fs);
@@ -96,49 +101,13 @@ namespace m3D {
                 const NetCDFDataStore<T> *data_store,
                 const map<size_t, T> &min,
                 const map<size_t, T> &max)
-        : m_vars(data_store->variables())
-        , m_min(min)
-        , m_max(max)
-        , m_weight(new MultiArrayBlitz<T>(fs->coordinate_system->get_dimension_sizes(), 0.0))
+        : PrecomputedWeightFunction<T>(fs->coordinate_system->get_dimension_sizes())
+        , m_vars(data_store->variables())
         , m_coordinate_system(fs->coordinate_system)
         {
+            this->set_limits(min, max);
             calculate_weight_function(fs);
         }
-
-        ~BrightBandWeight()
-        {
-            if (this->m_weight != NULL) {
-                delete m_weight;
-                m_weight = NULL;
-            }
-        }
-
-        /** Actual weight computation happens here
-         */
-        T compute_weight(Point<T> *p)
-        {
-            T sum = 0.0;
-
-            size_t num_vars = p->values.size() - p->coordinate.size();
-
-            for (size_t var_index = 0; var_index < num_vars; var_index++) {
-                NcVar var = m_vars[var_index];
-
-                T value = p->values[p->coordinate.size() + var_index];
-
-                if (var.getName() == "zh") {
-                } else if (var.getName() == "zdr") {
-                } else if (var.getName() == "kdp") {
-                }
-            }
-
-            return sum;
-        }
-
-        T operator()(const typename Point<T>::ptr p) const
-        {
-            return m_weight->get(p->gridpoint);
-        }
     };
 }
 
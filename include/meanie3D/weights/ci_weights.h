@@ -39,7 +39,7 @@
 #include <vector>
 #include <map>
 
-#include "weight_function.h"
+#include "precomputed_weight_function.h"
 
 namespace m3D {
 
@@ -84,7 +84,7 @@ namespace m3D {
      *
      */
     template<class T>
-    class OASECIWeightFunction : public WeightFunction<T> {
+    class OASECIWeightFunction : public PrecomputedWeightFunction<T> {
     private:
 
         //
@@ -104,8 +104,8 @@ namespace m3D {
         // const std::string *m_ci_comparison_file;
         // const CoordinateSystem<T> *m_coordinate_system;
         
-        MultiArray<T> *m_weight;
         MultiArray<bool> *m_overlap;
+        DenseGridView<bool> m_overlap_grid;
         
         std::vector<std::string> m_variable_names;
         // bool m_satellite_only;
@@ -152,10 +152,10 @@ namespace m3D {
          */
         OASECIWeightFunction(const detection_params_t<T> &params, 
                              const detection_context_t<T> &ctx) 
-            : m_super_params(params)
+            : PrecomputedWeightFunction<T>(ctx.coord_system->get_dimension_sizes())
+            , m_super_params(params)
             , m_super_context(ctx)
             , m_data_store(NULL)
-            , m_weight(new MultiArrayBlitz<T>(ctx.coord_system->get_dimension_sizes(), 0.0))
         
         {
             using namespace utils;
@@ -201,6 +201,7 @@ namespace m3D {
             m_bandwidth = ctx.fs->spatial_component(ctx.bandwidth);
             m_index = PointIndex<T>::create(&ctx.fs->points, ctx.coord_system->rank());
             m_search_params = new RangeSearchParams<T>(m_bandwidth);
+            m_index->build(m_search_params);
 
             this->obtain_protoclusters();
 
@@ -392,7 +393,7 @@ namespace m3D {
                 data_map_t shifted_data;
                 for (size_t var_index = 0; var_index < m_ci_comparison_data_store->rank(); var_index++) {
                     T NOT_SET = m_ci_comparison_data_store->fill_value(var_index);
-                    shifted_data[var_index] = new MultiArrayBlitz<T>(dims, NOT_SET);
+                    shifted_data[var_index] = new MultiArrayLinear<T>(dims, NOT_SET);
                 }
 
                 //                ::m3D::utils::opencv::display_variable(m_ci_comparison_data_store,msevi_l15_ir_108);
@@ -478,9 +479,13 @@ namespace m3D {
         void
         calculate_overlap() {
             vector<size_t> dims = m_ctx.coord_system->get_dimension_sizes();
-            m_overlap = new MultiArrayBlitz<bool>(dims, false);
-            m_prev_cluster_area = new MultiArrayBlitz<bool>(dims, false);
-            m_curr_cluster_area = new MultiArrayBlitz<bool>(dims, false);
+            m_overlap = create_dense_multiarray<bool>(dims, false);
+            m_prev_cluster_area = create_dense_multiarray<bool>(dims, false);
+            m_curr_cluster_area = create_dense_multiarray<bool>(dims, false);
+
+            m_overlap_grid = DenseGridView<bool>(m_overlap);
+            DenseGridView<bool> prev_area(m_prev_cluster_area);
+            DenseGridView<bool> curr_area(m_curr_cluster_area);
 
             // Mark area occupied by all protoclusters from previous set
             for (size_t pi = 0; pi < m_previous_protoclusters->size(); pi++) {
@@ -488,7 +493,7 @@ namespace m3D {
                 typename Point<T>::list::iterator point_iter;
                 for (point_iter = c->get_points().begin(); point_iter != c->get_points().end(); point_iter++) {
                     typename Point<T>::ptr p = *point_iter;
-                    m_prev_cluster_area->set(p->gridpoint, true);
+                    prev_area.set(p->gridpoint, true);
                 }
             }
 
@@ -499,39 +504,21 @@ namespace m3D {
                 typename Point<T>::list::iterator point_iter;
                 for (point_iter = c->get_points().begin(); point_iter != c->get_points().end(); point_iter++) {
                     typename Point<T>::ptr p = *point_iter;
-                    m_curr_cluster_area->set(p->gridpoint, true);
+                    curr_area.set(p->gridpoint, true);
                 }
             }
 
             // Collate
 
-            class OverlapFunctor : public MultiArray<bool>::ForEachFunctor {
-            public:
-
-                MultiArray<bool> *m_overlap;
-                MultiArray<bool> *m_curr_cluster_area;
-
-                OverlapFunctor(MultiArray<bool> *overlap, MultiArray<bool> *curr_cluster_area)
-                        : m_overlap(overlap), m_curr_cluster_area(curr_cluster_area) {
-                };
-
-                // for_each callback functor
-
-                void
-                operator()(const vector<int> &index, const bool have_previous) {
-                    bool have_current = m_curr_cluster_area->get(index);
-                    m_overlap->set(index, have_current && have_previous);
-                }
-            };
-
-            OverlapFunctor f(m_overlap, m_curr_cluster_area);
-            m_prev_cluster_area->for_each(&f);
+            for (size_t i = 0; i < m_overlap_grid.size(); i++) {
+                m_overlap_grid.set(i, prev_area.get(i) && curr_area.get(i));
+            }
 
             delete m_prev_cluster_area;
             m_prev_cluster_area = NULL;
 
             delete m_curr_cluster_area;
-            m_prev_cluster_area = NULL;
+            m_curr_cluster_area = NULL;
         }
 
         // replace each data point in the overlap area
@@ -554,7 +541,7 @@ namespace m3D {
                 // exempt radar and lightning from this
                 if (var_index == cband_radolan_rx || var_index == linet_oase_tl) continue;
                 MultiArray<T> *data = ds->get_data(var_index);
-                MultiArray<T> *result = new MultiArrayBlitz<T>(data->get_dimensions());
+                MultiArray<T> *result = new MultiArrayLinear<T>(data->get_dimensions());
                 result->copy_from(data);
 #if WITH_OPENMP
 #pragma omp parallel for schedule(dynamic)
@@ -595,27 +582,42 @@ namespace m3D {
             ds->save_as(fn);
         }
 
+        /** Evaluates the score point by point. Points outside
+         * of the overlap area receive no score.
+         */
+        struct ScoreKernel
+        {
+            OASECIWeightFunction<T> *weight_function;
+
+            inline T operator()(Point<T> *p) const
+            {
+                return weight_function->overlap_score(p);
+            }
+        };
+
+        friend struct ScoreKernel;
+
+        T overlap_score(Point<T> *p) {
+            bool have_overlap = (m_overlap == NULL || m_overlap_grid.get(p->gridpoint));
+            return have_overlap ? this->compute_weight(p) : 0.0;
+        }
+
         void
         calculate_weight_function(FeatureSpace<T> *fs) {
 
 #if DEBUG_CI_SCORE
             vector<size_t> dims = m_coordinate_system->get_dimension_sizes();
-            m_score_108 = new MultiArrayBlitz<T>(dims, 1000);
-            m_score_108_trend = new MultiArrayBlitz<T>(dims, 1000);
-            m_score_62_108 = new MultiArrayBlitz<T>(dims, 1000);
-            m_score_134_108 = new MultiArrayBlitz<T>(dims, 1000);
-            m_62_108_trend = new MultiArrayBlitz<T>(dims, 1000);
-            m_134_108_trend = new MultiArrayBlitz<T>(dims, 1000);
+            m_score_108 = create_dense_multiarray<T>(dims, 1000);
+            m_score_108_trend = create_dense_multiarray<T>(dims, 1000);
+            m_score_62_108 = create_dense_multiarray<T>(dims, 1000);
+            m_score_134_108 = create_dense_multiarray<T>(dims, 1000);
+            m_62_108_trend = create_dense_multiarray<T>(dims, 1000);
+            m_134_108_trend = create_dense_multiarray<T>(dims, 1000);
 #endif
             // compute the weights
-            for (size_t i = 0; i < fs->points.size(); i++) {
-                Point<T> *p = fs->points[i];
-                bool have_overlap = (m_overlap == NULL || m_overlap->get(p->gridpoint) == true);
-                if (have_overlap) {
-                    T saliency = this->compute_weight(p);
-                    m_weight->set(p->gridpoint, saliency);
-                }
-            }
+            ScoreKernel kernel;
+            kernel.weight_function = this;
+            this->precompute_points(fs, kernel);
 
 #if DEBUG_CI_SCORE
 #if WITH_VTK
@@ -624,7 +626,7 @@ namespace m3D {
             std::string basename = ppath.filename().stem().generic_string();
 
             std::string fn = "ci-score-" + basename + ".vtk";
-            VisitUtils<T>::write_multiarray_vtk(fn, "ci-score", m_coordinate_system, m_weight);
+            VisitUtils<T>::write_multiarray_vtk(fn, "ci-score", m_coordinate_system, this->m_weight);
 
             fn = "score_108-" + basename + ".vtk";
             VisitUtils<T>::write_multiarray_vtk(fn, "10.8 ", m_coordinate_system, m_score_108);
@@ -863,11 +865,6 @@ namespace m3D {
 
             return score;
         }
-
-        T operator()(const typename Point<T>::ptr p) const {
-            return m_weight->get(p->gridpoint);
-        }
-
     };
 }
 
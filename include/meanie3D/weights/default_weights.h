@@ -27,7 +27,7 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/utils.h>
-#include <meanie3D/weights/weight_function.h>
+#include <meanie3D/weights/precomputed_weight_function.h>
 
 #include <netcdf>
 #include <vector>
@@ -42,13 +42,30 @@ namespace m3D {
      * divided by the number of variables. 
      */
     template <class T>
-    class DefaultWeightFunction : public WeightFunction<T>
+    class DefaultWeightFunction : public PrecomputedWeightFunction<T>
     {
     private:
 
-        map<size_t, T> m_min;
-        map<size_t, T> m_max;
-        MultiArray<T> *m_weight;
+        const CoordinateSystem<T> *m_coordinate_system;
+
+        /** Scales each variable to [0..1] and averages */
+        struct WeightKernel
+        {
+            const T *min;
+            const T *inverse_range;
+            T inverse_rank;
+            const FeatureSpace<T> *fs;
+
+            inline T term(size_t var_index, T value) const
+            {
+                return (value - min[var_index]) * inverse_range[var_index];
+            }
+
+            inline T finish(T sum, const Point<T> *p) const
+            {
+                return fs->off_limits_grid().get(p->gridpoint) ? 0.0 : sum * inverse_rank;
+            }
+        };
 
     public:
 
@@ -60,29 +77,23 @@ namespace m3D {
          */
         DefaultWeightFunction(const detection_params_t<T> &params, 
                              const detection_context_t<T> &ctx)
-        : m_weight(new MultiArrayBlitz<T>(ctx.coord_system->get_dimension_sizes(), 0.0))
+        : PrecomputedWeightFunction<T>(ctx.coord_system->get_dimension_sizes())
+        , m_coordinate_system(ctx.coord_system)
         {
-            // If scale-space filter is present, use the filtered
-            // limits. If not, use the original limits
-            if (ctx.sf == NULL) {
-                for (size_t index = 0; index < ctx.data_store->rank(); index++) {
-                    m_min[index] = ctx.data_store->min(index);
-                    m_max[index] = ctx.data_store->max(index);
-                }
-            } else {
-                m_min = ctx.sf->get_filtered_min();
-                m_max = ctx.sf->get_filtered_max();
-            }
-
+            this->set_limits(ctx, ctx.data_store->rank());
             calculate_weight_function(ctx.fs);
         }
-        
-        ~DefaultWeightFunction()
+
+        bool
+        recalculate(const detection_params_t<T> &params,
+                const detection_context_t<T> &ctx)
         {
-            if (this->m_weight != NULL) {
-                delete m_weight;
-                m_weight = NULL;
+            if (ctx.coord_system != m_coordinate_system || !this->reset_weights(ctx)) {
+                return false;
             }
+            this->set_limits(ctx, ctx.data_store->rank());
+            calculate_weight_function(ctx.fs);
+            return true;
         }
 
     private:
@@ -90,51 +101,19 @@ namespace m3D {
         void
         calculate_weight_function(const FeatureSpace<T> *fs)
         {
-            //            #if WITH_OPENMP
-            //            #pragma omp parallel for 
-            //            #endif
-            for (size_t i = 0; i < fs->points.size(); i++) {
-                Point<T> *p = fs->points[i];
-
-                T saliency = (fs->off_limits()->get(p->gridpoint)) 
-                        ? 0.0 : compute_weight(fs,p->values);
-
-                //                #if WITH_OPENMP
-                //                #pragma omp critical 
-                //                #endif
-                m_weight->set(p->gridpoint, saliency);
-            }
-        };
-
-        /** Actual weight computation happens here
-         */
-
-        T compute_weight(const FeatureSpace<T> *fs,
-                const vector<T> &values) const
-        {
-            T sum = 0.0;
-
+            vector<T> inverse_range(fs->value_rank());
             for (size_t var_index = 0; var_index < fs->value_rank(); var_index++) {
-                T value = values.at(fs->spatial_rank() + var_index);
-
-                // value scaled to [0..1]
-                T max = m_max.find(var_index)->second;
-                T min = m_min.find(var_index)->second;
-                T var_weight = (value - min) / (max - min);
-                sum += var_weight;
+                inverse_range[var_index] = 1.0 / (this->m_max.at(var_index) - this->m_min.at(var_index));
             }
 
-            return sum / ((T) fs->value_rank());
-        }
-
-    public:
+            WeightKernel kernel;
+            kernel.min = &this->m_min[0];
+            kernel.inverse_range = &inverse_range[0];
+            kernel.inverse_rank = 1.0 / ((T) fs->value_rank());
+            kernel.fs = fs;
 
-        /** @return pre-calculated weight
-         */
-        T operator()(const typename Point<T>::ptr p) const
-        {
-            return m_weight->get(p->gridpoint);
-        }
+            this->precompute(fs, kernel);
+        };
     };
 }
 
@@ -35,6 +35,7 @@
 #include <meanie3D/namespaces.h>
 #include <meanie3D/utils.h>
 #include <meanie3D/weights/weight_function.h>
+#include <meanie3D/array/multiarray_dense.h>
 #include <vector>
 
 namespace m3D {
@@ -52,7 +53,7 @@ namespace m3D {
         {
             using namespace utils::vectors;
 
-            m_weight = new MultiArrayBlitz<T>(fs->coordinate_system->get_dimension_sizes(), 0.0);
+            m_weight = create_dense_multiarray<T>(fs->coordinate_system->get_dimension_sizes(), 0.0);
 
             for (size_t i = 0; i < fs->points.size(); i++) {
                 Point<T> *p = fs->points[i];
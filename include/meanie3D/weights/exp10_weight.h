@@ -27,7 +27,7 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/utils.h>
-#include <meanie3D/weights/weight_function.h>
+#include <meanie3D/weights/precomputed_weight_function.h>
 
 #include <netcdf>
 #include <vector>
@@ -41,26 +41,33 @@ namespace m3D {
     using std::map;
 
     template <class T>
-    class EXP10WeightFunction : public WeightFunction<T>
+    class EXP10WeightFunction : public PrecomputedWeightFunction<T>
     {
     private:
 
         vector<string> m_vars; // variables for weighting
-        MultiArray<T> *m_weight;
         const CoordinateSystem<T> *m_coordinate_system;
 
-        void
-        calculate_weight_function(FeatureSpace<T> *fs)
+        /** Sums up value^10 over all variables */
+        struct WeightKernel
         {
-            for (size_t i = 0; i < fs->points.size(); i++) {
-                Point<T> *p = fs->points[i];
-
-                T saliency = this->compute_weight(p);
+            inline T term(size_t var_index, T value) const
+            {
+                return pow(boost::numeric_cast<double>(value), 10.0);
+            }
 
-                m_weight->set(p->gridpoint, saliency);
+            inline T finish(T sum, const Point<T> *p) const
+            {
+                return sum;
             }
         };
 
+        void
+        calculate_weight_function(FeatureSpace<T> *fs)
+        {
+            this->precompute(fs, WeightKernel());
+        };
+
     public:
 
         /** Construct the weight function, using the default values
@@ -69,41 +76,22 @@ namespace m3D {
          */
         EXP10WeightFunction(const detection_params_t<T> &params, 
                              const detection_context_t<T> &ctx)
-        : m_vars(params.variables)
-        , m_weight(new MultiArrayBlitz<T>(ctx.coord_system->get_dimension_sizes(), 0.0))
+        : PrecomputedWeightFunction<T>(ctx.coord_system->get_dimension_sizes())
+        , m_vars(params.variables)
         , m_coordinate_system(ctx.coord_system)
         {
             calculate_weight_function(ctx.fs);
         }
 
-        ~EXP10WeightFunction()
-        {
-            if (m_weight != NULL) {
-                delete m_weight;
-                m_weight = NULL;
-            }
-        }
-
-        /** Actual weight computation happens here
-         */
-        T compute_weight(Point<T> *p)
+        bool
+        recalculate(const detection_params_t<T> &params,
+                const detection_context_t<T> &ctx)
         {
-            T sum = 0.0;
-
-            size_t num_vars = p->values.size() - p->coordinate.size();
-
-            for (size_t var_index = 0; var_index < num_vars; var_index++) {
-                T value = p->values[p->coordinate.size() + var_index];
-
-                sum += pow(boost::numeric_cast<double>(value), 10.0);
+            if (ctx.coord_system != m_coordinate_system || !this->reset_weights(ctx)) {
+                return false;
             }
-
-            return sum;
-        }
-
-        T operator()(const typename Point<T>::ptr p) const
-        {
-            return m_weight->get(p->gridpoint);
+            calculate_weight_function(ctx.fs);
+            return true;
         }
     };
 }
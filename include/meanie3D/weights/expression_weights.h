@@ -0,0 +1,301 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef M3D_EXPRESSIONWEIGHTFUNCTION_H
+#define M3D_EXPRESSIONWEIGHTFUNCTION_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+#include <meanie3D/utils.h>
+#include <meanie3D/filters/separable_convolution.h>
+#include <meanie3D/weights/precomputed_weight_function.h>
+#include <meanie3D/weights/weight_expression.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace m3D {
+
+    /** Weight function given as an expression over the variables
+     * (see WeightExpression for the syntax). The expression is 
+     * compiled once and evaluated block by block over the whole
+     * feature-space. Neighbourhood aggregates are calculated on the
+     * grid beforehand, within a box of the spatial bandwidth around 
+     * each point.
+     */
+    template <class T>
+    class ExpressionWeightFunction : public PrecomputedWeightFunction<T>
+    {
+    private:
+
+        WeightExpression<T> m_expression;
+        const CoordinateSystem<T> *m_coordinate_system;
+        vector<T> m_bandwidth; // spatial bandwidth for aggregates
+
+        /** Replaces each element with the minimum or maximum within
+         * a window of w elements to either side along the given axis.
+         */
+        static void
+        extremum_pass(const vector<size_t> &dims,
+                size_t axis,
+                long w,
+                bool maximum,
+                const T *in,
+                T *out)
+        {
+            size_t outer = 1, stride = 1;
+            for (size_t i = 0; i < axis; i++) outer *= dims[i];
+            for (size_t i = axis + 1; i < dims.size(); i++) stride *= dims[i];
+            const long n = dims[axis];
+
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t o = 0; o < outer; o++) {
+                const T *src = in + o * n * stride;
+                T *dst = out + o * n * stride;
+                for (long k = 0; k < n; k++) {
+                    T *dk = dst + k * stride;
+                    const T *sk = src + k * stride;
+                    for (size_t j = 0; j < stride; j++) {
+                        dk[j] = sk[j];
+                    }
+                    const long lo = (k - w > 0) ? (k - w) : 0;
+                    const long hi = (k + w < n - 1) ? (k + w) : (n - 1);
+                    for (long i = lo; i <= hi; i++) {
+                        const T *si = src + i * stride;
+                        if (maximum) {
+                            for (size_t j = 0; j < stride; j++) {
+                                dk[j] = (si[j] > dk[j]) ? si[j] : dk[j];
+                            }
+                        } else {
+                            for (size_t j = 0; j < stride; j++) {
+                                dk[j] = (si[j] < dk[j]) ? si[j] : dk[j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        void
+        calculate_weight_function(const FeatureSpace<T> *fs)
+        {
+            PointStore<T> store;
+            fs->gather(store);
+
+            const size_t num_points = store.size();
+            const size_t spatial_rank = fs->spatial_rank();
+            const size_t value_rank = fs->value_rank();
+
+            vector<size_t> linear_index(num_points);
+            for (size_t pi = 0; pi < num_points; pi++) {
+                linear_index[pi] = this->m_weight_grid.linear_index(store.gridpoint(pi));
+            }
+
+            vector< vector<T> > aggregates;
+            calculate_aggregates(m_expression,
+                    m_coordinate_system->get_dimension_sizes(),
+                    m_coordinate_system->resolution(),
+                    m_bandwidth, store, linear_index, aggregates);
+            const size_t num_aggregates = aggregates.size();
+
+            // Make sure there is a limit for every variable
+            this->m_min.resize(value_rank, 0.0);
+            this->m_max.resize(value_rank, 0.0);
+
+            const size_t block_size = WEIGHT_FUNCTION_BLOCK_SIZE;
+            const size_t num_blocks = (num_points + block_size - 1) / block_size;
+            const size_t depth = m_expression.stack_depth();
+
+#if WITH_OPENMP
+#pragma omp parallel
+#endif
+            {
+                vector<T> values(value_rank * block_size + 1);
+                vector<T> aggregate_values(num_aggregates * block_size + 1);
+                vector<T> stack(depth * block_size + 1);
+                vector<T> result(block_size);
+
+#if WITH_OPENMP
+#pragma omp for schedule(static)
+#endif
+                for (size_t block = 0; block < num_blocks; block++) {
+                    const size_t begin = block * block_size;
+                    const size_t n = (num_points - begin < block_size) ? (num_points - begin) : block_size;
+
+                    for (size_t vi = 0; vi < value_rank; vi++) {
+                        memcpy(&values[vi * n], store.column(spatial_rank + vi) + begin, n * sizeof(T));
+                    }
+
+                    for (size_t ai = 0; ai < num_aggregates; ai++) {
+                        memcpy(&aggregate_values[ai * n], &aggregates[ai][begin], n * sizeof(T));
+                    }
+
+                    m_expression.evaluate(n,
+                            &values[0],
+                            &aggregate_values[0],
+                            &this->m_min[0],
+                            &this->m_max[0],
+                            &stack[0],
+                            &result[0]);
+
+                    for (size_t k = 0; k < n; k++) {
+                        this->m_weight_grid.set(linear_index[begin + k], result[k]);
+                    }
+                }
+            }
+        }
+
+    public:
+
+        /** Calculates the neighbourhood aggregates used by the 
+         * expression at every point. The neighbourhood is the box
+         * of the bandwidth around the point, clipped at the grid
+         * boundary. Grid points without a point do not count.
+         * @param expression
+         * @param grid dimensions
+         * @param grid resolution per spatial axis
+         * @param spatial bandwidth
+         * @param points of the feature-space
+         * @param linear index of each point in the grid
+         * @param aggregates (filled, one vector per aggregate, 
+         *        indexed by point)
+         */
+        static void
+        calculate_aggregates(const WeightExpression<T> &expression,
+                const vector<size_t> &dims,
+                const vector<T> &resolution,
+                const vector<T> &bandwidth,
+                const PointStore<T> &store,
+                const vector<size_t> &linear_index,
+                vector< vector<T> > &result)
+        {
+            typedef typename WeightExpression<T>::aggregate_t aggregate_t;
+            const vector<aggregate_t> &aggregates = expression.aggregates();
+            result.resize(aggregates.size());
+            if (aggregates.empty()) return;
+
+            const size_t spatial_rank = store.spatial_rank();
+            const size_t num_points = store.size();
+
+            vector<long> width(spatial_rank, 0);
+            vector< vector<T> > box(spatial_rank);
+            for (size_t i = 0; i < spatial_rank; i++) {
+                T h = (i < bandwidth.size()) ? bandwidth[i] : 0.0;
+                width[i] = (h > 0 && resolution[i] > 0) ? (long) floor(h / resolution[i]) : 0;
+                box[i].assign(width[i] + 1, 1.0);
+            }
+
+            SeparableConvolution<T> convolution(dims, box);
+            const size_t N = convolution.size();
+            vector<T> data(N), buffer(N);
+
+            // Number of points in each neighbourhood, for the means
+
+            vector<T> count;
+
+            for (size_t ai = 0; ai < aggregates.size(); ai++) {
+                const aggregate_t &aggregate = aggregates[ai];
+                const size_t vi = spatial_rank + aggregate.var_index;
+
+                T absent = 0.0;
+                if (aggregate.kind == WeightExpression<T>::AggregateMin) {
+                    absent = std::numeric_limits<T>::max();
+                } else if (aggregate.kind == WeightExpression<T>::AggregateMax) {
+                    absent = -std::numeric_limits<T>::max();
+                }
+
+                data.assign(N, absent);
+                const T *column = store.column(vi);
+                for (size_t pi = 0; pi < num_points; pi++) {
+                    data[linear_index[pi]] = column[pi];
+                }
+
+                for (size_t d = 0; d < spatial_rank; d++) {
+                    if (aggregate.kind == WeightExpression<T>::AggregateMean) {
+                        convolution.convolve(d, &data[0], &buffer[0]);
+                    } else {
+                        bool maximum = (aggregate.kind == WeightExpression<T>::AggregateMax);
+                        extremum_pass(dims, d, width[d], maximum, &data[0], &buffer[0]);
+                    }
+                    data.swap(buffer);
+                }
+
+                if (aggregate.kind == WeightExpression<T>::AggregateMean && count.empty()) {
+                    count.assign(N, 0.0);
+                    for (size_t pi = 0; pi < num_points; pi++) {
+                        count[linear_index[pi]] = 1.0;
+                    }
+                    for (size_t d = 0; d < spatial_rank; d++) {
+                        convolution.convolve(d, &count[0], &buffer[0]);
+                        count.swap(buffer);
+                    }
+                }
+
+                result[ai].resize(num_points);
+                for (size_t pi = 0; pi < num_points; pi++) {
+                    T value = data[linear_index[pi]];
+                    if (aggregate.kind == WeightExpression<T>::AggregateMean) {
+                        value /= count[linear_index[pi]];
+                    }
+                    result[ai][pi] = value;
+                }
+            }
+        }
+
+        /** Construct the weight function from the expression in
+         * params.weight_function_expression.
+         * @param params
+         * @param context
+         * @throws std::invalid_argument if the expression is invalid
+         */
+        ExpressionWeightFunction(const detection_params_t<T> &params,
+                const detection_context_t<T> &ctx)
+        : PrecomputedWeightFunction<T>(ctx.coord_system->get_dimension_sizes())
+        , m_expression(params.weight_function_expression, params.variables)
+        , m_coordinate_system(ctx.coord_system)
+        , m_bandwidth(ctx.fs->spatial_component(ctx.bandwidth))
+        {
+            this->set_limits(ctx, params.variables.size());
+            calculate_weight_function(ctx.fs);
+        }
+
+        bool
+        recalculate(const detection_params_t<T> &params,
+                const detection_context_t<T> &ctx)
+        {
+            if (ctx.coord_system != m_coordinate_system || !this->reset_weights(ctx)) {
+                return false;
+            }
+            this->set_limits(ctx, params.variables.size());
+            calculate_weight_function(ctx.fs);
+            return true;
+        }
+    };
+}
+
+#endif
@@ -27,7 +27,7 @@
 #include <meanie3D/defines.h>
 #include <meanie3D/namespaces.h>
 #include <meanie3D/utils.h>
-#include <meanie3D/weights/weight_function.h>
+#include <meanie3D/weights/precomputed_weight_function.h>
 
 #include <netcdf>
 #include <vector>
@@ -41,24 +41,48 @@ namespace m3D {
     using std::map;
 
     template <class T>
-    class InverseDefaultWeightFunction : public WeightFunction<T>
+    class InverseDefaultWeightFunction : public PrecomputedWeightFunction<T>
     {
     protected:
 
         vector<string> m_vars; // variables for weighting
-        map<size_t, T> m_min; // [index,min]
-        map<size_t, T> m_max; // [index,max]
-        MultiArray<T> *m_weight;
         const CoordinateSystem<T> *m_coordinate_system;
 
+        /** Maps each variable linearly from 1 at min to 0 at max.
+         * Only original points receive a weight.
+         */
+        struct WeightKernel
+        {
+            const T *a;
+            const T *b;
+
+            inline T term(size_t var_index, T value) const
+            {
+                return a[var_index] * value + b[var_index];
+            }
+
+            inline T finish(T sum, const Point<T> *p) const
+            {
+                return p->isOriginalPoint ? sum : 0.0;
+            }
+        };
+
         void
         calculate_weight_function(FeatureSpace<T> *fs)
         {
-            for (size_t i = 0; i < fs->points.size(); i++) {
-                Point<T> *p = fs->points[i];
-                T saliency = compute_weight(p);
-                m_weight->set(p->gridpoint, saliency);
+            size_t num_vars = fs->value_rank();
+            vector<T> a(num_vars), b(num_vars);
+            for (size_t var_index = 0; var_index < num_vars; var_index++) {
+                T range = this->m_max.at(var_index) - this->m_min.at(var_index);
+                a[var_index] = -1.0 / range;
+                b[var_index] = 0.5 * (1.0 - a[var_index] * range);
             }
+
+            WeightKernel kernel;
+            kernel.a = &a[0];
+            kernel.b = &b[0];
+
+            this->precompute(fs, kernel);
         };
 
     public:
@@ -69,55 +93,24 @@ namespace m3D {
          */
         InverseDefaultWeightFunction(const detection_params_t<T> &params, 
                              const detection_context_t<T> &ctx)
-        : m_vars(params.variables)
-        , m_weight(new MultiArrayBlitz<T>(ctx.coord_system->get_dimension_sizes(), 0.0))
+        : PrecomputedWeightFunction<T>(ctx.coord_system->get_dimension_sizes())
+        , m_vars(params.variables)
         , m_coordinate_system(ctx.coord_system)
         {
-            // If scale-space filter is present, use the filtered
-            // limits. If not, use the original limits
-            if (ctx.sf == NULL) {
-                for (size_t index = 0; index < m_vars.size(); index++) {
-                    m_min[index] = ctx.data_store->min(index);
-                    m_max[index] = ctx.data_store->max(index);
-                }
-            } else {
-                m_min = ctx.sf->get_filtered_min();
-                m_max = ctx.sf->get_filtered_max();
-            }
-
+            this->set_limits(ctx, m_vars.size());
             calculate_weight_function(ctx.fs);
         }
 
-        ~InverseDefaultWeightFunction()
-        {
-            if (this->m_weight != NULL) {
-                delete m_weight;
-                m_weight = NULL;
-            }
-        }
-
-        /** Actual weight computation happens here
-         */
-        virtual T compute_weight(Point<T> *p)
+        bool
+        recalculate(const detection_params_t<T> &params,
+                const detection_context_t<T> &ctx)
         {
-            T sum = 0.0;
-            size_t num_vars = p->values.size() - p->coordinate.size();
-            if (p->isOriginalPoint) {
-                for (size_t var_index = 0; var_index < num_vars; var_index++) {
-                    T value = p->values[p->coordinate.size() + var_index];
-                    // value scaled to [0..1]
-                    T a = -1.0 / (m_max.at(var_index) - m_min.at(var_index));
-                    T b = 0.5 * (1.0 - a * (m_max.at(var_index) - m_min.at(var_index)));
-                    T var_weight = a * value + b;
-                    sum += var_weight;
-                }
+            if (ctx.coord_system != m_coordinate_system || !this->reset_weights(ctx)) {
+                return false;
             }
-            return sum;
-        }
-
-        T operator()(const typename Point<T>::ptr p) const
-        {
-            return m_weight->get(p->gridpoint);
+            this->set_limits(ctx, m_vars.size());
+            calculate_weight_function(ctx.fs);
+            return true;
         }
     };
 }
@@ -28,12 +28,13 @@
 #include <meanie3D/namespaces.h>
 #include <meanie3D/utils.h>
 #include <meanie3D/weights/weight_function.h>
-#include <meanie3D/index/search_parameters.h>
-#include <meanie3D/operations/kernels.h>
+#include <meanie3D/array/multiarray_dense.h>
 #include <meanie3D/utils/vector_utils.h>
 #include <meanie3D/filters/scalespace_filter.h>
+#include <meanie3D/operations/kernels.h>
 
 #include <netcdf>
+#include <cmath>
 #include <vector>
 #include <map>
 
@@ -49,40 +50,225 @@ namespace m3D {
     {
     private:
 
+        /** Role of a variable in the weight */
+        typedef enum
+        {
+            OASERoleNone,
+            OASERoleScaled,
+            OASERoleCloudType
+        } oase_role_t;
+
         vector<string> m_vars; // variables for weighting
         map<size_t, T> m_min; // [index,min]
         map<size_t, T> m_max; // [index,max]
         MultiArray<T> *m_weight;
+        DenseGridView<T> m_weight_grid;
         const CoordinateSystem<T> *m_coordinate_system;
 
-        // Weight function with range weight
-
-        PointIndex<T> *m_index; // index for range search
         vector<T> m_bandwidth; // bandwidth for range weight
-        SearchParameters *m_search_params; // search params for search
-        Kernel<T> *m_kernel; // kernel for weighing 
 
+        // Variable roles, resolved once at construction
+
+        vector<oase_role_t> m_roles; // [index,role]
+        vector<T> m_multiplier; // [index,multiplier]
+        vector<T> m_offset; // [index,min]
+        vector<T> m_scale; // [index,1/(max-min)]
+
+        /** Resolves the variable names to roles and pre-calculates
+         * the scaling to [0..1] for each variable.
+         */
+        void
+        resolve_roles()
+        {
+            size_t n = m_vars.size();
+            m_roles.assign(n, OASERoleNone);
+            m_multiplier.assign(n, 0.0);
+            m_offset.assign(n, 0.0);
+            m_scale.assign(n, 0.0);
+
+            for (size_t var_index = 0; var_index < n; var_index++) {
+                const string &var = m_vars[var_index];
+                if (var == "cband_radolan_rx") {
+                    // varies from 0 .. 1. Multiplier 10x
+                    m_roles[var_index] = OASERoleScaled;
+                    m_multiplier[var_index] = 10.0;
+                } else if (var == "msevi_l2_cmsaf_cot" || var == "msevi_l15_ir_108") {
+                    m_roles[var_index] = OASERoleScaled;
+                    m_multiplier[var_index] = 1.0;
+                } else if (var == "linet_oase_tl") {
+                    // varies from 0 .. 1. Multiplier 10x
+                    m_roles[var_index] = OASERoleScaled;
+                    m_multiplier[var_index] = 10.0;
+                } else if (var == "msevi_l2_nwcsaf_ct") {
+                    m_roles[var_index] = OASERoleCloudType;
+                    m_multiplier[var_index] = 1.0;
+                }
+
+                if (m_roles[var_index] == OASERoleScaled) {
+                    T min = m_min.at(var_index);
+                    T max = m_max.at(var_index);
+                    m_offset[var_index] = min;
+                    m_scale[var_index] = 1.0 / (max - min);
+                }
+            }
+        }
+
+        /** Calculates the raw score per grid point and smoothes
+         * it over the bandwidth ellipsoid.
+         */
         void
         calculate_weight_function(FeatureSpace<T> *fs)
         {
-            size_t spatial_dim = fs->coordinate_system->rank();
-            vector<size_t> indexes(spatial_dim);
-            for (size_t i = 0; i < spatial_dim; i++) indexes[i] = i;
-            m_index = PointIndex<T>::create(&fs->points, indexes);
-            m_kernel = new GaussianNormalKernel<T>(vector_norm(m_bandwidth));
-            m_search_params = new RangeSearchParams<T>(m_bandwidth);
-            for (size_t i = 0; i < fs->points.size(); i++) {
-                Point<T> *p = fs->points[i];
-                T saliency = this->compute_weight(p);
-                m_weight->set(p->gridpoint, saliency);
+            vector<T> data(m_weight_grid.size(), 0.0);
+            vector<size_t> linear_index(fs->points.size());
+
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t pi = 0; pi < fs->points.size(); pi++) {
+                Point<T> *p = fs->points[pi];
+                size_t index = m_weight_grid.linear_index(p->gridpoint);
+                linear_index[pi] = index;
+                data[index] = this->weight_version_one(p);
+            }
+
+            vector<T> smoothed;
+            smooth(m_coordinate_system->get_dimension_sizes(),
+                    m_coordinate_system->resolution(),
+                    m_bandwidth, data, linear_index, smoothed);
+
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t pi = 0; pi < fs->points.size(); pi++) {
+                m_weight_grid.set(linear_index[pi], smoothed[pi]);
             }
-            delete m_index;
-            delete m_kernel;
-            delete m_search_params;
         };
 
     public:
 
+        /** Smoothes raw scores on the grid the way the range search
+         * this replaces did: each grid point sums the scores of all
+         * grid points within the bandwidth ellipsoid around it,
+         * weighed with GaussianNormalKernel on their distance. The
+         * ellipsoid is turned into a table of linear offsets and
+         * kernel values once. Grid points far enough from the 
+         * boundary use the table as is, others test each offset.
+         *
+         * @param grid dimensions
+         * @param grid resolution per spatial axis
+         * @param bandwidth per spatial axis
+         * @param raw score per grid point (row-major)
+         * @param linear indexes of the grid points to smooth
+         * @param smoothed score per linear index (output)
+         */
+        static void
+        smooth(const vector<size_t> &dims,
+                const vector<T> &resolution,
+                const vector<T> &bandwidth,
+                const vector<T> &data,
+                const vector<size_t> &indexes,
+                vector<T> &result)
+        {
+            const size_t rank = dims.size();
+
+            vector<long> strides(rank);
+            vector<int> width(rank);
+            long stride = 1;
+            for (size_t d = rank; d > 0; d--) {
+                strides[d - 1] = stride;
+                stride *= (long) dims[d - 1];
+
+                T h = bandwidth[d - 1];
+                T r = resolution[d - 1];
+                width[d - 1] = (h > 0 && r > 0) ? (int) floor(h / r) : 0;
+            }
+
+            // Walk the box around the origin and keep the offsets
+            // inside the ellipsoid x1^2/h1^2 + ... + xn^2/hn^2 <= 1
+
+            GaussianNormalKernel<T> kernel;
+            vector<int> offsets; // rank components per entry
+            vector<long> linear_offsets;
+            vector<T> weights;
+
+            vector<int> k(rank);
+            for (size_t d = 0; d < rank; d++) {
+                k[d] = -width[d];
+            }
+
+            bool done = (rank == 0);
+            while (!done) {
+                T r = 0.0;
+                T dist = 0.0;
+                long offset = 0;
+                for (size_t d = 0; d < rank; d++) {
+                    T x = ((T) k[d]) * resolution[d];
+                    T c = (bandwidth[d] > 0) ? 1.0 / (bandwidth[d] * bandwidth[d]) : 0.0;
+                    r += x * x * c;
+                    dist += x * x;
+                    offset += k[d] * strides[d];
+                }
+
+                if (r <= 1.0) {
+                    offsets.insert(offsets.end(), k.begin(), k.end());
+                    linear_offsets.push_back(offset);
+                    weights.push_back(kernel.apply(sqrt(dist)));
+                }
+
+                done = true;
+                for (size_t d = rank; d > 0; d--) {
+                    if (k[d - 1] < width[d - 1]) {
+                        k[d - 1]++;
+                        done = false;
+                        break;
+                    }
+                    k[d - 1] = -width[d - 1];
+                }
+            }
+
+            const size_t n = weights.size();
+            result.assign(indexes.size(), 0.0);
+
+#if WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (size_t i = 0; i < indexes.size(); i++) {
+                const long index = (long) indexes[i];
+
+                vector<int> g(rank);
+                bool interior = true;
+                long rest = index;
+                for (size_t d = 0; d < rank; d++) {
+                    g[d] = (int) (rest / strides[d]);
+                    rest = rest % strides[d];
+                    interior = interior && g[d] >= width[d] && g[d] + width[d] < (int) dims[d];
+                }
+
+                T sum = 0.0;
+
+                if (interior) {
+                    for (size_t s = 0; s < n; s++) {
+                        sum += weights[s] * data[index + linear_offsets[s]];
+                    }
+                } else {
+                    for (size_t s = 0; s < n; s++) {
+                        const int *o = &offsets[s * rank];
+                        bool inside = true;
+                        for (size_t d = 0; d < rank && inside; d++) {
+                            int x = g[d] + o[d];
+                            inside = (x >= 0 && x < (int) dims[d]);
+                        }
+                        if (inside) {
+                            sum += weights[s] * data[index + linear_offsets[s]];
+                        }
+                    }
+                }
+
+                result[i] = sum;
+            }
+        }
+
         /** Construct the weight function, using the default values
          * for valid_min/valid_max
          * @param featurespace
@@ -90,7 +276,8 @@ namespace m3D {
         OASEWeightFunction(const detection_params_t<T> &params, 
                              const detection_context_t<T> &ctx)
         : m_vars(params.variables)
-        , m_weight(new MultiArrayBlitz<T>(ctx.coord_system->get_dimension_sizes(), 0.0))
+        , m_weight(create_dense_multiarray<T>(ctx.coord_system->get_dimension_sizes(), 0.0))
+        , m_weight_grid(m_weight)
         , m_coordinate_system(ctx.coord_system)
         , m_bandwidth(ctx.bandwidth)
         {
@@ -106,6 +293,7 @@ namespace m3D {
                 m_max = ctx.sf->get_filtered_max();
             }
 
+            this->resolve_roles();
             calculate_weight_function(ctx.fs);
         }
 
@@ -121,153 +309,92 @@ namespace m3D {
          * cloud type, 10.8um, cband_radolan, cloud optical 
          * thickness and lightning counts
          */
-        T weight_version_one(Point<T> *p)
+        T weight_version_one(Point<T> *p) const
         {
             T sum = 0.0;
 
-            const float msevi_l2_nwcsaf_ct_multiplier = 1.0;
-            const float cband_radolan_rx_multiplier = 10.0;
-            const float linet_oase_tl_multiplier = 10.0;
-
             size_t num_vars = p->values.size() - p->coordinate.size();
 
             for (size_t var_index = 0; var_index < num_vars; var_index++) {
-                string var = m_vars[var_index];
-
                 T value = p->values[p->coordinate.size() + var_index];
 
-                if (var == "cband_radolan_rx") {
-                    // varies from 0 .. 1. Multiplier 10x
-
-                    T rx_weight = (value - m_min.at(var_index)) / (m_max.at(var_index) - m_min.at(var_index));
-
-                    sum += cband_radolan_rx_multiplier * rx_weight;
-                } else if (var == "msevi_l2_cmsaf_cot") {
-                    T cot_weight = (value - m_min.at(var_index)) / (m_max.at(var_index) - m_min.at(var_index));
-                    sum += cot_weight;
-                } else if (var == "msevi_l15_ir_108") {
-                    T ir_weight = (value - m_min.at(var_index)) / (m_max.at(var_index) - m_min.at(var_index));
-                    sum += ir_weight;
-                } else if (var == "msevi_l2_nwcsaf_ct") {
-                    //                    
-                    //                    http://www.nwcsaf.org/HTMLContributions/CT/Prod_CT.htm
-                    //                    0  non-processed          containing no data or corrupted data
-                    //                    
-                    //                    1	cloud free land 	no contamination by snow/ice covered surface, 
-                    //                                              no contamination by clouds ; but contamination 
-                    //                                              by thin dust/volcanic clouds not checked
-                    //                    
-                    //                    2	cloud free sea          no contamination by snow/ice covered surface, 
-                    //                                              no contamination by clouds ; but contamination 
-                    //                                              by thin dust/volcanic clouds not checked
-                    //                    3	land contaminated by snow
-                    //                    4	sea contaminated by snow/ice
-                    //                    5	very low and cumuliform clouds
-                    //                    6	very low and stratiform clouds
-                    //                    7	low and cumuliform clouds
-                    //                    8	low and stratiform clouds
-                    //                    9	medium and cumuliform clouds
-                    //                    10	medium and stratiform clouds
-                    //                    11	high opaque and cumuliform clouds
-                    //                    12	high opaque and stratiform clouds
-                    //                    13	very high opaque and cumuliform clouds
-                    //                    14	very high opaque and stratiform clouds
-                    //                    15	high semitransparent thin clouds 	
-                    //                    16	high semitransparent meanly thick clouds 	
-                    //                    17	high semitransparent thick clouds 	
-                    //                    18	high semitransparent above low or medium clouds 	
-                    //                    19	fractional clouds (sub-pixel water clouds) 	
-                    //                    20	undefined (undefined by CMa)
-                    //
-                    // weight: low = 1 point, medium = 1.5 points, high = 2 points, very high = 2.5 points.
-                    //          stratiform = x1 cumulus = x2
-                    // weight from 0 .. 5, multiplier 1x
-
-                    float height_factor = 0.0;
-
-                    if (value >= 7 && value <= 8)
-                        height_factor = 1.0;
-                    else if (value >= 9 && value <= 10)
-                        height_factor = 1.5;
-                    else if (value >= 11 && value <= 12)
-                        height_factor = 2.0;
-                    else if (value >= 13 && value <= 14)
-                        height_factor = 2.5;
-
-                    // default = stratiform
-                    float type_multiplier = 1.0;
-
-                    // double for cumuliform
-                    if (value == 7 || value == 11 || value == 13) {
-                        type_multiplier = 2.0;
+                switch (m_roles[var_index]) {
+                    case OASERoleScaled:
+                        sum += m_multiplier[var_index] * (value - m_offset[var_index]) * m_scale[var_index];
+                        break;
+
+                    case OASERoleCloudType:
+                    {
+                        //                    
+                        //                    http://www.nwcsaf.org/HTMLContributions/CT/Prod_CT.htm
+                        //                    0  non-processed          containing no data or corrupted data
+                        //                    
+                        //                    1	cloud free land 	no contamination by snow/ice covered surface, 
+                        //                                              no contamination by clouds ; but contamination 
+                        //                                              by thin dust/volcanic clouds not checked
+                        //                    
+                        //                    2	cloud free sea          no contamination by snow/ice covered surface, 
+                        //                                              no contamination by clouds ; but contamination 
+                        //                                              by thin dust/volcanic clouds not checked
+                        //                    3	land contaminated by snow
+                        //                    4	sea contaminated by snow/ice
+                        //                    5	very low and cumuliform clouds
+                        //                    6	very low and stratiform clouds
+                        //                    7	low and cumuliform clouds
+                        //                    8	low and stratiform clouds
+                        //                    9	medium and cumuliform clouds
+                        //                    10	medium and stratiform clouds
+                        //                    11	high opaque and cumuliform clouds
+                        //                    12	high opaque and stratiform clouds
+                        //                    13	very high opaque and cumuliform clouds
+                        //                    14	very high opaque and stratiform clouds
+                        //                    15	high semitransparent thin clouds 	
+                        //                    16	high semitransparent meanly thick clouds 	
+                        //                    17	high semitransparent thick clouds 	
+                        //                    18	high semitransparent above low or medium clouds 	
+                        //                    19	fractional clouds (sub-pixel water clouds) 	
+                        //                    20	undefined (undefined by CMa)
+                        //
+                        // weight: low = 1 point, medium = 1.5 points, high = 2 points, very high = 2.5 points.
+                        //          stratiform = x1 cumulus = x2
+                        // weight from 0 .. 5, multiplier 1x
+
+                        float height_factor = 0.0;
+
+                        if (value >= 7 && value <= 8)
+                            height_factor = 1.0;
+                        else if (value >= 9 && value <= 10)
+                            height_factor = 1.5;
+                        else if (value >= 11 && value <= 12)
+                            height_factor = 2.0;
+                        else if (value >= 13 && value <= 14)
+                            height_factor = 2.5;
+
+                        // default = stratiform
+                        float type_multiplier = 1.0;
+
+                        // double for cumuliform
+                        if (value == 7 || value == 11 || value == 13) {
+                            type_multiplier = 2.0;
+                        }
+
+                        T ct_weight = height_factor * type_multiplier;
+
+                        sum += m_multiplier[var_index] * ct_weight;
+                        break;
                     }
 
-                    T ct_weight = height_factor * type_multiplier;
-
-                    sum += msevi_l2_nwcsaf_ct_multiplier * ct_weight;
-                } else if (var == "linet_oase_tl") {
-                    // varies from 0 .. 1. Multiplier 100x
-
-                    T linet_weight = (value - m_min.at(var_index)) / (m_max.at(var_index) - m_min.at(var_index));
-                    sum += linet_oase_tl_multiplier * linet_weight;
-                } else {
-                    //                    // value scaled to [0..1]
-                    //                    T var_weight = (value - m_min.at(var_index)) / ( m_max.at(var_index) - m_min.at(var_index) );
-                    //                    
-                    //                    // value^2
-                    //                    //T var_weight = ( sample->at(index)->values[weight_var_index] ) * ( sample->at(index)->values[weight_var_index] );
-                    //                    
-                    //                    // value^3
-                    //                    //T value = sample->at(index)->values[weight_var_index];
-                    //                    //T var_weight = pow( value, 3 );
-                    //                    
-                    //                    // value^t
-                    //                    //T var_weight = pow( sample->at(index)->values[weight_var_index], this->feature_space->scale() );
-                    //                    
-                    //                    // 10^(value/10)
-                    //                    // T var_weight = pow( 10, value / 10 );
-                    //                    
-                    //                    sum += var_weight;
+                    default:
+                        break;
                 }
             }
 
             return sum;
         }
 
-        /** Actual weight computation happens here
-         */
-        T compute_weight(Point<T> *p)
-        {
-
-
-            typename Point<T>::list *neighbors = m_index->search(p->coordinate, m_search_params);
-
-            T weight = 0;
-
-            for (size_t pi = 0; pi < neighbors->size(); pi++) {
-                typename Point<T>::ptr n = neighbors->at(pi);
-
-                // calculate weight at that point
-
-                T point_weight = weight_version_one(n);
-
-                // calculate distance between n and p
-
-                T dist = vector_norm(p->coordinate - n->coordinate);
-
-                // calculate gaussian weighed sum 
-
-                weight += m_kernel->apply(dist) * point_weight;
-            }
-
-            delete neighbors;
-
-            return weight;
-        }
-
         T operator()(const typename Point<T>::ptr p) const
         {
-            return m_weight->get(p->gridpoint);
+            return m_weight_grid.get(p->gridpoint);
         }
     };
 }
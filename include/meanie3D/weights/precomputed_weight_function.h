@@ -0,0 +1,275 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef M3D_PRECOMPUTEDWEIGHTFUNCTION_H
+#define M3D_PRECOMPUTEDWEIGHTFUNCTION_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+#include <meanie3D/array/multiarray.h>
+#include <meanie3D/array/multiarray_dense.h>
+#include <meanie3D/featurespace/point.h>
+#include <meanie3D/featurespace/point_store.h>
+#include <meanie3D/weights/weight_function.h>
+
+#include <vector>
+#include <map>
+
+namespace m3D {
+
+    using std::vector;
+    using std::map;
+
+    /** Base for weight functions, which are calculated once for 
+     * every point in feature-space and looked up afterwards. 
+     *
+     * Subclasses supply a small kernel object and call one of the
+     * precompute methods from their constructor. For weights that 
+     * are a sum of terms per variable, the kernel provides:
+     *
+     *   T term(size_t var_index, T value) const
+     *   T finish(T sum, const Point<T> *p) const
+     *
+     * The points are gathered into a PointStore and processed in
+     * parallel blocks. Per block, the terms of each variable are 
+     * summed over a contiguous column in a tight loop, that the 
+     * compiler can vectorize when term() is simple enough. The 
+     * results are written to the weight grid by linear index.
+     */
+    template <typename T>
+    class PrecomputedWeightFunction : public WeightFunction<T>
+    {
+    protected:
+
+        MultiArray<T> *m_weight;
+        DenseGridView<T> m_weight_grid;
+
+        vector<T> m_min; // [var_index]
+        vector<T> m_max; // [var_index]
+
+#pragma mark -
+#pragma mark Constructor/Destructor
+
+        /** @param dimension sizes of the weight grid
+         */
+        PrecomputedWeightFunction(const vector<size_t> &dimensions)
+        : m_weight(create_dense_multiarray<T>(dimensions, 0.0))
+        , m_weight_grid(m_weight)
+        {
+        }
+
+    public:
+
+        virtual ~PrecomputedWeightFunction()
+        {
+            if (this->m_weight != NULL) {
+                delete m_weight;
+                m_weight = NULL;
+            }
+        }
+
+    protected:
+
+#pragma mark -
+#pragma mark Re-calculation
+
+        /** Prepares the weight array for another calculation on the 
+         * context's grid by setting all weights to 0.
+         * @param context
+         * @return false if the context's grid differs from the one
+         * the array was allocated for.
+         */
+        bool
+        reset_weights(const detection_context_t<T> &ctx)
+        {
+            if (ctx.coord_system->get_dimension_sizes() != m_weight->get_dimensions()) {
+                return false;
+            }
+            m_weight->populate_array(0.0);
+            return true;
+        }
+
+    public:
+
+        /** Re-calculates the weights for the feature-space of the
+         * given context in place, re-using the weight array. This
+         * serves the steps of a series, which share the grid. The
+         * default implementation does nothing.
+         * @param params
+         * @param context
+         * @return true if the weights were re-calculated, false if the
+         * weight function has to be constructed anew.
+         */
+        virtual bool
+        recalculate(const detection_params_t<T> &params,
+                const detection_context_t<T> &ctx)
+        {
+            return false;
+        }
+
+    protected:
+
+#pragma mark -
+#pragma mark Limits
+
+        /** Flattens the given limit maps into m_min/m_max.
+         * @param map of lower bounds
+         * @param map of upper bounds
+         */
+        void
+        set_limits(const map<size_t, T> &min, const map<size_t, T> &max)
+        {
+            typename map<size_t, T>::const_iterator mi;
+            for (mi = min.begin(); mi != min.end(); ++mi) {
+                if (mi->first >= m_min.size()) m_min.resize(mi->first + 1, 0.0);
+                m_min[mi->first] = mi->second;
+            }
+            for (mi = max.begin(); mi != max.end(); ++mi) {
+                if (mi->first >= m_max.size()) m_max.resize(mi->first + 1, 0.0);
+                m_max[mi->first] = mi->second;
+            }
+        }
+
+        /** Obtains the limits of the first num_vars variables. If a
+         * scale-space filter is present, the filtered limits are 
+         * used. If not, the original limits.
+         * @param context
+         * @param number of variables
+         */
+        void
+        set_limits(const detection_context_t<T> &ctx, size_t num_vars)
+        {
+            if (ctx.sf == NULL) {
+                m_min.resize(num_vars);
+                m_max.resize(num_vars);
+                for (size_t index = 0; index < num_vars; index++) {
+                    m_min[index] = ctx.data_store->min(index);
+                    m_max[index] = ctx.data_store->max(index);
+                }
+            } else {
+                this->set_limits(ctx.sf->get_filtered_min(), ctx.sf->get_filtered_max());
+            }
+        }
+
+#pragma mark -
+#pragma mark Pre-computation
+
+        /** Evaluates a kernel, that sums terms per variable, at 
+         * every point of the feature-space and stores the result.
+         * @param feature-space
+         * @param kernel
+         */
+        template <class Kernel>
+        void
+        precompute(const FeatureSpace<T> *fs, const Kernel &kernel)
+        {
+            PointStore<T> store;
+            fs->gather(store);
+            this->precompute(store, kernel);
+        }
+
+        /** Evaluates a kernel, that sums terms per variable, at
+         * every point of the store and stores the result. The
+         * store's values are the spatial components followed by
+         * the variables.
+         * @param point store
+         * @param kernel
+         */
+        template <class Kernel>
+        void
+        precompute(const PointStore<T> &store, const Kernel &kernel)
+        {
+            const size_t num_points = store.size();
+            const size_t spatial_rank = store.spatial_rank();
+            const size_t value_rank = (store.rank() > spatial_rank) ? store.rank() - spatial_rank : 0;
+            const size_t block_size = WEIGHT_FUNCTION_BLOCK_SIZE;
+            const size_t num_blocks = (num_points + block_size - 1) / block_size;
+
+#if WITH_OPENMP
+#pragma omp parallel
+#endif
+            {
+                vector<T> sum(block_size);
+
+#if WITH_OPENMP
+#pragma omp for schedule(static)
+#endif
+                for (size_t block = 0; block < num_blocks; block++) {
+                    const size_t begin = block * block_size;
+                    const size_t n = (num_points - begin < block_size) ? (num_points - begin) : block_size;
+
+                    for (size_t k = 0; k < n; k++) {
+                        sum[k] = 0.0;
+                    }
+
+                    for (size_t vi = 0; vi < value_rank; vi++) {
+                        const T *column = store.column(spatial_rank + vi) + begin;
+                        for (size_t k = 0; k < n; k++) {
+                            sum[k] += kernel.term(vi, column[k]);
+                        }
+                    }
+
+                    for (size_t k = 0; k < n; k++) {
+                        const size_t i = begin + k;
+                        m_weight_grid.set(m_weight_grid.linear_index(store.gridpoint(i)),
+                                kernel.finish(sum[k], store.point(i)));
+                    }
+                }
+            }
+        }
+
+        /** Evaluates a kernel point by point, in parallel. For
+         * weights that do not break down into terms per variable.
+         * The kernel provides T operator()(Point<T> *p) and must be 
+         * safe to call from several threads at once.
+         * @param feature-space
+         * @param kernel
+         */
+        template <class Kernel>
+        void
+        precompute_points(const FeatureSpace<T> *fs, const Kernel &kernel)
+        {
+            const typename Point<T>::list &points = fs->points;
+
+#if WITH_OPENMP
+#pragma omp parallel for schedule(dynamic, WEIGHT_FUNCTION_BLOCK_SIZE)
+#endif
+            for (size_t i = 0; i < points.size(); i++) {
+                Point<T> *p = points[i];
+                m_weight_grid.set(p->gridpoint, kernel(p));
+            }
+        }
+
+    public:
+
+        /** @return pre-calculated weight
+         */
+        T operator()(const typename Point<T>::ptr p) const
+        {
+            return m_weight_grid.get(p->gridpoint);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,706 @@
+/* The MIT License (MIT)
+ * 
+ * (c) Jürgen Simon 2014 (juergen.simon@uni-bonn.de)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef M3D_WEIGHTEXPRESSION_H
+#define M3D_WEIGHTEXPRESSION_H
+
+#include <meanie3D/defines.h>
+#include <meanie3D/namespaces.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace m3D {
+
+    using std::string;
+    using std::vector;
+
+    /** An arithmetic and logical expression over the variables of 
+     * a feature-space, compiled once into a program for a small stack
+     * machine. The program is run on blocks of points: every 
+     * instruction processes a whole block of values in one tight 
+     * loop, which keeps the interpretation overhead per point low and 
+     * allows the compiler to vectorize the loops.
+     *
+     * Syntax (in order of increasing precedence):
+     *
+     *   a || b, a && b                 logical (result 0 or 1)
+     *   ==, !=, <, <=, >, >=           comparison (result 0 or 1)
+     *   a + b, a - b, a * b, a / b
+     *   -a, !a
+     *   a ^ b                          power
+     *
+     * Operands are numbers, variable names, parenthesized expressions
+     * and the following functions:
+     *
+     *   abs(a), sqrt(a), exp(a), log(a), log10(a), pow(a,b)
+     *   min(a,b), max(a,b), if(condition,a,b)
+     *   min(var), max(var)             limits of a variable
+     *   scaled(var)                    var scaled from [min..max] to [0..1]
+     *   nbmean(var), nbmin(var), nbmax(var)
+     *                                  mean, minimum or maximum of var
+     *                                  in the neighbourhood of a point
+     *
+     * Example: "scaled(zh) + 10 * (nbmax(linet_oase_tl) > 0)"
+     */
+    template <typename T>
+    class WeightExpression
+    {
+    public:
+
+        typedef enum
+        {
+            AggregateMean,
+            AggregateMin,
+            AggregateMax
+        } aggregate_kind_t;
+
+        /** A neighbourhood aggregate used by the expression */
+        typedef struct
+        {
+            aggregate_kind_t kind;
+            size_t var_index;
+        } aggregate_t;
+
+    private:
+
+        typedef enum
+        {
+            OpConst, OpVariable, OpAggregate, OpMin, OpMax,
+            OpNeg, OpNot, OpAbs, OpSqrt, OpExp, OpLog, OpLog10,
+            OpAdd, OpSub, OpMul, OpDiv, OpPow, OpMinimum, OpMaximum,
+            OpLess, OpLessEqual, OpGreater, OpGreaterEqual, OpEqual, OpNotEqual,
+            OpAnd, OpOr,
+            OpSelect
+        } opcode_t;
+
+        typedef struct
+        {
+            opcode_t op;
+            size_t arg;
+            T value;
+        } instruction_t;
+
+        typedef enum
+        {
+            TokenEnd, TokenNumber, TokenIdentifier, TokenOperator
+        } token_type_t;
+
+        // Source
+
+        string m_expression;
+        vector<string> m_variables;
+
+        // Program
+
+        vector<instruction_t> m_program;
+        vector<aggregate_t> m_aggregates;
+        size_t m_depth;
+        size_t m_max_depth;
+
+        // Parser state
+
+        size_t m_pos;
+        token_type_t m_token_type;
+        string m_token;
+        T m_token_value;
+
+#pragma mark -
+#pragma mark Tokenizer
+
+        void
+        next_token()
+        {
+            const string &s = m_expression;
+            while (m_pos < s.size() && isspace(s[m_pos])) {
+                m_pos++;
+            }
+
+            m_token.clear();
+
+            if (m_pos >= s.size()) {
+                m_token_type = TokenEnd;
+                return;
+            }
+
+            char c = s[m_pos];
+
+            if (isdigit(c) || (c == '.' && m_pos + 1 < s.size() && isdigit(s[m_pos + 1]))) {
+                const char *begin = s.c_str() + m_pos;
+                char *end = NULL;
+                m_token_value = (T) strtod(begin, &end);
+                m_token = string(begin, end - begin);
+                m_pos += (end - begin);
+                m_token_type = TokenNumber;
+                return;
+            }
+
+            if (isalpha(c) || c == '_') {
+                size_t begin = m_pos;
+                while (m_pos < s.size() && (isalnum(s[m_pos]) || s[m_pos] == '_' || s[m_pos] == '.')) {
+                    m_pos++;
+                }
+                m_token = s.substr(begin, m_pos - begin);
+                m_token_type = TokenIdentifier;
+                return;
+            }
+
+            static const char *two_char_ops[] = {"&&", "||", "==", "!=", "<=", ">="};
+            for (size_t i = 0; i < 6; i++) {
+                if (s.compare(m_pos, 2, two_char_ops[i]) == 0) {
+                    m_token = two_char_ops[i];
+                    m_pos += 2;
+                    m_token_type = TokenOperator;
+                    return;
+                }
+            }
+
+            if (strchr("+-*/^!<>(),", c) != NULL) {
+                m_token = string(1, c);
+                m_pos++;
+                m_token_type = TokenOperator;
+                return;
+            }
+
+            this->fail("unexpected character '" + string(1, c) + "'");
+        }
+
+        bool
+        accept(const char *op)
+        {
+            if (m_token_type == TokenOperator && m_token == op) {
+                this->next_token();
+                return true;
+            }
+            return false;
+        }
+
+        void
+        expect(const char *op)
+        {
+            if (!this->accept(op)) {
+                this->fail("expected '" + string(op) + "'");
+            }
+        }
+
+        void
+        fail(const string &message) const
+        {
+            std::ostringstream s;
+            s << "weight expression '" << m_expression << "': " << message << " at position " << m_pos;
+            throw std::invalid_argument(s.str());
+        }
+
+        size_t
+        variable_index(const string &name) const
+        {
+            for (size_t i = 0; i < m_variables.size(); i++) {
+                if (m_variables[i] == name) return i;
+            }
+            this->fail("unknown variable '" + name + "'");
+            return 0;
+        }
+
+#pragma mark -
+#pragma mark Code generation
+
+        /** Number of operands an instruction consumes */
+        static size_t
+        arity(opcode_t op)
+        {
+            if (op <= OpMax) return 0;
+            if (op <= OpLog10) return 1;
+            if (op <= OpOr) return 2;
+            return 3;
+        }
+
+        void
+        emit(opcode_t op, size_t arg = 0, T value = 0.0)
+        {
+            size_t n = arity(op);
+
+            // Fold operations on constants right away
+            if (n > 0 && m_program.size() >= n) {
+                bool constant = true;
+                for (size_t i = m_program.size() - n; i < m_program.size(); i++) {
+                    constant = constant && (m_program[i].op == OpConst);
+                }
+                if (constant) {
+                    T a = m_program[m_program.size() - n].value;
+                    T b = (n > 1) ? m_program[m_program.size() - n + 1].value : 0.0;
+                    T c = (n > 2) ? m_program[m_program.size() - n + 2].value : 0.0;
+                    m_program.resize(m_program.size() - n);
+                    m_depth -= n;
+                    value = (n == 3) ? (a != 0 ? b : c) : apply(op, a, b);
+                    op = OpConst;
+                    n = 0;
+                }
+            }
+
+            instruction_t instruction;
+            instruction.op = op;
+            instruction.arg = arg;
+            instruction.value = value;
+            m_program.push_back(instruction);
+
+            m_depth = m_depth + 1 - n;
+            if (m_depth > m_max_depth) {
+                m_max_depth = m_depth;
+            }
+        }
+
+        size_t
+        aggregate_index(aggregate_kind_t kind, size_t var_index)
+        {
+            for (size_t i = 0; i < m_aggregates.size(); i++) {
+                if (m_aggregates[i].kind == kind && m_aggregates[i].var_index == var_index) {
+                    return i;
+                }
+            }
+            aggregate_t aggregate;
+            aggregate.kind = kind;
+            aggregate.var_index = var_index;
+            m_aggregates.push_back(aggregate);
+            return m_aggregates.size() - 1;
+        }
+
+#pragma mark -
+#pragma mark Parser
+
+        void
+        parse_or()
+        {
+            this->parse_and();
+            while (this->accept("||")) {
+                this->parse_and();
+                this->emit(OpOr);
+            }
+        }
+
+        void
+        parse_and()
+        {
+            this->parse_comparison();
+            while (this->accept("&&")) {
+                this->parse_comparison();
+                this->emit(OpAnd);
+            }
+        }
+
+        void
+        parse_comparison()
+        {
+            this->parse_sum();
+            while (true) {
+                opcode_t op;
+                if (this->accept("==")) op = OpEqual;
+                else if (this->accept("!=")) op = OpNotEqual;
+                else if (this->accept("<=")) op = OpLessEqual;
+                else if (this->accept(">=")) op = OpGreaterEqual;
+                else if (this->accept("<")) op = OpLess;
+                else if (this->accept(">")) op = OpGreater;
+                else break;
+                this->parse_sum();
+                this->emit(op);
+            }
+        }
+
+        void
+        parse_sum()
+        {
+            this->parse_product();
+            while (true) {
+                if (this->accept("+")) {
+                    this->parse_product();
+                    this->emit(OpAdd);
+                } else if (this->accept("-")) {
+                    this->parse_product();
+                    this->emit(OpSub);
+                } else {
+                    break;
+                }
+            }
+        }
+
+        void
+        parse_product()
+        {
+            this->parse_unary();
+            while (true) {
+                if (this->accept("*")) {
+                    this->parse_unary();
+                    this->emit(OpMul);
+                } else if (this->accept("/")) {
+                    this->parse_unary();
+                    this->emit(OpDiv);
+                } else {
+                    break;
+                }
+            }
+        }
+
+        void
+        parse_unary()
+        {
+            if (this->accept("-")) {
+                this->parse_unary();
+                this->emit(OpNeg);
+            } else if (this->accept("!")) {
+                this->parse_unary();
+                this->emit(OpNot);
+            } else {
+                this->parse_power();
+            }
+        }
+
+        void
+        parse_power()
+        {
+            this->parse_primary();
+            if (this->accept("^")) {
+                this->parse_unary();
+                this->emit(OpPow);
+            }
+        }
+
+        /** Parses '( variable )' and returns the variable's index */
+        size_t
+        parse_variable_argument()
+        {
+            this->expect("(");
+            if (m_token_type != TokenIdentifier) {
+                this->fail("expected variable name");
+            }
+            size_t var_index = this->variable_index(m_token);
+            this->next_token();
+            this->expect(")");
+            return var_index;
+        }
+
+        /** @return true if the next tokens are '( variable )' */
+        bool
+        variable_argument_follows()
+        {
+            size_t pos = m_pos;
+            token_type_t type = m_token_type;
+            string token = m_token;
+            T value = m_token_value;
+
+            bool result = false;
+            if (this->accept("(") && m_token_type == TokenIdentifier) {
+                string name = m_token;
+                this->next_token();
+                if (m_token_type == TokenOperator && m_token == ")") {
+                    for (size_t i = 0; i < m_variables.size(); i++) {
+                        result = result || (m_variables[i] == name);
+                    }
+                }
+            }
+
+            m_pos = pos;
+            m_token_type = type;
+            m_token = token;
+            m_token_value = value;
+            return result;
+        }
+
+        /** Parses '( expression, ... )' with the given number of arguments */
+        void
+        parse_arguments(size_t count)
+        {
+            this->expect("(");
+            for (size_t i = 0; i < count; i++) {
+                if (i > 0) this->expect(",");
+                this->parse_or();
+            }
+            this->expect(")");
+        }
+
+        void
+        parse_primary()
+        {
+            if (m_token_type == TokenNumber) {
+                this->emit(OpConst, 0, m_token_value);
+                this->next_token();
+                return;
+            }
+
+            if (this->accept("(")) {
+                this->parse_or();
+                this->expect(")");
+                return;
+            }
+
+            if (m_token_type != TokenIdentifier) {
+                this->fail("unexpected " + (m_token_type == TokenEnd ? string("end") : ("'" + m_token + "'")));
+            }
+
+            string name = m_token;
+            this->next_token();
+
+            bool call = (m_token_type == TokenOperator && m_token == "(");
+            if (!call) {
+                this->emit(OpVariable, this->variable_index(name));
+                return;
+            }
+
+            if (name == "min" || name == "max") {
+                if (this->variable_argument_follows()) {
+                    this->emit(name == "min" ? OpMin : OpMax, this->parse_variable_argument());
+                } else {
+                    this->parse_arguments(2);
+                    this->emit(name == "min" ? OpMinimum : OpMaximum);
+                }
+            } else if (name == "scaled") {
+                size_t var_index = this->parse_variable_argument();
+                this->emit(OpVariable, var_index);
+                this->emit(OpMin, var_index);
+                this->emit(OpSub);
+                this->emit(OpMax, var_index);
+                this->emit(OpMin, var_index);
+                this->emit(OpSub);
+                this->emit(OpDiv);
+            } else if (name == "nbmean") {
+                this->emit(OpAggregate, this->aggregate_index(AggregateMean, this->parse_variable_argument()));
+            } else if (name == "nbmin") {
+                this->emit(OpAggregate, this->aggregate_index(AggregateMin, this->parse_variable_argument()));
+            } else if (name == "nbmax") {
+                this->emit(OpAggregate, this->aggregate_index(AggregateMax, this->parse_variable_argument()));
+            } else if (name == "abs") {
+                this->parse_arguments(1);
+                this->emit(OpAbs);
+            } else if (name == "sqrt") {
+                this->parse_arguments(1);
+                this->emit(OpSqrt);
+            } else if (name == "exp") {
+                this->parse_arguments(1);
+                this->emit(OpExp);
+            } else if (name == "log") {
+                this->parse_arguments(1);
+                this->emit(OpLog);
+            } else if (name == "log10") {
+                this->parse_arguments(1);
+                this->emit(OpLog10);
+            } else if (name == "pow") {
+                this->parse_arguments(2);
+                this->emit(OpPow);
+            } else if (name == "if") {
+                this->parse_arguments(3);
+                this->emit(OpSelect);
+            } else {
+                this->fail("unknown function '" + name + "'");
+            }
+        }
+
+#pragma mark -
+#pragma mark Evaluation
+
+        static inline T
+        apply(opcode_t op, T a, T b)
+        {
+            switch (op) {
+                case OpNeg: return -a;
+                case OpNot: return (a == 0) ? 1.0 : 0.0;
+                case OpAbs: return fabs(a);
+                case OpSqrt: return sqrt(a);
+                case OpExp: return exp(a);
+                case OpLog: return log(a);
+                case OpLog10: return log10(a);
+                case OpAdd: return a + b;
+                case OpSub: return a - b;
+                case OpMul: return a * b;
+                case OpDiv: return a / b;
+                case OpPow: return pow(a, b);
+                case OpMinimum: return (a < b) ? a : b;
+                case OpMaximum: return (a > b) ? a : b;
+                case OpLess: return (a < b) ? 1.0 : 0.0;
+                case OpLessEqual: return (a <= b) ? 1.0 : 0.0;
+                case OpGreater: return (a > b) ? 1.0 : 0.0;
+                case OpGreaterEqual: return (a >= b) ? 1.0 : 0.0;
+                case OpEqual: return (a == b) ? 1.0 : 0.0;
+                case OpNotEqual: return (a != b) ? 1.0 : 0.0;
+                case OpAnd: return (a != 0 && b != 0) ? 1.0 : 0.0;
+                case OpOr: return (a != 0 || b != 0) ? 1.0 : 0.0;
+                default: return 0.0;
+            }
+        }
+
+    public:
+
+#pragma mark -
+#pragma mark Constructor
+
+        /** Parses and compiles the given expression. 
+         * @param expression
+         * @param names of the variables, in order of the value 
+         *        components of the feature-space
+         * @throws std::invalid_argument if the expression can not 
+         *         be parsed or refers to unknown variables
+         */
+        WeightExpression(const string &expression, const vector<string> &variables)
+        : m_expression(expression)
+        , m_variables(variables)
+        , m_depth(0)
+        , m_max_depth(0)
+        , m_pos(0)
+        , m_token_type(TokenEnd)
+        , m_token_value(0.0)
+        {
+            this->next_token();
+            this->parse_or();
+            if (m_token_type != TokenEnd) {
+                this->fail("unexpected '" + m_token + "'");
+            }
+        }
+
+#pragma mark -
+#pragma mark Accessors
+
+        const string &expression() const
+        {
+            return m_expression;
+        }
+
+        /** @return the neighbourhood aggregates used by the expression.
+         * Their values have to be passed into evaluate() in this order.
+         */
+        const vector<aggregate_t> &aggregates() const
+        {
+            return m_aggregates;
+        }
+
+        /** @return number of instructions in the compiled program */
+        size_t program_size() const
+        {
+            return m_program.size();
+        }
+
+        /** @return number of values per point needed on the 
+         * evaluation stack. 
+         */
+        size_t stack_depth() const
+        {
+            return m_max_depth;
+        }
+
+#pragma mark -
+#pragma mark Evaluation
+
+        /** Evaluates the expression for a block of n points.
+         *
+         * @param number of points
+         * @param values, one column of n values per variable
+         * @param aggregates, one column of n values per aggregate
+         * @param lower limits of the variables
+         * @param upper limits of the variables
+         * @param stack (stack_depth() * n values)
+         * @param result (n values)
+         */
+        void
+        evaluate(size_t n,
+                const T *values,
+                const T *aggregates,
+                const T *min,
+                const T *max,
+                T *stack,
+                T *result) const
+        {
+            size_t sp = 0;
+
+            for (size_t pc = 0; pc < m_program.size(); pc++) {
+                const instruction_t &ins = m_program[pc];
+                const size_t arity = WeightExpression<T>::arity(ins.op);
+                T *a = stack + (sp - arity) * n;
+                const T *b = a + n;
+                const T *c = b + n;
+
+                switch (ins.op) {
+                    case OpConst:
+                    case OpMin:
+                    case OpMax:
+                    {
+                        T value = (ins.op == OpConst) ? ins.value : ((ins.op == OpMin) ? min[ins.arg] : max[ins.arg]);
+                        for (size_t k = 0; k < n; k++) a[k] = value;
+                        break;
+                    }
+                    case OpVariable:
+                        memcpy(a, values + ins.arg * n, n * sizeof(T));
+                        break;
+                    case OpAggregate:
+                        memcpy(a, aggregates + ins.arg * n, n * sizeof(T));
+                        break;
+                    case OpNeg:
+                        for (size_t k = 0; k < n; k++) a[k] = -a[k];
+                        break;
+                    case OpAdd:
+                        for (size_t k = 0; k < n; k++) a[k] += b[k];
+                        break;
+                    case OpSub:
+                        for (size_t k = 0; k < n; k++) a[k] -= b[k];
+                        break;
+                    case OpMul:
+                        for (size_t k = 0; k < n; k++) a[k] *= b[k];
+                        break;
+                    case OpDiv:
+                        for (size_t k = 0; k < n; k++) a[k] /= b[k];
+                        break;
+                    case OpMinimum:
+                        for (size_t k = 0; k < n; k++) a[k] = (a[k] < b[k]) ? a[k] : b[k];
+                        break;
+                    case OpMaximum:
+                        for (size_t k = 0; k < n; k++) a[k] = (a[k] > b[k]) ? a[k] : b[k];
+                        break;
+                    case OpLess:
+                        for (size_t k = 0; k < n; k++) a[k] = (a[k] < b[k]) ? 1.0 : 0.0;
+                        break;
+                    case OpGreater:
+                        for (size_t k = 0; k < n; k++) a[k] = (a[k] > b[k]) ? 1.0 : 0.0;
+                        break;
+                    case OpSelect:
+                        for (size_t k = 0; k < n; k++) a[k] = (a[k] != 0) ? b[k] : c[k];
+                        break;
+                    default:
+                        if (arity == 1) {
+                            for (size_t k = 0; k < n; k++) a[k] = apply(ins.op, a[k], 0.0);
+                        } else {
+                            for (size_t k = 0; k < n; k++) a[k] = apply(ins.op, a[k], b[k]);
+                        }
+                        break;
+                }
+
+                sp = sp + 1 - arity;
+            }
+
+            memcpy(result, stack, n * sizeof(T));
+        }
+    };
+}
+
+#endif
@@ -27,11 +27,16 @@ namespace m3D {
              * 
              * @param params
              * @param ctx
+             * @param weight function of the previous step in a series
+             *        (optional). If it can be re-calculated in place for 
+             *        the context's feature-space, it is returned. If not,
+             *        it is deleted and a new one is constructed.
              * @return 
              */
             static 
             WeightFunction<T> *create(const detection_params_t<T> &params, 
-                const detection_context_t<T>& ctx);
+                const detection_context_t<T>& ctx,
+                WeightFunction<T> *previous = NULL);
     };
     
 }
@@ -30,6 +30,7 @@
 #include "default_weights.h"
 #include "inverse_default.h"
 #include "exp10_weight.h"
+#include "expression_weights.h"
 
 #include "weight_function_factory.h"
 
@@ -40,8 +41,18 @@ namespace m3D {
     template <typename T>
     WeightFunction<T> *
     WeightFunctionFactory<T>::create(const detection_params_t<T> &params,
-            const detection_context_t<T>& ctx)
+            const detection_context_t<T>& ctx,
+            WeightFunction<T> *previous)
     {
+        if (previous != NULL) {
+            // Re-use the weight array of the previous step if possible
+            PrecomputedWeightFunction<T> *precomputed = dynamic_cast<PrecomputedWeightFunction<T> *> (previous);
+            if (precomputed != NULL && precomputed->recalculate(params, ctx)) {
+                return previous;
+            }
+            delete previous;
+        }
+
         if (params.verbosity > VerbositySilent) {
             cout << endl << "Constructing " << params.weight_function_name << " weight function ...";
             start_timer();
@@ -65,6 +76,10 @@ namespace m3D {
         {
             weight_function = new EXP10WeightFunction<T>(params, ctx);
         }
+        else if (params.weight_function_name == "expression") 
+        {
+            weight_function = new ExpressionWeightFunction<T>(params, ctx);
+        }
         else 
         {
             weight_function = new DefaultWeightFunction<T>(params,ctx);
@@ -119,6 +119,14 @@ void parse_commmandline(program_options::variables_map vm,
         tokenizer dim_tokens(str_value, sep);
         try {
             NcFile *file = new NcFile(filename, NcFile::read);
+            if (type == FileTypeClusters) {
+                // Cluster files might only refer to their source file
+                NcFile *data_file = ClusterList<FS_TYPE>::open_data_file(filename, file);
+                if (data_file != file) {
+                    delete file;
+                    file = data_file;
+                }
+            }
             vector<NcDim> dimensions = file->getVar(variable).getDims();
 
             mindTheTime = false;
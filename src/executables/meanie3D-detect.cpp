@@ -85,6 +85,72 @@ void print_compile_time_options() {
     cout << endl;
 }
 
+#pragma mark -
+#pragma mark Tracking
+
+/** Tracks the clusters of the given context against the previous
+ * clusters and writes the results.
+ * 
+ * @param detection params
+ * @param tracking params
+ * @param detection context after the run
+ * @param tracking
+ */
+void track_and_write(const detection_params_t<FS_TYPE> &detection_params,
+        const tracking_param_t &tracking_params,
+        detection_context_t<FS_TYPE> &detection_context,
+        Tracking<FS_TYPE> &tracking)
+{
+    Verbosity verbosity = detection_params.verbosity;
+    
+    if (verbosity >= VerbosityNormal) {
+        start_timer("Performing tracking step ...");
+    }
+
+    tracking.track(detection_context.previous_clusters, 
+            detection_context.clusters,
+            detection_context.coord_system);
+
+    if (verbosity > VerbosityNormal) {
+        stop_timer("done");
+        cout << "Results after tracking:" << endl;
+        detection_context.clusters->print();
+    }
+
+    #if WITH_VTK
+    if (tracking_params.write_vtk) {
+        
+        m3D::utils::VisitUtils<FS_TYPE>::write_clusters_vtu(
+                detection_context.clusters, 
+                detection_context.coord_system, 
+                detection_context.clusters->source_file);
+        
+        boost::filesystem::path path(detection_params.output_filename);
+        string modes_path = path.filename().stem().string() + "_modes.vtk";
+        ::m3D::utils::VisitUtils<FS_TYPE>::write_cluster_modes_vtk(
+                modes_path, 
+                detection_context.clusters->clusters, 
+                true);
+        
+        string centers_path = path.filename().stem().string() + "_centers.vtk";
+        ::m3D::utils::VisitUtils<FS_TYPE>::write_geometrical_cluster_centers_vtk(
+                centers_path, 
+                detection_context.clusters->clusters);
+    }
+    #endif
+
+    // Write results 
+    if (verbosity >= VerbosityNormal) {
+        start_timer("-- Writing " + detection_params.output_filename + " ... ");
+    }
+    utils::Profiler::instance().begin("write");
+    detection_context.clusters->write(detection_params.output_filename);
+    utils::Profiler::instance().end();
+    if (verbosity >= VerbosityNormal) {
+        stop_timer("done");
+    }
+}
+
 #pragma mark -
 #pragma mark Main
 
@@ -101,7 +167,8 @@ int main(int argc, char **argv) {
     program_options::options_description desc("Options");
     utils::add_standard_options(desc);
     
-    desc.add_options() ;
+    desc.add_options()
+        ("profile", program_options::value<string>(), "Write a JSON report of time and memory used by each processing stage to the given file.");
 
     add_detection_options<FS_TYPE>(desc,detection_params);
     add_tracking_options<FS_TYPE>(desc,tracking_params);
@@ -119,14 +186,25 @@ int main(int argc, char **argv) {
 
     // Get the command line content
     Verbosity verbosity;
+    string profile_filename;
     try {
         utils::get_standard_options(argc,vm,desc,verbosity);
+        if (vm.count("profile") > 0) {
+            profile_filename = vm["profile"].as<string>();
+            utils::Profiler::instance().set_enabled(true);
+        }
         get_detection_parameters(vm,detection_params);
         #if WITH_VTK
         utils::set_vtk_dimensions_from_args<FS_TYPE>(vm, detection_params.dimensions);
         #endif
         detection_params.verbosity = verbosity;
-        if (detection_params.inline_tracking) {
+        if (detection_params.series) {
+            // the first file is only tracked if a previous
+            // output was given
+            detection_params.inline_tracking = 
+                    (detection_params.previous_clusters_filename != NULL);
+        }
+        if (detection_params.inline_tracking || detection_params.series) {
             get_tracking_parameters<FS_TYPE>(vm,tracking_params,true);
             tracking_params.verbosity = verbosity;
         }
@@ -147,7 +225,7 @@ int main(int argc, char **argv) {
         cout << "----------------------------------------------------" << endl;
         cout << endl;
         print_detection_params(detection_params, detection_context, vm);
-        if (detection_params.inline_tracking) {
+        if (detection_params.inline_tracking || detection_params.series) {
             print_tracking_params(tracking_params,vm);
         }
         if (verbosity > VerbosityNormal) {
@@ -157,57 +235,39 @@ int main(int argc, char **argv) {
         }
     }
 
-    // Off we go
-    Detection<FS_TYPE>::run(detection_params, detection_context);
-
-    if (detection_params.inline_tracking) {
+    // Off we go. In a series, the context is advanced to the next
+    // file after each step and the results are tracked in-process.
+    Tracking<FS_TYPE> tracking(tracking_params);
+    size_t steps = detection_params.series ? detection_params.series_filenames.size() : 1;
+    for (size_t step = 0; step < steps; step++) {
         
-        if (verbosity >= VerbosityNormal) {
-            start_timer("Performing tracking step ...");
-        }
-
-        Tracking<FS_TYPE> tracking(tracking_params);
-        tracking.track(detection_context.previous_clusters, 
-                detection_context.clusters);
-
-        if (verbosity > VerbosityNormal) {
-            stop_timer("done");
-            cout << "Results after tracking:" << endl;
-            detection_context.clusters->print();
-        }
-
-        #if WITH_VTK
-        if (tracking_params.write_vtk) {
-            
-            m3D::utils::VisitUtils<FS_TYPE>::write_clusters_vtu(
-                    detection_context.clusters, 
-                    detection_context.coord_system, 
-                    detection_context.clusters->source_file);
+        if (step > 0) {
+            detection_params.filename = detection_params.series_filenames[step];
+            detection_params.output_filename = series_output_filename(
+                    detection_params.series_output_directory,
+                    detection_params.filename);
+            detection_params.inline_tracking = true;
             
-            boost::filesystem::path path(detection_params.output_filename);
-            string modes_path = path.filename().stem().string() + "_modes.vtk";
-            ::m3D::utils::VisitUtils<FS_TYPE>::write_cluster_modes_vtk(
-                    modes_path, 
-                    detection_context.clusters->clusters, 
-                    true);
+            if (verbosity > VerbositySilent) {
+                cout << endl << "Processing " << detection_params.filename 
+                     << " (" << (step+1) << "/" << steps << ")" << endl;
+            }
             
-            string centers_path = path.filename().stem().string() + "_centers.vtk";
-            ::m3D::utils::VisitUtils<FS_TYPE>::write_geometrical_cluster_centers_vtk(
-                    centers_path, 
-                    detection_context.clusters->clusters);
+            Detection<FS_TYPE>::advance(detection_params, detection_context);
         }
-        #endif
+        
+        Detection<FS_TYPE>::run(detection_params, detection_context);
 
-        // Write results 
-        if (verbosity >= VerbosityNormal) {
-            start_timer("-- Writing " + detection_params.output_filename + " ... ");
-        }
-        detection_context.clusters->write(detection_params.output_filename);
-        if (verbosity >= VerbosityNormal) {
-            stop_timer("done");
+        if (detection_params.inline_tracking) {
+            track_and_write(detection_params, tracking_params, 
+                    detection_context, tracking);
         }
     }
         
     Detection<FS_TYPE>::cleanup(detection_params, detection_context);
+
+    if (!profile_filename.empty()) {
+        utils::Profiler::instance().write_json(profile_filename);
+    }
     return EXIT_SUCCESS;
 }
\ No newline at end of file
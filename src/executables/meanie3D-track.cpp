@@ -45,6 +45,8 @@ int main(int argc, char** argv) {
 
     program_options::options_description desc("Options");
     utils::add_standard_options(desc);
+    desc.add_options()
+        ("profile", program_options::value<string>(), "Write a JSON report of time and memory used by each processing stage to the given file.");
     add_tracking_options<FS_TYPE>(desc,params);
     
     program_options::variables_map vm;
@@ -58,10 +60,15 @@ int main(int argc, char** argv) {
 
     // Get the command line content
     Verbosity verbosity;
+    string profile_filename;
     try {
         utils::get_standard_options(argc,vm,desc,verbosity);
         params.verbosity = verbosity;
         get_tracking_parameters<FS_TYPE>(vm,params);
+        if (vm.count("profile") > 0) {
+            profile_filename = vm["profile"].as<string>();
+            Profiler::instance().set_enabled(true);
+        }
     } catch (const std::exception &e) {
         cerr << e.what() << endl;
         exit(EXIT_FAILURE);
@@ -77,7 +84,9 @@ int main(int argc, char** argv) {
 
     // Read previous clusters
     if (params.verbosity >= VerbosityNormal) start_timer("Reading " + params.previous_filename+ " ... ");
+    Profiler::instance().begin("read");
     ClusterList<FS_TYPE>::ptr previous = ClusterList<FS_TYPE>::read(params.previous_filename);
+    Profiler::instance().end();
     if (params.verbosity >= VerbosityNormal) stop_timer("done");
 
     #if WITH_VTK
@@ -87,7 +96,9 @@ int main(int argc, char** argv) {
     // Read current clusters
     CoordinateSystem<FS_TYPE> *cs;
     if (params.verbosity >= VerbosityNormal) start_timer("Reading " + params.current_filename + " ... ");
+    Profiler::instance().begin("read");
     ClusterList<FS_TYPE>::ptr current = ClusterList<FS_TYPE>::read(params.current_filename, &cs);
+    Profiler::instance().end();
     if (params.verbosity >= VerbosityNormal) stop_timer("done");
 
     // Perform tracking
@@ -114,12 +125,18 @@ int main(int argc, char** argv) {
 
     // Write results back
     if (params.verbosity >= VerbosityNormal) start_timer("-- Writing " + params.current_filename + " ... ");
+    Profiler::instance().begin("write");
     current->save();
+    Profiler::instance().end();
     if (params.verbosity >= VerbosityNormal) stop_timer("done");
 
     // Clean up
     delete previous;
     delete current;
+
+    if (!profile_filename.empty()) {
+        Profiler::instance().write_json(profile_filename);
+    }
     
     return EXIT_SUCCESS;
 }
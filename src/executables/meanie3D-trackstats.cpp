@@ -13,6 +13,8 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/exception/info.hpp>
 #include <boost/smart_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include <algorithm>
@@ -79,6 +81,14 @@ typedef struct
     link_type_t type; // split, merge, continue?
 } link_t;
 
+// Index of the first node with a given (id, step)
+typedef std::pair<m3D::id_t, unsigned int> node_key_t;
+typedef boost::unordered_map<node_key_t, size_t> node_index_t;
+
+// Index of existing links by ((source, target), type)
+typedef std::pair<std::pair<m3D::uuid_t, m3D::uuid_t>, int> link_key_t;
+typedef boost::unordered_set<link_key_t> link_index_t;
+
 // Store the cluster min/max and median values so that the
 // points can be disposed of early on.
 typedef map< m3D::id_t, vector<FS_TYPE> > val_map_t;
@@ -106,6 +116,7 @@ typedef struct
     bool write_cumulated_tracks_as_vtk;
     bool write_gnuplot_files;
     bool write_track_dictionary;
+    std::string spill_directory;
 } parameter_t;
 
 /**
@@ -118,6 +129,7 @@ typedef struct
 
     // Control flags and other properties
     bool need_points;
+    PointSpillFile<FS_TYPE> *spill_file; // holds cluster points while not needed
 
     // NetCDF properties
     size_t spatial_rank;
@@ -135,6 +147,8 @@ typedef struct
 
     vector<node_t> nodes;
     vector<link_t> links;
+    node_index_t node_index; // (id, step) -> index in nodes
+    link_index_t link_index; // links already present
     unsigned int step;
     unsigned long timestamp; // seconds since epoch
     
@@ -190,6 +204,8 @@ trackstats_context_t initialiseContext(parameter_t params) {
     ctx.coords_file = NULL;
     ctx.need_points = params.create_cumulated_size_stats
             || params.write_cumulated_tracks_as_vtk;
+    ctx.spill_file = ctx.need_points
+            ? new PointSpillFile<FS_TYPE>(params.spill_directory) : NULL;
     ctx.step = 0;
     ctx.timestamp = 0;
     ctx.average_cluster_size = 0;
@@ -225,6 +241,7 @@ void parse_commmandline(program_options::variables_map vm, parameter_t &p) {
     p.create_cluster_stats = vm.count("create-cluster-statistics") > 0;
     p.cluster_histogram_bins = vm["cluster-histogram-classes"].as<bin_t>();
     p.create_cumulated_tracking_stats = vm.count("create-cumulated-tracking-stats") > 0;
+    p.spill_directory = vm["spill-directory"].as<string>();
 }
 
 #pragma mark -
@@ -371,25 +388,23 @@ bool compareNodesByStep(const node_t &a, const node_t &b) {
 /**
  * Finds the node with the given id in the node list.
  * 
- * @param nodes
+ * @param ctx
  * @param id
  * @param step
  * @param contains the node after the call
  * @return <code>true</code> if node exists. 
  */
 bool
-findNode(const vector<node_t> &nodes, const m3D::id_t &id, const unsigned int &step, node_t &node) {
-    bool found = false;
-    for (size_t i = 0; i < nodes.size() && !found; i++) {
-        node_t n = nodes[i];
-        if (n.id == id && n.step == step) {
-            node.id = n.id;
-            node.step = n.step;
-            node.uuid = n.uuid;
-            found = true;
-        }
+findNode(const trackstats_context_t &ctx, const m3D::id_t &id, const unsigned int &step, node_t &node) {
+    node_index_t::const_iterator fi = ctx.node_index.find(node_key_t(id, step));
+    if (fi == ctx.node_index.end()) {
+        return false;
     }
-    return found;
+    const node_t &n = ctx.nodes[fi->second];
+    node.id = n.id;
+    node.step = n.step;
+    node.uuid = n.uuid;
+    return true;
 }
 
 void printNodes(const vector<node_t> &nodes) {
@@ -413,14 +428,8 @@ void
 addUniqueLink(trackstats_context_t &ctx, node_t source, node_t target, link_type_t type) {
     // Figure out if there is a link for this already. This can
     // happen as the result of a split or link with continued id
-    bool haveLink = false;
-    for (int li = 0; li < ctx.links.size() && !haveLink; li++) {
-        link_t link = ctx.links[li];
-        haveLink = (link.source == source.uuid
-                && link.target == target.uuid
-                && link.type == type);
-    }
-    if (!haveLink) {
+    link_key_t key(std::make_pair(source.uuid, target.uuid), (int) type);
+    if (ctx.link_index.insert(key).second) {
         link_t link;
         link.source = source.uuid;
         link.target = target.uuid;
@@ -442,7 +451,9 @@ addUniqueLink(trackstats_context_t &ctx, node_t source, node_t target, link_type
 void
 addGraphNode(trackstats_context_t &ctx, const node_t &node) {
 
-    // Construct a new node for the tree data
+    // Construct a new node for the tree data. Only the first
+    // node for an (id, step) is indexed.
+    ctx.node_index.insert(std::make_pair(node_key_t(node.id, node.step), ctx.nodes.size()));
     ctx.nodes.push_back(node);
 
     // check for split event
@@ -450,14 +461,9 @@ addGraphNode(trackstats_context_t &ctx, const node_t &node) {
     for (mi = ctx.cluster_list->splits.begin(); mi != ctx.cluster_list->splits.end(); ++mi) {
         m3D::id_t sourceId = mi->first;
         node_t source;
-        if (findNode(ctx.nodes, sourceId, node.step - 1, source)) {
-            id_set_t::const_iterator si;
-            for (si = mi->second.begin(); si != mi->second.end(); si++) {
-                m3D::id_t targetId = *si;
-                if (targetId == node.id) {
-                    addUniqueLink(ctx, source, node, Split);
-                }
-            }
+        if (mi->second.find(node.id) != mi->second.end()
+                && findNode(ctx, sourceId, node.step - 1, source)) {
+            addUniqueLink(ctx, source, node, Split);
         }
     }
 
@@ -471,7 +477,7 @@ addGraphNode(trackstats_context_t &ctx, const node_t &node) {
             for (si = mi->second.begin(); si != mi->second.end(); si++) {
                 node_t source;
                 m3D::id_t sourceId = (*si);
-                if (findNode(ctx.nodes, sourceId, node.step - 1, source)) {
+                if (findNode(ctx, sourceId, node.step - 1, source)) {
                     addUniqueLink(ctx, source, node, Merge);
                 }
             }
@@ -479,11 +485,10 @@ addGraphNode(trackstats_context_t &ctx, const node_t &node) {
     }
 
     // check for continuation event
-    id_set_t::const_iterator ti = find(ctx.cluster_list->tracked_ids.begin(),
-            ctx.cluster_list->tracked_ids.end(), node.id);
+    id_set_t::const_iterator ti = ctx.cluster_list->tracked_ids.find(node.id);
     if (ti != ctx.cluster_list->tracked_ids.end()) {
         node_t source;
-        if (findNode(ctx.nodes, node.id, node.step - 1, source)) {
+        if (findNode(ctx, node.id, node.step - 1, source)) {
             addUniqueLink(ctx, source, node, Continue);
         }
     }
@@ -502,14 +507,20 @@ addGraphNode(trackstats_context_t &ctx, const node_t &node) {
 void getFeaturespaceInfo(trackstats_context_t &ctx, const std::string &filename) {
     if (ctx.coord_system == NULL) {
 
-        ctx.coords_file = new NcFile(filename, NcFile::read);
+        NcFile *cluster_file = new NcFile(filename, NcFile::read);
         
         string buffer;
-        ctx.coords_file->getAtt("dimensions").getValues(buffer);
+        cluster_file->getAtt("dimensions").getValues(buffer);
         ctx.dim_names = from_string<std::string>(buffer);
         
-        ctx.coords_file->getAtt("dimension_variables").getValues(buffer);
+        cluster_file->getAtt("dimension_variables").getValues(buffer);
         vector<string> dimension_variables = from_string<std::string>(buffer);
+
+        // Dimension variables might live in the referenced source file
+        ctx.coords_file = ClusterList<FS_TYPE>::open_data_file(filename, cluster_file);
+        if (ctx.coords_file != cluster_file) {
+            delete cluster_file;
+        }
         
         // Construct coordinate system
         ctx.coord_system = new CoordinateSystem<FS_TYPE>(ctx.coords_file, ctx.dim_names, dimension_variables);
@@ -523,153 +534,310 @@ void getFeaturespaceInfo(trackstats_context_t &ctx, const std::string &filename)
     }
 }
 
-template <typename T>
-void readTrackingData(trackstats_context_t &ctx) {
-    // run the directory's files
+/**
+ * A cluster file read ahead of the graph building, reduced to its
+ * meta-data, the track clusters and the values derived from the
+ * clusters' points.
+ */
+typedef struct
+{
+    std::string path;
+    ClusterList<FS_TYPE>::ptr cluster_list;     // meta-data only
+    vector<TrackCluster<FS_TYPE>::ptr> track_clusters; // per cluster index
+    vector< vector<FS_TYPE> > cluster_min;      // per cluster index
+    vector< vector<FS_TYPE> > cluster_max;      // per cluster index
+    vector< vector<FS_TYPE> > cluster_median;   // per cluster index
+    std::string error;
+} ingested_file_t;
+
+/**
+ * Collects the cluster files in the source directory, sorted
+ * by timestamp.
+ *
+ * @param ctx
+ * @param files (filled)
+ */
+void getClusterFiles(const trackstats_context_t &ctx, vector<std::string> &files) {
+    vector< pair<timestamp_t, std::string> > timed;
     fs::directory_iterator dir_iter(ctx.params.sourcepath);
     fs::directory_iterator end;
-
-    while (dir_iter != end) {
-        //            double time_reading = 0;
-        //            double time_searching = 0;
-        //            double time_inserting = 0;
-        //            double time_pushing_clusters = 0;
-        //            double time_constructing_clusters = 0;
-        //            double time_deleting = 0;
-        //            double time_constructing = 0;
-
+    for (; dir_iter != end; ++dir_iter) {
         fs::path f = dir_iter->path();
         if (fs::is_regular_file(f) && boost::algorithm::ends_with(f.filename().generic_string(), ".nc")) {
-
             std::string path = f.generic_string();
-            std::string filename = f.filename().generic_string();
+            try {
+                timestamp_t t = netcdf::get_time_checked<timestamp_t>(path, 0);
+                timed.push_back(make_pair(t, path));
+            } catch (std::exception &e) {
+                cerr << "ERROR:could not read time from " << path << ":" << e.what() << endl;
+            }
+        }
+    }
+    std::sort(timed.begin(), timed.end());
+
+    files.clear();
+    for (size_t i = 0; i < timed.size(); i++) {
+        files.push_back(timed[i].second);
+    }
+}
+
+/**
+ * Reads a cluster file without its points and reduces it to track
+ * clusters. The points are brought in one cluster at a time for
+ * the calculations based on them (geometrical center, variable
+ * ranges) and are moved to the spill file right away. Called from
+ * several threads at once. The NetCDF library is not thread safe,
+ * so all access to it is serialised, as is the access to the
+ * spill file.
+ *
+ * @param path
+ * @param spill file (or NULL if the points are not needed later)
+ * @return ingested file
+ */
+ingested_file_t *ingestFile(const std::string &path, PointSpillFile<FS_TYPE> *spill_file) {
+    ingested_file_t *file = new ingested_file_t();
+    file->path = path;
+    file->cluster_list = NULL;
+
+    ClusterList<FS_TYPE>::ptr list = NULL;
+
+#if WITH_OPENMP
+#pragma omp critical (netcdf)
+#endif
+    {
+        try {
+            list = ClusterList<FS_TYPE>::read(path, NULL, false);
+        } catch (netCDF::exceptions::NcException &e) {
+            file->error = e.what();
+        } catch (std::exception &e) {
+            file->error = e.what();
+        }
+    }
+
+    file->cluster_list = list;
+    if (list == NULL) {
+        return file;
+    }
 
-            // Set up coordinate system, variable- and dimension names
-            getFeaturespaceInfo(ctx, path);
+    int timeDifference = list->tracking_time_difference;
+    size_t n = list->clusters.size();
+    file->cluster_min.resize(n);
+    file->cluster_max.resize(n);
+    file->cluster_median.resize(n);
+    for (size_t ci = 0; ci < n && file->error.empty(); ci++) {
+        Cluster<FS_TYPE>::ptr cluster = list->clusters[ci];
 
+#if WITH_OPENMP
+#pragma omp critical (netcdf)
+#endif
+        {
             try {
-                // start_timer();
-                ctx.cluster_list = ClusterList<FS_TYPE>::read(path);
+                cluster->get_points();
+            } catch (std::exception &e) {
+                file->error = e.what();
+            }
+        }
+        if (!file->error.empty()) {
+            break;
+        }
 
-                int timeDifference = ctx.cluster_list->tracking_time_difference;
-                ctx.timestamp = (unsigned long) ctx.cluster_list->get_time_in_seconds().get();
-                // time_reading += stop_timer();
+        cluster->geometrical_center();
+        cluster->variable_ranges(file->cluster_min[ci],
+                file->cluster_max[ci],
+                file->cluster_median[ci]);
+
+        // Instead of the original cluster, use a TrackCluster, which
+        // moves its point list to the spill file and reads it
+        // back on demand, saving memory.
+        TrackCluster<FS_TYPE>::ptr tc = NULL;
+#if WITH_OPENMP
+#pragma omp critical (spill)
+#endif
+        tc = new TrackCluster<FS_TYPE>(cluster, timeDifference, spill_file);
+        file->track_clusters.push_back(tc);
 
-                cout << "Processing " << filename << " (" << ctx.cluster_list->size() << " clusters) ... ";
+        cluster->clear(true);
+    }
 
-                if (ctx.spatial_rank == 0) {
-                    ctx.spatial_rank = ctx.cluster_list->dimensions.size();
-                } else if (ctx.spatial_rank != ctx.cluster_list->dimensions.size()) {
-                    cerr << "FATAL:spatial range must remain identical across the track" << endl;
-                    exit(EXIT_FAILURE);
-                }
+    // Only the list's meta-data is used from here on
+#if WITH_OPENMP
+#pragma omp critical (netcdf)
+#endif
+    {
+        list->clear(true);
+        delete list->file;
+        list->file = NULL;
+    }
 
-                size_t v_rank = ctx.cluster_list->variables.size();
-                if (ctx.value_rank == 0) {
-                    ctx.value_rank = v_rank;
-                } else if (v_rank != ctx.value_rank) {
-                    cerr << "FATAL:value range must remain identical across the track" << endl;
-                    exit(EXIT_FAILURE);
-                }
+    return file;
+}
 
-                // Iterate over the clusters in the list we just read
-                Cluster<FS_TYPE>::list::const_iterator ci;
-                for (ci = ctx.cluster_list->clusters.begin(); ci != ctx.cluster_list->clusters.end(); ++ci) {
-                    Cluster<FS_TYPE>::ptr cluster = (*ci);
-                    m3D::id_t id = id = cluster->id;
-                    Track<FS_TYPE>::ptr tm = NULL;
-                    Track<FS_TYPE>::trackmap::const_iterator ti;
-
-                    // start_timer();
-                    ti = ctx.track_map.find(id);
-                    // time_searching += stop_timer();
-
-                    if (ti == ctx.track_map.end()) {
-                        // new entry
-                        tm = new Track<FS_TYPE>();
-                        tm->id = id;
-                        // start_timer();
-                        ctx.track_map[id] = tm;
-                        // time_inserting += stop_timer();
-                    } else {
-                        tm = ti->second;
-                    }
-
-                    boost::filesystem::path sf(ctx.cluster_list->source_file);
-                    tm->sourcefiles.push_back(sf.filename().generic_string());
-
-                    // Instead of the original cluster, use a TrackCluster, which
-                    // has facilities of writing it's point list to disk and read
-                    // it back on demand, saving memory.
-
-                    // start_timer();
-                    TrackCluster<FS_TYPE>::ptr tc = new TrackCluster<FS_TYPE>(cluster, timeDifference, ctx.need_points);
-                    tc->step = ctx.step;
-                    tc->timestamp = ctx.timestamp;
-                    
-                    // time_constructing_clusters += stop_timer();
-
-                    node_t node;
-                    node.uuid = cluster->uuid;
-                    node.id = cluster->id;
-                    node.step = ctx.step;
-                    node.size = cluster->size();
-                    node.timestamp = ctx.timestamp;
-
-                    addGraphNode(ctx, node);
-
-                    // Keep track to calculate average cluster size
-                    ctx.average_cluster_size += cluster->size();
-                    ctx.number_of_clusters++;
-
-                    // start_timer();
-                    tm->clusters.push_back(tc);
-                    // time_pushing_clusters += stop_timer();
-
-                    // Pre-empt calculations based on points
-                    // and dispose of the data if possible
-
-                    tc->geometrical_center();
-                    vector<FS_TYPE> min, max, median;
-                    cluster->variable_ranges(min, max, median);
-                    ctx.cluster_min[cluster->id] = min;
-                    ctx.cluster_max[cluster->id] = max;
-                    ctx.cluster_median[cluster->id] = median;
-                    // start_timer();
-                    cluster->clear(true);
-                    // time_deleting += stop_timer();
-                }
+/**
+ * Disposes of an ingested file's cluster list, which holds NetCDF
+ * resources (coordinate system, referenced source file).
+ *
+ * @param file
+ */
+void disposeIngestedFile(ingested_file_t *file) {
+#if WITH_OPENMP
+#pragma omp critical (netcdf)
+#endif
+    delete file->cluster_list;
+    delete file;
+}
+
+/**
+ * Adds the clusters of an ingested file to the tracks and the track
+ * graph. Files must be handed in in the order of their timestamps.
+ *
+ * @param ctx
+ * @param file
+ */
+void addIngestedFile(trackstats_context_t &ctx, ingested_file_t &file) {
+    std::string filename = fs::path(file.path).filename().generic_string();
 
-                // start_timer();
-                delete ctx.cluster_list;
-                ctx.cluster_list = NULL;
-                // time_deleting += stop_timer();
+    if (file.cluster_list == NULL || !file.error.empty()) {
+        cerr << "ERROR:" << filename << ":" << file.error << endl;
+        for (size_t ci = 0; ci < file.track_clusters.size(); ci++) {
+            delete file.track_clusters[ci];
+        }
+        return;
+    }
 
-                // cout << "tracking map has " << track_map.size() << " tracks" << endl;
-                cout << "done." << endl;
+    try {
+        // Set up coordinate system, variable- and dimension names
+#if WITH_OPENMP
+#pragma omp critical (netcdf)
+#endif
+        getFeaturespaceInfo(ctx, file.path);
 
-            } catch (netCDF::exceptions::NcException &e) {
-                cerr << "ERROR:" << e.what() << endl;
-            } catch (std::exception &e) {
-                cerr << "ERROR:" << e.what() << endl;
+        ctx.cluster_list = file.cluster_list;
+
+        ctx.timestamp = (unsigned long) ctx.cluster_list->get_time_in_seconds().get();
+
+        cout << "Processing " << filename << " (" << file.track_clusters.size() << " clusters) ... ";
+
+        if (ctx.spatial_rank == 0) {
+            ctx.spatial_rank = ctx.cluster_list->dimensions.size();
+        } else if (ctx.spatial_rank != ctx.cluster_list->dimensions.size()) {
+            cerr << "FATAL:spatial range must remain identical across the track" << endl;
+            exit(EXIT_FAILURE);
+        }
+
+        size_t v_rank = ctx.cluster_list->variables.size();
+        if (ctx.value_rank == 0) {
+            ctx.value_rank = v_rank;
+        } else if (v_rank != ctx.value_rank) {
+            cerr << "FATAL:value range must remain identical across the track" << endl;
+            exit(EXIT_FAILURE);
+        }
+
+        // Iterate over the clusters of the file we just read
+        for (size_t ci = 0; ci < file.track_clusters.size(); ci++) {
+            TrackCluster<FS_TYPE>::ptr tc = file.track_clusters[ci];
+            m3D::id_t id = tc->id;
+            Track<FS_TYPE>::ptr tm = NULL;
+            Track<FS_TYPE>::trackmap::const_iterator ti;
+
+            ti = ctx.track_map.find(id);
+
+            if (ti == ctx.track_map.end()) {
+                // new entry
+                tm = new Track<FS_TYPE>();
+                tm->id = id;
+                ctx.track_map[id] = tm;
+            } else {
+                tm = ti->second;
             }
+
+            boost::filesystem::path sf(ctx.cluster_list->source_file);
+            tm->sourcefiles.push_back(sf.filename().generic_string());
+
+            tc->step = ctx.step;
+            tc->timestamp = ctx.timestamp;
+
+            node_t node;
+            node.uuid = tc->uuid;
+            node.id = tc->id;
+            node.step = ctx.step;
+            node.size = tc->size();
+            node.timestamp = ctx.timestamp;
+
+            addGraphNode(ctx, node);
+
+            // Keep track to calculate average cluster size
+            ctx.average_cluster_size += tc->size();
+            ctx.number_of_clusters++;
+
+            tm->clusters.push_back(tc);
+
+            // Calculations based on points were done when ingesting
+            ctx.cluster_min[tc->id] = file.cluster_min[ci];
+            ctx.cluster_max[tc->id] = file.cluster_max[ci];
+            ctx.cluster_median[tc->id] = file.cluster_median[ci];
         }
 
-        // cout << "Clusters processed:" << endl;
-        // cout << "\t number:" << number_of_clusters << endl;
-        // cout << "\t average size:" << ((double)average_cluster_size) / ((double)number_of_clusters) << endl;
-        // cout << endl;
-        //
-        // cout << "Time spend:" << endl;
-        // cout << "\t reading:" << time_reading << endl;
-        // cout << "\t searching:" << time_searching << endl;
-        // cout << "\t inserting:" << time_inserting << endl;
-        // cout << "\t constructing clusters:" << time_constructing_clusters << endl;
-        // cout << "\t pushing clusters:" << time_pushing_clusters << endl;
-        // cout << "\t deleting:" << time_deleting << endl;
-
-        dir_iter++;
-        ctx.step++;
+        cout << "done." << endl;
+
+    } catch (netCDF::exceptions::NcException &e) {
+        cerr << "ERROR:" << e.what() << endl;
+    } catch (std::exception &e) {
+        cerr << "ERROR:" << e.what() << endl;
+    }
+
+    ctx.cluster_list = NULL;
+}
+
+template <typename T>
+void readTrackingData(trackstats_context_t &ctx) {
+    vector<std::string> files;
+    getClusterFiles(ctx, files);
+
+    // Files are read and reduced by all threads and handed to the
+    // graph building on the master thread in timestamp order through
+    // a bounded queue. An ingested file only holds its meta-data and
+    // derived values, the points went to the spill file one cluster
+    // at a time. At most 'capacity' files are ingested ahead.
+    size_t capacity = 2;
+#if WITH_OPENMP
+    capacity = 2 * (size_t) omp_get_max_threads();
+#endif
+    utils::OrderedQueue<ingested_file_t *> queue(files.size(), capacity);
+
+#if WITH_OPENMP
+#pragma omp parallel
+#endif
+    {
+        bool is_master = true;
+#if WITH_OPENMP
+        is_master = (omp_get_thread_num() == 0);
+#endif
+        size_t job = 0;
+        ingested_file_t *file = NULL;
+
+        if (is_master) {
+            // Build the graph in order. While the next file isn't
+            // ready, help reading.
+            for (;;) {
+                if (queue.try_take(file)) {
+                    addIngestedFile(ctx, *file);
+                    disposeIngestedFile(file);
+                    ctx.step++;
+                } else if (queue.try_claim(job)) {
+                    queue.put(job, ingestFile(files[job], ctx.spill_file));
+                } else if (queue.take(file)) {
+                    addIngestedFile(ctx, *file);
+                    disposeIngestedFile(file);
+                    ctx.step++;
+                } else {
+                    break;
+                }
+            }
+        } else {
+            while (queue.claim(job)) {
+                queue.put(job, ingestFile(files[job], ctx.spill_file));
+            }
+        }
     }
 
     // Clear out all point data
@@ -1457,6 +1625,7 @@ int main(int argc, char** argv) {
             ("write-cumulated-tracks-as-vtk,m", "Write cumulated tracks out as .vtk files. Only has effect if --create-cumulated-size-statistics is used")
             ("vtk-dimensions", program_options::value<string>(), "VTK files are written in the order of dimensions given. This may lead to wrong results if the order of the dimensions is not x,y,z. Add the comma-separated list of dimensions here, in the order you would like them to be written as (x,y,z)")
 #endif    
+            ("spill-directory", program_options::value<string>()->default_value("/tmp"), "Directory for the temporary file holding cluster points while they are not needed")
             ("write-gnuplot-files,g", "write individual files for the statistics fit for use with gnuplot")
             ;
 
@@ -1524,6 +1693,7 @@ int main(int argc, char** argv) {
 
     // Clean up
     delete ctx.coords_file;
+    delete ctx.spill_file;
 
     // Done.
     return EXIT_SUCCESS;
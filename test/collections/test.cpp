@@ -17,6 +17,20 @@
 #include "tests_set.h"
 #include "tests_arrayindex.h"
 #include "tests_multiarray.h"
+#include "tests_oase_weights.h"
+#include "tests_ordered_queue.h"
+#include "tests_cell_hash.h"
+#include "tests_cluster_overlap.h"
+#include "tests_dense_grid.h"
+#include "tests_expression_weights.h"
+#include "tests_point_spill_file.h"
+#include "tests_pointstore.h"
+#include "tests_precomputed_weights.h"
+#include "tests_profiler.h"
+#include "tests_separable_convolution.h"
+#include "tests_sparse_matrix.h"
+#include "tests_union_find.h"
+#include "tests_weight_expression.h"
 
 int main(int argc, char **argv)
 {
@@ -123,6 +123,19 @@ TYPED_TEST(ArrayIndexTest2D, VectorDataTypes)
         EXPECT_EQ(a->values, b->values);
     }
 
+    // Ids are the positions in the indexed list, grid points
+    // outside of the grid have no point
+
+    for (size_t pi = 0; pi < points.size(); pi++) {
+        EXPECT_EQ((int) pi, index.id(points[pi]->gridpoint));
+    }
+
+    g[0] = -1;
+    g[1] = 3;
+    EXPECT_EQ(ArrayIndex<TypeParam>::NO_POINT, index.id(g));
+    g[0] = 3;
+    g[1] = 10;
+    EXPECT_EQ(ArrayIndex<TypeParam>::NO_POINT, index.id(g));
 
     // clean up
 
@@ -202,5 +215,94 @@ TYPED_TEST(ArrayIndexTest3D, VectorDataTypes)
 
 }
 
-#endif
+// NEIGHBOURHOOD
+
+template <typename T>
+class ArrayIndexNeighboursTest : public testing::Test
+{
+};
+
+TYPED_TEST_CASE(ArrayIndexNeighboursTest, VectorDataTypes);
+
+TYPED_TEST(ArrayIndexNeighboursTest, VectorDataTypes)
+{
+    PointFactory<TypeParam>::set_instance(new PointDefaultFactory<TypeParam>());
+
+    typename Point<TypeParam>::list points;
+
+    vector<size_t> dimensions(3);
+    dimensions[0] = 5;
+    dimensions[1] = 6;
+    dimensions[2] = 7;
+
+    // fill every other grid point along the last dimension
+
+    vector<int> g(dimensions.size(), 0);
+    vector<TypeParam> c(dimensions.size(), 0);
+
+    for (int iz = 0; iz < dimensions[0]; iz++) {
+        g[0] = iz;
+        for (int iy = 0; iy < dimensions[1]; iy++) {
+            g[1] = iy;
+            for (int ix = 0; ix < dimensions[2]; ix += 2) {
+                g[2] = ix;
+                typename Point<TypeParam>::ptr p = PointFactory<TypeParam>::get_instance()->create(g, c, c);
+                points.push_back(p);
+            }
+        }
+    }
+
+    ArrayIndex<TypeParam> index(dimensions, points, false);
+
+    EXPECT_EQ(points.size(), index.count());
+    EXPECT_EQ(27, index.neighbourhood_size(1));
+    EXPECT_EQ(125, index.neighbourhood_size(2));
+
+    // compare against a brute force search for every
+    // grid point in the index and a couple of reaches
+
+    typename Point<TypeParam>::list neighbours;
+    vector<typename ArrayIndex<TypeParam>::id_t> ids(index.neighbourhood_size(2));
+
+    for (size_t reach = 1; reach <= 2; reach++) {
+        for (int iz = 0; iz < dimensions[0]; iz++) {
+            for (int iy = 0; iy < dimensions[1]; iy++) {
+                for (int ix = 0; ix < dimensions[2]; ix++) {
+                    g[0] = iz;
+                    g[1] = iy;
+                    g[2] = ix;
+
+                    typename Point<TypeParam>::list expected;
+                    for (size_t pi = 0; pi < points.size(); pi++) {
+                        const vector<int> &pg = points[pi]->gridpoint;
+                        if (abs(pg[0] - iz) <= (int) reach
+                                && abs(pg[1] - iy) <= (int) reach
+                                && abs(pg[2] - ix) <= (int) reach) {
+                            expected.push_back(points[pi]);
+                        }
+                    }
+
+                    index.find_neighbours(g, neighbours, reach);
+                    EXPECT_EQ(expected, neighbours);
+                    EXPECT_EQ(expected, index.find_neighbours(g, reach));
+
+                    size_t n = index.find_neighbour_ids(g, &ids[0], reach);
+                    ASSERT_EQ(expected.size(), n);
+                    for (size_t ni = 0; ni < n; ni++) {
+                        EXPECT_EQ(expected[ni], index.point(ids[ni]));
+                    }
+                }
+            }
+        }
+    }
+
+    // clean up
+
+    while (!points.empty()) {
+        typename Point<TypeParam>::ptr a = points.back();
+        points.pop_back();
+        delete a;
+    }
+}
 
+#endif
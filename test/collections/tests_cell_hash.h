@@ -0,0 +1,124 @@
+#ifndef M3D_CELL_HASH_TEST_H
+#define M3D_CELL_HASH_TEST_H
+
+#include <meanie3D/utils/cell_hash.h>
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace m3D;
+using namespace m3D::utils;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Cell Hash
+
+typedef std::set< std::pair<size_t, size_t> > cell_hash_pairs_t;
+
+static std::vector< std::vector<double> >
+cell_hash_random_positions(size_t count, size_t rank, double extent)
+{
+    std::vector< std::vector<double> > positions(count, std::vector<double>(rank));
+    for (size_t i = 0; i < count; i++) {
+        for (size_t d = 0; d < rank; d++) {
+            positions[i][d] = extent * ((double) rand() / RAND_MAX) - 0.5 * extent;
+        }
+    }
+    return positions;
+}
+
+static bool
+cell_hash_within(const std::vector<double> &a, const std::vector<double> &b, double radius)
+{
+    double sum = 0.0;
+    for (size_t d = 0; d < a.size(); d++) {
+        sum += (a[d] - b[d]) * (a[d] - b[d]);
+    }
+    return sum <= radius * radius;
+}
+
+/** Pairs every current position with the previous positions within
+ * radius, once exhaustively and once through the hash, the way the
+ * tracking finds its candidates.
+ */
+static void
+cell_hash_compare(size_t rank, double radius)
+{
+    std::vector< std::vector<double> > previous = cell_hash_random_positions(60, rank, 10.0);
+    std::vector< std::vector<double> > current = cell_hash_random_positions(50, rank, 10.0);
+
+    cell_hash_pairs_t exhaustive;
+    for (size_t n = 0; n < current.size(); n++) {
+        for (size_t m = 0; m < previous.size(); m++) {
+            if (cell_hash_within(current[n], previous[m], radius)) {
+                exhaustive.insert(std::make_pair(n, m));
+            }
+        }
+    }
+
+    std::vector<size_t> ids(previous.size());
+    for (size_t m = 0; m < ids.size(); m++) {
+        ids[m] = m;
+    }
+    CellHash<double> grid(previous, ids, radius);
+
+    cell_hash_pairs_t pruned;
+    std::vector<size_t> neighbours;
+    size_t num_tested = 0;
+    for (size_t n = 0; n < current.size(); n++) {
+        grid.neighbours(current[n], neighbours);
+        num_tested += neighbours.size();
+        for (size_t i = 0; i < neighbours.size(); i++) {
+            if (cell_hash_within(current[n], previous[neighbours[i]], radius)) {
+                pruned.insert(std::make_pair(n, neighbours[i]));
+            }
+        }
+    }
+
+    EXPECT_FALSE(exhaustive.empty());
+    EXPECT_TRUE(exhaustive == pruned);
+    EXPECT_LT(num_tested, current.size() * previous.size());
+}
+
+TEST(CellHashTest, MatchesExhaustivePairing2D)
+{
+    srand(42);
+    cell_hash_compare(2, 1.5);
+}
+
+TEST(CellHashTest, MatchesExhaustivePairing3D)
+{
+    srand(43);
+    cell_hash_compare(3, 2.5);
+}
+
+TEST(CellHashTest, NoCellSizeYieldsEverything)
+{
+    std::vector< std::vector<double> > positions = cell_hash_random_positions(10, 2, 10.0);
+    std::vector<size_t> ids(positions.size());
+    for (size_t m = 0; m < ids.size(); m++) {
+        ids[m] = m;
+    }
+    CellHash<double> grid(positions, ids, 0.0);
+    EXPECT_EQ(1u, grid.size());
+
+    std::vector<size_t> neighbours;
+    grid.neighbours(positions[0], neighbours);
+    EXPECT_EQ(positions.size(), neighbours.size());
+}
+
+TEST(CellHashTest, Empty)
+{
+    std::vector< std::vector<double> > positions;
+    std::vector<size_t> ids;
+    CellHash<double> grid(positions, ids, 1.0);
+
+    std::vector<size_t> neighbours(3, 0);
+    grid.neighbours(std::vector<double>(2, 0.0), neighbours);
+    EXPECT_TRUE(neighbours.empty());
+}
+
+#endif
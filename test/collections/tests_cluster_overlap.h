@@ -0,0 +1,100 @@
+#ifndef M3D_CLUSTER_OVERLAP_TEST_H
+#define M3D_CLUSTER_OVERLAP_TEST_H
+
+#include <meanie3D/clustering/cluster.h>
+#include <meanie3D/utils/cluster_overlap.h>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace m3D;
+using namespace m3D::utils;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Cluster Overlap
+
+/** Creates a cluster covering the rectangle [x0,x1) x [y0,y1) 
+ */
+template <typename T>
+typename Cluster<T>::ptr
+create_rectangle_cluster(int x0, int x1, int y0, int y1)
+{
+    vector<T> mode(3, 0.0);
+    typename Cluster<T>::ptr c = new Cluster<T>(mode, 2);
+    for (int x = x0; x < x1; x++) {
+        for (int y = y0; y < y1; y++) {
+            vector<int> gridpoint(2);
+            gridpoint[0] = x;
+            gridpoint[1] = y;
+            vector<T> coordinate(2);
+            coordinate[0] = x;
+            coordinate[1] = y;
+            vector<T> values(3, 1.0);
+            values[0] = x;
+            values[1] = y;
+            c->add_point(new Point<T>(gridpoint, coordinate, values));
+        }
+    }
+    return c;
+}
+
+template <typename T>
+void
+delete_clusters(typename Cluster<T>::list &list)
+{
+    for (size_t i = 0; i < list.size(); i++) {
+        for (size_t pi = 0; pi < list[i]->size(); pi++) {
+            delete list[i]->at(pi);
+        }
+        delete list[i];
+    }
+    list.clear();
+}
+
+template<typename T>
+class ClusterOverlapTest : public ::testing::Test {
+};
+
+TYPED_TEST_CASE(ClusterOverlapTest, VectorDataTypes);
+
+TYPED_TEST(ClusterOverlapTest, PairwiseCounts)
+{
+    typedef TypeParam T;
+
+    vector<size_t> dims(2, 20);
+
+    // a[0]: 4x4 at (0,0), a[1]: 2x10 at (10,0)
+    typename Cluster<T>::list a;
+    a.push_back(create_rectangle_cluster<T>(0, 4, 0, 4));
+    a.push_back(create_rectangle_cluster<T>(10, 12, 0, 10));
+
+    // b[0]: 4x4 at (2,2) overlaps a[0] in 2x2
+    // b[1]: 2x5 at (10,5) overlaps a[1] in 2x5
+    // b[2]: far away
+    typename Cluster<T>::list b;
+    b.push_back(create_rectangle_cluster<T>(2, 6, 2, 6));
+    b.push_back(create_rectangle_cluster<T>(10, 12, 5, 10));
+    b.push_back(create_rectangle_cluster<T>(15, 20, 15, 20));
+
+    ClusterOverlap<T> overlap(a, b, dims);
+
+    EXPECT_EQ(4u, overlap.common(0, 0));
+    EXPECT_EQ(0u, overlap.common(0, 1));
+    EXPECT_EQ(10u, overlap.common(1, 1));
+    EXPECT_EQ(0u, overlap.common(1, 2));
+
+    EXPECT_DOUBLE_EQ(0.25, overlap.ratio_a(0, 0));
+    EXPECT_DOUBLE_EQ(0.25, overlap.ratio_b(0, 0));
+    EXPECT_DOUBLE_EQ(0.5, overlap.ratio_a(1, 1));
+    EXPECT_DOUBLE_EQ(1.0, overlap.ratio_b(1, 1));
+
+    // only overlapping pairs are stored
+    EXPECT_EQ(2u, overlap.counts().stored());
+    EXPECT_EQ(1u, overlap.counts().row(0).size());
+
+    delete_clusters<T>(a);
+    delete_clusters<T>(b);
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef M3D_DENSE_GRID_TEST_H
+#define M3D_DENSE_GRID_TEST_H
+
+#include <meanie3D/array/dense_grid.h>
+#include <meanie3D/array/multiarray_dense.h>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace m3D;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Dense Grid
+
+template <typename T>
+class DenseGridTest : public testing::Test
+{
+};
+
+TYPED_TEST_CASE(DenseGridTest, VectorDataTypes);
+
+TYPED_TEST(DenseGridTest, VectorDataTypes)
+{
+    typedef DenseGrid<TypeParam, 3> grid_t;
+
+    vector<size_t> dims(3);
+    dims[0] = 4;
+    dims[1] = 5;
+    dims[2] = 6;
+
+    grid_t grid(dims, 0.0);
+    ASSERT_EQ(120u, grid.size());
+    ASSERT_EQ(30u, grid.strides()[0]);
+    ASSERT_EQ(6u, grid.strides()[1]);
+    ASSERT_EQ(1u, grid.strides()[2]);
+
+    // Linear and grid index are inverse to each other
+
+    for (size_t i = 0; i < grid.size(); i++) {
+        typename grid_t::index_t index = grid.grid_index(i);
+        ASSERT_EQ(i, grid.linear_index(index));
+        grid.set(index, (TypeParam) i);
+    }
+
+    vector<int> gp(3);
+    gp[0] = 2;
+    gp[1] = 3;
+    gp[2] = 4;
+    EXPECT_EQ((TypeParam) (2 * 30 + 3 * 6 + 4), grid.get(gp));
+
+    // Neighbourhood at the corner is clipped to the grid
+
+    typename grid_t::index_t center, radius;
+    center[0] = 0;
+    center[1] = 4;
+    center[2] = 2;
+    radius.assign(1);
+
+    size_t count = 0;
+    typename grid_t::neighbourhood_iterator it(grid, center, radius);
+    for (; it.valid(); ++it) {
+        typename grid_t::index_t index = it.index();
+        EXPECT_LE(0, index[0]);
+        EXPECT_GE(1, index[0]);
+        EXPECT_LE(3, index[1]);
+        EXPECT_GE(4, index[1]);
+        EXPECT_LE(1, index[2]);
+        EXPECT_GE(3, index[2]);
+        EXPECT_EQ(grid.linear_index(index), it.linear_index());
+        EXPECT_EQ(grid.get(index), it.value());
+        count++;
+    }
+    EXPECT_EQ(2u * 2u * 3u, count);
+
+    // In the interior the whole box is visited
+
+    center[0] = 2;
+    center[1] = 2;
+    center[2] = 3;
+    radius[2] = 2;
+
+    count = 0;
+    size_t previous = 0;
+    for (it = typename grid_t::neighbourhood_iterator(grid, center, radius); it.valid(); ++it) {
+        EXPECT_TRUE(count == 0 || it.linear_index() > previous);
+        EXPECT_EQ(grid.linear_index(it.index()), it.linear_index());
+        previous = it.linear_index();
+        count++;
+    }
+    EXPECT_EQ(3u * 3u * 5u, count);
+
+    // Runtime rank adapter
+
+    MultiArray<TypeParam> *array = create_dense_multiarray<TypeParam>(dims, 1.0);
+    EXPECT_EQ(dims, array->get_dimensions());
+    EXPECT_EQ(120u, array->count_value(1.0));
+    array->set(gp, 7.0);
+    EXPECT_EQ((TypeParam) 7.0, array->get(gp));
+
+    // Linear access through a view
+
+    DenseGridView<TypeParam> view(array);
+    ASSERT_EQ(3u, view.rank());
+    ASSERT_EQ(120u, view.size());
+    EXPECT_EQ(grid.linear_index(gp), view.linear_index(gp));
+    EXPECT_EQ(grid.linear_index(gp), view.linear_index(&gp[0]));
+    EXPECT_EQ((TypeParam) 7.0, view.get(view.linear_index(gp)));
+    view.set(0, 3.0);
+    EXPECT_EQ((TypeParam) 3.0, array->get(vector<int>(3, 0)));
+    EXPECT_EQ(dims, view.dimensions());
+
+    // The view's neighbourhood visits the same elements as the grid's
+
+    vector<int> view_center(center.begin(), center.end());
+    view_center[2] = 5;
+    center[2] = 5;
+    radius.assign(2);
+
+    typename DenseGridView<TypeParam>::neighbourhood_iterator vi(view, view_center, 2);
+    for (it = typename grid_t::neighbourhood_iterator(grid, center, radius); it.valid(); ++it, ++vi) {
+        ASSERT_TRUE(vi.valid());
+        EXPECT_EQ(it.linear_index(), vi.linear_index());
+        for (size_t d = 0; d < 3; d++) {
+            EXPECT_EQ(it.index()[d], vi.index()[d]);
+        }
+    }
+    EXPECT_FALSE(vi.valid());
+
+    MultiArray<TypeParam> *copy = create_dense_multiarray<TypeParam>(dims, 0.0);
+    copy->copy_from(array);
+    EXPECT_EQ((TypeParam) 7.0, copy->get(gp));
+    EXPECT_EQ(118u, copy->count_value(1.0));
+
+    delete array;
+    delete copy;
+
+    // Masks
+
+    MultiArray<bool> *mask = create_dense_multiarray<bool>(dims, false);
+    mask->set(gp, true);
+    EXPECT_TRUE(mask->get(gp));
+    EXPECT_EQ(1u, mask->count_value(true));
+    DenseGridView<bool> mask_view(mask);
+    EXPECT_TRUE(mask_view.get(gp));
+    mask_view.set(0, true);
+    EXPECT_EQ(2u, mask->count_value(true));
+    delete mask;
+
+    // Views need a DenseGrid behind the array
+
+    MultiArrayLinear<TypeParam> linear(dims, 0.0);
+    EXPECT_THROW(DenseGridView<TypeParam> invalid(&linear), std::invalid_argument);
+}
+
+#endif
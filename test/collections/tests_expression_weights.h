@@ -0,0 +1,110 @@
+#ifndef M3D_EXPRESSION_WEIGHTS_TEST_H
+#define M3D_EXPRESSION_WEIGHTS_TEST_H
+
+#include <meanie3D/featurespace.h>
+#include <meanie3D/weights.h>
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace m3D;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Expression weight aggregates
+
+template <typename T>
+class ExpressionWeightsTest : public testing::Test
+{
+};
+
+TYPED_TEST_CASE(ExpressionWeightsTest, VectorDataTypes);
+
+TYPED_TEST(ExpressionWeightsTest, VectorDataTypes)
+{
+    PointFactory<TypeParam>::set_instance(new PointDefaultFactory<TypeParam>());
+
+    vector<std::string> variables;
+    variables.push_back("a");
+    variables.push_back("b");
+
+    WeightExpression<TypeParam> expression("nbmean(a) + nbmin(b) + nbmax(a)", variables);
+    ASSERT_EQ(3u, expression.aggregates().size());
+
+    // Every 5th grid point is missing from the feature-space. The
+    // bandwidth reaches 2 grid points along the first axis and
+    // 3 along the second.
+
+    vector<size_t> dims(2);
+    dims[0] = 7;
+    dims[1] = 9;
+
+    vector<TypeParam> resolution(2);
+    resolution[0] = 1.0;
+    resolution[1] = 0.5;
+
+    vector<TypeParam> bandwidth(2);
+    bandwidth[0] = 2.2;
+    bandwidth[1] = 1.6;
+
+    const int w[2] = {2, 3};
+
+    typename Point<TypeParam>::list points;
+    vector<size_t> linear_index;
+    vector<int> g(2);
+    vector<TypeParam> c(2);
+    for (size_t i = 0; i < dims[0] * dims[1]; i++) {
+        if (i % 5 == 2) continue;
+        g[0] = i / dims[1];
+        g[1] = i % dims[1];
+        c[0] = g[0] * resolution[0];
+        c[1] = g[1] * resolution[1];
+
+        vector<TypeParam> values(c);
+        values.push_back((TypeParam) ((i * 7919) % 13) - 6.0);
+        values.push_back((TypeParam) ((i * 104729) % 17) / 4.0);
+        points.push_back(PointFactory<TypeParam>::get_instance()->create(g, c, values));
+        linear_index.push_back(i);
+    }
+
+    PointStore<TypeParam> store(points, 2);
+    vector< vector<TypeParam> > aggregates;
+    ExpressionWeightFunction<TypeParam>::calculate_aggregates(expression,
+            dims, resolution, bandwidth, store, linear_index, aggregates);
+    ASSERT_EQ(3u, aggregates.size());
+
+    // Brute force over the clipped box, interior and edges alike
+
+    for (size_t pi = 0; pi < points.size(); pi++) {
+        typename Point<TypeParam>::ptr p = points[pi];
+
+        TypeParam sum = 0.0, min = 0.0, max = 0.0;
+        size_t count = 0;
+        for (size_t ni = 0; ni < points.size(); ni++) {
+            typename Point<TypeParam>::ptr n = points[ni];
+            if (abs(n->gridpoint[0] - p->gridpoint[0]) > w[0]
+                    || abs(n->gridpoint[1] - p->gridpoint[1]) > w[1]) {
+                continue;
+            }
+            TypeParam a = n->values[2];
+            TypeParam b = n->values[3];
+            sum += a;
+            min = (count == 0 || b < min) ? b : min;
+            max = (count == 0 || a > max) ? a : max;
+            count++;
+        }
+        ASSERT_GT(count, 0u);
+
+        EXPECT_NEAR(sum / count, aggregates[0][pi], 1e-5);
+        EXPECT_EQ(min, aggregates[1][pi]);
+        EXPECT_EQ(max, aggregates[2][pi]);
+    }
+
+    while (!points.empty()) {
+        delete points.back();
+        points.pop_back();
+    }
+}
+
+#endif
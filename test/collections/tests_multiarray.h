@@ -428,5 +428,67 @@ TYPED_TEST(MultiArrayBoostTest, VectorDataTypes)
     TEST_A5(dims, a52, index, 550);
 };
 
+#pragma mark -
+#pragma mark Linear Multi-Array
+
+template <typename T>
+class MultiArrayLinearTest : public testing::Test
+{
+};
+
+TYPED_TEST_CASE(MultiArrayLinearTest, VectorDataTypes);
+
+TYPED_TEST(MultiArrayLinearTest, VectorDataTypes)
+{
+    vector<size_t> dims;
+    vector<int> index;
+
+    // 3D
+
+    dims.resize(3);
+    dims[0] = 10;
+    dims[1] = 10;
+    dims[2] = 100;
+
+    MultiArrayLinear<TypeParam> a31(dims);
+
+    SET_A3(dims, a31, index, 300);
+    TEST_A3(dims, a31, index, 300);
+
+    MultiArrayLinear<TypeParam> a32(dims, 350);
+    TEST_A3(dims, a32, index, 350);
+
+    // Row-major layout, same as netCDF
+
+    index.resize(3);
+    index[0] = 2;
+    index[1] = 3;
+    index[2] = 4;
+    a32.set(index, 1);
+    EXPECT_EQ(2 * 1000 + 3 * 100 + 4, a32.linear_index(index));
+    EXPECT_EQ(1, a32.get((size_t) 2304));
+    EXPECT_EQ(1, a32.data()[2304]);
+
+    // Copy from another implementation
+
+    MultiArrayBlitz<TypeParam> b(dims, 375);
+    a31.copy_from(&b);
+    TEST_A3(dims, a31, index, 375);
+
+    // 6D (beyond what the other implementations support)
+
+    dims.resize(6);
+    for (size_t i = 0; i < 6; i++) dims[i] = 3;
+
+    MultiArrayLinear<TypeParam> a61(dims, 600);
+    EXPECT_EQ(729u, a61.size());
+    EXPECT_EQ(729u, a61.count_value(600));
+
+    index.assign(6, 2);
+    a61.set(index, 650);
+    EXPECT_EQ(650, a61.get(index));
+    EXPECT_EQ(650, a61.get((size_t) 728));
+}
+
 #endif
 
@@ -0,0 +1,130 @@
+#ifndef M3D_OASE_WEIGHTS_TEST_H
+#define M3D_OASE_WEIGHTS_TEST_H
+
+#include <meanie3D/filters.h>
+#include <meanie3D/index.h>
+#include <meanie3D/operations.h>
+#include <meanie3D/weights.h>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace m3D;
+using namespace testing;
+
+#pragma mark -
+#pragma mark OASE weight smoothing
+
+template <typename T>
+class OASEWeightsTest : public testing::Test
+{
+};
+
+/** Smoothes pseudo-random scores on a grid of the given dimensions
+ * and compares every grid point against a range search summed with
+ * GaussianNormalKernel, which is how the weight used to be computed.
+ */
+template <typename T>
+void
+test_oase_smoothing(const vector<size_t> &dims,
+        const vector<T> &resolution,
+        const vector<T> &bandwidth)
+{
+    const size_t rank = dims.size();
+
+    size_t size = 1;
+    for (size_t d = 0; d < rank; d++) {
+        size *= dims[d];
+    }
+
+    typename Point<T>::list points;
+    vector<T> data(size);
+    vector<size_t> linear_index(size);
+    vector<int> g(rank);
+    vector<T> c(rank);
+    for (size_t i = 0; i < size; i++) {
+        size_t rest = i;
+        for (size_t d = rank; d > 0; d--) {
+            g[d - 1] = rest % dims[d - 1];
+            rest /= dims[d - 1];
+            c[d - 1] = g[d - 1] * resolution[d - 1];
+        }
+        data[i] = (T) ((i * 7919) % 13) / 10.0;
+        linear_index[i] = i;
+
+        vector<T> values(c);
+        values.push_back(data[i]);
+        points.push_back(PointFactory<T>::get_instance()->create(g, c, values));
+    }
+
+    vector<T> smoothed;
+    OASEWeightFunction<T>::smooth(dims, resolution, bandwidth, data, linear_index, smoothed);
+    ASSERT_EQ(size, smoothed.size());
+
+    vector<size_t> indexes(rank);
+    for (size_t d = 0; d < rank; d++) {
+        indexes[d] = d;
+    }
+    PointIndex<T> *index = PointIndex<T>::create(&points, indexes, PointIndex<T>::IndexTypeLinear);
+    RangeSearchParams<T> params(bandwidth);
+    index->build(&params);
+    GaussianNormalKernel<T> kernel;
+
+    for (size_t pi = 0; pi < points.size(); pi++) {
+        typename Point<T>::ptr p = points[pi];
+        typename Point<T>::list *neighbours = index->search(p->coordinate, &params);
+
+        T expected = 0.0;
+        for (size_t ni = 0; ni < neighbours->size(); ni++) {
+            typename Point<T>::ptr n = neighbours->at(ni);
+            T dist = vector_norm(p->coordinate - n->coordinate);
+            expected += kernel.apply(dist) * n->values[rank];
+        }
+        delete neighbours;
+
+        EXPECT_NEAR(expected, smoothed[pi], 1e-5 * (1.0 + expected));
+    }
+
+    delete index;
+    while (!points.empty()) {
+        delete points.back();
+        points.pop_back();
+    }
+}
+
+TYPED_TEST_CASE(OASEWeightsTest, VectorDataTypes);
+
+TYPED_TEST(OASEWeightsTest, VectorDataTypes)
+{
+    PointFactory<TypeParam>::set_instance(new PointDefaultFactory<TypeParam>());
+
+    // 2D, with a wide and a narrow ellipsoid on either axis
+
+    vector<size_t> dims(2);
+    dims[0] = 9;
+    dims[1] = 11;
+
+    vector<TypeParam> resolution(2);
+    resolution[0] = 0.5;
+    resolution[1] = 1.0;
+
+    vector<TypeParam> bandwidth(2);
+    bandwidth[0] = 2.2;
+    bandwidth[1] = 3.3;
+    test_oase_smoothing(dims, resolution, bandwidth);
+
+    bandwidth[0] = 1.3;
+    bandwidth[1] = 0.3;
+    test_oase_smoothing(dims, resolution, bandwidth);
+
+    // 3D, reaching the boundary on all axes
+
+    dims.push_back(8);
+    resolution.push_back(0.25);
+    bandwidth[0] = 1.1;
+    bandwidth[1] = 2.4;
+    bandwidth.push_back(0.6);
+    test_oase_smoothing(dims, resolution, bandwidth);
+}
+
+#endif
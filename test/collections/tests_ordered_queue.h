@@ -0,0 +1,131 @@
+#ifndef M3D_ORDERED_QUEUE_TEST_H
+#define M3D_ORDERED_QUEUE_TEST_H
+
+#include <meanie3D/utils/ordered_queue.h>
+#include <meanie3D/parallel.h>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace m3D;
+using namespace m3D::utils;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Ordered Queue
+
+TEST(OrderedQueueTest, Sequential)
+{
+    OrderedQueue<int> queue(4, 2);
+
+    size_t job = 0;
+    int item = 0;
+
+    EXPECT_TRUE(queue.try_claim(job));
+    EXPECT_EQ(0u, job);
+    EXPECT_TRUE(queue.try_claim(job));
+    EXPECT_EQ(1u, job);
+
+    // full
+    EXPECT_FALSE(queue.try_claim(job));
+
+    // items are taken in order only
+    EXPECT_FALSE(queue.try_take(item));
+    queue.put(1, 10);
+    EXPECT_FALSE(queue.try_take(item));
+    queue.put(0, 0);
+
+    EXPECT_TRUE(queue.try_take(item));
+    EXPECT_EQ(0, item);
+
+    // room for one more
+    EXPECT_TRUE(queue.claim(job));
+    EXPECT_EQ(2u, job);
+    EXPECT_FALSE(queue.try_claim(job));
+
+    EXPECT_TRUE(queue.take(item));
+    EXPECT_EQ(10, item);
+
+    EXPECT_TRUE(queue.claim(job));
+    EXPECT_EQ(3u, job);
+    EXPECT_FALSE(queue.claim(job));
+
+    queue.put(3, 30);
+    queue.put(2, 20);
+    EXPECT_TRUE(queue.take(item));
+    EXPECT_EQ(20, item);
+    EXPECT_TRUE(queue.take(item));
+    EXPECT_EQ(30, item);
+
+    // all jobs taken
+    EXPECT_FALSE(queue.take(item));
+    EXPECT_FALSE(queue.try_take(item));
+}
+
+TEST(OrderedQueueTest, Concurrent)
+{
+    // The master thread consumes (and produces when it can), all
+    // other threads produce. Items must arrive in order and never
+    // more than 'capacity' jobs may be in flight.
+
+    const size_t N = 2000;
+    const size_t capacity = 3;
+
+    OrderedQueue<size_t> queue(N, capacity);
+
+    vector<size_t> taken;
+    size_t in_flight = 0;
+    size_t max_in_flight = 0;
+
+#if WITH_OPENMP
+#pragma omp parallel
+#endif
+    {
+        bool is_master = true;
+#if WITH_OPENMP
+        is_master = (omp_get_thread_num() == 0);
+#endif
+        size_t job = 0;
+        size_t item = 0;
+
+        if (is_master) {
+            for (;;) {
+                if (queue.try_take(item)) {
+                    taken.push_back(item);
+                } else if (queue.try_claim(job)) {
+                    queue.put(job, job * job);
+                } else if (queue.take(item)) {
+                    taken.push_back(item);
+                } else {
+                    break;
+                }
+            }
+        } else {
+            while (queue.claim(job)) {
+#if WITH_OPENMP
+#pragma omp atomic
+#endif
+                in_flight++;
+#if WITH_OPENMP
+#pragma omp critical (ordered_queue_test)
+#endif
+                {
+                    if (in_flight > max_in_flight) max_in_flight = in_flight;
+                }
+                queue.put(job, job * job);
+#if WITH_OPENMP
+#pragma omp atomic
+#endif
+                in_flight--;
+            }
+        }
+    }
+
+    ASSERT_EQ(N, taken.size());
+    for (size_t i = 0; i < N; i++) {
+        EXPECT_EQ(i * i, taken[i]);
+    }
+    EXPECT_LE(max_in_flight, capacity);
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef M3D_POINT_SPILL_FILE_TEST_H
+#define M3D_POINT_SPILL_FILE_TEST_H
+
+#include <meanie3D/featurespace/point.h>
+#include <meanie3D/tracking/point_spill_file.h>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace m3D;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Point Spill File
+
+template<typename T>
+class PointSpillFileTest : public ::testing::Test {
+};
+
+TYPED_TEST_CASE(PointSpillFileTest, VectorDataTypes);
+
+TYPED_TEST(PointSpillFileTest, RoundTrip)
+{
+    typedef TypeParam T;
+
+    PointSpillFile<T> spill("/tmp");
+
+    // Two records of different sizes, the second one
+    // appended after the first one has been read
+    typename PointSpillFile<T>::record_t records[2];
+    size_t sizes[2] = {3, 17};
+    typename Point<T>::list originals[2];
+
+    for (size_t r = 0; r < 2; r++) {
+        for (size_t i = 0; i < sizes[r]; i++) {
+            vector<int> gridpoint(2);
+            gridpoint[0] = (int) (r * 100 + i);
+            gridpoint[1] = -((int) i);
+            vector<T> coordinate(2);
+            coordinate[0] = 0.5 * gridpoint[0];
+            coordinate[1] = 0.5 * gridpoint[1];
+            vector<T> values = coordinate;
+            values.push_back((T) (i * i) + 0.25);
+            originals[r].push_back(new Point<T>(gridpoint, coordinate, values));
+        }
+        records[r] = spill.append(originals[r], 3, 2);
+
+        typename Point<T>::list points;
+        spill.read(records[r], points);
+        ASSERT_EQ(sizes[r], points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            EXPECT_EQ(originals[r][i]->values, points[i]->values);
+            EXPECT_EQ(originals[r][i]->gridpoint, points[i]->gridpoint);
+            EXPECT_EQ(originals[r][i]->coordinate, points[i]->coordinate);
+            delete points[i];
+        }
+    }
+
+    // The first record is still readable after the file grew
+    EXPECT_EQ(0u, records[1].offset % 16);
+    const T *values = spill.values(records[0]);
+    EXPECT_EQ(originals[0][2]->values[2], values[2 * 3 + 2]);
+    const int *gridpoints = spill.gridpoints(records[1]);
+    EXPECT_EQ(105, gridpoints[5 * 2]);
+
+    for (size_t r = 0; r < 2; r++) {
+        for (size_t i = 0; i < originals[r].size(); i++) {
+            delete originals[r][i];
+        }
+    }
+}
+
+#endif
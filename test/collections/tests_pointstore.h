@@ -0,0 +1,95 @@
+#ifndef M3D_POINT_STORE_TEST_H
+#define M3D_POINT_STORE_TEST_H
+
+#include <meanie3D/featurespace.h>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace m3D;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Point Store
+
+template <typename T>
+class PointStoreTest : public testing::Test
+{
+};
+
+TYPED_TEST_CASE(PointStoreTest, VectorDataTypes);
+
+TYPED_TEST(PointStoreTest, VectorDataTypes)
+{
+    PointFactory<TypeParam>::set_instance(new PointDefaultFactory<TypeParam>());
+
+    typename Point<TypeParam>::list points;
+
+    // 2D grid with one value component
+
+    vector<int> g(2, 0);
+    vector<TypeParam> c(2, 0);
+    vector<TypeParam> v(3, 0);
+
+    for (int ix = 0; ix < 10; ix++) {
+        for (int iy = 0; iy < 10; iy++) {
+            g[0] = ix;
+            g[1] = iy;
+            c[0] = v[0] = ix;
+            c[1] = v[1] = iy;
+            v[2] = ix * iy;
+            points.push_back(PointFactory<TypeParam>::get_instance()->create(g, c, v));
+        }
+    }
+
+    PointStore<TypeParam> store(points, 2);
+
+    ASSERT_EQ(points.size(), store.size());
+    ASSERT_EQ(3, store.rank());
+    ASSERT_EQ(2, store.spatial_rank());
+
+    // The store refers to the point list, it does not copy it
+    EXPECT_EQ(&points, &store.points());
+
+    // Compare values and grid points
+
+    for (size_t pi = 0; pi < points.size(); pi++) {
+        typename Point<TypeParam>::ptr p = points[pi];
+        EXPECT_EQ(p, store.point(pi));
+        for (size_t d = 0; d < 3; d++) {
+            EXPECT_EQ(p->values[d], store.value(pi, d));
+            EXPECT_EQ(p->values[d], store.column(d)[pi]);
+        }
+        for (size_t d = 0; d < 2; d++) {
+            EXPECT_EQ(p->gridpoint[d], store.gridpoint(pi)[d]);
+        }
+    }
+
+    // Range search in the spatial components must match
+    // a brute force search on the point objects
+
+    vector<TypeParam> x(2, 4.0);
+    vector<TypeParam> h(2, 2.0);
+    vector<size_t> components(2);
+    components[0] = 0;
+    components[1] = 1;
+
+    vector<size_t> hits;
+    store.range_search(x, h, components, hits);
+
+    size_t expected = 0;
+    for (size_t pi = 0; pi < points.size(); pi++) {
+        TypeParam dx = points[pi]->values[0] - x[0];
+        TypeParam dy = points[pi]->values[1] - x[1];
+        if ((dx * dx + dy * dy) / 4.0 <= 1.0) {
+            expected++;
+        }
+    }
+    EXPECT_EQ(expected, hits.size());
+
+    for (size_t pi = 0; pi < points.size(); pi++) {
+        delete points[pi];
+    }
+}
+
+#endif
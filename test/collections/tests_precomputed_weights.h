@@ -0,0 +1,112 @@
+#ifndef M3D_PRECOMPUTED_WEIGHTS_TEST_H
+#define M3D_PRECOMPUTED_WEIGHTS_TEST_H
+
+#include <meanie3D/featurespace.h>
+#include <meanie3D/weights.h>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace m3D;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Precomputed weight function
+
+/** Exposes the pre-computation of the base class */
+template <typename T>
+class PrecomputedWeightProbe : public PrecomputedWeightFunction<T>
+{
+public:
+
+    PrecomputedWeightProbe(const vector<size_t> &dims)
+    : PrecomputedWeightFunction<T>(dims)
+    {
+    }
+
+    using PrecomputedWeightFunction<T>::precompute;
+
+    const MultiArray<T> *weight() const
+    {
+        return this->m_weight;
+    }
+};
+
+/** Weighs each variable by its index + 1 and adds the
+ * first grid point component */
+template <typename T>
+struct PrecomputedWeightTestKernel
+{
+    inline T term(size_t var_index, T value) const
+    {
+        return (var_index + 1) * value;
+    }
+
+    inline T finish(T sum, const Point<T> *p) const
+    {
+        return sum + p->gridpoint[0];
+    }
+};
+
+template <typename T>
+class PrecomputedWeightsTest : public testing::Test
+{
+};
+
+TYPED_TEST_CASE(PrecomputedWeightsTest, VectorDataTypes);
+
+TYPED_TEST(PrecomputedWeightsTest, VectorDataTypes)
+{
+    PointFactory<TypeParam>::set_instance(new PointDefaultFactory<TypeParam>());
+
+    // More points than one block, with every 7th grid
+    // point missing from the feature-space
+
+    vector<size_t> dims(2);
+    dims[0] = 40;
+    dims[1] = 53;
+
+    typename Point<TypeParam>::list points;
+    vector<int> g(2);
+    vector<TypeParam> c(2);
+    for (size_t i = 0; i < dims[0] * dims[1]; i++) {
+        if (i % 7 == 3) continue;
+        g[0] = i / dims[1];
+        g[1] = i % dims[1];
+        c[0] = g[0];
+        c[1] = g[1];
+
+        vector<TypeParam> values(c);
+        values.push_back((TypeParam) (i % 11));
+        values.push_back((TypeParam) (i % 5) / 2.0);
+        points.push_back(PointFactory<TypeParam>::get_instance()->create(g, c, values));
+    }
+    ASSERT_GT(points.size(), (size_t) WEIGHT_FUNCTION_BLOCK_SIZE);
+
+    PointStore<TypeParam> store(points, 2);
+    PrecomputedWeightProbe<TypeParam> weight(dims);
+    weight.precompute(store, PrecomputedWeightTestKernel<TypeParam>());
+
+    for (size_t pi = 0; pi < points.size(); pi++) {
+        typename Point<TypeParam>::ptr p = points[pi];
+        TypeParam expected = p->values[2] + 2 * p->values[3] + p->gridpoint[0];
+        EXPECT_NEAR(expected, weight(p), 1e-5);
+        EXPECT_NEAR(expected, weight.weight()->get(p->gridpoint), 1e-5);
+    }
+
+    // Grid points without a point are left alone
+
+    for (size_t i = 0; i < dims[0] * dims[1]; i++) {
+        if (i % 7 != 3) continue;
+        g[0] = i / dims[1];
+        g[1] = i % dims[1];
+        EXPECT_EQ(0.0, weight.weight()->get(g));
+    }
+
+    while (!points.empty()) {
+        delete points.back();
+        points.pop_back();
+    }
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef M3D_PROFILER_TEST_H
+#define M3D_PROFILER_TEST_H
+
+#include <meanie3D/utils/profiler.h>
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+using namespace m3D;
+using namespace m3D::utils;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Profiler
+
+TEST(ProfilerTest, Disabled)
+{
+    Profiler &profiler = Profiler::instance();
+    profiler.reset();
+    profiler.set_enabled(false);
+    {
+        ScopedTimer timer("ignored");
+        profiler.count("points", 10);
+    }
+    EXPECT_TRUE(profiler.stage("ignored") == NULL);
+}
+
+TEST(ProfilerTest, Nesting)
+{
+    Profiler &profiler = Profiler::instance();
+    profiler.reset();
+    profiler.set_enabled(true);
+
+    for (size_t i = 0; i < 3; i++) {
+        ScopedTimer outer("detection");
+        {
+            ScopedTimer inner("mean-shift");
+            profiler.count("searches", 4);
+            profiler.count("neighbours", 10);
+        }
+        {
+            ScopedTimer inner("aggregation");
+        }
+    }
+
+    const Profiler::Stage *detection = profiler.stage("detection");
+    ASSERT_TRUE(detection != NULL);
+    EXPECT_EQ(3u, detection->calls);
+    ASSERT_EQ(2u, detection->children.size());
+    EXPECT_EQ("mean-shift", detection->children[0]);
+    EXPECT_EQ("aggregation", detection->children[1]);
+
+    const Profiler::Stage *meanshift = profiler.stage("detection/mean-shift");
+    ASSERT_TRUE(meanshift != NULL);
+    EXPECT_EQ(3u, meanshift->calls);
+    EXPECT_EQ(12.0, meanshift->counters.find("searches")->second);
+    EXPECT_EQ(30.0, meanshift->counters.find("neighbours")->second);
+    EXPECT_LE(meanshift->wall_time, detection->wall_time);
+
+    std::ostringstream json;
+    profiler.write_json(json);
+    EXPECT_NE(std::string::npos, json.str().find("\"neighbours_per_search\": 2.5"));
+    EXPECT_NE(std::string::npos, json.str().find("\"name\": \"aggregation\""));
+
+    profiler.set_enabled(false);
+    profiler.reset();
+}
+
+TEST(ProfilerTest, WorkerThreadsCountIntoMasterStage)
+{
+    Profiler &profiler = Profiler::instance();
+    profiler.reset();
+    profiler.set_enabled(true);
+    {
+        ScopedTimer timer("parallel");
+#if WITH_OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < 1000; i++) {
+            profiler.count("items");
+        }
+    }
+    const Profiler::Stage *stage = profiler.stage("parallel");
+    ASSERT_TRUE(stage != NULL);
+    EXPECT_EQ(1000.0, stage->counters.find("items")->second);
+
+    profiler.set_enabled(false);
+    profiler.reset();
+}
+
+TEST(ProfilerTest, EscapesNames)
+{
+    Profiler &profiler = Profiler::instance();
+    profiler.reset();
+    profiler.set_enabled(true);
+    {
+        ScopedTimer timer("say \"hi\"\\now");
+        profiler.count("tab\tcount");
+    }
+
+    std::ostringstream json;
+    profiler.write_json(json);
+    EXPECT_NE(std::string::npos, json.str().find("\"name\": \"say \\\"hi\\\"\\\\now\""));
+    EXPECT_NE(std::string::npos, json.str().find("\"tab\\tcount\": 1"));
+
+    profiler.set_enabled(false);
+    profiler.reset();
+}
+
+TEST(ProfilerTest, NestedTeamsKeepSeparateStacks)
+{
+    Profiler &profiler = Profiler::instance();
+    profiler.reset();
+    profiler.set_enabled(true);
+
+    size_t expected_calls = 0;
+    {
+        ScopedTimer timer("outer");
+#if WITH_OPENMP
+        int nested = omp_get_nested();
+        omp_set_nested(1);
+#pragma omp parallel num_threads(2)
+#endif
+        {
+#if WITH_OPENMP
+#pragma omp parallel num_threads(2)
+#endif
+            {
+                // Threads with the same number in different inner 
+                // teams must not nest into each other's stages
+                profiler.begin("inner");
+#if WITH_OPENMP
+#pragma omp barrier
+#pragma omp atomic
+#endif
+                expected_calls++;
+                profiler.end();
+            }
+        }
+#if WITH_OPENMP
+        omp_set_nested(nested);
+#endif
+    }
+
+    const Profiler::Stage *inner = profiler.stage("outer/inner");
+    ASSERT_TRUE(inner != NULL);
+    EXPECT_EQ(expected_calls, inner->calls);
+    EXPECT_TRUE(profiler.stage("outer/inner/inner") == NULL);
+
+    profiler.set_enabled(false);
+    profiler.reset();
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef M3D_SEPARABLE_CONVOLUTION_TEST_H
+#define M3D_SEPARABLE_CONVOLUTION_TEST_H
+
+#include <meanie3D/filters.h>
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+using namespace m3D;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Separable Convolution
+
+template <typename T>
+class SeparableConvolutionTest : public testing::Test
+{
+};
+
+TYPED_TEST_CASE(SeparableConvolutionTest, VectorDataTypes);
+
+TYPED_TEST(SeparableConvolutionTest, VectorDataTypes)
+{
+    // The strides of the first two axes are larger than
+    // the tile size, so that partial tiles are covered
+
+    vector<size_t> dims(3);
+    dims[0] = 3;
+    dims[1] = 37;
+    dims[2] = 61;
+
+    vector< vector<TypeParam> > kernels(3);
+    kernels[0].push_back(0.5);
+    kernels[0].push_back(0.25);
+    for (size_t d = 0; d < 4; d++) kernels[1].push_back(1.0 / (d + 1));
+    for (size_t d = 0; d < 7; d++) kernels[2].push_back(std::exp(-0.1 * d * d));
+
+    SeparableConvolution<TypeParam> convolution(dims, kernels);
+    const size_t N = convolution.size();
+    ASSERT_EQ(3u * 37u * 61u, N);
+
+    vector<TypeParam> data(N);
+    vector<unsigned char> mask(N, 0);
+    for (size_t i = 0; i < N; i++) {
+        data[i] = (TypeParam) ((i * 7919) % 101) / 10.0;
+        mask[i] = (i % 97 == 0) ? 1 : 0;
+    }
+
+    vector<TypeParam> result(N);
+    vector<unsigned char> dilated(N);
+
+    for (size_t axis = 0; axis < 3; axis++) {
+        convolution.convolve(axis, &data[0], &result[0]);
+        convolution.dilate(axis, &mask[0], &dilated[0]);
+
+        // Compare with a straightforward convolution
+
+        const long w = kernels[axis].size() - 1;
+        size_t stride = 1;
+        for (size_t i = axis + 1; i < 3; i++) stride *= dims[i];
+        const long n = dims[axis];
+
+        for (size_t i = 0; i < N; i++) {
+            const long k = (i / stride) % n;
+            TypeParam sum = 0.0;
+            unsigned char any = 0;
+            for (long j = k - w; j <= k + w; j++) {
+                if (j < 0 || j >= n) continue;
+                size_t other = i + (j - k) * (long) stride;
+                sum += kernels[axis][j < k ? k - j : j - k] * data[other];
+                any |= mask[other];
+            }
+            EXPECT_NEAR(sum, result[i], 1e-4);
+            EXPECT_EQ(any, dilated[i]);
+        }
+    }
+
+    // Empty kernels leave the data unchanged
+
+    vector< vector<TypeParam> > empty(3);
+    SeparableConvolution<TypeParam> identity(dims, empty);
+    identity.convolve(1, &data[0], &result[0]);
+    identity.dilate(1, &mask[0], &dilated[0]);
+    for (size_t i = 0; i < N; i++) {
+        EXPECT_EQ(data[i], result[i]);
+        EXPECT_EQ(mask[i], dilated[i]);
+    }
+}
+
+#endif
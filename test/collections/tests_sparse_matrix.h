@@ -0,0 +1,53 @@
+#ifndef M3D_SPARSE_MATRIX_TEST_H
+#define M3D_SPARSE_MATRIX_TEST_H
+
+#include <meanie3D/utils/matrix.h>
+#include <meanie3D/utils/matrix_impl.h>
+
+#include <gtest/gtest.h>
+
+using namespace m3D;
+using namespace m3D::utils;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Sparse Matrix
+
+TEST(SparseMatrixTest, Access)
+{
+    SparseMatrix<double> matrix(3, 1000);
+    ASSERT_EQ(3u, matrix.rows());
+    ASSERT_EQ(1000u, matrix.cols());
+    EXPECT_EQ(0u, matrix.stored());
+
+    EXPECT_EQ(0.0, matrix.get(1, 500));
+    EXPECT_FALSE(matrix.contains(1, 500));
+
+    matrix.set(1, 500, 0.5);
+    matrix.set(1, 7, 0.25);
+    matrix.set(2, 999, 1.0);
+    EXPECT_EQ(0.5, matrix.get(1, 500));
+    EXPECT_TRUE(matrix.contains(1, 500));
+    EXPECT_EQ(3u, matrix.stored());
+
+    // rows are ordered by column
+    SparseMatrix<double>::row_t::const_iterator ri = matrix.row(1).begin();
+    EXPECT_EQ(7u, ri->first);
+    ++ri;
+    EXPECT_EQ(500u, ri->first);
+
+    matrix.resize(2, 2);
+    EXPECT_EQ(0u, matrix.stored());
+    EXPECT_EQ(2u, matrix.rows());
+}
+
+TEST(SparseMatrixTest, DefaultValue)
+{
+    SparseMatrix<int> matrix(2, 2, -1);
+    EXPECT_EQ(-1, matrix.get(0, 0));
+    matrix.set(0, 0, 0);
+    EXPECT_EQ(0, matrix.get(0, 0));
+    EXPECT_EQ(-1, matrix.get(1, 1));
+}
+
+#endif
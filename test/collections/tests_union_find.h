@@ -0,0 +1,64 @@
+#ifndef M3D_UNION_FIND_TEST_H
+#define M3D_UNION_FIND_TEST_H
+
+#include <meanie3D/utils/union_find.h>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace m3D;
+using namespace m3D::utils;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Union Find
+
+TEST(UnionFindTest, Sequential)
+{
+    UnionFind sets(10);
+    ASSERT_EQ(10u, sets.size());
+
+    for (size_t i = 0; i < 10; i++) {
+        EXPECT_EQ(i, sets.find(i));
+    }
+
+    EXPECT_TRUE(sets.unite(7, 3));
+    EXPECT_TRUE(sets.unite(9, 7));
+    EXPECT_FALSE(sets.unite(3, 9));
+    EXPECT_TRUE(sets.unite(8, 5));
+
+    // the representative is the smallest index
+
+    EXPECT_EQ(3u, sets.find(9));
+    EXPECT_EQ(3u, sets.find(7));
+    EXPECT_EQ(5u, sets.find(8));
+    EXPECT_EQ(0u, sets.find(0));
+
+    EXPECT_TRUE(sets.unite(9, 5));
+    EXPECT_EQ(3u, sets.find(8));
+}
+
+TEST(UnionFindTest, Concurrent)
+{
+    // Join every index with the next one within blocks of 100
+    // from many threads at once, in a scrambled order
+
+    const size_t N = 100000;
+    UnionFind sets(N);
+
+#if WITH_OPENMP
+#pragma omp parallel for schedule(dynamic,64)
+#endif
+    for (size_t k = 0; k < N; k++) {
+        size_t i = (k * 7919) % N;
+        if ((i + 1) % 100 != 0) {
+            sets.unite(i + 1, i);
+        }
+    }
+
+    for (size_t i = 0; i < N; i++) {
+        EXPECT_EQ(i - i % 100, sets.find(i));
+    }
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef M3D_WEIGHT_EXPRESSION_TEST_H
+#define M3D_WEIGHT_EXPRESSION_TEST_H
+
+#include <meanie3D/weights/weight_expression.h>
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace m3D;
+using namespace testing;
+
+#pragma mark -
+#pragma mark Weight Expression
+
+template <typename T>
+class WeightExpressionTest : public testing::Test
+{
+};
+
+TYPED_TEST_CASE(WeightExpressionTest, VectorDataTypes);
+
+TYPED_TEST(WeightExpressionTest, VectorDataTypes)
+{
+    vector<std::string> variables;
+    variables.push_back("zh");
+    variables.push_back("linet");
+
+    WeightExpression<TypeParam> expression(
+            "scaled(zh) + 10 * (nbmax(linet) > 0) - if(zh >= 40 && !(linet == 1), 2^2, -1) + max(zh, 30) / 10",
+            variables);
+
+    // Constants are folded
+    WeightExpression<TypeParam> constant("2 * (3 + 4) - sqrt(16)", variables);
+    ASSERT_EQ(1u, constant.program_size());
+
+    ASSERT_EQ(1u, expression.aggregates().size());
+    ASSERT_EQ(WeightExpression<TypeParam>::AggregateMax, expression.aggregates()[0].kind);
+    ASSERT_EQ(1u, expression.aggregates()[0].var_index);
+
+    const size_t n = 5;
+    TypeParam zh[n] = {0, 20, 40, 50, 60};
+    TypeParam linet[n] = {0, 1, 0, 1, 2};
+    TypeParam nbmax[n] = {0, 1, 0, 3, 2};
+
+    vector<TypeParam> values(2 * n);
+    for (size_t k = 0; k < n; k++) {
+        values[k] = zh[k];
+        values[n + k] = linet[k];
+    }
+
+    TypeParam min[2] = {0, 0};
+    TypeParam max[2] = {60, 5};
+
+    vector<TypeParam> stack(expression.stack_depth() * n);
+    vector<TypeParam> result(n);
+    expression.evaluate(n, &values[0], nbmax, min, max, &stack[0], &result[0]);
+
+    for (size_t k = 0; k < n; k++) {
+        TypeParam expected = zh[k] / 60.0
+                + 10.0 * (nbmax[k] > 0 ? 1 : 0)
+                - ((zh[k] >= 40 && !(linet[k] == 1)) ? 4.0 : -1.0)
+                + (zh[k] > 30 ? zh[k] : 30) / 10.0;
+        EXPECT_NEAR(expected, result[k], 1e-5);
+    }
+
+    vector<TypeParam> constant_stack(constant.stack_depth() * n);
+    constant.evaluate(n, &values[0], NULL, min, max, &constant_stack[0], &result[0]);
+    for (size_t k = 0; k < n; k++) {
+        EXPECT_NEAR(10.0, result[k], 1e-6);
+    }
+
+    // Errors
+
+    EXPECT_THROW(WeightExpression<TypeParam>("zh +", variables), std::invalid_argument);
+    EXPECT_THROW(WeightExpression<TypeParam>("rx * 2", variables), std::invalid_argument);
+    EXPECT_THROW(WeightExpression<TypeParam>("nbmean(2)", variables), std::invalid_argument);
+    EXPECT_THROW(WeightExpression<TypeParam>("foo(zh)", variables), std::invalid_argument);
+    EXPECT_THROW(WeightExpression<TypeParam>("(zh", variables), std::invalid_argument);
+}
+
+#endif
@@ -25,6 +25,7 @@
 #define RUN_WEIGHED_SAMPLE 1
 #define RUN_ITERATION 1
 #define RUN_CLUSTERING 1
+#define RUN_WEIGHTS 1
 
 #pragma mark -
 #pragma mark Data Types 
@@ -41,4 +42,11 @@ typedef Types< float, double > DataTypes;
 #include "clustering.h"
 #endif
 
+#pragma mark -
+#pragma mark Weight functions
+
+#if RUN_WEIGHTS
+#include "weights.h"
+#endif
+
 #endif
@@ -0,0 +1,41 @@
+#ifndef M3D_TEST_DETECTION_WEIGHTS_H
+#define M3D_TEST_DETECTION_WEIGHTS_H
+
+//
+//  weights.h
+//  cf-algorithms
+//
+//  Tests the weight functions built on PrecomputedWeightFunction
+//  against their formulas, on a small 2D feature-space.
+//
+
+#include "../testcase_base.h"
+
+#pragma mark -
+#pragma mark Test Fixture
+
+template <class T>
+class FSWeightFunctionTest : public FSTestBase<T>
+{
+protected:
+
+    detection_params_t<T> m_params;
+    detection_context_t<T> m_ctx;
+
+    /** @param grid point
+     * @return the value written at that grid point
+     */
+    T value_at(const vector<int> &gridpoint) const;
+
+public:
+
+    FSWeightFunctionTest();
+
+    virtual void SetUp();
+
+    virtual void TearDown();
+};
+
+#include "weights_impl.h"
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef M3D_TEST_DETECTION_WEIGHTS_IMPL_H
+#define M3D_TEST_DETECTION_WEIGHTS_IMPL_H
+
+#include <cmath>
+#include <typeinfo>
+
+template<class T>
+FSWeightFunctionTest<T>::FSWeightFunctionTest() : FSTestBase<T>()
+{
+    this->m_settings = new FSTestSettings(2, 1, 40, FSTestBase<T>::filename_from_current_testcase());
+}
+
+template<class T>
+T FSWeightFunctionTest<T>::value_at(const vector<int> &gridpoint) const
+{
+    return 0.25 * ((7 * gridpoint[0] + 3 * gridpoint[1]) % 10 + 1);
+}
+
+template<class T>
+void FSWeightFunctionTest<T>::SetUp()
+{
+    const ::testing::TestInfo * const test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+
+    INFO << "Setting up test " << test_info->test_case_name() << " with typeid " << typeid (T).name() << endl;
+
+    FSTestBase<T>::SetUp();
+
+    vector<float> bounds(this->m_settings->num_dimensions(), 0.5f * this->m_settings->num_gridpoints());
+    this->m_settings->set_axis_bound_values(bounds);
+    this->generate_dimensions();
+
+    NcVar var = this->add_variable("value", 0.0, FS_VALUE_MAX);
+
+    size_t n = this->m_settings->num_gridpoints();
+    vector<int> gridpoint(2);
+    vector<size_t> index(2);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            gridpoint[0] = index[0] = i;
+            gridpoint[1] = index[1] = j;
+            var.putVar(index, this->value_at(gridpoint));
+        }
+    }
+
+    this->generate_featurespace();
+
+    m_params = Detection<T>::defaultParams();
+    m_params.variables = this->m_variables;
+
+    Detection<T>::initialiseContext(m_ctx);
+    m_ctx.coord_system = this->coordinate_system();
+    m_ctx.data_store = this->m_data_store;
+    m_ctx.fs = this->m_featureSpace;
+}
+
+template<class T>
+void FSWeightFunctionTest<T>::TearDown()
+{
+    FSTestBase<T>::TearDown();
+}
+
+#pragma mark -
+#pragma mark Test parameterization
+
+TYPED_TEST_CASE(FSWeightFunctionTest, DataTypes);
+
+#pragma mark -
+#pragma mark Test
+
+TYPED_TEST(FSWeightFunctionTest, FS_WeightFunction_Precomputed)
+{
+    const FeatureSpace<TypeParam> *fs = this->m_featureSpace;
+    ASSERT_EQ(this->m_settings->num_gridpoints() * this->m_settings->num_gridpoints(), fs->size());
+
+    TypeParam min = this->m_data_store->min(0);
+    TypeParam max = this->m_data_store->max(0);
+
+    DefaultWeightFunction<TypeParam> linear(this->m_params, this->m_ctx);
+    EXP10WeightFunction<TypeParam> exp10(this->m_params, this->m_ctx);
+
+    for (size_t pass = 0; pass < 2; pass++) {
+        for (size_t pi = 0; pi < fs->points.size(); pi++) {
+            Point<TypeParam> *p = fs->points[pi];
+            TypeParam value = this->value_at(p->gridpoint);
+            ASSERT_NEAR(value, p->values[2], 1e-5);
+
+            EXPECT_NEAR((value - min) / (max - min), linear(p), 1e-5);
+
+            TypeParam expected = std::pow((double) value, 10.0);
+            EXPECT_NEAR(expected, exp10(p), 1e-5 * expected);
+        }
+
+        // Recalculating in place gives the same weights
+
+        if (pass == 0) {
+            ASSERT_TRUE(linear.recalculate(this->m_params, this->m_ctx));
+            ASSERT_TRUE(exp10.recalculate(this->m_params, this->m_ctx));
+        }
+    }
+
+    // A coordinate system of the same shape is still a different one
+
+    CoordinateSystem<TypeParam> other(*this->m_ctx.coord_system);
+    detection_context_t<TypeParam> ctx = this->m_ctx;
+    ctx.coord_system = &other;
+    EXPECT_FALSE(linear.recalculate(this->m_params, ctx));
+    EXPECT_FALSE(exp10.recalculate(this->m_params, ctx));
+}
+
+#endif
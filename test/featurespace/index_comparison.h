@@ -0,0 +1,64 @@
+#ifndef M3D_TEST_FS_INDEX_COMPARISON_H
+#define M3D_TEST_FS_INDEX_COMPARISON_H
+
+//
+//  index_comparison.h
+//  cf-algorithms
+//
+//  Compares the range search of the rectilinear grid index with 
+//  the FLANN index and a linear scan on a densely populated grid.
+//
+
+#include "../testcase_base.h"
+
+#pragma mark -
+#pragma mark Test Fixture
+
+template <class T>
+class FSIndexComparisonTest2D : public FSTestBase<T>
+{
+protected:
+
+    //
+    // Protected member variables
+    //
+
+    // The half-axis numbers for the ellipsoids 
+    vector< vector<T> > m_bandwidths;
+
+    //
+    // Protected methods
+    //
+
+    void create_dense_distribution_recursive(const NcVar &var,
+            size_t dimensionIndex,
+            typename CoordinateSystem<T>::GridPoint &gridpoint);
+
+    void create_dense_distribution(const NcVar &var);
+
+    /** Runs the searches on every n-th point of the featurespace, 
+     * shifted by a quarter resolution, and compares the results.
+     * @param every n-th point is used as origin
+     */
+    void compare_indexes(size_t stride);
+
+public:
+
+    FSIndexComparisonTest2D();
+
+    virtual void SetUp();
+
+    virtual void TearDown();
+
+};
+
+template <class T>
+class FSIndexComparisonTest3D : public FSIndexComparisonTest2D<T>
+{
+public:
+    FSIndexComparisonTest3D();
+};
+
+#include "index_comparison_impl.h"
+
+#endif
@@ -0,0 +1,246 @@
+#ifndef M3D_TEST_FS_INDEX_COMPARISON_IMPL_H
+#define M3D_TEST_FS_INDEX_COMPARISON_IMPL_H
+
+#include <algorithm>
+#include <typeinfo>
+
+#include <meanie3D/utils/time_utils.h>
+
+template <class T>
+void
+FSIndexComparisonTest2D<T>::create_dense_distribution_recursive(const NcVar &var,
+        size_t dimensionIndex,
+        typename CoordinateSystem<T>::GridPoint &gridpoint)
+{
+    NcDim dim = var.getDim(dimensionIndex);
+
+    for (int index = 0; index < dim.getSize(); index++) {
+        gridpoint[dimensionIndex] = index;
+
+        if (dimensionIndex < this->file()->getDimCount() - 1) {
+            create_dense_distribution_recursive(var, dimensionIndex + 1, gridpoint);
+        } else {
+            this->m_pointCount++;
+
+            // Values on 17 levels, scrambled over the grid, so
+            // that the value range actually filters points
+
+            int level = 0;
+
+            for (size_t d = 0; d < gridpoint.size(); d++) {
+                level += (int) (2 * d + 7) * gridpoint[d];
+            }
+
+            T value = (T) (FS_VALUE_MAX * (level % 17) / 16.0);
+
+            vector<size_t> gp(gridpoint.begin(), gridpoint.end());
+
+            var.putVar(gp, value);
+        }
+    }
+}
+
+/** Creates a value at every grid point 
+ */
+template <class T>
+void
+FSIndexComparisonTest2D<T>::create_dense_distribution(const NcVar &var)
+{
+    typename CoordinateSystem<T>::GridPoint gridpoint(this->file()->getDimCount(), 0);
+
+    this->m_pointCount = 0;
+
+    INFO << "Creating dense distribution ...";
+
+    create_dense_distribution_recursive(var, 0, gridpoint);
+
+    if (INFO_ENABLED) cout << "done. (" << this->m_pointCount << " points)" << endl;
+
+    this->m_totalPointCount += this->m_pointCount;
+}
+
+template<class T>
+void FSIndexComparisonTest2D<T>::SetUp()
+{
+    const ::testing::TestInfo * const test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+
+    INFO << "Setting up test " << test_info->test_case_name() << " with typeid " << typeid (T).name() << endl;
+
+    FSTestBase<T>::SetUp();
+
+    // Axis values go from -bound to +bound over num_gridpoints
+    // intervals, which makes the resolution 1.0
+
+    float bound = 0.5f * this->m_settings->num_gridpoints();
+
+    vector<float> bounds(this->m_settings->fs_dim(), bound);
+
+    this->m_settings->set_axis_bound_values(bounds);
+
+    // Spatial half-axis between nodes, so that no point sits 
+    // exactly on the boundary of the search ellipsoid
+
+    size_t rank = this->m_settings->num_dimensions();
+
+    for (size_t k = 1; k <= 3; k++) {
+        vector<T> h(this->m_settings->fs_dim(), (T) (k + 0.5));
+        h[rank] = (T) (0.3 * FS_VALUE_MAX);
+        this->m_bandwidths.push_back(h);
+    }
+
+    try {
+        this->generate_dimensions();
+    } catch (const netCDF::exceptions::NcException &e) {
+        cerr << "FATAL:error while generating dimensions: " << e.what() << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    NcVar var = this->add_variable("index_comparison", 0.0, FS_VALUE_MAX);
+
+    create_dense_distribution(var);
+
+    FSTestBase<T>::generate_featurespace();
+}
+
+template<class T>
+void FSIndexComparisonTest2D<T>::TearDown()
+{
+    FSTestBase<T>::TearDown();
+}
+
+template<class T>
+void FSIndexComparisonTest2D<T>::compare_indexes(size_t stride)
+{
+    FeatureSpace<T> *fs = this->m_featureSpace;
+
+    const vector<T> &resolution = this->coordinate_system()->resolution();
+
+    size_t rank = this->coordinate_system()->rank();
+
+    PointIndex<T> *grid = PointIndex<T>::create(fs, PointIndex<T>::IndexTypeRectilinearGrid);
+    PointIndex<T> *flann = PointIndex<T>::create(fs, PointIndex<T>::IndexTypeFLANN);
+    PointIndex<T> *linear = PointIndex<T>::create(fs, PointIndex<T>::IndexTypeLinear);
+
+    // Origins are the points shifted by a quarter of the resolution,
+    // which puts them between the grid nodes
+
+    vector< vector<T> > origins;
+
+    for (size_t pi = 0; pi < fs->size(); pi += stride) {
+        vector<T> x = fs->points[pi]->values;
+        for (size_t d = 0; d < rank; d++) {
+            x[d] += 0.25 * resolution[d];
+        }
+        origins.push_back(x);
+    }
+
+    for (size_t i = 0; i < m_bandwidths.size(); i++) {
+        RangeSearchParams<T> params(m_bandwidths[i]);
+
+        grid->build(&params);
+        flann->build(&params);
+        linear->build(&params);
+
+        typename Point<T>::list result;
+
+        vector< vector<typename Point<T>::ptr> > grid_results(origins.size());
+
+        start_timer();
+
+        for (size_t oi = 0; oi < origins.size(); oi++) {
+            grid->search_into(origins[oi], &params, result);
+            grid_results[oi].assign(result.begin(), result.end());
+        }
+
+        double grid_time = stop_timer();
+
+        vector< vector<typename Point<T>::ptr> > flann_results(origins.size());
+
+        start_timer();
+
+        for (size_t oi = 0; oi < origins.size(); oi++) {
+            flann->search_into(origins[oi], &params, result);
+            flann_results[oi].assign(result.begin(), result.end());
+        }
+
+        double flann_time = stop_timer();
+
+        // The linear scan is the reference. FLANN searches in the
+        // whitened space, its results are reported but not required
+        // to be identical.
+
+        size_t sample_size = 0;
+
+        size_t flann_mismatches = 0;
+
+        for (size_t oi = 0; oi < origins.size(); oi++) {
+            linear->search_into(origins[oi], &params, result);
+
+            vector<typename Point<T>::ptr> expected(result.begin(), result.end());
+
+            std::sort(expected.begin(), expected.end());
+            std::sort(grid_results[oi].begin(), grid_results[oi].end());
+            std::sort(flann_results[oi].begin(), flann_results[oi].end());
+
+            EXPECT_EQ(expected, grid_results[oi]);
+
+            if (expected != flann_results[oi]) {
+                flann_mismatches++;
+            }
+
+            sample_size += expected.size();
+        }
+
+        cout << "h=" << m_bandwidths[i]
+                << " searches:" << origins.size()
+                << " avg. sample size:" << sample_size / (double) origins.size()
+                << " grid:" << grid_time << "s"
+                << " flann:" << flann_time << "s"
+                << " flann mismatches:" << flann_mismatches
+                << endl;
+    }
+
+    delete grid;
+    delete flann;
+    delete linear;
+}
+
+#pragma mark -
+#pragma mark Test parameterization
+
+template<class T>
+FSIndexComparisonTest2D<T>::FSIndexComparisonTest2D() : FSTestBase<T>()
+{
+    this->m_settings = new FSTestSettings(2, 1, 40, FSTestBase<T>::filename_from_current_testcase());
+}
+
+template<class T>
+FSIndexComparisonTest3D<T>::FSIndexComparisonTest3D() : FSIndexComparisonTest2D<T>()
+{
+    std::string filename = FSTestBase<T>::filename_from_current_testcase();
+    this->m_settings = new FSTestSettings(3, 1, 24, filename);
+}
+
+// 2D
+#if RUN_2D
+
+TYPED_TEST_CASE(FSIndexComparisonTest2D, DataTypes);
+
+TYPED_TEST(FSIndexComparisonTest2D, FS_IndexComparisonTest_2D)
+{
+    this->compare_indexes(7);
+}
+#endif
+
+// 3D
+#if RUN_3D
+
+TYPED_TEST_CASE(FSIndexComparisonTest3D, DataTypes);
+
+TYPED_TEST(FSIndexComparisonTest3D, FS_IndexComparisonTest_3D)
+{
+    this->compare_indexes(53);
+}
+#endif
+
+#endif
@@ -22,6 +22,7 @@
 #define RUN_UNWEIGHED_SAMPLE 1
 #define RUN_WEIGHED_SAMPLE 1
 #define RUN_ITERATION 1
+#define RUN_INDEX_COMPARISON 1
 
 #pragma mark -
 #pragma mark Data Types 
@@ -59,4 +60,11 @@ typedef Types< float, double > DataTypes;
 #include "iteration.h"
 #endif
 
+#pragma mark -
+#pragma mark Index comparison (grid vs. FLANN vs. linear)
+
+#if RUN_INDEX_COMPARISON
+#include "index_comparison.h"
+#endif
+
 #endif
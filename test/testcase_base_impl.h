@@ -19,7 +19,7 @@ template<class T>
 const T FSTestBase<T>::FILL_VALUE = std::numeric_limits<T>::min();
 
 template<class T>
-FSTestBase<T>::FSTestBase() : m_file(NULL), m_settings(NULL), m_coordinate_system(NULL),
+FSTestBase<T>::FSTestBase() : m_file(NULL), m_data_store(NULL), m_settings(NULL), m_coordinate_system(NULL),
 m_totalPointCount(0), m_featureSpace(NULL), m_featureSpaceIndex(NULL)
 {
 }
@@ -0,0 +1,67 @@
+#ifndef M3D_TEST_TRACKING_CLUSTER_FILE_H
+#define M3D_TEST_TRACKING_CLUSTER_FILE_H
+
+//
+//  cluster_file.h
+//  cf-algorithms
+//
+//  Writes cluster lists in the compact layout and reads them back.
+//
+
+#include "tracking_base.h"
+
+#pragma mark -
+#pragma mark Cluster list with access to the file layout
+
+template <class T>
+class ClusterListProbe : public ClusterList<T>
+{
+public:
+
+    ClusterListProbe(const typename Cluster<T>::list &list,
+            const string &source,
+            const vector<string> &vars,
+            const vector<string> &dims,
+            const vector<string> &dim_vars,
+            long timestamp)
+    : ClusterList<T>(list, source, vars, dims, dim_vars, timestamp) {};
+
+    using ClusterList<T>::point_index_type;
+    using ClusterList<T>::write_clusters;
+    using ClusterList<T>::read_clusters;
+    using ClusterList<T>::resolve_source_path;
+};
+
+#pragma mark -
+#pragma mark Test Fixture
+
+template <class T>
+class ClusterFileTest2D : public TrackingTestBase<T>
+{
+protected:
+
+    /** Creates three clusters in the previous list: one with all
+     * meta-data set, one without displacement and bounding box 
+     * and a single point cluster with a partial displacement.
+     */
+    void create_clusters();
+
+    /** Compares the points and meta-data of the clusters read 
+     * back with the previous list.
+     * @param clusters read from file
+     */
+    void compare_clusters(const typename Cluster<T>::list &read);
+
+    /** @return name for a cluster file of the current test */
+    std::string cluster_filename();
+
+public:
+
+    virtual void SetUp();
+
+    virtual void TearDown();
+};
+
+#include "cluster_file_impl.h"
+
+#endif
@@ -0,0 +1,297 @@
+#ifndef M3D_TEST_TRACKING_CLUSTER_FILE_IMPL_H
+#define M3D_TEST_TRACKING_CLUSTER_FILE_IMPL_H
+
+#include <limits>
+
+template<class T>
+void ClusterFileTest2D<T>::SetUp()
+{
+    TrackingTestBase<T>::SetUp();
+
+    // The cluster files copy their dimensions from the test file
+
+    this->reopen_file_for_reading();
+
+    create_clusters();
+}
+
+template<class T>
+void ClusterFileTest2D<T>::TearDown()
+{
+    TrackingTestBase<T>::TearDown();
+
+    boost::filesystem::path path(cluster_filename());
+    if (boost::filesystem::exists(path)) {
+        boost::filesystem::remove(path);
+    }
+}
+
+template<class T>
+std::string
+ClusterFileTest2D<T>::cluster_filename()
+{
+    const ::testing::TestInfo * const test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+    std::string filename = test_info->test_case_name() + string("-") + test_info->name() + string("-clusters.nc");
+    boost::replace_all(filename, "/", "_");
+    return filename;
+}
+
+template<class T>
+void
+ClusterFileTest2D<T>::create_clusters()
+{
+    typename Cluster<T>::list clusters;
+
+    vector<int> origin(2), extent(2);
+
+    origin[0] = 10; origin[1] = 10;
+    extent[0] = 4; extent[1] = 3;
+    typename Cluster<T>::ptr c = this->create_cluster(1, origin, extent, 1.0);
+    c->uuid = 11;
+    c->displacement[0] = 1.5;
+    c->displacement[1] = -2.0;
+    c->set_bounding_box_min(vector<T>(2, -45.0));
+    c->set_bounding_box_max(vector<T>(2, 45.0));
+    c->set_has_margin_points(true);
+    clusters.push_back(c);
+
+    origin[0] = 30; origin[1] = 40;
+    extent[0] = 2; extent[1] = 5;
+    c = this->create_cluster(2, origin, extent, 2.0);
+    c->uuid = 12;
+    c->displacement.clear();
+    clusters.push_back(c);
+
+    origin[0] = 60; origin[1] = 20;
+    extent[0] = 1; extent[1] = 1;
+    c = this->create_cluster(3, origin, extent, 0.5);
+    c->uuid = 13;
+    c->displacement[0] = std::numeric_limits<T>::quiet_NaN();
+    c->displacement[1] = 1.0;
+    clusters.push_back(c);
+
+    this->m_previous = this->create_list(clusters, 600);
+}
+
+template<class T>
+void
+ClusterFileTest2D<T>::compare_clusters(const typename Cluster<T>::list &read)
+{
+    const typename Cluster<T>::list &written = this->m_previous->clusters;
+
+    ASSERT_EQ(written.size(), read.size());
+
+    for (size_t ci = 0; ci < written.size(); ci++) {
+        typename Cluster<T>::ptr w = written[ci];
+        typename Cluster<T>::ptr r = read[ci];
+
+        EXPECT_EQ(w->id, r->id);
+        EXPECT_EQ(w->uuid, r->uuid);
+        EXPECT_EQ(w->has_margin_points(), r->has_margin_points());
+        EXPECT_EQ(w->get_bounding_box_min(), r->get_bounding_box_min());
+        EXPECT_EQ(w->get_bounding_box_max(), r->get_bounding_box_max());
+
+        ASSERT_EQ(w->size(), r->size());
+
+        for (size_t pi = 0; pi < w->size(); pi++) {
+            EXPECT_EQ(w->at(pi)->gridpoint, r->at(pi)->gridpoint);
+            EXPECT_EQ(w->at(pi)->coordinate, r->at(pi)->coordinate);
+            EXPECT_EQ(w->at(pi)->values, r->at(pi)->values);
+        }
+    }
+
+    // Displacements that were not (fully) set are written as
+    // NaN and come back empty
+
+    EXPECT_EQ(written[0]->displacement, read[0]->displacement);
+    EXPECT_TRUE(read[1]->displacement.empty());
+    EXPECT_TRUE(read[2]->displacement.empty());
+}
+
+#pragma mark -
+#pragma mark Test parameterization
+
+TYPED_TEST_CASE(ClusterFileTest2D, DataTypes);
+
+TYPED_TEST(ClusterFileTest2D, ClusterFile_RoundTrip_2D)
+{
+    std::string path = this->cluster_filename();
+
+    this->m_previous->write(path);
+
+    // Only the compact layout is written
+
+    NcFile file(path, NcFile::read);
+    int layout = 0;
+    file.getAtt("cluster_file_layout").getValues(&layout);
+    EXPECT_EQ(CLUSTER_FILE_LAYOUT, layout);
+    EXPECT_EQ(0u, file.getAtts().count("cluster_ids"));
+    EXPECT_EQ(ncInt, file.getVar("point_index").getType());
+
+    typename ClusterList<TypeParam>::ptr list = ClusterList<TypeParam>::read(path);
+
+    this->compare_clusters(list->clusters);
+
+    list->clear(true);
+    delete list;
+}
+
+TYPED_TEST(ClusterFileTest2D, ClusterFile_PointIndexType_2D)
+{
+    vector<size_t> small(2, 101);
+    EXPECT_EQ(ncInt, ClusterListProbe<TypeParam>::point_index_type(small));
+
+    vector<size_t> large(2, 65536);
+    EXPECT_EQ(ncInt64, ClusterListProbe<TypeParam>::point_index_type(large));
+
+    // Both index types read back the same points
+
+    std::string path = this->cluster_filename();
+
+    const CoordinateSystem<TypeParam> *cs = this->coordinate_system();
+
+    NcType types[2] = {ncInt, ncInt64};
+
+    for (size_t ti = 0; ti < 2; ti++) {
+        ClusterListProbe<TypeParam> list(this->m_previous->clusters,
+                this->m_filename,
+                this->m_previous->variables,
+                this->m_dimensions,
+                this->m_dimension_variables,
+                600);
+
+        NcFile *file = new NcFile(path, NcFile::replace);
+        file->addDim("rank", (int) list.rank());
+        list.write_clusters(file, cs->get_dimension_sizes(), types[ti]);
+        delete file;
+
+        // The list does not own the clusters of the fixture
+
+        list.clusters.clear();
+
+        file = new NcFile(path, NcFile::read);
+        EXPECT_EQ(types[ti], file->getVar("point_index").getType());
+
+        typename Cluster<TypeParam>::list read;
+        ClusterListProbe<TypeParam>::read_clusters(file, cs, read, true);
+        delete file;
+
+        this->compare_clusters(read);
+
+        for (size_t ci = 0; ci < read.size(); ci++) {
+            read[ci]->clear(true);
+            delete read[ci];
+        }
+    }
+}
+
+TYPED_TEST(ClusterFileTest2D, ClusterFile_StoredClusters_2D)
+{
+    std::string path = this->cluster_filename();
+
+    this->m_previous->write(path);
+
+    CoordinateSystem<TypeParam> *cs = NULL;
+
+    typename ClusterList<TypeParam>::ptr list = ClusterList<TypeParam>::read(path, &cs, false);
+
+    const typename Cluster<TypeParam>::list &written = this->m_previous->clusters;
+
+    ASSERT_EQ(written.size(), list->size());
+
+    for (size_t ci = 0; ci < list->size(); ci++) {
+        StoredCluster<TypeParam> *sc = dynamic_cast<StoredCluster<TypeParam> *>(list->clusters[ci]);
+        ASSERT_TRUE(sc != NULL);
+        EXPECT_FALSE(sc->points_loaded());
+        EXPECT_EQ(written[ci]->size(), sc->size());
+    }
+
+    // Point access through at() reads the points
+
+    typename Cluster<TypeParam>::ptr c = list->clusters[0];
+    EXPECT_EQ(written[0]->at(0)->gridpoint, c->at(0)->gridpoint);
+    EXPECT_EQ(written[0]->at(0)->values, c->at(0)->values);
+
+    // So does the histogram of an unloaded cluster
+
+    c = list->clusters[1];
+    typename Histogram<TypeParam>::ptr h = c->histogram(2, 0.0, FS_VALUE_MAX);
+    EXPECT_EQ(written[1]->size(), h->sum());
+
+    // Writing the list replaces the file the clusters came from.
+    // Points dropped afterwards are read again from the new file.
+
+    list->write(path);
+
+    for (size_t ci = 0; ci < list->size(); ci++) {
+        list->clusters[ci]->clear(true);
+    }
+
+    this->compare_clusters(list->clusters);
+
+    list->clear(true);
+    delete list;
+    delete cs;
+}
+
+TYPED_TEST(ClusterFileTest2D, ClusterFile_ReferenceSource_2D)
+{
+    namespace fs = boost::filesystem;
+
+    // Cluster file and a copy of the source in a directory of 
+    // their own, which is moved after writing. The recorded
+    // source path then no longer exists.
+
+    fs::path dir(this->cluster_filename() + "-dir");
+    fs::path moved(this->cluster_filename() + "-moved");
+    fs::remove_all(dir);
+    fs::remove_all(moved);
+    fs::create_directory(dir);
+
+    fs::path source = dir / "source.nc";
+    fs::copy_file(this->m_filename, source);
+
+    this->m_previous->source_file = source.generic_string();
+    this->m_previous->source_by_reference = true;
+    this->m_previous->write((dir / "clusters.nc").generic_string());
+
+    delete this->m_previous->file;
+    this->m_previous->file = NULL;
+
+    fs::rename(dir, moved);
+
+    std::string path = (moved / "clusters.nc").generic_string();
+    std::string recorded = source.generic_string();
+
+    EXPECT_EQ(this->m_filename, ClusterListProbe<TypeParam>::resolve_source_path(path, this->m_filename));
+    EXPECT_EQ((moved / "source.nc").generic_string(), ClusterListProbe<TypeParam>::resolve_source_path(path, recorded));
+    EXPECT_EQ(std::string(), ClusterListProbe<TypeParam>::resolve_source_path(path, "elsewhere/missing.nc"));
+
+    {
+        // The reference is resolved next to the cluster file
+
+        NcFile file(path, NcFile::read);
+        EXPECT_EQ(0u, file.getVars().count("x"));
+
+        NcFile *data_file = ClusterList<TypeParam>::open_data_file(path, &file);
+        ASSERT_TRUE(data_file != &file);
+        EXPECT_EQ(1u, data_file->getVars().count("x"));
+        delete data_file;
+
+        typename ClusterList<TypeParam>::ptr list = ClusterList<TypeParam>::read(path);
+        EXPECT_TRUE(list->source_by_reference);
+        this->compare_clusters(list->clusters);
+        list->clear(true);
+        delete list;
+
+        // A source modified after writing is rejected
+
+        fs::path moved_source = moved / "source.nc";
+        fs::last_write_time(moved_source, fs::last_write_time(moved_source) + 10);
+        EXPECT_THROW(ClusterList<TypeParam>::open_data_file(path, &file), std::runtime_error);
+    }
+
+    fs::remove_all(moved);
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef M3D_TEST_TRACKING_CORRELATION_H
+#define M3D_TEST_TRACKING_CORRELATION_H
+
+//
+//  correlation.h
+//  cf-algorithms
+//
+//  Compares the correlation data and match probabilities of a 
+//  parallel tracking run with those of a serial run.
+//
+
+#include "tracking_base.h"
+
+#pragma mark -
+#pragma mark Test Fixture
+
+template <class T>
+class TrackingCorrelationTest2D : public TrackingTestBase<T>
+{
+protected:
+
+    /** Creates two lists of clusters scattered over the grid. The 
+     * current clusters are displaced and resized versions of the 
+     * previous ones, so that there are overlapping pairs, pairs
+     * only within reach and pairs violating the size constraint.
+     * @param number of clusters per list
+     */
+    void create_scattered_lists(size_t count);
+
+    /** Runs correlation and probabilities on the fixture's lists.
+     * @param run
+     * @param number of threads (0 = default)
+     */
+    void score(typename TrackingProbe<T>::run_t &run, int num_threads);
+};
+
+#include "correlation_impl.h"
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef M3D_TEST_TRACKING_CORRELATION_IMPL_H
+#define M3D_TEST_TRACKING_CORRELATION_IMPL_H
+
+#include <cstdlib>
+
+template<class T>
+void
+TrackingCorrelationTest2D<T>::create_scattered_lists(size_t count)
+{
+    srand(4711);
+
+    typename Cluster<T>::list previous, current;
+
+    vector<int> origin(2), extent(2), shifted(2), resized(2);
+
+    for (size_t i = 0; i < count; i++) {
+        for (size_t d = 0; d < 2; d++) {
+            extent[d] = 2 + rand() % 8;
+            origin[d] = 3 + rand() % (85 - extent[d]);
+            shifted[d] = origin[d] + rand() % 7 - 3;
+            resized[d] = extent[d] + rand() % 5 - 2;
+            if (resized[d] < 1) resized[d] = 1;
+        }
+
+        previous.push_back(this->create_cluster(i + 1, origin, extent, (T) (rand() % 3)));
+        current.push_back(this->create_cluster(NO_ID, shifted, resized, (T) (rand() % 3)));
+    }
+
+    this->m_previous = this->create_list(previous, 0);
+    this->m_current = this->create_list(current, 300);
+}
+
+template<class T>
+void
+TrackingCorrelationTest2D<T>::score(typename TrackingProbe<T>::run_t &run, int num_threads)
+{
+    tracking_param_t params = Tracking<T>::defaultParams();
+    params.correlation_weight = 1.0;
+    params.verbosity = VerbositySilent;
+
+    TrackingProbe<T> tracking(params);
+
+    // Fresh lists for every run, so that none of the cached
+    // cluster properties are carried over from the previous run
+
+    this->delete_lists();
+    create_scattered_lists(40);
+
+    this->prepare_run(run, 10.0);
+
+#if WITH_OPENMP
+    int default_threads = omp_get_max_threads();
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    }
+#endif
+
+    tracking.calculateCorrelationData(run);
+    tracking.calculateProbabilities(run);
+
+#if WITH_OPENMP
+    omp_set_num_threads(default_threads);
+#endif
+}
+
+#pragma mark -
+#pragma mark Test parameterization
+
+TYPED_TEST_CASE(TrackingCorrelationTest2D, DataTypes);
+
+TYPED_TEST(TrackingCorrelationTest2D, Tracking_ParallelScoringMatchesSerial_2D)
+{
+    typename TrackingProbe<TypeParam>::run_t serial;
+    this->score(serial, 1);
+
+    typename TrackingProbe<TypeParam>::run_t parallel;
+    this->score(parallel, 0);
+
+    ASSERT_GT(serial.candidates.size(), 0u);
+    ASSERT_EQ(serial.candidates, parallel.candidates);
+    ASSERT_EQ(serial.candidateRows, parallel.candidateRows);
+
+    EXPECT_EQ(serial.maxSizeDifference, parallel.maxSizeDifference);
+    EXPECT_EQ(serial.maxMidDisplacement.get(), parallel.maxMidDisplacement.get());
+
+    size_t possible = 0;
+
+    for (size_t ci = 0; ci < serial.candidates.size(); ci++) {
+        size_t n = serial.candidates[ci].first;
+        size_t m = serial.candidates[ci].second;
+
+        EXPECT_EQ(serial.matchPossible.get(n, m), parallel.matchPossible.get(n, m));
+        EXPECT_EQ(serial.coverOldByNew.get(n, m), parallel.coverOldByNew.get(n, m));
+        EXPECT_EQ(serial.coverNewByOld.get(n, m), parallel.coverNewByOld.get(n, m));
+        EXPECT_EQ(serial.midDisplacement.get(n, m).get(), parallel.midDisplacement.get(n, m).get());
+        EXPECT_EQ(serial.sizeDifference.get(n, m), parallel.sizeDifference.get(n, m));
+        EXPECT_EQ(serial.rankCorrelation.get(n, m), parallel.rankCorrelation.get(n, m));
+        EXPECT_EQ(serial.likelihood.get(n, m), parallel.likelihood.get(n, m));
+
+        if (serial.matchPossible.get(n, m)) {
+            possible++;
+        }
+    }
+
+    // Some pairs pass the constraints, some don't
+
+    EXPECT_GT(possible, 0u);
+    EXPECT_LT(possible, serial.candidates.size());
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef M3D_TEST_TRACKING_MERGE_SPLIT_H
+#define M3D_TEST_TRACKING_MERGE_SPLIT_H
+
+//
+//  merge_split.h
+//  cf-algorithms
+//
+//  Checks the merge and split candidates derived from the 
+//  overlap graph of the tracking.
+//
+
+#include "tracking_base.h"
+
+#pragma mark -
+#pragma mark Test Fixture
+
+template <class T>
+class TrackingMergeSplitTest2D : public TrackingTestBase<T>
+{
+protected:
+
+    /** Previous and current clusters forming a merge (two 
+     * previous into one current), a split (one previous into
+     * two current) and a pair touching too little for either.
+     */
+    void create_lists();
+
+    /** Runs the tracking up to the overlap graph.
+     * @param tracking
+     * @param run
+     */
+    void build_graph(TrackingProbe<T> &tracking, typename TrackingProbe<T>::run_t &run);
+
+public:
+
+    virtual void SetUp();
+};
+
+#include "merge_split_impl.h"
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef M3D_TEST_TRACKING_MERGE_SPLIT_IMPL_H
+#define M3D_TEST_TRACKING_MERGE_SPLIT_IMPL_H
+
+template<class T>
+void TrackingMergeSplitTest2D<T>::SetUp()
+{
+    TrackingTestBase<T>::SetUp();
+
+    create_lists();
+}
+
+template<class T>
+void
+TrackingMergeSplitTest2D<T>::create_lists()
+{
+    typename Cluster<T>::list previous, current;
+
+    vector<int> origin(2), extent(2, 5);
+
+    // Merge: previous 0 and 1 side by side, current 0 covers both
+
+    origin[0] = 10; origin[1] = 10;
+    previous.push_back(this->create_cluster(1, origin, extent, 1.0));
+    origin[0] = 15;
+    previous.push_back(this->create_cluster(2, origin, extent, 1.0));
+
+    origin[0] = 10;
+    extent[0] = 10;
+    current.push_back(this->create_cluster(NO_ID, origin, extent, 1.0));
+
+    // Split: previous 2 is covered by current 1 and 2
+
+    origin[0] = 50; origin[1] = 50;
+    extent[0] = 10; extent[1] = 6;
+    previous.push_back(this->create_cluster(3, origin, extent, 2.0));
+
+    extent[0] = 5;
+    current.push_back(this->create_cluster(NO_ID, origin, extent, 2.0));
+    origin[0] = 55;
+    current.push_back(this->create_cluster(NO_ID, origin, extent, 2.0));
+
+    // Previous 3 and current 3 share a sixth of their points
+
+    origin[0] = 80; origin[1] = 80;
+    extent[0] = 6; extent[1] = 6;
+    previous.push_back(this->create_cluster(4, origin, extent, 1.0));
+    origin[0] = 85;
+    current.push_back(this->create_cluster(NO_ID, origin, extent, 1.0));
+
+    for (size_t i = 0; i < current.size(); i++) {
+        current[i]->uuid = 101 + i;
+    }
+
+    this->m_previous = this->create_list(previous, 0);
+    this->m_current = this->create_list(current, 300);
+}
+
+template<class T>
+void
+TrackingMergeSplitTest2D<T>::build_graph(TrackingProbe<T> &tracking,
+        typename TrackingProbe<T>::run_t &run)
+{
+    this->prepare_run(run, 10.0);
+
+    tracking.calculateCorrelationData(run);
+    tracking.calculateProbabilities(run);
+    tracking.buildOverlapGraph(run);
+}
+
+#pragma mark -
+#pragma mark Test parameterization
+
+TYPED_TEST_CASE(TrackingMergeSplitTest2D, DataTypes);
+
+TYPED_TEST(TrackingMergeSplitTest2D, Tracking_OverlapGraph_2D)
+{
+    tracking_param_t params = Tracking<TypeParam>::defaultParams();
+    params.verbosity = VerbositySilent;
+    TrackingProbe<TypeParam> tracking(params);
+
+    typename TrackingProbe<TypeParam>::run_t run;
+    this->build_graph(tracking, run);
+
+    vector<int> expected;
+
+    expected.push_back(0);
+    expected.push_back(1);
+    EXPECT_EQ(expected, run.previousOverlaps[0]);
+
+    expected.clear();
+    expected.push_back(2);
+    EXPECT_EQ(expected, run.previousOverlaps[1]);
+    EXPECT_EQ(expected, run.previousOverlaps[2]);
+
+    expected.clear();
+    expected.push_back(1);
+    expected.push_back(2);
+    EXPECT_EQ(expected, run.currentOverlaps[2]);
+
+    expected.clear();
+    expected.push_back(3);
+    EXPECT_EQ(expected, run.currentOverlaps[3]);
+    EXPECT_EQ(expected, run.previousOverlaps[3]);
+
+    // Merge candidates of current 0
+
+    bool track_flag = false;
+    vector<int> candidates;
+    id_set_t ids;
+    tracking.getMergeCandidates(run, 0, track_flag, candidates, ids);
+
+    expected.clear();
+    expected.push_back(0);
+    expected.push_back(1);
+    EXPECT_EQ(expected, candidates);
+    EXPECT_FALSE(track_flag);
+    EXPECT_EQ(2u, ids.size());
+    EXPECT_EQ(1u, ids.count(1));
+    EXPECT_EQ(1u, ids.count(2));
+
+    // Split candidates of previous 2
+
+    track_flag = false;
+    candidates.clear();
+    uuid_set_t uuids;
+    tracking.getSplitCandidates(run, 2, track_flag, candidates, uuids);
+
+    expected.clear();
+    expected.push_back(1);
+    expected.push_back(2);
+    EXPECT_EQ(expected, candidates);
+    EXPECT_FALSE(track_flag);
+    EXPECT_EQ(2u, uuids.size());
+    EXPECT_EQ(1u, uuids.count(102));
+    EXPECT_EQ(1u, uuids.count(103));
+
+    // Too little coverage for a merge or a split
+
+    candidates.clear();
+    ids.clear();
+    tracking.getMergeCandidates(run, 3, track_flag, candidates, ids);
+    EXPECT_TRUE(candidates.empty());
+
+    candidates.clear();
+    uuids.clear();
+    tracking.getSplitCandidates(run, 3, track_flag, candidates, uuids);
+    EXPECT_TRUE(candidates.empty());
+
+    // Previous clusters already tracked are not merged
+
+    this->m_current->tracked_ids.insert(1);
+
+    candidates.clear();
+    ids.clear();
+    tracking.getMergeCandidates(run, 0, track_flag, candidates, ids);
+
+    expected.clear();
+    expected.push_back(1);
+    EXPECT_EQ(expected, candidates);
+}
+
+#endif
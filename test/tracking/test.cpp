@@ -0,0 +1,16 @@
+//
+//  test.cpp
+//  cf-algorithms
+//
+//  Created by Jürgen Lorenz Simon on 5/3/12.
+//  Copyright (c) 2012 Jürgen Lorenz Simon. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+#include "testcases.h"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,48 @@
+#ifndef M3D_TESTS_TRACKING_TESTCASES_H
+#define M3D_TESTS_TRACKING_TESTCASES_H
+
+#include <meanie3D/meanie3D.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <iostream>
+#include <fstream>
+
+#pragma mark - 
+#pragma mark Switch individual tests on/off here
+
+#define RUN_CORRELATION 1
+#define RUN_CLUSTER_FILE 1
+#define RUN_MERGE_SPLIT 1
+
+#pragma mark -
+#pragma mark Data Types 
+
+using ::testing::Types;
+using namespace std;
+
+typedef Types< float, double > DataTypes;
+
+#pragma mark -
+#pragma mark Correlation data (parallel vs. serial)
+
+#if RUN_CORRELATION
+#include "correlation.h"
+#endif
+
+#pragma mark -
+#pragma mark Cluster file layout
+
+#if RUN_CLUSTER_FILE
+#include "cluster_file.h"
+#endif
+
+#pragma mark -
+#pragma mark Merge and split candidates
+
+#if RUN_MERGE_SPLIT
+#include "merge_split.h"
+#endif
+
+#endif
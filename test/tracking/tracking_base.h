@@ -0,0 +1,89 @@
+#ifndef M3D_TEST_TRACKING_BASE_H
+#define M3D_TEST_TRACKING_BASE_H
+
+//
+//  tracking_base.h
+//  cf-algorithms
+//
+//  Base fixture for the tracking tests. Provides a 2D coordinate
+//  system and builds rectangular clusters on its grid.
+//
+
+#include "../testcase_base.h"
+
+#pragma mark -
+#pragma mark Tracking with access to the individual steps
+
+template <class T>
+class TrackingProbe : public Tracking<T>
+{
+public:
+
+    typedef typename Tracking<T>::tracking_run_t run_t;
+    typedef typename Tracking<T>::candidate_t candidate_t;
+
+    TrackingProbe(tracking_param_t params) : Tracking<T>(params) {};
+
+    using Tracking<T>::calculateCorrelationData;
+    using Tracking<T>::calculateProbabilities;
+    using Tracking<T>::buildOverlapGraph;
+    using Tracking<T>::getMergeCandidates;
+    using Tracking<T>::getSplitCandidates;
+};
+
+#pragma mark -
+#pragma mark Test Fixture
+
+template <class T>
+class TrackingTestBase : public FSTestBase<T>
+{
+protected:
+
+    typename ClusterList<T>::ptr m_previous;
+    typename ClusterList<T>::ptr m_current;
+
+    /** Creates a cluster covering the grid points from origin 
+     * to origin + extent (exclusive). All points have the given
+     * value.
+     * @param id
+     * @param origin (grid point)
+     * @param extent (number of grid points in each dimension)
+     * @param value
+     * @return cluster
+     */
+    typename Cluster<T>::ptr create_cluster(m3D::id_t id,
+            const vector<int> &origin,
+            const vector<int> &extent,
+            T value);
+
+    /** @param clusters
+     * @return cluster list with one variable 'value' on the
+     * test coordinate system
+     */
+    typename ClusterList<T>::ptr create_list(const typename Cluster<T>::list &clusters,
+            long timestamp);
+
+    /** Fills the run with the lists and coordinate system of
+     * the fixture and the derived constraints, the way the 
+     * tracking initialises a run.
+     * @param run
+     * @param max displacement in meters
+     */
+    void prepare_run(typename TrackingProbe<T>::run_t &run, T maxDisplacement);
+
+    /** Deletes the previous and current lists and their clusters
+     */
+    void delete_lists();
+
+public:
+
+    TrackingTestBase();
+
+    virtual void SetUp();
+
+    virtual void TearDown();
+};
+
+#include "tracking_base_impl.h"
+
+#endif
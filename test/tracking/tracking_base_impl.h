@@ -0,0 +1,139 @@
+#ifndef M3D_TEST_TRACKING_BASE_IMPL_H
+#define M3D_TEST_TRACKING_BASE_IMPL_H
+
+#include <typeinfo>
+
+template<class T>
+TrackingTestBase<T>::TrackingTestBase() : FSTestBase<T>(), m_previous(NULL), m_current(NULL)
+{
+    this->m_settings = new FSTestSettings(2, 1, 100, FSTestBase<T>::filename_from_current_testcase());
+}
+
+template<class T>
+void TrackingTestBase<T>::SetUp()
+{
+    const ::testing::TestInfo * const test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+
+    INFO << "Setting up test " << test_info->test_case_name() << " with typeid " << typeid (T).name() << endl;
+
+    FSTestBase<T>::SetUp();
+
+    // Axis values go from -bound to +bound over num_gridpoints
+    // intervals, which makes the resolution 1.0 (meters)
+
+    float bound = 0.5f * this->m_settings->num_gridpoints();
+
+    vector<float> bounds(this->m_settings->num_dimensions(), bound);
+
+    this->m_settings->set_axis_bound_values(bounds);
+
+    try {
+        this->generate_dimensions();
+    } catch (const netCDF::exceptions::NcException &e) {
+        cerr << "FATAL:error while generating dimensions: " << e.what() << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    this->add_variable("value", 0.0, FS_VALUE_MAX);
+}
+
+template<class T>
+void TrackingTestBase<T>::TearDown()
+{
+    delete_lists();
+
+    FSTestBase<T>::TearDown();
+}
+
+template<class T>
+void TrackingTestBase<T>::delete_lists()
+{
+    if (m_previous != NULL) {
+        m_previous->clear(true);
+        delete m_previous;
+        m_previous = NULL;
+    }
+
+    if (m_current != NULL) {
+        m_current->clear(true);
+        delete m_current;
+        m_current = NULL;
+    }
+}
+
+template<class T>
+typename Cluster<T>::ptr
+TrackingTestBase<T>::create_cluster(m3D::id_t id,
+        const vector<int> &origin,
+        const vector<int> &extent,
+        T value)
+{
+    const CoordinateSystem<T> *cs = this->coordinate_system();
+
+    size_t rank = cs->rank();
+
+    typename Cluster<T>::ptr cluster = new Cluster<T>(vector<T>(rank + 1, 0.0), rank);
+    cluster->id = id;
+
+    size_t count = 1;
+    for (size_t d = 0; d < rank; d++) {
+        count *= extent[d];
+    }
+
+    vector<int> gridpoint(rank);
+    vector<T> coordinate(rank);
+
+    for (size_t i = 0; i < count; i++) {
+        size_t code = i;
+        for (size_t d = 0; d < rank; d++) {
+            gridpoint[d] = origin[d] + (int) (code % extent[d]);
+            code /= extent[d];
+        }
+
+        cs->lookup(gridpoint, coordinate);
+
+        vector<T> values(coordinate);
+        values.push_back(value);
+
+        cluster->add_point(new Point<T>(gridpoint, coordinate, values));
+    }
+
+    return cluster;
+}
+
+template<class T>
+typename ClusterList<T>::ptr
+TrackingTestBase<T>::create_list(const typename Cluster<T>::list &clusters, long timestamp)
+{
+    vector<string> variables(1, "value");
+
+    return new ClusterList<T>(clusters,
+            this->m_filename,
+            variables,
+            this->m_dimensions,
+            this->m_dimension_variables,
+            timestamp);
+}
+
+template<class T>
+void
+TrackingTestBase<T>::prepare_run(typename TrackingProbe<T>::run_t &run, T maxDisplacement)
+{
+    run.previous = m_previous;
+    run.current = m_current;
+    run.N = m_current->size();
+    run.M = m_previous->size();
+    run.cs = this->coordinate_system();
+    run.owns_cs = false;
+    run.info_file = NULL;
+
+    run.haveHistogramInfo = true;
+    run.tracking_var_index = this->coordinate_system()->rank();
+    run.valid_min = 0.0;
+    run.valid_max = FS_VALUE_MAX;
+
+    run.maxDisplacement = ::units::values::m(maxDisplacement);
+    run.overlap_constraint_radius = ::units::values::m(0.5 * maxDisplacement);
+}
+
+#endif